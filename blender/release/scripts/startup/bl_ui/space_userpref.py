@@ -698,6 +698,7 @@ class USERPREF_PT_viewport_textures(PreferencePanel, Panel):
         flow.prop(system, "anisotropic_filter")
         flow.prop(system, "gl_clip_alpha", slider=True)
         flow.prop(system, "image_draw_method", text="Image Display Method")
+        flow.prop(system, "use_display_transform_lut")
 
 
 class USERPREF_PT_viewport_selection(PreferencePanel, Panel):
@@ -58,6 +58,9 @@ struct CDStreamConfig {
 
   bool pack_uvs;
 
+  /* Polygons and loops of the mesh already match the sample, only loop data is written. */
+  bool keep_topology;
+
   /* TODO(kevin): might need a better way to handle adding and/or updating
    * custom datas such that it updates the custom data holder and its pointers
    * properly. */
@@ -76,6 +79,7 @@ struct CDStreamConfig {
         totpoly(0),
         totvert(0),
         pack_uvs(false),
+        keep_topology(false),
         mesh(NULL),
         add_customdata_cb(NULL),
         weight(0.0f),
@@ -20,6 +20,7 @@
 
 #include "abc_exporter.h"
 
+#include <algorithm>
 #include <cmath>
 
 #include "abc_archive.h"
@@ -44,6 +45,7 @@ extern "C" {
 #include "DNA_space_types.h" /* for FILE_MAX */
 
 #include "BLI_string.h"
+#include "BLI_task.h"
 
 #ifdef WIN32
 /* needed for MSCV because of snprintf from BLI_string */
@@ -332,8 +334,8 @@ void AbcExporter::operator()(short *do_update, float *progress, bool *was_cancel
   const float size = static_cast<float>(frames.size());
   size_t i = 0;
 
-  for (; begin != end; ++begin) {
-    *progress = (++i / size);
+  for (; begin != end; ++begin, ++i) {
+    *progress = (i / size);
     *do_update = 1;
 
     if (G.is_break) {
@@ -347,9 +349,7 @@ void AbcExporter::operator()(short *do_update, float *progress, bool *was_cancel
     setCurrentFrame(m_bmain, frame);
 
     if (shape_frames.count(frame) != 0) {
-      for (int i = 0, e = m_shapes.size(); i != e; i++) {
-        m_shapes[i]->write();
-      }
+      writeShapes(i / size, (i + 1) / size, do_update, progress);
     }
 
     if (xform_frames.count(frame) == 0) {
@@ -371,6 +371,55 @@ void AbcExporter::operator()(short *do_update, float *progress, bool *was_cancel
 
     archive_bounds_prop.set(bounds);
   }
+
+  if (!*was_canceled) {
+    *progress = 1.0f;
+    *do_update = 1;
+  }
+}
+
+static void prepare_shape_cb(void *__restrict userdata,
+                             const int iter,
+                             const TaskParallelTLS *__restrict /*tls*/)
+{
+  AbcObjectWriter **shapes = static_cast<AbcObjectWriter **>(userdata);
+  shapes[iter]->prepare();
+}
+
+/* Shapes are exported in batches. The objects of a batch are evaluated one at a time, since
+ * modifiers may read or rebuild the evaluated mesh of other objects. Their meshes are then
+ * converted in parallel, and the samples are written to the archive one writer at a time, since
+ * the archive can't be written from multiple threads. Batches bound the memory used by evaluated
+ * meshes and converted samples, and allow reporting progress within a frame. */
+void AbcExporter::writeShapes(float progress_start,
+                              float progress_end,
+                              short *do_update,
+                              float *progress)
+{
+  const int batch_size = 256;
+  const int num_shapes = m_shapes.size();
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  /* Mesh sizes and modifier stacks vary a lot between objects. */
+  settings.scheduling_mode = TASK_SCHEDULING_DYNAMIC;
+
+  for (int start = 0; start < num_shapes; start += batch_size) {
+    const int end = std::min(start + batch_size, num_shapes);
+
+    for (int i = start; i < end; i++) {
+      m_shapes[i]->evaluate();
+    }
+
+    BLI_task_parallel_range(0, end - start, &m_shapes[start], prepare_shape_cb, &settings);
+
+    for (int i = start; i < end; i++) {
+      m_shapes[i]->write();
+    }
+
+    *progress = progress_start + (progress_end - progress_start) * end / num_shapes;
+    *do_update = 1;
+  }
 }
 
 void AbcExporter::createTransformWritersHierarchy()
@@ -599,7 +648,15 @@ void AbcExporter::createShapeWriter(Object *ob, Object *dupliObParent)
         return;
       }
 
-      m_shapes.push_back(new AbcMeshWriter(ob, xform, m_shape_sampling_index, m_settings));
+      AbcMeshWriter *writer = new AbcMeshWriter(ob, xform, m_shape_sampling_index, m_settings);
+
+      /* An object may be instanced more than once. Evaluating it again for the next instance could
+       * rebuild the mesh the previous one is still converting, so only its first writer converts
+       * in parallel. Metaballs and curves are converted through Main or shared caches, so they
+       * are done serially. */
+      writer->setPrepareInParallel(m_parallel_mesh_objects.insert(ob).second);
+
+      m_shapes.push_back(writer);
       break;
     }
     case OB_SURF: {
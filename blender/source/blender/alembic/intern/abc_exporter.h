@@ -99,6 +99,8 @@ class AbcExporter {
   m_xforms_type m_xforms;
 
   std::vector<AbcObjectWriter *> m_shapes;
+  /* Objects of the mesh writers that evaluate in parallel. */
+  std::set<Object *> m_parallel_mesh_objects;
 
  public:
   AbcExporter(Main *bmain, const char *filename, ExportSettings &settings);
@@ -123,6 +125,11 @@ class AbcExporter {
   void createShapeWriter(Object *ob, Object *dupliObParent);
   void createParticleSystemsWriters(Object *ob, AbcTransformWriter *xform);
 
+  void writeShapes(float progress_start,
+                   float progress_end,
+                   short *do_update,
+                   float *progress);
+
   AbcTransformWriter *getXForm(const std::string &name);
 
   void setCurrentFrame(Main *bmain, double t);
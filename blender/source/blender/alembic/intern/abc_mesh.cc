@@ -33,8 +33,10 @@ extern "C" {
 #include "DNA_object_fluidsim_types.h"
 #include "DNA_object_types.h"
 
+#include "BLI_hash_mm2a.h"
 #include "BLI_math_geom.h"
 #include "BLI_string.h"
+#include "BLI_task.h"
 
 #include "BKE_animsys.h"
 #include "BKE_key.h"
@@ -297,6 +299,11 @@ AbcGenericMeshWriter::AbcGenericMeshWriter(Object *ob,
   m_is_animated = isAnimated();
   m_subsurf_mod = NULL;
   m_is_subd = false;
+  m_export_loop_normals = false;
+  m_eval_mesh = NULL;
+  m_eval_mesh_needsfree = false;
+  m_is_prepared = false;
+  m_prepare_in_parallel = false;
 
   /* If the object is static, use the default static time sampling. */
   if (!m_is_animated) {
@@ -333,6 +340,10 @@ AbcGenericMeshWriter::~AbcGenericMeshWriter()
   if (m_subsurf_mod) {
     m_subsurf_mod->mode &= ~eModifierMode_DisableTemporary;
   }
+
+  if (m_eval_mesh && m_eval_mesh_needsfree) {
+    BKE_id_free(NULL, m_eval_mesh);
+  }
 }
 
 bool AbcGenericMeshWriter::isAnimated() const
@@ -369,6 +380,46 @@ void AbcGenericMeshWriter::setIsAnimated(bool is_animated)
   m_is_animated = is_animated;
 }
 
+void AbcGenericMeshWriter::setPrepareInParallel(bool prepare_in_parallel)
+{
+  m_prepare_in_parallel = prepare_in_parallel;
+}
+
+void AbcGenericMeshWriter::do_evaluate()
+{
+  /* The first frame also writes face sets, UVs and custom data, which need the mesh itself. */
+  if (m_first_frame || !m_is_animated || !m_prepare_in_parallel) {
+    return;
+  }
+
+  m_eval_mesh = evaluateMesh(m_eval_mesh_needsfree);
+}
+
+void AbcGenericMeshWriter::do_prepare()
+{
+  if (m_eval_mesh == NULL) {
+    return;
+  }
+
+  bool needsfree = m_eval_mesh_needsfree;
+  struct Mesh *mesh = triangulateMesh(m_eval_mesh, needsfree);
+  m_eval_mesh = NULL;
+  m_eval_mesh_needsfree = false;
+
+  try {
+    getSampleData(mesh);
+    m_is_prepared = true;
+  }
+  catch (...) {
+    /* Leave it to do_write(), which reports errors from the main thread. */
+    clearSampleData();
+  }
+
+  if (needsfree) {
+    freeEvaluatedMesh(mesh);
+  }
+}
+
 void AbcGenericMeshWriter::do_write()
 {
   /* We have already stored a sample for this object. */
@@ -376,10 +427,30 @@ void AbcGenericMeshWriter::do_write()
     return;
   }
 
+  if (m_is_prepared) {
+    /* The sample data is already converted, only the archive is written here. */
+    try {
+      if (m_settings.use_subdiv_schema && m_subdiv_schema.valid()) {
+        writeSubD(NULL);
+      }
+      else {
+        writeMesh(NULL);
+      }
+      clearSampleData();
+    }
+    catch (...) {
+      clearSampleData();
+      throw;
+    }
+    return;
+  }
+
   bool needsfree;
   struct Mesh *mesh = getFinalMesh(needsfree);
 
   try {
+    getSampleData(mesh);
+
     if (m_settings.use_subdiv_schema && m_subdiv_schema.valid()) {
       writeSubD(mesh);
     }
@@ -387,11 +458,15 @@ void AbcGenericMeshWriter::do_write()
       writeMesh(mesh);
     }
 
+    clearSampleData();
+
     if (needsfree) {
       freeEvaluatedMesh(mesh);
     }
   }
   catch (...) {
+    clearSampleData();
+
     if (needsfree) {
       freeEvaluatedMesh(mesh);
     }
@@ -404,23 +479,60 @@ void AbcGenericMeshWriter::freeEvaluatedMesh(struct Mesh *mesh)
   BKE_id_free(NULL, mesh);
 }
 
-void AbcGenericMeshWriter::writeMesh(struct Mesh *mesh)
+void AbcGenericMeshWriter::getSampleData(struct Mesh *mesh)
 {
-  std::vector<Imath::V3f> points, normals;
-  std::vector<int32_t> poly_verts, loop_counts;
-  std::vector<Imath::V3f> velocities;
+  get_vertices(mesh, m_points);
+
+  if (m_settings.use_subdiv_schema && m_subdiv_schema.valid()) {
+    m_export_loop_normals = false;
+    get_topology(mesh, m_poly_verts, m_loop_counts, m_export_loop_normals);
+    get_creases(mesh, m_crease_indices, m_crease_lengths, m_crease_sharpness);
+    return;
+  }
+
+  m_export_loop_normals = (mesh->flag & ME_AUTOSMOOTH) != 0;
+  get_topology(mesh, m_poly_verts, m_loop_counts, m_export_loop_normals);
+
+  if (m_settings.export_normals) {
+    if (m_export_loop_normals) {
+      get_loop_normals(mesh, m_normals);
+    }
+    else {
+      get_vertex_normals(mesh, m_normals);
+    }
+  }
+
+  if (m_is_liquid) {
+    getVelocities(mesh, m_velocities);
+  }
+}
 
-  bool export_loop_normals = (mesh->flag & ME_AUTOSMOOTH) != 0;
+/* Free the sample data once it is written, it is only needed for one frame at a time. */
+void AbcGenericMeshWriter::clearSampleData()
+{
+  std::vector<Imath::V3f>().swap(m_points);
+  std::vector<Imath::V3f>().swap(m_normals);
+  std::vector<Imath::V3f>().swap(m_velocities);
+  std::vector<int32_t>().swap(m_poly_verts);
+  std::vector<int32_t>().swap(m_loop_counts);
+  std::vector<int32_t>().swap(m_crease_indices);
+  std::vector<int32_t>().swap(m_crease_lengths);
+  std::vector<float>().swap(m_crease_sharpness);
+  m_is_prepared = false;
+}
 
-  get_vertices(mesh, points);
-  get_topology(mesh, poly_verts, loop_counts, export_loop_normals);
+/* Write the sample data from getSampleData(). The mesh is only needed on the first frame. */
+void AbcGenericMeshWriter::writeMesh(struct Mesh *mesh)
+{
+  BLI_assert(mesh != NULL || !m_first_frame);
 
   if (m_first_frame && m_settings.export_face_sets) {
     writeFaceSets(mesh, m_mesh_schema);
   }
 
-  m_mesh_sample = OPolyMeshSchema::Sample(
-      V3fArraySample(points), Int32ArraySample(poly_verts), Int32ArraySample(loop_counts));
+  m_mesh_sample = OPolyMeshSchema::Sample(V3fArraySample(m_points),
+                                          Int32ArraySample(m_poly_verts),
+                                          Int32ArraySample(m_loop_counts));
 
   UVSample sample;
   if (m_first_frame && m_settings.export_uvs) {
@@ -441,25 +553,17 @@ void AbcGenericMeshWriter::writeMesh(struct Mesh *mesh)
   }
 
   if (m_settings.export_normals) {
-    if (export_loop_normals) {
-      get_loop_normals(mesh, normals);
-    }
-    else {
-      get_vertex_normals(mesh, normals);
-    }
-
     ON3fGeomParam::Sample normals_sample;
-    if (!normals.empty()) {
-      normals_sample.setScope(export_loop_normals ? kFacevaryingScope : kVertexScope);
-      normals_sample.setVals(V3fArraySample(normals));
+    if (!m_normals.empty()) {
+      normals_sample.setScope(m_export_loop_normals ? kFacevaryingScope : kVertexScope);
+      normals_sample.setVals(V3fArraySample(m_normals));
     }
 
     m_mesh_sample.setNormals(normals_sample);
   }
 
   if (m_is_liquid) {
-    getVelocities(mesh, velocities);
-    m_mesh_sample.setVelocities(V3fArraySample(velocities));
+    m_mesh_sample.setVelocities(V3fArraySample(m_velocities));
   }
 
   m_mesh_sample.setSelfBounds(bounds());
@@ -471,23 +575,15 @@ void AbcGenericMeshWriter::writeMesh(struct Mesh *mesh)
 
 void AbcGenericMeshWriter::writeSubD(struct Mesh *mesh)
 {
-  std::vector<float> crease_sharpness;
-  std::vector<Imath::V3f> points;
-  std::vector<int32_t> poly_verts, loop_counts;
-  std::vector<int32_t> crease_indices, crease_lengths;
-
-  bool export_loop_normals = false;
-
-  get_vertices(mesh, points);
-  get_topology(mesh, poly_verts, loop_counts, export_loop_normals);
-  get_creases(mesh, crease_indices, crease_lengths, crease_sharpness);
+  BLI_assert(mesh != NULL || !m_first_frame);
 
   if (m_first_frame && m_settings.export_face_sets) {
     writeFaceSets(mesh, m_subdiv_schema);
   }
 
-  m_subdiv_sample = OSubDSchema::Sample(
-      V3fArraySample(points), Int32ArraySample(poly_verts), Int32ArraySample(loop_counts));
+  m_subdiv_sample = OSubDSchema::Sample(V3fArraySample(m_points),
+                                        Int32ArraySample(m_poly_verts),
+                                        Int32ArraySample(m_loop_counts));
 
   UVSample sample;
   if (m_first_frame && m_settings.export_uvs) {
@@ -507,10 +603,10 @@ void AbcGenericMeshWriter::writeSubD(struct Mesh *mesh)
         m_subdiv_schema.getArbGeomParams(), m_custom_data_config, &mesh->ldata, CD_MLOOPUV);
   }
 
-  if (!crease_indices.empty()) {
-    m_subdiv_sample.setCreaseIndices(Int32ArraySample(crease_indices));
-    m_subdiv_sample.setCreaseLengths(Int32ArraySample(crease_lengths));
-    m_subdiv_sample.setCreaseSharpnesses(FloatArraySample(crease_sharpness));
+  if (!m_crease_indices.empty()) {
+    m_subdiv_sample.setCreaseIndices(Int32ArraySample(m_crease_indices));
+    m_subdiv_sample.setCreaseLengths(Int32ArraySample(m_crease_lengths));
+    m_subdiv_sample.setCreaseSharpnesses(FloatArraySample(m_crease_sharpness));
   }
 
   m_subdiv_sample.setSelfBounds(bounds());
@@ -534,6 +630,13 @@ template<typename Schema> void AbcGenericMeshWriter::writeFaceSets(struct Mesh *
 }
 
 Mesh *AbcGenericMeshWriter::getFinalMesh(bool &r_needsfree)
+{
+  struct Mesh *mesh = evaluateMesh(r_needsfree);
+  return triangulateMesh(mesh, r_needsfree);
+}
+
+/* Get the evaluated mesh of the object. This may evaluate the object, which isn't thread-safe. */
+Mesh *AbcGenericMeshWriter::evaluateMesh(bool &r_needsfree)
 {
   /* We don't want subdivided mesh data */
   if (m_subsurf_mod) {
@@ -550,6 +653,13 @@ Mesh *AbcGenericMeshWriter::getFinalMesh(bool &r_needsfree)
     m_subsurf_mod->mode &= ~eModifierMode_DisableTemporary;
   }
 
+  return mesh;
+}
+
+/* Apply the export settings to an evaluated mesh. Only touches the given mesh, so this can run in
+ * parallel for different writers. */
+Mesh *AbcGenericMeshWriter::triangulateMesh(struct Mesh *mesh, bool &r_needsfree)
+{
   if (m_settings.triangulate) {
     const bool tag_only = false;
     const int quad_method = m_settings.quad_method;
@@ -746,9 +856,18 @@ static void assign_materials(Main *bmain,
 
 /* ************************************************************************** */
 
+using Alembic::AbcGeom::index_t;
 using Alembic::AbcGeom::UInt32ArraySamplePtr;
 using Alembic::AbcGeom::V2fArraySamplePtr;
 
+/* Number of samples read ahead of the current one while playing back. */
+#define ABC_PREFETCH_SAMPLES 2
+
+struct AbcMeshPrefetchTask {
+  index_t index;
+  int read_flag;
+};
+
 struct AbcMeshData {
   Int32ArraySamplePtr face_indices;
   Int32ArraySamplePtr face_counts;
@@ -820,7 +939,8 @@ void read_mverts(MVert *mverts,
   }
 }
 
-static void read_mpolys(CDStreamConfig &config, const AbcMeshData &mesh_data)
+/* Returns true when the polygons or loops of the mesh were changed. */
+static bool read_mpolys(CDStreamConfig &config, const AbcMeshData &mesh_data)
 {
   MPoly *mpolys = config.mpoly;
   MLoop *mloops = config.mloop;
@@ -835,16 +955,21 @@ static void read_mpolys(CDStreamConfig &config, const AbcMeshData &mesh_data)
 
   const bool do_uvs = (mloopuvs && uvs && uvs_indices) &&
                       (uvs_indices->size() == face_indices->size());
+  const bool keep_topology = config.keep_topology;
   unsigned int loop_index = 0;
   unsigned int rev_loop_index = 0;
   unsigned int uv_index = 0;
+  bool topology_changed = !keep_topology && (config.mesh->totedge == 0);
 
   for (int i = 0; i < face_counts->size(); i++) {
     const int face_size = (*face_counts)[i];
 
     MPoly &poly = mpolys[i];
-    poly.loopstart = loop_index;
-    poly.totloop = face_size;
+    if (!keep_topology) {
+      topology_changed |= (poly.loopstart != (int)loop_index || poly.totloop != face_size);
+      poly.loopstart = loop_index;
+      poly.totloop = face_size;
+    }
 
     if (mesh_data.poly_flag_smooth) {
       poly.flag |= ME_SMOOTH;
@@ -853,12 +978,21 @@ static void read_mpolys(CDStreamConfig &config, const AbcMeshData &mesh_data)
       poly.flag &= ~ME_SMOOTH;
     }
 
+    if (keep_topology && !do_uvs) {
+      loop_index += face_size;
+      continue;
+    }
+
     /* NOTE: Alembic data is stored in the reverse order. */
     rev_loop_index = loop_index + (face_size - 1);
 
     for (int f = 0; f < face_size; f++, loop_index++, rev_loop_index--) {
-      MLoop &loop = mloops[rev_loop_index];
-      loop.v = (*face_indices)[loop_index];
+      if (!keep_topology) {
+        MLoop &loop = mloops[rev_loop_index];
+        const unsigned int vert_index = (*face_indices)[loop_index];
+        topology_changed |= (loop.v != vert_index);
+        loop.v = vert_index;
+      }
 
       if (do_uvs) {
         MLoopUV &loopuv = mloopuvs[rev_loop_index];
@@ -876,7 +1010,12 @@ static void read_mpolys(CDStreamConfig &config, const AbcMeshData &mesh_data)
     }
   }
 
-  BKE_mesh_calc_edges(config.mesh, false, false);
+  /* Edges only depend on the loops, so keep them when streaming a mesh with constant topology. */
+  if (topology_changed) {
+    BKE_mesh_calc_edges(config.mesh, false, false);
+  }
+
+  return topology_changed;
 }
 
 static void process_normals(CDStreamConfig &config, const AbcMeshData &mesh_data)
@@ -915,15 +1054,12 @@ static void process_normals(CDStreamConfig &config, const AbcMeshData &mesh_data
 ABC_INLINE void read_uvs_params(CDStreamConfig &config,
                                 AbcMeshData &abc_data,
                                 const IV2fGeomParam &uv,
-                                const ISampleSelector &selector)
+                                const IV2fGeomParam::Sample &uvsamp)
 {
-  if (!uv.valid()) {
+  if (!uv.valid() || !uvsamp.valid()) {
     return;
   }
 
-  IV2fGeomParam::Sample uvsamp;
-  uv.getIndexed(uvsamp, selector);
-
   abc_data.uvs = uvsamp.getVals();
   abc_data.uvs_indices = uvsamp.getIndices();
 
@@ -944,14 +1080,12 @@ ABC_INLINE void read_uvs_params(CDStreamConfig &config,
 
 ABC_INLINE void read_normals_params(AbcMeshData &abc_data,
                                     const IN3fGeomParam &normals,
-                                    const ISampleSelector &selector)
+                                    const IN3fGeomParam::Sample &normsamp)
 {
-  if (!normals.valid()) {
+  if (!normals.valid() || !normsamp.valid()) {
     return;
   }
 
-  IN3fGeomParam::Sample normsamp = normals.getExpandedValue(selector);
-
   Alembic::AbcGeom::GeometryScope scope = normals.getScope();
   switch (scope) {
     case Alembic::AbcGeom::kFacevaryingScope:
@@ -1007,35 +1141,78 @@ static void get_weight_and_index(CDStreamConfig &config,
   config.ceil_index = i1;
 }
 
-static void read_mesh_sample(const std::string &iobject_full_name,
+/* Read the parts of a mesh sample that read_mesh_sample() converts. This does the actual I/O and
+ * decompression, and may run on a background thread. */
+static void read_abc_mesh_sample(const IPolyMeshSchema &schema,
+                                 const index_t index,
+                                 const int read_flag,
+                                 AbcMeshSample &r_sample)
+{
+  const ISampleSelector selector(index);
+
+  r_sample.sample = schema.getValue(selector);
+  r_sample.read_flag = read_flag;
+
+  /* Normals are only used when reading polygons. */
+  const IN3fGeomParam normals = schema.getNormalsParam();
+  if ((read_flag & MOD_MESHSEQ_READ_POLY) != 0 && normals.valid()) {
+    r_sample.normals = normals.getExpandedValue(selector);
+  }
+
+  const IV2fGeomParam uvs = schema.getUVsParam();
+  if ((read_flag & MOD_MESHSEQ_READ_UV) != 0 && uvs.valid()) {
+    uvs.getIndexed(r_sample.uvs, selector);
+  }
+}
+
+static bool mesh_topology_changed(const Mesh *existing_mesh,
+                                  const IPolyMeshSchema::Sample &sample)
+{
+  const P3fArraySamplePtr &positions = sample.getPositions();
+  const Alembic::Abc::Int32ArraySamplePtr &face_indices = sample.getFaceIndices();
+  const Alembic::Abc::Int32ArraySamplePtr &face_counts = sample.getFaceCounts();
+
+  return positions->size() != existing_mesh->totvert ||
+         face_counts->size() != existing_mesh->totpoly ||
+         face_indices->size() != existing_mesh->totloop;
+}
+
+/* Hash of the polygons and loops of the mesh, to notice when the input of the modifier
+ * changes without changing its counts, e.g. after editing the original mesh. */
+static uint32_t mesh_topology_hash(const Mesh *mesh)
+{
+  uint32_t hash = BLI_hash_mm2(
+      (const unsigned char *)mesh->mpoly, sizeof(MPoly) * (size_t)mesh->totpoly, 0);
+  return BLI_hash_mm2(
+      (const unsigned char *)mesh->mloop, sizeof(MLoop) * (size_t)mesh->totloop, hash);
+}
+
+/* Returns true when the polygons or loops of the mesh were changed. */
+static bool read_mesh_sample(const std::string &iobject_full_name,
                              ImportSettings *settings,
                              const IPolyMeshSchema &schema,
+                             const AbcMeshSample &mesh_sample,
+                             const P3fArraySamplePtr &ceil_positions,
                              const ISampleSelector &selector,
                              CDStreamConfig &config)
 {
-  const IPolyMeshSchema::Sample sample = schema.getValue(selector);
+  const IPolyMeshSchema::Sample &sample = mesh_sample.sample;
+  bool topology_changed = false;
 
   AbcMeshData abc_mesh_data;
   abc_mesh_data.face_counts = sample.getFaceCounts();
   abc_mesh_data.face_indices = sample.getFaceIndices();
   abc_mesh_data.positions = sample.getPositions();
+  abc_mesh_data.ceil_positions = ceil_positions;
 
   /* The auto-smoothing flag can be used by artists when the Alembic file does not contain custom
    * loop normals. Auto-smoothing only works when polys are marked as smooth. */
   abc_mesh_data.poly_flag_smooth = (config.mesh->flag & ME_AUTOSMOOTH);
 
-  read_normals_params(abc_mesh_data, schema.getNormalsParam(), selector);
-
-  get_weight_and_index(config, schema.getTimeSampling(), schema.getNumSamples());
-
-  if (config.weight != 0.0f) {
-    Alembic::AbcGeom::IPolyMeshSchema::Sample ceil_sample;
-    schema.get(ceil_sample, Alembic::Abc::ISampleSelector(config.ceil_index));
-    abc_mesh_data.ceil_positions = ceil_sample.getPositions();
-  }
+  read_normals_params(abc_mesh_data, schema.getNormalsParam(), mesh_sample.normals);
 
   if ((settings->read_flag & MOD_MESHSEQ_READ_UV) != 0) {
-    read_uvs_params(config, abc_mesh_data, schema.getUVsParam(), selector);
+    read_uvs_params(config, abc_mesh_data, schema.getUVsParam(), mesh_sample.uvs);
   }
 
   if ((settings->read_flag & MOD_MESHSEQ_READ_VERT) != 0) {
@@ -1043,13 +1220,15 @@ static void read_mesh_sample(const std::string &iobject_full_name,
   }
 
   if ((settings->read_flag & MOD_MESHSEQ_READ_POLY) != 0) {
-    read_mpolys(config, abc_mesh_data);
+    topology_changed = read_mpolys(config, abc_mesh_data);
     process_normals(config, abc_mesh_data);
   }
 
   if ((settings->read_flag & (MOD_MESHSEQ_READ_UV | MOD_MESHSEQ_READ_COLOR)) != 0) {
     read_custom_data(iobject_full_name, schema.getArbGeomParams(), config, selector);
   }
+
+  return topology_changed;
 }
 
 CDStreamConfig get_config(Mesh *mesh)
@@ -1073,7 +1252,11 @@ CDStreamConfig get_config(Mesh *mesh)
 /* ************************************************************************** */
 
 AbcMeshReader::AbcMeshReader(const IObject &object, ImportSettings &settings)
-    : AbcObjectReader(object, settings)
+    : AbcObjectReader(object, settings),
+      m_prefetch_index(0),
+      m_prefetch_pool(NULL),
+      m_topology_verified(false),
+      m_topology_hash(0)
 {
   m_settings->read_flag |= MOD_MESHSEQ_READ_ALL;
 
@@ -1081,6 +1264,16 @@ AbcMeshReader::AbcMeshReader(const IObject &object, ImportSettings &settings)
   m_schema = ipoly_mesh.getSchema();
 
   get_min_max_time(m_iobject, m_schema, m_min_time, m_max_time);
+
+  BLI_mutex_init(&m_prefetch_mutex);
+  BLI_condition_init(&m_prefetch_cond);
+}
+
+AbcMeshReader::~AbcMeshReader()
+{
+  finish_prefetch();
+  BLI_condition_end(&m_prefetch_cond);
+  BLI_mutex_end(&m_prefetch_mutex);
 }
 
 bool AbcMeshReader::valid() const
@@ -1135,11 +1328,149 @@ bool AbcMeshReader::accepts_object_type(
   return true;
 }
 
+/* Get a sample from the prefetched ones, or read it when it isn't available. A sample that is
+ * being read in the background with the needed data is waited for instead of being read twice.
+ * Reads that didn't start yet are taken over, waiting for them could block all worker threads. */
+void AbcMeshReader::read_sample(const index_t index, const int read_flag, AbcMeshSample &r_sample)
+{
+  bool found = false;
+
+  BLI_mutex_lock(&m_prefetch_mutex);
+  while (true) {
+    std::map<index_t, AbcMeshSample>::const_iterator iter = m_prefetched_samples.find(index);
+    if (iter != m_prefetched_samples.end() && (iter->second.read_flag & read_flag) == read_flag) {
+      r_sample = iter->second;
+      found = true;
+      break;
+    }
+
+    std::map<index_t, int>::const_iterator running = m_prefetch_running.find(index);
+    if (running == m_prefetch_running.end() || (running->second & read_flag) != read_flag) {
+      m_prefetch_queued.erase(index);
+      break;
+    }
+    BLI_condition_wait(&m_prefetch_cond, &m_prefetch_mutex);
+  }
+  BLI_mutex_unlock(&m_prefetch_mutex);
+
+  if (found) {
+    return;
+  }
+
+  read_abc_mesh_sample(m_schema, index, read_flag, r_sample);
+
+  if (m_use_prefetch) {
+    /* Keep it around, the same sample is often requested twice for the ORCO mesh. */
+    BLI_mutex_lock(&m_prefetch_mutex);
+    m_prefetched_samples[index] = r_sample;
+    BLI_mutex_unlock(&m_prefetch_mutex);
+  }
+}
+
+/* Queue reading the samples following the given one on a background thread, and drop cached
+ * samples outside of that range, so the cache stays bounded when jumping to another frame. */
+void AbcMeshReader::prefetch_samples(const index_t index, const int read_flag)
+{
+  const index_t last_index = std::min<index_t>(index + ABC_PREFETCH_SAMPLES,
+                                               m_schema.getNumSamples() - 1);
+
+  BLI_mutex_lock(&m_prefetch_mutex);
+  m_prefetch_index = index;
+
+  std::map<index_t, AbcMeshSample>::iterator iter = m_prefetched_samples.begin();
+  while (iter != m_prefetched_samples.end()) {
+    if (iter->first < index || iter->first > last_index) {
+      iter = m_prefetched_samples.erase(iter);
+    }
+    else {
+      ++iter;
+    }
+  }
+
+  for (index_t prefetch_index = index + 1; prefetch_index <= last_index; prefetch_index++) {
+    if (m_prefetched_samples.count(prefetch_index) || m_prefetch_queued.count(prefetch_index) ||
+        m_prefetch_running.count(prefetch_index)) {
+      continue;
+    }
+
+    if (m_prefetch_pool == NULL) {
+      m_prefetch_pool = BLI_task_pool_create_background(BLI_task_scheduler_get(), this);
+    }
+
+    AbcMeshPrefetchTask *task = static_cast<AbcMeshPrefetchTask *>(
+        MEM_mallocN(sizeof(AbcMeshPrefetchTask), "AbcMeshPrefetchTask"));
+    task->index = prefetch_index;
+    task->read_flag = read_flag;
+
+    m_prefetch_queued[prefetch_index] = read_flag;
+    BLI_task_pool_push(m_prefetch_pool, prefetch_sample_task, task, true, TASK_PRIORITY_LOW);
+  }
+  BLI_mutex_unlock(&m_prefetch_mutex);
+}
+
+void AbcMeshReader::prefetch_sample_task(TaskPool *__restrict pool,
+                                         void *taskdata,
+                                         int /*threadid*/)
+{
+  AbcMeshReader *reader = static_cast<AbcMeshReader *>(BLI_task_pool_userdata(pool));
+  const AbcMeshPrefetchTask *task = static_cast<const AbcMeshPrefetchTask *>(taskdata);
+
+  AbcMeshSample sample;
+  bool is_valid = !BLI_task_pool_canceled(pool);
+
+  /* Evaluation may have taken over the read already. */
+  BLI_mutex_lock(&reader->m_prefetch_mutex);
+  if (reader->m_prefetch_queued.erase(task->index) == 0) {
+    is_valid = false;
+  }
+  if (is_valid) {
+    reader->m_prefetch_running[task->index] = task->read_flag;
+  }
+  BLI_mutex_unlock(&reader->m_prefetch_mutex);
+
+  if (!is_valid) {
+    return;
+  }
+
+  try {
+    read_abc_mesh_sample(reader->m_schema, task->index, task->read_flag, sample);
+  }
+  catch (Alembic::Util::Exception &) {
+    /* The error is reported when the sample is read again for evaluation. */
+    is_valid = false;
+  }
+
+  BLI_mutex_lock(&reader->m_prefetch_mutex);
+  reader->m_prefetch_running.erase(task->index);
+  if (is_valid && task->index > reader->m_prefetch_index &&
+      task->index <= reader->m_prefetch_index + ABC_PREFETCH_SAMPLES) {
+    reader->m_prefetched_samples[task->index] = sample;
+  }
+  BLI_condition_notify_all(&reader->m_prefetch_cond);
+  BLI_mutex_unlock(&reader->m_prefetch_mutex);
+}
+
+void AbcMeshReader::finish_prefetch()
+{
+  if (m_prefetch_pool != NULL) {
+    /* Cancels queued reads and waits for the running ones. */
+    BLI_task_pool_free(m_prefetch_pool);
+    m_prefetch_pool = NULL;
+  }
+
+  m_prefetched_samples.clear();
+  m_prefetch_queued.clear();
+  m_prefetch_running.clear();
+}
+
 bool AbcMeshReader::topology_changed(Mesh *existing_mesh, const ISampleSelector &sample_sel)
 {
-  IPolyMeshSchema::Sample sample;
+  const index_t index = sample_sel.getIndex(m_schema.getTimeSampling(),
+                                            m_schema.getNumSamples());
+
+  AbcMeshSample sample;
   try {
-    sample = m_schema.getValue(sample_sel);
+    read_sample(index, 0, sample);
   }
   catch (Alembic::Util::Exception &ex) {
     printf("Alembic: error reading mesh sample for '%s/%s' at time %f: %s\n",
@@ -1151,13 +1482,7 @@ bool AbcMeshReader::topology_changed(Mesh *existing_mesh, const ISampleSelector
     return false;
   }
 
-  const P3fArraySamplePtr &positions = sample.getPositions();
-  const Alembic::Abc::Int32ArraySamplePtr &face_indices = sample.getFaceIndices();
-  const Alembic::Abc::Int32ArraySamplePtr &face_counts = sample.getFaceCounts();
-
-  return positions->size() != existing_mesh->totvert ||
-         face_counts->size() != existing_mesh->totpoly ||
-         face_indices->size() != existing_mesh->totloop;
+  return mesh_topology_changed(existing_mesh, sample.sample);
 }
 
 Mesh *AbcMeshReader::read_mesh(Mesh *existing_mesh,
@@ -1165,9 +1490,27 @@ Mesh *AbcMeshReader::read_mesh(Mesh *existing_mesh,
                                int read_flag,
                                const char **err_str)
 {
-  IPolyMeshSchema::Sample sample;
+  const index_t index = sample_sel.getIndex(m_schema.getTimeSampling(),
+                                            m_schema.getNumSamples());
+
+  /* Only read point data when streaming meshes, unless we need to create new ones. */
+  ImportSettings settings;
+  settings.read_flag |= read_flag;
+
+  AbcMeshSample sample;
   try {
-    sample = m_schema.getValue(sample_sel);
+    read_sample(index, settings.read_flag, sample);
+
+    if (m_use_prefetch) {
+      /* Start reading the next samples while this one is converted. */
+      prefetch_samples(index, settings.read_flag);
+    }
+
+    if (mesh_topology_changed(existing_mesh, sample.sample) &&
+        (sample.read_flag & MOD_MESHSEQ_READ_ALL) != MOD_MESHSEQ_READ_ALL) {
+      /* Everything is read into the new mesh created below. */
+      read_sample(index, settings.read_flag | MOD_MESHSEQ_READ_ALL, sample);
+    }
   }
   catch (Alembic::Util::Exception &ex) {
     if (err_str != nullptr) {
@@ -1181,17 +1524,13 @@ Mesh *AbcMeshReader::read_mesh(Mesh *existing_mesh,
     return existing_mesh;
   }
 
-  const P3fArraySamplePtr &positions = sample.getPositions();
-  const Alembic::Abc::Int32ArraySamplePtr &face_indices = sample.getFaceIndices();
-  const Alembic::Abc::Int32ArraySamplePtr &face_counts = sample.getFaceCounts();
+  const P3fArraySamplePtr &positions = sample.sample.getPositions();
+  const Alembic::Abc::Int32ArraySamplePtr &face_indices = sample.sample.getFaceIndices();
+  const Alembic::Abc::Int32ArraySamplePtr &face_counts = sample.sample.getFaceCounts();
 
   Mesh *new_mesh = NULL;
 
-  /* Only read point data when streaming meshes, unless we need to create new ones. */
-  ImportSettings settings;
-  settings.read_flag |= read_flag;
-
-  if (topology_changed(existing_mesh, sample_sel)) {
+  if (mesh_topology_changed(existing_mesh, sample.sample)) {
     new_mesh = BKE_mesh_new_nomain_from_template(
         existing_mesh, positions->size(), 0, 0, face_indices->size(), face_counts->size());
 
@@ -1215,8 +1554,41 @@ Mesh *AbcMeshReader::read_mesh(Mesh *existing_mesh,
 
   CDStreamConfig config = get_config(new_mesh ? new_mesh : existing_mesh);
   config.time = sample_sel.getRequestedTime();
+  get_weight_and_index(config, m_schema.getTimeSampling(), m_schema.getNumSamples());
+
+  /* The mesh passed in is a copy of the same input mesh every frame. When its polygons and loops
+   * matched once and the samples share their topology, they don't need to be written again.
+   * The input mesh may still change, e.g. when the original mesh is edited, which is caught by
+   * comparing a hash of its polygons and loops with the one of the matching input. */
+  const bool is_topology_shared = m_schema.getTopologyVariance() !=
+                                  Alembic::AbcGeom::kHeterogenousTopology;
+  const uint32_t topology_hash = (is_topology_shared && new_mesh == NULL) ?
+                                     mesh_topology_hash(existing_mesh) :
+                                     0;
+  config.keep_topology = m_topology_verified && is_topology_shared && new_mesh == NULL &&
+                         existing_mesh->totedge != 0 && topology_hash == m_topology_hash;
+
+  P3fArraySamplePtr ceil_positions;
+  if (config.weight != 0.0f) {
+    AbcMeshSample ceil_sample;
+    read_sample(config.ceil_index, 0, ceil_sample);
+    ceil_positions = ceil_sample.sample.getPositions();
+  }
 
-  read_mesh_sample(m_iobject.getFullName(), &settings, m_schema, sample_sel, config);
+  const bool topology_changed = read_mesh_sample(m_iobject.getFullName(),
+                                                 &settings,
+                                                 m_schema,
+                                                 sample,
+                                                 ceil_positions,
+                                                 sample_sel,
+                                                 config);
+
+  if (!config.keep_topology && new_mesh == NULL &&
+      (settings.read_flag & MOD_MESHSEQ_READ_POLY) != 0) {
+    /* Nothing was changed, so the hash of the input is the one of the written mesh. */
+    m_topology_verified = is_topology_shared && !topology_changed;
+    m_topology_hash = topology_hash;
+  }
 
   if (new_mesh) {
     /* Here we assume that the number of materials doesn't change, i.e. that
@@ -1329,7 +1701,12 @@ static void read_subd_sample(const std::string &iobject_full_name,
   }
 
   if ((settings->read_flag & MOD_MESHSEQ_READ_UV) != 0) {
-    read_uvs_params(config, abc_mesh_data, schema.getUVsParam(), selector);
+    const IV2fGeomParam uv = schema.getUVsParam();
+    IV2fGeomParam::Sample uvsamp;
+    if (uv.valid()) {
+      uv.getIndexed(uvsamp, selector);
+    }
+    read_uvs_params(config, abc_mesh_data, uv, uvsamp);
   }
 
   if ((settings->read_flag & MOD_MESHSEQ_READ_VERT) != 0) {
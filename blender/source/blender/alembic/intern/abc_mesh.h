@@ -24,8 +24,15 @@
 #include "abc_customdata.h"
 #include "abc_object.h"
 
+#include <map>
+
+extern "C" {
+#include "BLI_threads.h"
+}
+
 struct Mesh;
 struct ModifierData;
+struct TaskPool;
 
 /* ************************************************************************** */
 
@@ -48,6 +55,20 @@ class AbcGenericMeshWriter : public AbcObjectWriter {
   bool m_is_liquid;
   bool m_is_subd;
 
+  /* Sample data of the current frame, converted from the evaluated mesh. */
+  std::vector<Imath::V3f> m_points, m_normals, m_velocities;
+  std::vector<int32_t> m_poly_verts, m_loop_counts;
+  std::vector<int32_t> m_crease_indices, m_crease_lengths;
+  std::vector<float> m_crease_sharpness;
+  bool m_export_loop_normals;
+  /* Mesh evaluated by do_evaluate(), converted and freed by do_prepare(). */
+  struct Mesh *m_eval_mesh;
+  bool m_eval_mesh_needsfree;
+  /* The sample data was filled in by do_prepare(). */
+  bool m_is_prepared;
+  /* The mesh may be converted by do_prepare(), in parallel with other writers. */
+  bool m_prepare_in_parallel;
+
  public:
   AbcGenericMeshWriter(Object *ob,
                        AbcTransformWriter *parent,
@@ -56,14 +77,22 @@ class AbcGenericMeshWriter : public AbcObjectWriter {
 
   ~AbcGenericMeshWriter();
   void setIsAnimated(bool is_animated);
+  void setPrepareInParallel(bool prepare_in_parallel);
 
  protected:
+  virtual void do_evaluate();
+  virtual void do_prepare();
   virtual void do_write();
   virtual bool isAnimated() const;
   virtual Mesh *getEvaluatedMesh(Scene *scene_eval, Object *ob_eval, bool &r_needsfree) = 0;
   virtual void freeEvaluatedMesh(struct Mesh *mesh);
 
   Mesh *getFinalMesh(bool &r_needsfree);
+  Mesh *evaluateMesh(bool &r_needsfree);
+  Mesh *triangulateMesh(struct Mesh *mesh, bool &r_needsfree);
+
+  void getSampleData(struct Mesh *mesh);
+  void clearSampleData();
 
   void writeMesh(struct Mesh *mesh);
   void writeSubD(struct Mesh *mesh);
@@ -92,13 +121,41 @@ class AbcMeshWriter : public AbcGenericMeshWriter {
 
 /* ************************************************************************** */
 
+/* The parts of an Alembic mesh sample that are read for every frame of playback. */
+struct AbcMeshSample {
+  Alembic::AbcGeom::IPolyMeshSchema::Sample sample;
+  Alembic::AbcGeom::IN3fGeomParam::Sample normals;
+  Alembic::AbcGeom::IV2fGeomParam::Sample uvs;
+
+  /* MOD_MESHSEQ_READ_xxx flags this sample was read with. */
+  int read_flag;
+};
+
 class AbcMeshReader : public AbcObjectReader {
   Alembic::AbcGeom::IPolyMeshSchema m_schema;
 
   CDStreamConfig m_mesh_data;
 
+  /* Samples read ahead of playback by m_prefetch_pool, keyed by sample index. The read flags of
+   * queued and running reads are kept by index as well. All are guarded by m_prefetch_mutex,
+   * m_prefetch_cond is signaled whenever a running read is done. */
+  std::map<Alembic::AbcGeom::index_t, AbcMeshSample> m_prefetched_samples;
+  std::map<Alembic::AbcGeom::index_t, int> m_prefetch_queued;
+  std::map<Alembic::AbcGeom::index_t, int> m_prefetch_running;
+  Alembic::AbcGeom::index_t m_prefetch_index;
+  struct TaskPool *m_prefetch_pool;
+  ThreadMutex m_prefetch_mutex;
+  ThreadCondition m_prefetch_cond;
+
+  /* Polygons and loops of the mesh passed to read_mesh() were found to match the samples, which
+   * share their topology. Following reads only update vertices and loop data, as long as the
+   * polygons and loops of the mesh passed in still have m_topology_hash. */
+  bool m_topology_verified;
+  uint32_t m_topology_hash;
+
  public:
   AbcMeshReader(const Alembic::Abc::IObject &object, ImportSettings &settings);
+  ~AbcMeshReader();
 
   bool valid() const override;
   bool accepts_object_type(const Alembic::AbcCoreAbstract::ObjectHeader &alembic_header,
@@ -113,7 +170,13 @@ class AbcMeshReader : public AbcObjectReader {
   bool topology_changed(Mesh *existing_mesh,
                         const Alembic::Abc::ISampleSelector &sample_sel) override;
 
+  void finish_prefetch() override;
+
  private:
+  void read_sample(Alembic::AbcGeom::index_t index, int read_flag, AbcMeshSample &r_sample);
+  void prefetch_samples(Alembic::AbcGeom::index_t index, int read_flag);
+  static void prefetch_sample_task(struct TaskPool *__restrict pool, void *taskdata, int threadid);
+
   void readFaceSetsSample(Main *bmain,
                           Mesh *mesh,
                           const Alembic::AbcGeom::ISampleSelector &sample_sel);
@@ -102,6 +102,26 @@ Imath::Box3d AbcObjectWriter::bounds()
   return this->m_bounds;
 }
 
+void AbcObjectWriter::evaluate()
+{
+  do_evaluate();
+}
+
+void AbcObjectWriter::do_evaluate()
+{
+  /* By default all the work is done in do_write(). */
+}
+
+void AbcObjectWriter::prepare()
+{
+  do_prepare();
+}
+
+void AbcObjectWriter::do_prepare()
+{
+  /* By default all the work is done in do_write(). */
+}
+
 void AbcObjectWriter::write()
 {
   do_write();
@@ -120,6 +140,7 @@ AbcObjectReader::AbcObjectReader(const IObject &object, ImportSettings &settings
       m_min_time(std::numeric_limits<chrono_t>::max()),
       m_max_time(std::numeric_limits<chrono_t>::min()),
       m_refcount(0),
+      m_use_prefetch(false),
       parent_reader(NULL)
 {
   m_name = object.getFullName();
@@ -254,6 +275,16 @@ bool AbcObjectReader::topology_changed(Mesh * /*existing_mesh*/,
   return false;
 }
 
+void AbcObjectReader::use_prefetch(bool use_prefetch)
+{
+  m_use_prefetch = use_prefetch;
+}
+
+void AbcObjectReader::finish_prefetch()
+{
+  /* Only readers that actually prefetch have something to wait for. */
+}
+
 void AbcObjectReader::setupObjectTransform(const float time)
 {
   bool is_constant = false;
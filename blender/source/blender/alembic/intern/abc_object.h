@@ -64,9 +64,17 @@ class AbcObjectWriter {
 
   virtual Imath::Box3d bounds();
 
+  /* Evaluate the data of the current frame ahead of prepare(). Evaluation may rebuild evaluated
+   * data that other objects depend on, so this is always called from the main thread. */
+  void evaluate();
+  /* Convert the evaluated data of the current frame ahead of write(). This is called for many
+   * writers in parallel, so it must neither evaluate objects nor touch the archive. */
+  void prepare();
   void write();
 
  private:
+  virtual void do_evaluate();
+  virtual void do_prepare();
   virtual void do_write() = 0;
 };
 
@@ -141,6 +149,9 @@ class AbcObjectReader {
 
   bool m_inherits_xform;
 
+  /* Whether samples may be read ahead of the requested time, see use_prefetch(). */
+  bool m_use_prefetch;
+
  public:
   AbcObjectReader *parent_reader;
 
@@ -193,6 +204,14 @@ class AbcObjectReader {
   virtual bool topology_changed(Mesh *existing_mesh,
                                 const Alembic::Abc::ISampleSelector &sample_sel);
 
+  /**
+   * Allow reading upcoming samples on a background thread while the current one is being
+   * converted. Only used for playback through the Mesh Sequence Cache modifier.
+   */
+  void use_prefetch(bool use_prefetch);
+  /** Wait for and discard pending background reads; required before the archive is closed. */
+  virtual void finish_prefetch();
+
   /** Reads the object matrix and sets up an object transform if animated. */
   void setupObjectTransform(const float time);
 
@@ -999,6 +999,9 @@ bool ABC_mesh_topology_changed(
 void CacheReader_free(CacheReader *reader)
 {
   AbcObjectReader *abc_reader = reinterpret_cast<AbcObjectReader *>(reader);
+
+  /* The archive may be closed right after this, so background reads must be done. */
+  abc_reader->finish_prefetch();
   abc_reader->decref();
 
   if (abc_reader->refcount() == 0) {
@@ -1041,6 +1044,7 @@ CacheReader *CacheReader_open_alembic_object(AbcArchiveHandle *handle,
     return NULL;
   }
   abc_reader->object(object);
+  abc_reader->use_prefetch(true);
   abc_reader->incref();
 
   return reinterpret_cast<CacheReader *>(abc_reader);
@@ -89,4 +89,7 @@ typedef struct DupliObject {
   unsigned int random_id;
 } DupliObject;
 
+/* Instances of a dupli-list are stored contiguously in list order. */
+DupliObject *object_duplilist_array(struct ListBase *lb, int *r_len);
+
 #endif
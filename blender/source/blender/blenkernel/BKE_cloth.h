@@ -42,6 +42,15 @@ struct Scene;
  * represented by a float, given its precision. */
 #define ALMOST_ZERO FLT_EPSILON
 
+/* Extra inflation of the self collision tree, relative to the self collision distance.
+ * Candidate pairs stay valid while no vertex moves further than this margin / sqrt(3). */
+#define CLOTH_SELF_OVERLAP_MARGIN 0.5f
+
+/* Minimum number of triangles for the collision tree leaf update to be threaded,
+ * and the number of triangles each thread updates at least. */
+#define CLOTH_BVH_UPDATE_THREAD_LIMIT 1024
+#define CLOTH_BVH_UPDATE_ITER_PER_THREAD 256
+
 /* Bits to or into the ClothVertex.flags. */
 typedef enum eClothVertexFlag {
   CLOTH_VERT_FLAG_PINNED = 1,
@@ -88,6 +97,17 @@ typedef struct Cloth {
   struct Implicit_Data *implicit; /* our implicit solver connects to this pointer */
   struct EdgeSet *edgeset;        /* used for selfcollisions */
   int last_frame, pad4;
+
+  /* Self collision candidate pairs, reused between substeps while the cloth moves less than
+   * the tree margin since they were found (see CLOTH_SELF_OVERLAP_MARGIN). */
+  struct BVHTreeOverlap *self_overlap;
+  unsigned int self_overlap_num;
+  float (*self_overlap_co)[3]; /* vertex positions the pairs were found for */
+
+  /* Statistics: overlap queries, substeps that reused pairs, and pairs added/removed
+   * by the last query (only counted when the bke.collision log is at level 2 or above). */
+  unsigned int self_overlap_queries, self_overlap_reuses;
+  unsigned int self_overlap_added, self_overlap_removed;
 } Cloth;
 
 /**
@@ -261,6 +281,7 @@ void cloth_find_point_contacts(struct Depsgraph *depsgraph,
                                ColliderContacts **r_collider_contacts,
                                int *r_totcolliders);
 void cloth_free_contacts(ColliderContacts *collider_contacts, int totcolliders);
+void cloth_free_self_overlap(struct Cloth *cloth);
 
 ////////////////////////////////////////////////
 
@@ -293,8 +293,8 @@ struct Image *BKE_image_copy(struct Main *bmain, const struct Image *ima);
 /* merge source into dest, and free source */
 void BKE_image_merge(struct Main *bmain, struct Image *dest, struct Image *source);
 
-/* scale the image */
-bool BKE_image_scale(struct Image *image, int width, int height);
+/* scale the image, filter is one of eIMBScaleFilter */
+bool BKE_image_scale(struct Image *image, int width, int height, int filter);
 
 /* check if texture has alpha (depth=32) */
 bool BKE_image_has_alpha(struct Image *image);
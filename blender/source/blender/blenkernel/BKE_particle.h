@@ -177,6 +177,9 @@ typedef struct ParticleThreadContext {
   float *vg_effector;
   float *vg_twist;
 
+  /* per-child parameters owned by psys->child_interp_cache, NULL when not cached */
+  struct ParticleTexture *child_ptex;
+
   struct CurveMapping *clumpcurve;
   struct CurveMapping *roughcurve;
   struct CurveMapping *twistcurve;
@@ -520,6 +523,7 @@ void free_hair(struct Object *ob, struct ParticleSystem *psys, int dynamics);
 void free_keyed_keys(struct ParticleSystem *psys);
 void psys_free_particles(struct ParticleSystem *psys);
 void psys_free_children(struct ParticleSystem *psys);
+void psys_free_child_interp_cache(struct ParticleSystem *psys);
 
 void psys_interpolate_particle(
     short type, struct ParticleKey keys[4], float dt, struct ParticleKey *result, bool velocity);
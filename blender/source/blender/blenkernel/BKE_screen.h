@@ -144,6 +144,9 @@ typedef struct ARegionType {
                    struct ARegion *ar,
                    struct wmNotifier *wmn,
                    const struct Scene *scene);
+  /* Notifier categories the listener reacts to (NOTE_CATEGORY_FLAG), zero for all of them.
+   * The window manager only sends notifiers of these categories to the region. */
+  unsigned int listener_categories;
   /* Optional callback to generate subscriptions. */
   void (*message_subscribe)(const struct bContext *C,
                             struct WorkSpace *workspace,
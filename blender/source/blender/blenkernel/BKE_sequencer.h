@@ -90,9 +90,14 @@ void BKE_sequence_iterator_end(SeqIterator *iter);
   } \
   ((void)0)
 
+/* Maximum number of threads rendering frames ahead of the playhead. */
+#define SEQ_PREFETCH_WORKERS_MAX 8
+
 typedef enum eSeqTaskId {
   SEQ_TASK_MAIN_RENDER,
+  /* Prefetch worker N uses SEQ_TASK_PREFETCH_RENDER + N. */
   SEQ_TASK_PREFETCH_RENDER,
+  SEQ_TASK_MAX = SEQ_TASK_PREFETCH_RENDER + SEQ_PREFETCH_WORKERS_MAX,
 } eSeqTaskId;
 
 typedef struct SeqRenderData {
@@ -33,6 +33,7 @@
 #include "BLI_math.h"
 #include "BLI_edgehash.h"
 #include "BLI_linklist.h"
+#include "BLI_task.h"
 
 #include "DEG_depsgraph.h"
 #include "DEG_depsgraph_query.h"
@@ -197,9 +198,46 @@ static BVHTree *bvhtree_build_from_cloth(ClothModifierData *clmd, float epsilon)
   return bvhtree;
 }
 
+typedef struct ClothBVHUpdateData {
+  BVHTree *bvhtree;
+  const ClothVertex *verts;
+  const MVertTri *tri;
+  bool moving;
+} ClothBVHUpdateData;
+
+static void cloth_bvhtree_update_node_cb(void *__restrict userdata,
+                                         const int i,
+                                         const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ClothBVHUpdateData *data = userdata;
+  const ClothVertex *verts = data->verts;
+  const MVertTri *vt = &data->tri[i];
+  float co[3][3], co_moving[3][3];
+
+  /* copy new locations into array */
+  if (data->moving) {
+    copy_v3_v3(co[0], verts[vt->tri[0]].txold);
+    copy_v3_v3(co[1], verts[vt->tri[1]].txold);
+    copy_v3_v3(co[2], verts[vt->tri[2]].txold);
+
+    /* update moving positions */
+    copy_v3_v3(co_moving[0], verts[vt->tri[0]].tx);
+    copy_v3_v3(co_moving[1], verts[vt->tri[1]].tx);
+    copy_v3_v3(co_moving[2], verts[vt->tri[2]].tx);
+
+    BLI_bvhtree_update_node(data->bvhtree, i, co[0], co_moving[0], 3);
+  }
+  else {
+    copy_v3_v3(co[0], verts[vt->tri[0]].tx);
+    copy_v3_v3(co[1], verts[vt->tri[1]].tx);
+    copy_v3_v3(co[2], verts[vt->tri[2]].tx);
+
+    BLI_bvhtree_update_node(data->bvhtree, i, co[0], NULL, 3);
+  }
+}
+
 void bvhtree_update_from_cloth(ClothModifierData *clmd, bool moving, bool self)
 {
-  unsigned int i = 0;
   Cloth *cloth = clmd->clothObject;
   BVHTree *bvhtree;
   ClothVertex *verts = cloth->verts;
@@ -220,36 +258,20 @@ void bvhtree_update_from_cloth(ClothModifierData *clmd, bool moving, bool self)
 
   /* update vertex position in bvh tree */
   if (verts && vt) {
-    for (i = 0; i < cloth->tri_num; i++, vt++) {
-      float co[3][3], co_moving[3][3];
-      bool ret;
-
-      /* copy new locations into array */
-      if (moving) {
-        copy_v3_v3(co[0], verts[vt->tri[0]].txold);
-        copy_v3_v3(co[1], verts[vt->tri[1]].txold);
-        copy_v3_v3(co[2], verts[vt->tri[2]].txold);
-
-        /* update moving positions */
-        copy_v3_v3(co_moving[0], verts[vt->tri[0]].tx);
-        copy_v3_v3(co_moving[1], verts[vt->tri[1]].tx);
-        copy_v3_v3(co_moving[2], verts[vt->tri[2]].tx);
-
-        ret = BLI_bvhtree_update_node(bvhtree, i, co[0], co_moving[0], 3);
-      }
-      else {
-        copy_v3_v3(co[0], verts[vt->tri[0]].tx);
-        copy_v3_v3(co[1], verts[vt->tri[1]].tx);
-        copy_v3_v3(co[2], verts[vt->tri[2]].tx);
-
-        ret = BLI_bvhtree_update_node(bvhtree, i, co[0], NULL, 3);
-      }
-
-      /* check if tree is already full */
-      if (ret == false) {
-        break;
-      }
-    }
+    /* the tree is built from the same triangles, so every node exists */
+    BLI_assert(BLI_bvhtree_get_len(bvhtree) == (int)cloth->tri_num);
+
+    ClothBVHUpdateData data = {
+        .bvhtree = bvhtree,
+        .verts = verts,
+        .tri = vt,
+        .moving = moving,
+    };
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = (cloth->tri_num > CLOTH_BVH_UPDATE_THREAD_LIMIT);
+    settings.min_iter_per_thread = CLOTH_BVH_UPDATE_ITER_PER_THREAD;
+    BLI_task_parallel_range(0, (int)cloth->tri_num, &data, cloth_bvhtree_update_node_cb, &settings);
 
     BLI_bvhtree_update_tree(bvhtree);
   }
@@ -515,6 +537,8 @@ void cloth_free_modifier(ClothModifierData *clmd)
       BLI_bvhtree_free(cloth->bvhselftree);
     }
 
+    cloth_free_self_overlap(cloth);
+
     // we save our faces for collision objects
     if (cloth->tri) {
       MEM_freeN(cloth->tri);
@@ -592,6 +616,8 @@ void cloth_free_modifier_extern(ClothModifierData *clmd)
       BLI_bvhtree_free(cloth->bvhselftree);
     }
 
+    cloth_free_self_overlap(cloth);
+
     // we save our faces for collision objects
     if (cloth->tri) {
       MEM_freeN(cloth->tri);
@@ -855,7 +881,9 @@ static int cloth_from_object(
   }
 
   clmd->clothObject->bvhtree = bvhtree_build_from_cloth(clmd, clmd->coll_parms->epsilon);
-  clmd->clothObject->bvhselftree = bvhtree_build_from_cloth(clmd, clmd->coll_parms->selfepsilon);
+  /* Inflated beyond the collision distance so overlap pairs can be reused between substeps. */
+  clmd->clothObject->bvhselftree = bvhtree_build_from_cloth(
+      clmd, clmd->coll_parms->selfepsilon * (1.0f + CLOTH_SELF_OVERLAP_MARGIN));
 
   return 1;
 }
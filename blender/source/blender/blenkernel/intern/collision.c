@@ -51,10 +51,14 @@
 #include "DEG_depsgraph_physics.h"
 #include "DEG_depsgraph_query.h"
 
+#include "CLG_log.h"
+
 #ifdef WITH_ELTOPO
 #  include "eltopo-capi.h"
 #endif
 
+static CLG_LogRef LOG = {"bke.collision"};
+
 typedef struct ColDetectData {
   ClothModifierData *clmd;
   CollisionModifierData *collmd;
@@ -1276,6 +1280,159 @@ static int cloth_bvh_selfcollisions_resolve(ClothModifierData *clmd,
   return ret;
 }
 
+void cloth_free_self_overlap(Cloth *cloth)
+{
+  MEM_SAFE_FREE(cloth->self_overlap);
+  MEM_SAFE_FREE(cloth->self_overlap_co);
+  cloth->self_overlap_num = 0;
+}
+
+/* Pairs found with the tree inflated by margin beyond the collision distance still contain all
+ * pairs within collision distance, as long as no vertex moved further than margin / sqrt(3):
+ * the k-DOP axes aren't normalized, so bounds move up to sqrt(3) times the vertex offset. */
+static bool cloth_self_overlap_is_valid(const Cloth *cloth, const float margin)
+{
+  const ClothVertex *verts = cloth->verts;
+  const float(*co)[3] = (const float(*)[3])cloth->self_overlap_co;
+  const float dist_max_sq = margin * margin / 3.0f;
+  uint i;
+
+  if (co == NULL || margin <= 0.0f) {
+    return false;
+  }
+
+  for (i = 0; i < cloth->mvert_num; i++) {
+    if (len_squared_v3v3(verts[i].tx, co[i]) > dist_max_sq) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static int cloth_self_overlap_cmp(const void *a, const void *b)
+{
+  const BVHTreeOverlap *overlap_a = a, *overlap_b = b;
+
+  if (overlap_a->indexA != overlap_b->indexA) {
+    return (overlap_a->indexA < overlap_b->indexA) ? -1 : 1;
+  }
+  if (overlap_a->indexB != overlap_b->indexB) {
+    return (overlap_a->indexB < overlap_b->indexB) ? -1 : 1;
+  }
+  return 0;
+}
+
+/* Count pairs that appeared and disappeared between two overlap queries. */
+static void cloth_self_overlap_churn(const BVHTreeOverlap *overlap_old,
+                                     uint overlap_old_num,
+                                     const BVHTreeOverlap *overlap_new,
+                                     uint overlap_new_num,
+                                     uint *r_added,
+                                     uint *r_removed)
+{
+  BVHTreeOverlap *sorted_old = MEM_mallocN(sizeof(*sorted_old) * max_ii((int)overlap_old_num, 1),
+                                           __func__);
+  BVHTreeOverlap *sorted_new = MEM_mallocN(sizeof(*sorted_new) * max_ii((int)overlap_new_num, 1),
+                                           __func__);
+  uint i = 0, j = 0, common = 0;
+
+  memcpy(sorted_old, overlap_old, sizeof(*sorted_old) * overlap_old_num);
+  memcpy(sorted_new, overlap_new, sizeof(*sorted_new) * overlap_new_num);
+  qsort(sorted_old, overlap_old_num, sizeof(*sorted_old), cloth_self_overlap_cmp);
+  qsort(sorted_new, overlap_new_num, sizeof(*sorted_new), cloth_self_overlap_cmp);
+
+  while (i < overlap_old_num && j < overlap_new_num) {
+    const int cmp = cloth_self_overlap_cmp(&sorted_old[i], &sorted_new[j]);
+    if (cmp == 0) {
+      common++;
+      i++;
+      j++;
+    }
+    else if (cmp < 0) {
+      i++;
+    }
+    else {
+      j++;
+    }
+  }
+
+  *r_added = overlap_new_num - common;
+  *r_removed = overlap_old_num - common;
+
+  MEM_freeN(sorted_old);
+  MEM_freeN(sorted_new);
+}
+
+/* Self collision candidate pairs, reused from an earlier substep when possible.
+ * The returned array is owned by the cloth. */
+static BVHTreeOverlap *cloth_bvh_self_overlap(ClothModifierData *clmd, uint *r_overlap_num)
+{
+  Cloth *cloth = clmd->clothObject;
+  BVHTreeOverlap *overlap;
+  uint overlap_num = 0;
+  uint i;
+
+  if (cloth->bvhselftree == NULL) {
+    *r_overlap_num = 0;
+    return NULL;
+  }
+
+  const float margin = BLI_bvhtree_get_epsilon(cloth->bvhselftree) -
+                       clmd->coll_parms->selfepsilon;
+
+  if (cloth_self_overlap_is_valid(cloth, margin)) {
+    cloth->self_overlap_reuses++;
+    *r_overlap_num = cloth->self_overlap_num;
+    return cloth->self_overlap;
+  }
+
+  bvhtree_update_from_cloth(clmd, false, true);
+
+  overlap = BLI_bvhtree_overlap(
+      cloth->bvhselftree, cloth->bvhselftree, &overlap_num, NULL, NULL);
+  cloth->self_overlap_queries++;
+
+  /* Pair churn between substeps, shows how well reusing the previous pairs would work. */
+  if (CLOG_CHECK(&LOG, 2)) {
+    if (cloth->self_overlap_co) {
+      cloth_self_overlap_churn(cloth->self_overlap,
+                               cloth->self_overlap_num,
+                               overlap,
+                               overlap_num,
+                               &cloth->self_overlap_added,
+                               &cloth->self_overlap_removed);
+    }
+    else {
+      cloth->self_overlap_added = overlap_num;
+      cloth->self_overlap_removed = 0;
+    }
+    CLOG_INFO(&LOG,
+              2,
+              "cloth self overlap: %u pairs (+%u -%u), %u queries, %u reuses",
+              overlap_num,
+              cloth->self_overlap_added,
+              cloth->self_overlap_removed,
+              cloth->self_overlap_queries,
+              cloth->self_overlap_reuses);
+  }
+
+  MEM_SAFE_FREE(cloth->self_overlap);
+  cloth->self_overlap = overlap;
+  cloth->self_overlap_num = overlap_num;
+
+  if (cloth->self_overlap_co == NULL) {
+    cloth->self_overlap_co = MEM_mallocN(sizeof(*cloth->self_overlap_co) * cloth->mvert_num,
+                                         "cloth self overlap positions");
+  }
+  for (i = 0; i < cloth->mvert_num; i++) {
+    copy_v3_v3(cloth->self_overlap_co[i], cloth->verts[i].tx);
+  }
+
+  *r_overlap_num = overlap_num;
+  return overlap;
+}
+
 int cloth_bvh_collision(
     Depsgraph *depsgraph, Object *ob, ClothModifierData *clmd, float step, float dt)
 {
@@ -1328,10 +1485,7 @@ int cloth_bvh_collision(
   }
 
   if (clmd->coll_parms->flags & CLOTH_COLLSETTINGS_FLAG_SELF) {
-    bvhtree_update_from_cloth(clmd, false, true);
-
-    overlap_self = BLI_bvhtree_overlap(
-        cloth->bvhselftree, cloth->bvhselftree, &coll_count_self, NULL, NULL);
+    overlap_self = cloth_bvh_self_overlap(clmd, &coll_count_self);
   }
 
   do {
@@ -1428,7 +1582,7 @@ int cloth_bvh_collision(
 
   MEM_SAFE_FREE(coll_counts_obj);
 
-  MEM_SAFE_FREE(overlap_self);
+  /* overlap_self is owned by the cloth, see cloth_bvh_self_overlap() */
 
   BKE_collision_objects_free(collobjs);
 
@@ -272,6 +272,11 @@ void BKE_image_free_buffers(Image *ima)
 /** Free (or release) any data used by this image (does not free the image itself). */
 void BKE_image_free(Image *ima)
 {
+  if (!G.background) {
+    /* Textures may still be loading from this image in the background. */
+    GPU_image_load_wait(ima);
+  }
+
   /* Also frees animdata. */
   BKE_image_free_buffers(ima);
 
@@ -461,7 +466,7 @@ void BKE_image_merge(Main *bmain, Image *dest, Image *source)
 }
 
 /* note, we could be clever and scale all imbuf's but since some are mipmaps its not so simple */
-bool BKE_image_scale(Image *image, int width, int height)
+bool BKE_image_scale(Image *image, int width, int height, int filter)
 {
   ImBuf *ibuf;
   void *lock;
@@ -469,7 +474,7 @@ bool BKE_image_scale(Image *image, int width, int height)
   ibuf = BKE_image_acquire_ibuf(image, NULL, &lock);
 
   if (ibuf) {
-    IMB_scaleImBuf(ibuf, width, height);
+    IMB_scaleImBuf_filter(ibuf, width, height, filter);
     BKE_image_mark_dirty(image, ibuf);
   }
 
@@ -3600,10 +3605,15 @@ static void image_create_multilayer(Image *ima, ImBuf *ibuf, int framenr)
 
   /* only load rr once for multiview */
   if (!ima->rr) {
+    /* Passes are read from the file when first displayed, the render result
+     * then owns the handle. */
+    IMB_exr_begin_read_lazy(ibuf->userdata, ibuf->name);
     ima->rr = RE_MultilayerConvert(ibuf->userdata, colorspace, predivide, ibuf->x, ibuf->y);
   }
 
-  IMB_exr_close(ibuf->userdata);
+  if (ima->rr == NULL || ima->rr->exrhandle != ibuf->userdata) {
+    IMB_exr_close(ibuf->userdata);
+  }
 
   ibuf->userdata = NULL;
   if (ima->rr != NULL) {
@@ -3684,7 +3694,7 @@ static ImBuf *load_sequence_single(
   iuser_t.view = view_id;
   BKE_image_user_file_path(&iuser_t, ima, name);
 
-  flag = IB_rect | IB_multilayer | IB_metadata;
+  flag = IB_rect | IB_multilayer | IB_multilayer_lazy | IB_metadata;
   flag |= imbuf_alpha_flags_for_image(ima);
 
   /* read ibuf */
@@ -3802,12 +3812,13 @@ static ImBuf *image_load_sequence_multilayer(Image *ima, ImageUser *iuser, int f
   }
   if (ima->rr) {
     RenderPass *rpass = BKE_image_multilayer_index(ima->rr, iuser);
+    float *rect = (rpass) ? RE_render_result_pass_rect_ensure(ima->rr, rpass) : NULL;
 
-    if (rpass) {
+    if (rect) {
       // printf("load from pass %s\n", rpass->name);
       /* since we free  render results, we copy the rect */
       ibuf = IMB_allocImBuf(ima->rr->rectx, ima->rr->recty, 32, 0);
-      ibuf->rect_float = MEM_dupallocN(rpass->rect);
+      ibuf->rect_float = MEM_dupallocN(rect);
       ibuf->flags |= IB_rectfloat;
       ibuf->mall = IB_rectfloat;
       ibuf->channels = rpass->channels;
@@ -3984,7 +3995,7 @@ static ImBuf *load_image_single(Image *ima,
   else {
     ImageUser iuser_t;
 
-    flag = IB_rect | IB_multilayer | IB_metadata;
+    flag = IB_rect | IB_multilayer | IB_multilayer_lazy | IB_metadata;
     flag |= imbuf_alpha_flags_for_image(ima);
 
     /* get the correct filepath */
@@ -4128,13 +4139,14 @@ static ImBuf *image_get_ibuf_multilayer(Image *ima, ImageUser *iuser)
   }
   if (ima->rr) {
     RenderPass *rpass = BKE_image_multilayer_index(ima->rr, iuser);
+    float *rect = (rpass) ? RE_render_result_pass_rect_ensure(ima->rr, rpass) : NULL;
 
-    if (rpass) {
+    if (rect) {
       ibuf = IMB_allocImBuf(ima->rr->rectx, ima->rr->recty, 32, 0);
 
       image_initialize_after_load(ima, ibuf);
 
-      ibuf->rect_float = rpass->rect;
+      ibuf->rect_float = rect;
       ibuf->flags |= IB_rectfloat;
       ibuf->channels = rpass->channels;
 
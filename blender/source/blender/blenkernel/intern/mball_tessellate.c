@@ -39,6 +39,9 @@
 #include "BLI_string_utils.h"
 #include "BLI_utildefines.h"
 #include "BLI_memarena.h"
+#include "BLI_ghash.h"
+#include "BLI_hash.h"
+#include "BLI_task.h"
 
 #include "BKE_global.h"
 
@@ -54,6 +57,12 @@
 /* experimental (faster) normal calculation */
 // #define USE_ACCUM_NORMAL
 
+#ifndef USE_ACCUM_NORMAL
+/* Number of metaelems from which the parallel sparse grid polygonizer is used,
+ * for fewer elements the continuation method touches less of the lattice. */
+#  define MBALL_GRID_ELEM_LIMIT 128
+#endif
+
 /* Data types */
 
 typedef struct corner { /* corner of a cube */
@@ -591,6 +600,34 @@ static int rightface[12] = {
 };
 /* face on right when going corner1 to corner2 */
 
+/**
+ * Adds faces for a polygon of the cube table, given the vertex id's of its edges.
+ */
+static void make_polygon(PROCESS *process, const int indexar[8], const int count)
+{
+  switch (count) {
+    case 3:
+      make_face(process, indexar[2], indexar[1], indexar[0], indexar[0]); /* triangle */
+      break;
+    case 4:
+      make_face(process, indexar[3], indexar[2], indexar[1], indexar[0]);
+      break;
+    case 5:
+      make_face(process, indexar[3], indexar[2], indexar[1], indexar[0]);
+      make_face(process, indexar[4], indexar[3], indexar[0], indexar[0]); /* triangle */
+      break;
+    case 6:
+      make_face(process, indexar[3], indexar[2], indexar[1], indexar[0]);
+      make_face(process, indexar[5], indexar[4], indexar[3], indexar[0]);
+      break;
+    case 7:
+      make_face(process, indexar[3], indexar[2], indexar[1], indexar[0]);
+      make_face(process, indexar[5], indexar[4], indexar[3], indexar[0]);
+      make_face(process, indexar[6], indexar[5], indexar[0], indexar[0]); /* triangle */
+      break;
+  }
+}
+
 /**
  * triangulate the cube directly, without decomposition
  */
@@ -641,30 +678,7 @@ static void docube(PROCESS *process, CUBE *cube)
       count++;
     }
 
-    /* Adds faces to output. */
-    if (count > 2) {
-      switch (count) {
-        case 3:
-          make_face(process, indexar[2], indexar[1], indexar[0], indexar[0]); /* triangle */
-          break;
-        case 4:
-          make_face(process, indexar[3], indexar[2], indexar[1], indexar[0]);
-          break;
-        case 5:
-          make_face(process, indexar[3], indexar[2], indexar[1], indexar[0]);
-          make_face(process, indexar[4], indexar[3], indexar[0], indexar[0]); /* triangle */
-          break;
-        case 6:
-          make_face(process, indexar[3], indexar[2], indexar[1], indexar[0]);
-          make_face(process, indexar[5], indexar[4], indexar[3], indexar[0]);
-          break;
-        case 7:
-          make_face(process, indexar[3], indexar[2], indexar[1], indexar[0]);
-          make_face(process, indexar[5], indexar[4], indexar[3], indexar[0]);
-          make_face(process, indexar[6], indexar[5], indexar[0], indexar[0]); /* triangle */
-          break;
-      }
-    }
+    make_polygon(process, indexar, count);
   }
 }
 
@@ -1175,6 +1189,412 @@ static void polygonize(PROCESS *process)
   }
 }
 
+#ifdef MBALL_GRID_ELEM_LIMIT
+
+/* ******************* SPARSE GRID POLYGONIZATION ********************* */
+
+/**
+ * Alternative to the continuation method for many metaelems (particle systems...).
+ *
+ * The lattice is split into blocks of #GRID_BLOCK_SIZE^3 cubes, only blocks near the
+ * bounding boxes of metaelems are allocated. Each block evaluates the function at its
+ * corners, computes the vertices on the edges it owns and creates the faces of its cubes,
+ * blocks are processed in parallel.
+ *
+ * A block owns the cubes and edges whose lowest lattice corner lies inside it. Vertices on
+ * edges shared by several blocks are only created by the owner and looked up by the others,
+ * which welds the surface across blocks.
+ */
+
+#  define GRID_BLOCK_SIZE 8
+#  define GRID_BLOCK_CORNERS (GRID_BLOCK_SIZE + 1)
+
+typedef struct GridBlock {
+  int loc[3]; /* location of the block, the LBN corner is at lattice loc * GRID_BLOCK_SIZE */
+
+  /* Function values of all corners of the block's cubes. */
+  float *values;
+  /* Vertex id for each owned edge in +x, +y and +z direction, -1 when not crossed.
+   * Local to the block, #vert_offset gives the id in the final vertex array. */
+  int *edge_verts;
+
+  float (*co)[3], (*no)[3];
+  unsigned int verts_len;
+  unsigned int vert_offset;
+
+  int (*indices)[4];
+  unsigned int faces_len;
+} GridBlock;
+
+typedef struct GridData {
+  const PROCESS *process;
+  GridBlock **blocks;
+  GHash *block_hash;
+} GridData;
+
+BLI_INLINE int grid_value_index(const int x, const int y, const int z)
+{
+  return (x * GRID_BLOCK_CORNERS + y) * GRID_BLOCK_CORNERS + z;
+}
+
+BLI_INLINE int grid_edge_index(const int x, const int y, const int z, const int axis)
+{
+  return ((x * GRID_BLOCK_SIZE + y) * GRID_BLOCK_SIZE + z) * 3 + axis;
+}
+
+static unsigned int grid_block_hash(const void *key)
+{
+  const int *loc = key;
+  return BLI_hash_int_2d(BLI_hash_int_2d((unsigned int)loc[0], (unsigned int)loc[1]),
+                         (unsigned int)loc[2]);
+}
+
+static bool grid_block_cmp(const void *a, const void *b)
+{
+  const int *loc_a = a, *loc_b = b;
+  return !((loc_a[0] == loc_b[0]) && (loc_a[1] == loc_b[1]) && (loc_a[2] == loc_b[2]));
+}
+
+/**
+ * Allocate all blocks containing lattice corners inside the bounding box of a metaelem.
+ *
+ * Only corners inside a box can have a negative function value, extending the range by one
+ * corner downwards also includes the owners of all crossed edges and of the cubes using them.
+ * One more corner on both sides accounts for float precision of the box test.
+ */
+static GridBlock **grid_blocks_create(PROCESS *process,
+                                      GHash *block_hash,
+                                      unsigned int *r_blocks_len)
+{
+  GridBlock **blocks = NULL;
+  unsigned int blocks_len = 0, blocks_alloc = 0;
+  unsigned int a;
+
+  for (a = 0; a < process->totelem; a++) {
+    const BoundBox *bb = process->mainb[a]->bb;
+    int block_min[3], block_max[3], loc[3];
+
+    for (int i = 0; i < 3; i++) {
+      const int corner_min = (int)ceilf(bb->vec[0][i] / process->size + 0.5f) - 2;
+      const int corner_max = (int)floorf(bb->vec[6][i] / process->size + 0.5f) + 1;
+      block_min[i] = divide_floor_i(corner_min, GRID_BLOCK_SIZE);
+      block_max[i] = divide_floor_i(corner_max, GRID_BLOCK_SIZE);
+    }
+
+    for (loc[0] = block_min[0]; loc[0] <= block_max[0]; loc[0]++) {
+      for (loc[1] = block_min[1]; loc[1] <= block_max[1]; loc[1]++) {
+        for (loc[2] = block_min[2]; loc[2] <= block_max[2]; loc[2]++) {
+          if (BLI_ghash_haskey(block_hash, loc)) {
+            continue;
+          }
+
+          GridBlock *block = BLI_memarena_calloc(process->pgn_elements, sizeof(GridBlock));
+          copy_v3_v3_int(block->loc, loc);
+          BLI_ghash_insert(block_hash, block->loc, block);
+
+          if (UNLIKELY(blocks_len == blocks_alloc)) {
+            blocks_alloc = blocks_alloc * 2 + 64;
+            blocks = MEM_reallocN(blocks, sizeof(GridBlock *) * blocks_alloc);
+          }
+          blocks[blocks_len++] = block;
+        }
+      }
+    }
+  }
+
+  *r_blocks_len = blocks_len;
+  return blocks;
+}
+
+/**
+ * Copy of the process for use in a thread, with its own BVH queue and output arrays.
+ */
+static void grid_process_init(PROCESS *process_local, const PROCESS *process)
+{
+  *process_local = *process;
+  process_local->bvh_queue = MEM_mallocN(sizeof(MetaballBVHNode *) * process->bvh_queue_size,
+                                         __func__);
+  process_local->indices = NULL;
+  process_local->totindex = 0;
+  process_local->curindex = 0;
+  process_local->co = NULL;
+  process_local->no = NULL;
+  process_local->totvertex = 0;
+  process_local->curvertex = 0;
+}
+
+/**
+ * Evaluate the corners of a block and create the vertices on the edges it owns.
+ */
+static void grid_block_vertices_cb(void *__restrict userdata,
+                                   const int iter,
+                                   const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const GridData *data = userdata;
+  GridBlock *block = data->blocks[iter];
+  PROCESS process;
+  int lbn[3], x, y, z;
+  bool has_inside = false, has_outside = false;
+
+  grid_process_init(&process, data->process);
+
+  lbn[0] = block->loc[0] * GRID_BLOCK_SIZE;
+  lbn[1] = block->loc[1] * GRID_BLOCK_SIZE;
+  lbn[2] = block->loc[2] * GRID_BLOCK_SIZE;
+
+  block->values = MEM_mallocN(sizeof(float) * GRID_BLOCK_CORNERS * GRID_BLOCK_CORNERS *
+                                  GRID_BLOCK_CORNERS,
+                              __func__);
+  for (x = 0; x < GRID_BLOCK_CORNERS; x++) {
+    for (y = 0; y < GRID_BLOCK_CORNERS; y++) {
+      for (z = 0; z < GRID_BLOCK_CORNERS; z++) {
+        /* Same as #setcorner, so blocks sharing a corner find the same value. */
+        const float value = metaball(&process,
+                                     ((float)(lbn[0] + x) - 0.5f) * process.size,
+                                     ((float)(lbn[1] + y) - 0.5f) * process.size,
+                                     ((float)(lbn[2] + z) - 0.5f) * process.size);
+        block->values[grid_value_index(x, y, z)] = value;
+        if (value > 0.0f) {
+          has_outside = true;
+        }
+        else {
+          has_inside = true;
+        }
+      }
+    }
+  }
+
+  if (!(has_inside && has_outside)) {
+    /* No edge of the block is crossed by the surface. */
+    MEM_SAFE_FREE(block->values);
+    MEM_freeN(process.bvh_queue);
+    return;
+  }
+
+  block->edge_verts = MEM_mallocN(
+      sizeof(int) * GRID_BLOCK_SIZE * GRID_BLOCK_SIZE * GRID_BLOCK_SIZE * 3, __func__);
+
+  for (x = 0; x < GRID_BLOCK_SIZE; x++) {
+    for (y = 0; y < GRID_BLOCK_SIZE; y++) {
+      for (z = 0; z < GRID_BLOCK_SIZE; z++) {
+        CORNER c1, c2;
+        c1.value = block->values[grid_value_index(x, y, z)];
+        c1.co[0] = ((float)(lbn[0] + x) - 0.5f) * process.size;
+        c1.co[1] = ((float)(lbn[1] + y) - 0.5f) * process.size;
+        c1.co[2] = ((float)(lbn[2] + z) - 0.5f) * process.size;
+
+        for (int axis = 0; axis < 3; axis++) {
+          int *vid = &block->edge_verts[grid_edge_index(x, y, z, axis)];
+          const int offset[3] = {axis == 0, axis == 1, axis == 2};
+
+          c2.value = block->values[grid_value_index(x + offset[0], y + offset[1], z + offset[2])];
+          if ((c1.value > 0.0f) == (c2.value > 0.0f)) {
+            *vid = -1;
+            continue;
+          }
+
+          float v[3], no[3];
+          const int local[3] = {x, y, z};
+          copy_v3_v3(c2.co, c1.co);
+          c2.co[axis] = ((float)(lbn[axis] + local[axis] + 1) - 0.5f) * process.size;
+
+          converge(&process, &c1, &c2, v);
+          vnormal(&process, v, no);
+          addtovertices(&process, v, no);
+          *vid = (int)process.curvertex - 1;
+        }
+      }
+    }
+  }
+
+  block->co = process.co;
+  block->no = process.no;
+  block->verts_len = process.curvertex;
+
+  MEM_freeN(process.bvh_queue);
+}
+
+/**
+ * \return final id of the vertex on the edge from lattice corner \a p in direction \a axis.
+ */
+static int grid_edge_vertex(const GridData *data,
+                            const GridBlock *block,
+                            const int p[3],
+                            const int axis)
+{
+  int loc[3], local[3];
+
+  for (int i = 0; i < 3; i++) {
+    loc[i] = divide_floor_i(p[i], GRID_BLOCK_SIZE);
+    local[i] = p[i] - loc[i] * GRID_BLOCK_SIZE;
+  }
+
+  if ((loc[0] != block->loc[0]) || (loc[1] != block->loc[1]) || (loc[2] != block->loc[2])) {
+    block = BLI_ghash_lookup(data->block_hash, loc);
+  }
+
+  if (UNLIKELY(block == NULL || block->edge_verts == NULL)) {
+    BLI_assert(!"metaball edge vertex owned by missing block");
+    return -1;
+  }
+
+  const int vid = block->edge_verts[grid_edge_index(UNPACK3(local), axis)];
+  BLI_assert(vid != -1);
+  return (vid != -1) ? (int)block->vert_offset + vid : -1;
+}
+
+/**
+ * Create the faces of the cubes of a block, using the final vertex ids.
+ */
+static void grid_block_faces_cb(void *__restrict userdata,
+                                const int iter,
+                                const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const GridData *data = userdata;
+  GridBlock *block = data->blocks[iter];
+  PROCESS process;
+  int lbn[3], x, y, z;
+
+  if (block->edge_verts == NULL) {
+    return;
+  }
+
+  /* Only the output arrays are used, no need for a BVH queue. */
+  process = *data->process;
+  process.indices = NULL;
+  process.totindex = 0;
+  process.curindex = 0;
+
+  lbn[0] = block->loc[0] * GRID_BLOCK_SIZE;
+  lbn[1] = block->loc[1] * GRID_BLOCK_SIZE;
+  lbn[2] = block->loc[2] * GRID_BLOCK_SIZE;
+
+  for (x = 0; x < GRID_BLOCK_SIZE; x++) {
+    for (y = 0; y < GRID_BLOCK_SIZE; y++) {
+      for (z = 0; z < GRID_BLOCK_SIZE; z++) {
+        INTLISTS *polys;
+        int n, index = 0;
+
+        /* Determine which case cube falls into, same as #docube. */
+        for (n = 0; n < 8; n++) {
+          const float value = block->values[grid_value_index(
+              x + MB_BIT(n, 2), y + MB_BIT(n, 1), z + MB_BIT(n, 0))];
+          if (value > 0.0f) {
+            index += (1 << n);
+          }
+        }
+
+        for (polys = cubetable[index]; polys; polys = polys->next) {
+          INTLIST *edges;
+          int count = 0, indexar[8];
+          bool is_valid = true;
+
+          for (edges = polys->list; edges; edges = edges->next) {
+            const int n1 = corner1[edges->i], n2 = corner2[edges->i];
+            const int p[3] = {
+                lbn[0] + x + min_ii(MB_BIT(n1, 2), MB_BIT(n2, 2)),
+                lbn[1] + y + min_ii(MB_BIT(n1, 1), MB_BIT(n2, 1)),
+                lbn[2] + z + min_ii(MB_BIT(n1, 0), MB_BIT(n2, 0)),
+            };
+            const int axis = (MB_BIT(n1, 2) != MB_BIT(n2, 2)) ?
+                                 0 :
+                                 ((MB_BIT(n1, 1) != MB_BIT(n2, 1)) ? 1 : 2);
+
+            indexar[count] = grid_edge_vertex(data, block, p, axis);
+            if (indexar[count] == -1) {
+              is_valid = false;
+            }
+            count++;
+          }
+
+          if (is_valid) {
+            make_polygon(&process, indexar, count);
+          }
+        }
+      }
+    }
+  }
+
+  block->indices = process.indices;
+  block->faces_len = process.curindex;
+}
+
+/**
+ * Polygonize all metaelems on a sparse grid of blocks, in parallel.
+ * Results in the same vertices as #polygonize where both find the surface,
+ * except for their order.
+ */
+static void polygonize_grid(PROCESS *process)
+{
+  GridData data;
+  GridBlock **blocks;
+  unsigned int blocks_len, i;
+
+  makecubetable();
+
+  data.process = process;
+  data.block_hash = BLI_ghash_new(grid_block_hash, grid_block_cmp, __func__);
+  data.blocks = blocks = grid_blocks_create(process, data.block_hash, &blocks_len);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.scheduling_mode = TASK_SCHEDULING_DYNAMIC;
+
+  BLI_task_parallel_range(0, (int)blocks_len, &data, grid_block_vertices_cb, &settings);
+
+  /* Join the vertices of all blocks, keeping block order so the result is deterministic. */
+  process->totvertex = 0;
+  for (i = 0; i < blocks_len; i++) {
+    blocks[i]->vert_offset = process->totvertex;
+    process->totvertex += blocks[i]->verts_len;
+  }
+
+  if (process->totvertex != 0) {
+    process->co = MEM_mallocN(sizeof(float[3]) * process->totvertex, "mball grid co");
+    process->no = MEM_mallocN(sizeof(float[3]) * process->totvertex, "mball grid no");
+    for (i = 0; i < blocks_len; i++) {
+      GridBlock *block = blocks[i];
+      if (block->verts_len != 0) {
+        memcpy(process->co[block->vert_offset], block->co, sizeof(float[3]) * block->verts_len);
+        memcpy(process->no[block->vert_offset], block->no, sizeof(float[3]) * block->verts_len);
+      }
+    }
+    process->curvertex = process->totvertex;
+
+    BLI_task_parallel_range(0, (int)blocks_len, &data, grid_block_faces_cb, &settings);
+
+    process->totindex = 0;
+    for (i = 0; i < blocks_len; i++) {
+      process->totindex += blocks[i]->faces_len;
+    }
+    if (process->totindex != 0) {
+      process->indices = MEM_mallocN(sizeof(int[4]) * process->totindex, "mball grid indices");
+      for (i = 0; i < blocks_len; i++) {
+        GridBlock *block = blocks[i];
+        if (block->faces_len != 0) {
+          memcpy(process->indices[process->curindex],
+                 block->indices,
+                 sizeof(int[4]) * block->faces_len);
+          process->curindex += block->faces_len;
+        }
+      }
+    }
+  }
+
+  for (i = 0; i < blocks_len; i++) {
+    GridBlock *block = blocks[i];
+    MEM_SAFE_FREE(block->values);
+    MEM_SAFE_FREE(block->edge_verts);
+    MEM_SAFE_FREE(block->co);
+    MEM_SAFE_FREE(block->no);
+    MEM_SAFE_FREE(block->indices);
+  }
+  MEM_SAFE_FREE(blocks);
+  BLI_ghash_free(data.block_hash, NULL, NULL);
+}
+
+#endif /* MBALL_GRID_ELEM_LIMIT */
+
 /**
  * Iterates over ALL objects in the scene and all of its sets, including
  * making all duplis(not only metas). Copies metas to mainb array.
@@ -1438,7 +1858,15 @@ void BKE_mball_polygonize(Depsgraph *depsgraph, Scene *scene, Object *ob, ListBa
     if (ob->scale[0] > 0.00001f * (process.allbb.max[0] - process.allbb.min[0]) ||
         ob->scale[1] > 0.00001f * (process.allbb.max[1] - process.allbb.min[1]) ||
         ob->scale[2] > 0.00001f * (process.allbb.max[2] - process.allbb.min[2])) {
-      polygonize(&process);
+#ifdef MBALL_GRID_ELEM_LIMIT
+      if (process.totelem >= MBALL_GRID_ELEM_LIMIT) {
+        polygonize_grid(&process);
+      }
+      else
+#endif
+      {
+        polygonize(&process);
+      }
 
       /* add resulting surface to displist */
       if (process.curindex) {
@@ -1066,6 +1066,7 @@ ParticleSystem *BKE_object_copy_particlesystem(ParticleSystem *psys, const int f
 
   psysn->pathcache = NULL;
   psysn->childcache = NULL;
+  psysn->child_interp_cache = NULL;
   psysn->edit = NULL;
   psysn->pdd = NULL;
   psysn->effectors = NULL;
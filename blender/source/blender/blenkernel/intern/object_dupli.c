@@ -24,6 +24,7 @@
 #include <limits.h>
 #include <stdlib.h>
 #include <stddef.h>
+#include <string.h>
 
 #include "MEM_guardedalloc.h"
 
@@ -32,6 +33,7 @@
 
 #include "BLI_math.h"
 #include "BLI_rand.h"
+#include "BLI_task.h"
 
 #include "DNA_anim_types.h"
 #include "DNA_collection_types.h"
@@ -64,6 +66,16 @@
 
 /* Dupli-Geometry */
 
+/* Vertex and face instances are generated in parallel from this amount. */
+#define DUPLI_PARALLEL_LIMIT 1024
+
+/* All instances of a dupli-list are stored in a single array, in generation order.
+ * It is only linked into a ListBase once generation is done, see #object_duplilist. */
+typedef struct DupliArray {
+  DupliObject *data;
+  int len, alloc_len;
+} DupliArray;
+
 typedef struct DupliContext {
   Depsgraph *depsgraph;
   /** XXX child objects are selected from this group if set, could be nicer. */
@@ -81,8 +93,8 @@ typedef struct DupliContext {
 
   const struct DupliGenerator *gen;
 
-  /** Result containers. */
-  ListBase *duplilist; /* legacy doubly-linked list */
+  /** Result container. */
+  DupliArray *duplis;
 } DupliContext;
 
 typedef struct DupliGenerator {
@@ -116,7 +128,7 @@ static void init_context(DupliContext *r_ctx,
 
   r_ctx->gen = get_dupli_generator(r_ctx);
 
-  r_ctx->duplilist = NULL;
+  r_ctx->duplis = NULL;
 }
 
 /* create sub-context for recursive duplis */
@@ -141,23 +153,36 @@ static void copy_dupli_context(
   r_ctx->gen = get_dupli_generator(r_ctx);
 }
 
-/* generate a dupli instance
+/* make sure at least len more instances fit without reallocating */
+static void dupli_array_reserve(DupliArray *duplis, int len)
+{
+  if (duplis->len + len > duplis->alloc_len) {
+    duplis->alloc_len = max_ii(duplis->len + len, duplis->alloc_len * 2);
+    duplis->data = MEM_reallocN(duplis->data, sizeof(DupliObject) * (size_t)duplis->alloc_len);
+  }
+}
+
+/* add len zero initialized instances, pointers to earlier instances are invalidated */
+static DupliObject *dupli_array_append(DupliArray *duplis, int len)
+{
+  DupliObject *dob;
+
+  dupli_array_reserve(duplis, len);
+  dob = &duplis->data[duplis->len];
+  memset(dob, 0, sizeof(DupliObject) * (size_t)len);
+  duplis->len += len;
+
+  return dob;
+}
+
+/* fill in a dupli instance, safe to call from multiple threads for different instances
  * mat is transform of the object relative to current context (including object obmat)
  */
-static DupliObject *make_dupli(const DupliContext *ctx, Object *ob, float mat[4][4], int index)
+static void dupli_init(
+    const DupliContext *ctx, DupliObject *dob, Object *ob, float mat[4][4], int index)
 {
-  DupliObject *dob;
   int i;
 
-  /* add a DupliObject instance to the result container */
-  if (ctx->duplilist) {
-    dob = MEM_callocN(sizeof(DupliObject), "dupli object");
-    BLI_addtail(ctx->duplilist, dob);
-  }
-  else {
-    return NULL;
-  }
-
   dob->ob = ob;
   mul_m4_m4m4(dob->mat, (float(*)[4])ctx->space_mat, mat);
   dob->type = ctx->gen->type;
@@ -198,10 +223,35 @@ static DupliObject *make_dupli(const DupliContext *ctx, Object *ob, float mat[4]
   if (ctx->object != ob) {
     dob->random_id ^= BLI_hash_int(BLI_hash_string(ctx->object->id.name + 2));
   }
+}
+
+/* generate a dupli instance
+ * mat is transform of the object relative to current context (including object obmat)
+ * the returned instance is only valid until the next one is added
+ */
+static DupliObject *make_dupli(const DupliContext *ctx, Object *ob, float mat[4][4], int index)
+{
+  DupliObject *dob;
+
+  /* add a DupliObject instance to the result container */
+  if (ctx->duplis) {
+    dob = dupli_array_append(ctx->duplis, 1);
+  }
+  else {
+    return NULL;
+  }
+
+  dupli_init(ctx, dob, ob, mat, index);
 
   return dob;
 }
 
+/* instances for an object can be filled in parallel when it doesn't generate duplis itself */
+static bool dupli_use_threading(const DupliContext *ctx, const Object *inst_ob, int len)
+{
+  return ctx->duplis && len >= DUPLI_PARALLEL_LIMIT && (inst_ob->transflag & OB_DUPLI) == 0;
+}
+
 /* recursive dupli objects
  * space_mat is the local dupli space (excluding dupli object obmat!)
  */
@@ -359,14 +409,12 @@ static void get_duplivert_transform(const float co[3],
   loc_quat_size_to_mat4(mat, co, quat, size);
 }
 
-static void vertex_dupli(const VertexDupliData *vdd,
-                         int index,
-                         const float co[3],
-                         const short no[3])
+static void vertex_dupli_transform(const VertexDupliData *vdd,
+                                   const float co[3],
+                                   const short no[3],
+                                   float obmat[4][4])
 {
   Object *inst_ob = vdd->inst_ob;
-  DupliObject *dob;
-  float obmat[4][4], space_mat[4][4];
 
   /* obmat is transform to vertex */
   get_duplivert_transform(co, no, vdd->use_rotation, inst_ob->trackflag, inst_ob->upflag, obmat);
@@ -374,6 +422,18 @@ static void vertex_dupli(const VertexDupliData *vdd,
   mul_mat3_m4_v3((float(*)[4])vdd->child_imat, obmat[3]);
   /* apply obmat _after_ the local vertex transform */
   mul_m4_m4m4(obmat, inst_ob->obmat, obmat);
+}
+
+static void vertex_dupli(const VertexDupliData *vdd,
+                         int index,
+                         const float co[3],
+                         const short no[3])
+{
+  Object *inst_ob = vdd->inst_ob;
+  DupliObject *dob;
+  float obmat[4][4], space_mat[4][4];
+
+  vertex_dupli_transform(vdd, co, no, obmat);
 
   /* space matrix is constructed by removing obmat transform,
    * this yields the worldspace transform for recursive duplis
@@ -390,6 +450,30 @@ static void vertex_dupli(const VertexDupliData *vdd,
   make_recursive_duplis(vdd->ctx, vdd->inst_ob, space_mat, index);
 }
 
+typedef struct VertexDupliTaskData {
+  const VertexDupliData *vdd;
+  const DupliContext *ctx;
+  const MVert *mvert;
+  DupliObject *duplis;
+} VertexDupliTaskData;
+
+static void vertex_dupli_cb(void *__restrict userdata,
+                            const int i,
+                            const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const VertexDupliTaskData *data = userdata;
+  const VertexDupliData *vdd = data->vdd;
+  DupliObject *dob = &data->duplis[i];
+  float obmat[4][4];
+
+  vertex_dupli_transform(vdd, data->mvert[i].co, data->mvert[i].no, obmat);
+  dupli_init(data->ctx, dob, vdd->inst_ob, obmat, i);
+
+  if (vdd->orco) {
+    copy_v3_v3(dob->orco, vdd->orco[i]);
+  }
+}
+
 static void make_child_duplis_verts(const DupliContext *ctx, void *userdata, Object *child)
 {
   VertexDupliData *vdd = userdata;
@@ -401,6 +485,22 @@ static void make_child_duplis_verts(const DupliContext *ctx, void *userdata, Obj
   mul_m4_m4m4(vdd->child_imat, child->imat, ctx->object->obmat);
 
   const MVert *mvert = me_eval->mvert;
+
+  if (dupli_use_threading(ctx, child, me_eval->totvert)) {
+    /* no recursion, all instances can be allocated at once and filled in parallel */
+    VertexDupliTaskData data = {
+        .vdd = vdd,
+        .ctx = vdd->ctx,
+        .mvert = mvert,
+        .duplis = dupli_array_append(ctx->duplis, me_eval->totvert),
+    };
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.min_iter_per_thread = DUPLI_PARALLEL_LIMIT / 4;
+    BLI_task_parallel_range(0, me_eval->totvert, &data, vertex_dupli_cb, &settings);
+    return;
+  }
+
   for (int i = 0; i < me_eval->totvert; i++) {
     vertex_dupli(vdd, i, mvert[i].co, mvert[i].no);
   }
@@ -607,14 +707,123 @@ static void get_dupliface_transform(
   loc_quat_size_to_mat4(mat, loc, quat, size);
 }
 
+static void face_dupli_transform(const DupliContext *ctx,
+                                 const FaceDupliData *fdd,
+                                 Object *inst_ob,
+                                 float child_imat[4][4],
+                                 MPoly *mp,
+                                 float obmat[4][4])
+{
+  MLoop *loopstart = fdd->mloop + mp->loopstart;
+
+  /* obmat is transform to face */
+  get_dupliface_transform(
+      mp, loopstart, fdd->mvert, fdd->use_scale, ctx->object->instance_faces_scale, obmat);
+  /* make offset relative to inst_ob using relative child transform */
+  mul_mat3_m4_v3(child_imat, obmat[3]);
+
+  /* XXX ugly hack to ensure same behavior as in master
+   * this should not be needed, parentinv is not consistent
+   * outside of parenting.
+   */
+  {
+    float imat[3][3];
+    copy_m3_m4(imat, inst_ob->parentinv);
+    mul_m4_m3m4(obmat, imat, obmat);
+  }
+
+  /* apply obmat _after_ the local face transform */
+  mul_m4_m4m4(obmat, inst_ob->obmat, obmat);
+}
+
+static void face_dupli_attributes(const FaceDupliData *fdd, const MPoly *mp, DupliObject *dob)
+{
+  const MLoop *loopstart = fdd->mloop + mp->loopstart;
+  const float w = 1.0f / (float)mp->totloop;
+
+  if (fdd->orco) {
+    for (int j = 0; j < mp->totloop; j++) {
+      madd_v3_v3fl(dob->orco, fdd->orco[loopstart[j].v], w);
+    }
+  }
+  if (fdd->mloopuv) {
+    for (int j = 0; j < mp->totloop; j++) {
+      madd_v2_v2fl(dob->uv, fdd->mloopuv[mp->loopstart + j].uv, w);
+    }
+  }
+}
+
+typedef struct FaceDupliTaskData {
+  const DupliContext *ctx;
+  const FaceDupliData *fdd;
+  Object *inst_ob;
+  float (*child_imat)[4];
+  /* face of each instance, NULL when all faces are instanced */
+  const int *face_index;
+  DupliObject *duplis;
+} FaceDupliTaskData;
+
+static void face_dupli_cb(void *__restrict userdata,
+                          const int i,
+                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const FaceDupliTaskData *data = userdata;
+  const int a = data->face_index ? data->face_index[i] : i;
+  MPoly *mp = &data->fdd->mpoly[a];
+  DupliObject *dob = &data->duplis[i];
+  float obmat[4][4];
+
+  face_dupli_transform(data->ctx, data->fdd, data->inst_ob, data->child_imat, mp, obmat);
+  dupli_init(data->ctx, dob, data->inst_ob, obmat, a);
+  face_dupli_attributes(data->fdd, mp, dob);
+}
+
+static void make_child_duplis_faces_parallel(const DupliContext *ctx,
+                                             const FaceDupliData *fdd,
+                                             Object *inst_ob,
+                                             float child_imat[4][4])
+{
+  int *face_index = NULL;
+  int a, len = 0;
+
+  for (a = 0; a < fdd->totface; a++) {
+    if (fdd->mpoly[a].totloop >= 3) {
+      len++;
+    }
+  }
+  if (len == 0) {
+    return;
+  }
+  if (len != fdd->totface) {
+    face_index = MEM_mallocN(sizeof(int) * (size_t)len, __func__);
+    len = 0;
+    for (a = 0; a < fdd->totface; a++) {
+      if (fdd->mpoly[a].totloop >= 3) {
+        face_index[len++] = a;
+      }
+    }
+  }
+
+  FaceDupliTaskData data = {
+      .ctx = ctx,
+      .fdd = fdd,
+      .inst_ob = inst_ob,
+      .child_imat = child_imat,
+      .face_index = face_index,
+      .duplis = dupli_array_append(ctx->duplis, len),
+  };
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = DUPLI_PARALLEL_LIMIT / 4;
+  BLI_task_parallel_range(0, len, &data, face_dupli_cb, &settings);
+
+  MEM_SAFE_FREE(face_index);
+}
+
 static void make_child_duplis_faces(const DupliContext *ctx, void *userdata, Object *inst_ob)
 {
   FaceDupliData *fdd = userdata;
   MPoly *mpoly = fdd->mpoly, *mp;
-  MLoop *mloop = fdd->mloop;
-  MVert *mvert = fdd->mvert;
-  float(*orco)[3] = fdd->orco;
-  MLoopUV *mloopuv = fdd->mloopuv;
   int a, totface = fdd->totface;
   float child_imat[4][4];
   DupliObject *dob;
@@ -623,32 +832,20 @@ static void make_child_duplis_faces(const DupliContext *ctx, void *userdata, Obj
   /* relative transform from parent to child space */
   mul_m4_m4m4(child_imat, inst_ob->imat, ctx->object->obmat);
 
+  if (dupli_use_threading(ctx, inst_ob, totface)) {
+    /* no recursion, all instances can be allocated at once and filled in parallel */
+    make_child_duplis_faces_parallel(ctx, fdd, inst_ob, child_imat);
+    return;
+  }
+
   for (a = 0, mp = mpoly; a < totface; a++, mp++) {
-    MLoop *loopstart = mloop + mp->loopstart;
     float space_mat[4][4], obmat[4][4];
 
     if (UNLIKELY(mp->totloop < 3)) {
       continue;
     }
 
-    /* obmat is transform to face */
-    get_dupliface_transform(
-        mp, loopstart, mvert, fdd->use_scale, ctx->object->instance_faces_scale, obmat);
-    /* make offset relative to inst_ob using relative child transform */
-    mul_mat3_m4_v3(child_imat, obmat[3]);
-
-    /* XXX ugly hack to ensure same behavior as in master
-     * this should not be needed, parentinv is not consistent
-     * outside of parenting.
-     */
-    {
-      float imat[3][3];
-      copy_m3_m4(imat, inst_ob->parentinv);
-      mul_m4_m3m4(obmat, imat, obmat);
-    }
-
-    /* apply obmat _after_ the local face transform */
-    mul_m4_m4m4(obmat, inst_ob->obmat, obmat);
+    face_dupli_transform(ctx, fdd, inst_ob, child_imat, mp, obmat);
 
     /* space matrix is constructed by removing obmat transform,
      * this yields the worldspace transform for recursive duplis
@@ -656,18 +853,7 @@ static void make_child_duplis_faces(const DupliContext *ctx, void *userdata, Obj
     mul_m4_m4m4(space_mat, obmat, inst_ob->imat);
 
     dob = make_dupli(ctx, inst_ob, obmat, a);
-
-    const float w = 1.0f / (float)mp->totloop;
-    if (orco) {
-      for (int j = 0; j < mp->totloop; j++) {
-        madd_v3_v3fl(dob->orco, orco[loopstart[j].v], w);
-      }
-    }
-    if (mloopuv) {
-      for (int j = 0; j < mp->totloop; j++) {
-        madd_v2_v2fl(dob->uv, mloopuv[mp->loopstart + j].uv, w);
-      }
-    }
+    face_dupli_attributes(fdd, mp, dob);
 
     /* recursion */
     make_recursive_duplis(ctx, inst_ob, space_mat, a);
@@ -885,6 +1071,14 @@ static void make_duplis_particle_system(const DupliContext *ctx, ParticleSystem
       a = totpart;
     }
 
+    /* avoid growing the instance array one particle at a time */
+    if (ctx->duplis) {
+      const int totinstance = (part->ren_as == PART_DRAW_GR && use_whole_collection) ?
+                                  totcollection :
+                                  1;
+      dupli_array_reserve(ctx->duplis, (totpart + totchild - a) * totinstance);
+    }
+
     for (pa = psys->particles; a < totpart + totchild; a++, pa++) {
       if (a < totpart) {
         /* handle parent particle */
@@ -1116,18 +1310,46 @@ static const DupliGenerator *get_dupli_generator(const DupliContext *ctx)
 ListBase *object_duplilist(Depsgraph *depsgraph, Scene *sce, Object *ob)
 {
   ListBase *duplilist = MEM_callocN(sizeof(ListBase), "duplilist");
+  DupliArray duplis = {NULL};
   DupliContext ctx;
   init_context(&ctx, depsgraph, sce, ob, NULL);
   if (ctx.gen) {
-    ctx.duplilist = duplilist;
+    ctx.duplis = &duplis;
     ctx.gen->make_duplis(&ctx);
   }
 
+  /* link the instances, the list owns the array through its first element */
+  if (duplis.len) {
+    DupliObject *dob = duplis.data;
+    for (int i = 0; i < duplis.len; i++, dob++) {
+      dob->prev = (i > 0) ? dob - 1 : NULL;
+      dob->next = (i < duplis.len - 1) ? dob + 1 : NULL;
+    }
+    duplilist->first = duplis.data;
+    duplilist->last = duplis.data + duplis.len - 1;
+  }
+  else {
+    MEM_SAFE_FREE(duplis.data);
+  }
+
   return duplilist;
 }
 
 void free_object_duplilist(ListBase *lb)
 {
-  BLI_freelistN(lb);
+  /* all instances are stored in a single array, see object_duplilist */
+  if (lb->first) {
+    MEM_freeN(lb->first);
+  }
   MEM_freeN(lb);
 }
+
+/* Instances of a list from object_duplilist are contiguous and in list order,
+ * so they can be iterated as an array as well. */
+DupliObject *object_duplilist_array(ListBase *lb, int *r_len)
+{
+  DupliObject *first = lb->first, *last = lb->last;
+
+  *r_len = first ? (int)(last - first) + 1 : 0;
+  return first;
+}
@@ -41,6 +41,7 @@
 #include "BLI_blenlib.h"
 #include "BLI_math.h"
 #include "BLI_utildefines.h"
+#include "BLI_hash_mm2a.h"
 #include "BLI_kdopbvh.h"
 #include "BLI_kdtree.h"
 #include "BLI_rand.h"
@@ -572,6 +573,27 @@ void free_keyed_keys(ParticleSystem *psys)
     }
   }
 }
+
+/* Child parameters that only depend on the child distribution, the emitter topology,
+ * vertex groups and particle settings. They are kept between path cache updates so
+ * that e.g. playback, where only the parent hairs move, doesn't recompute them. */
+typedef struct ParticleChildInterpCache {
+  int totchild, totvert, totface;
+  unsigned int vgroup_hash;
+  ParticleTexture *ptex;
+} ParticleChildInterpCache;
+
+void psys_free_child_interp_cache(ParticleSystem *psys)
+{
+  ParticleChildInterpCache *cache = psys->child_interp_cache;
+
+  if (cache) {
+    MEM_SAFE_FREE(cache->ptex);
+    MEM_freeN(cache);
+    psys->child_interp_cache = NULL;
+  }
+}
+
 static void free_child_path_cache(ParticleSystem *psys)
 {
   psys_free_path_cache_buffers(psys->childcache, &psys->childcachebufs);
@@ -602,6 +624,7 @@ void psys_free_children(ParticleSystem *psys)
   }
 
   free_child_path_cache(psys);
+  psys_free_child_interp_cache(psys);
 }
 void psys_free_particles(ParticleSystem *psys)
 {
@@ -697,6 +720,7 @@ void psys_free(Object *ob, ParticleSystem *psys)
       psys->child = NULL;
       psys->totchild = 0;
     }
+    psys_free_child_interp_cache(psys);
 
     /* check if we are last non-visible particle system */
     for (tpsys = ob->particlesystem.first; tpsys; tpsys = tpsys->next) {
@@ -2401,6 +2425,148 @@ static void psys_task_init_path(ParticleTask *task, ParticleSimulationData *sim)
   task->rng_path = BLI_rng_new(seed);
 }
 
+/* Emitter element on which the textures and vertex groups of a child are evaluated. */
+static void psys_child_emitter_element(ParticleThreadContext *ctx,
+                                       ChildParticle *cpa,
+                                       short *r_cpa_from,
+                                       int *r_cpa_num,
+                                       float **r_cpa_fuv)
+{
+  ParticleSystem *psys = ctx->sim.psys;
+
+  if (ctx->between) {
+    *r_cpa_from = PART_FROM_FACE;
+    *r_cpa_num = cpa->num;
+    *r_cpa_fuv = cpa->fuv;
+  }
+  else {
+    ParticleData *pa = psys->particles + cpa->parent;
+    int cpa_num;
+
+    /*
+     * NOTE: Should in theory be the same as:
+     * cpa_num = psys_particle_dm_face_lookup(
+     *        ctx->sim.psmd->dm_final,
+     *        ctx->sim.psmd->dm_deformed,
+     *        pa->num, pa->fuv,
+     *        NULL);
+     */
+    cpa_num = (ELEM(pa->num_dmcache, DMCACHE_ISCHILD, DMCACHE_NOTFOUND)) ? pa->num :
+                                                                           pa->num_dmcache;
+
+    /* XXX hack to avoid messed up particle num and subsequent crash (#40733) */
+    if (cpa_num > ctx->sim.psmd->mesh_final->totface) {
+      cpa_num = 0;
+    }
+
+    *r_cpa_from = psys->part->from;
+    *r_cpa_num = cpa_num;
+    *r_cpa_fuv = pa->fuv;
+  }
+}
+
+/* Textures can be animated or edited without tagging the particle system,
+ * so children affected by them can't reuse their parameters. */
+static bool psys_child_textures_used(ParticleSettings *part)
+{
+  int m;
+
+  for (m = 0; m < MAX_MTEX; m++) {
+    MTex *mtex = part->mtex[m];
+    if (mtex && mtex->tex && (mtex->mapto & (PAMAP_DENS | PAMAP_CHILD))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/* Weights can change through weight painting or modifiers without a particle recalc,
+ * the hash detects that. */
+static unsigned int psys_child_vgroup_hash(ParticleThreadContext *ctx)
+{
+  const float *vgroups[] = {ctx->vg_length,
+                            ctx->vg_clump,
+                            ctx->vg_kink,
+                            ctx->vg_rough1,
+                            ctx->vg_rough2,
+                            ctx->vg_roughe,
+                            ctx->vg_effector,
+                            ctx->vg_twist};
+  BLI_HashMurmur2A mm2;
+  int i;
+
+  BLI_hash_mm2a_init(&mm2, 0);
+  for (i = 0; i < (int)ARRAY_SIZE(vgroups); i++) {
+    if (vgroups[i]) {
+      BLI_hash_mm2a_add_int(&mm2, i);
+      BLI_hash_mm2a_add(
+          &mm2, (const unsigned char *)vgroups[i], sizeof(float) * (size_t)ctx->mesh->totvert);
+    }
+  }
+  return BLI_hash_mm2a_end(&mm2);
+}
+
+static void psys_child_interp_cache_cb(void *__restrict userdata,
+                                       const int i,
+                                       const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ParticleThreadContext *ctx = userdata;
+  ParticleSystem *psys = ctx->sim.psys;
+  ChildParticle *cpa = psys->child + i;
+  float *cpa_fuv, orco[3] = {0.0f, 0.0f, 0.0f};
+  int cpa_num;
+  short cpa_from;
+
+  /* Only textures that don't affect children are evaluated here, orco is unused. */
+  psys_child_emitter_element(ctx, cpa, &cpa_from, &cpa_num, &cpa_fuv);
+  get_child_modifier_parameters(
+      psys->part, ctx, cpa, cpa_from, cpa_num, cpa_fuv, orco, &ctx->child_ptex[i]);
+}
+
+/* Make ctx->child_ptex point to up to date per-child parameters, recomputing them
+ * only when the children, emitter topology, vertex groups or settings changed. */
+static void psys_child_interp_cache_ensure(ParticleThreadContext *ctx)
+{
+  ParticleSystem *psys = ctx->sim.psys;
+  ParticleChildInterpCache *cache = psys->child_interp_cache;
+  Mesh *mesh = ctx->mesh;
+  TaskParallelSettings settings;
+  unsigned int vgroup_hash;
+
+  if (mesh == NULL || psys->child == NULL || psys_child_textures_used(psys->part)) {
+    psys_free_child_interp_cache(psys);
+    return;
+  }
+
+  vgroup_hash = psys_child_vgroup_hash(ctx);
+
+  if (cache && (psys->recalc & ID_RECALC_PSYS_ALL) == 0 && cache->totchild == ctx->totchild &&
+      cache->totvert == mesh->totvert && cache->totface == mesh->totface &&
+      cache->vgroup_hash == vgroup_hash) {
+    ctx->child_ptex = cache->ptex;
+    return;
+  }
+
+  if (cache == NULL) {
+    cache = psys->child_interp_cache = MEM_callocN(sizeof(*cache), "ParticleChildInterpCache");
+  }
+  if (cache->ptex == NULL || cache->totchild != ctx->totchild) {
+    MEM_SAFE_FREE(cache->ptex);
+    cache->ptex = MEM_mallocN(sizeof(ParticleTexture) * (size_t)ctx->totchild,
+                              "ParticleChildInterpCache ptex");
+  }
+  cache->totchild = ctx->totchild;
+  cache->totvert = mesh->totvert;
+  cache->totface = mesh->totface;
+  cache->vgroup_hash = vgroup_hash;
+
+  ctx->child_ptex = cache->ptex;
+
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+  BLI_task_parallel_range(0, ctx->totchild, ctx, psys_child_interp_cache_cb, &settings);
+}
+
 /* note: this function must be thread safe, except for branching! */
 static void psys_thread_create_path(ParticleTask *task,
                                     struct ChildParticle *cpa,
@@ -2517,11 +2683,9 @@ static void psys_thread_create_path(ParticleTask *task,
     }
 
     /* get the original coordinates (orco) for texture usage */
-    cpa_num = cpa->num;
+    psys_child_emitter_element(ctx, cpa, &cpa_from, &cpa_num, &cpa_fuv);
 
     foffset = cpa->foffset;
-    cpa_fuv = cpa->fuv;
-    cpa_from = PART_FROM_FACE;
 
     psys_particle_on_emitter(
         ctx->sim.psmd, cpa_from, cpa_num, DMCACHE_ISCHILD, cpa->fuv, foffset, co, 0, 0, 0, orco);
@@ -2549,24 +2713,7 @@ static void psys_thread_create_path(ParticleTask *task,
     key[0] = pcache[cpa->parent];
 
     /* get the original coordinates (orco) for texture usage */
-    cpa_from = part->from;
-
-    /*
-     * NOTE: Should in theory be the same as:
-     * cpa_num = psys_particle_dm_face_lookup(
-     *        ctx->sim.psmd->dm_final,
-     *        ctx->sim.psmd->dm_deformed,
-     *        pa->num, pa->fuv,
-     *        NULL);
-     */
-    cpa_num = (ELEM(pa->num_dmcache, DMCACHE_ISCHILD, DMCACHE_NOTFOUND)) ? pa->num :
-                                                                           pa->num_dmcache;
-
-    /* XXX hack to avoid messed up particle num and subsequent crash (#40733) */
-    if (cpa_num > ctx->sim.psmd->mesh_final->totface) {
-      cpa_num = 0;
-    }
-    cpa_fuv = pa->fuv;
+    psys_child_emitter_element(ctx, cpa, &cpa_from, &cpa_num, &cpa_fuv);
 
     psys_particle_on_emitter(ctx->sim.psmd,
                              cpa_from,
@@ -2586,7 +2733,12 @@ static void psys_thread_create_path(ParticleTask *task,
   child_keys->segments = ctx->segments;
 
   /* get different child parameters from textures & vgroups */
-  get_child_modifier_parameters(part, ctx, cpa, cpa_from, cpa_num, cpa_fuv, orco, &ptex);
+  if (ctx->child_ptex) {
+    ptex = ctx->child_ptex[i];
+  }
+  else {
+    get_child_modifier_parameters(part, ctx, cpa, cpa_from, cpa_num, cpa_fuv, orco, &ptex);
+  }
 
   if (ptex.exist < psys_frand(psys, i + 24)) {
     child_keys->segments = -1;
@@ -2774,6 +2926,8 @@ void psys_cache_child_paths(ParticleSimulationData *sim,
     return;
   }
 
+  psys_child_interp_cache_ensure(&ctx);
+
   task_scheduler = BLI_task_scheduler_get();
   task_pool = BLI_task_pool_create(task_scheduler, &ctx);
   totchild = ctx.totchild;
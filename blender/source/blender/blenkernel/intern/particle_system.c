@@ -3184,6 +3184,9 @@ static void psys_update_path_cache(ParticleSimulationData *sim,
   }
 
   if (distr) {
+    /* Children are redistributed, their cached parameters no longer apply. */
+    psys_free_child_interp_cache(psys);
+
     if (alloc) {
       realloc_particles(sim, sim->psys->totpart);
     }
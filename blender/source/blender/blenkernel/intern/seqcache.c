@@ -70,7 +70,8 @@ typedef struct SeqCache {
   ThreadMutex iterator_mutex;
   struct BLI_mempool *keys_pool;
   struct BLI_mempool *items_pool;
-  struct SeqCacheKey *last_key;
+  /* Last stored key of the frame being rendered, one per render task. */
+  struct SeqCacheKey *last_key[SEQ_TASK_MAX];
   size_t memory_used;
 } SeqCache;
 
@@ -200,7 +201,7 @@ static void seq_cache_put(SeqCache *cache, SeqCacheKey *key, ImBuf *ibuf)
 
   if (BLI_ghash_reinsert(cache->hash, key, item, seq_cache_keyfree, seq_cache_valfree)) {
     IMB_refImBuf(ibuf);
-    cache->last_key = key;
+    cache->last_key[key->task_id] = key;
     cache->memory_used += IMB_get_size_in_memory(ibuf);
   }
 }
@@ -218,6 +219,20 @@ static ImBuf *seq_cache_get(SeqCache *cache, void *key)
   return NULL;
 }
 
+static void seq_cache_last_key_reset(SeqCache *cache)
+{
+  memset(cache->last_key, 0, sizeof(cache->last_key));
+}
+
+/* Frames of other tasks may be recycled while they are being rendered,
+ * don't let their linking continue from a freed key. */
+static void seq_cache_last_key_forget(SeqCache *cache, SeqCacheKey *key)
+{
+  if (cache->last_key[key->task_id] == key) {
+    cache->last_key[key->task_id] = NULL;
+  }
+}
+
 static void seq_cache_relink_keys(SeqCacheKey *link_next, SeqCacheKey *link_prev)
 {
   if (link_next) {
@@ -308,6 +323,7 @@ static void seq_cache_recycle_linked(Scene *scene, SeqCacheKey *base)
 
   while (base) {
     SeqCacheKey *prev = base->link_prev;
+    seq_cache_last_key_forget(cache, base);
     BLI_ghash_remove(cache->hash, base, seq_cache_keyfree, seq_cache_valfree);
     base = prev;
   }
@@ -315,6 +331,7 @@ static void seq_cache_recycle_linked(Scene *scene, SeqCacheKey *base)
   base = next;
   while (base) {
     next = base->link_next;
+    seq_cache_last_key_forget(cache, base);
     BLI_ghash_remove(cache->hash, base, seq_cache_keyfree, seq_cache_valfree);
     base = next;
   }
@@ -440,7 +457,7 @@ static void BKE_sequencer_cache_create(Scene *scene)
     cache->keys_pool = BLI_mempool_create(sizeof(SeqCacheKey), 0, 64, BLI_MEMPOOL_NOP);
     cache->items_pool = BLI_mempool_create(sizeof(SeqCacheItem), 0, 64, BLI_MEMPOOL_NOP);
     cache->hash = BLI_ghash_new(seq_cache_hashhash, seq_cache_hashcmp, "SeqCache hash");
-    cache->last_key = NULL;
+    seq_cache_last_key_reset(cache);
     BLI_mutex_init(&cache->iterator_mutex);
     scene->ed->cache = cache;
   }
@@ -511,7 +528,7 @@ void BKE_sequencer_cache_cleanup(Scene *scene)
     BLI_ghashIterator_step(&gh_iter);
     BLI_ghash_remove(cache->hash, key, seq_cache_keyfree, seq_cache_valfree);
   }
-  cache->last_key = NULL;
+  seq_cache_last_key_reset(cache);
   seq_cache_unlock(scene);
 }
 
@@ -568,7 +585,7 @@ void BKE_sequencer_cache_cleanup_sequence(Scene *scene,
       BLI_ghash_remove(cache->hash, key, seq_cache_keyfree, seq_cache_valfree);
     }
   }
-  cache->last_key = NULL;
+  seq_cache_last_key_reset(cache);
   seq_cache_unlock(scene);
 }
 
@@ -625,8 +642,11 @@ bool BKE_sequencer_cache_put_if_possible(
     return true;
   }
   else {
-    seq_cache_set_temp_cache_linked(scene, scene->ed->cache->last_key);
-    scene->ed->cache->last_key = NULL;
+    SeqCache *cache = scene->ed->cache;
+    seq_cache_lock(scene);
+    seq_cache_set_temp_cache_linked(scene, cache->last_key[context->task_id]);
+    cache->last_key[context->task_id] = NULL;
+    seq_cache_unlock(scene);
     return false;
   }
 }
@@ -691,27 +711,27 @@ void BKE_sequencer_cache_put(
   /* Item stored for later use */
   if (flag & type) {
     key->is_temp_cache = false;
-    key->link_prev = cache->last_key;
+    key->link_prev = cache->last_key[key->task_id];
   }
 
-  SeqCacheKey *temp_last_key = cache->last_key;
+  SeqCacheKey *temp_last_key = cache->last_key[key->task_id];
   seq_cache_put(cache, key, i);
 
   /* Restore pointer to previous item as this one will be freed when stack is rendered */
   if (key->is_temp_cache) {
-    cache->last_key = temp_last_key;
+    cache->last_key[key->task_id] = temp_last_key;
   }
 
   /* Set last_key's reference to this key so we can look up chain backwards
    * Item is already put in cache, so cache->last_key points to current key;
    */
   if (flag & type && temp_last_key) {
-    temp_last_key->link_next = cache->last_key;
+    temp_last_key->link_next = cache->last_key[key->task_id];
   }
 
   /* Reset linking */
   if (key->type == SEQ_CACHE_STORE_FINAL_OUT) {
-    cache->last_key = NULL;
+    cache->last_key[key->task_id] = NULL;
   }
 
   seq_cache_unlock(scene);
@@ -739,7 +759,7 @@ void BKE_sequencer_cache_iterate(
     interrupt = callback(userdata, key->seq, key->nfra, key->type, key->cost);
   }
 
-  cache->last_key = NULL;
+  seq_cache_last_key_reset(cache);
   seq_cache_unlock(scene);
 }
 
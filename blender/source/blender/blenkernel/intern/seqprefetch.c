@@ -34,7 +34,9 @@
 #include "DNA_anim_types.h"
 
 #include "BLI_listbase.h"
+#include "BLI_math_base.h"
 #include "BLI_threads.h"
+#include "BLI_utildefines.h"
 
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
@@ -52,27 +54,46 @@
 #include "DEG_depsgraph_debug.h"
 #include "DEG_depsgraph_query.h"
 
+/* One thread rendering frames ahead of the playhead. Each worker evaluates its own copy of the
+ * scene, so workers don't have to share animation or strip state. Rendering the strips is still
+ * serialized with all other sequencer renders, see BKE_sequencer_give_ibuf(). */
+typedef struct PrefetchWorker {
+  struct PrefetchJob *pfjob;
+
+  struct Main *bmain_eval;
+  struct Scene *scene_eval;
+  struct Depsgraph *depsgraph;
+
+  /* context */
+  struct SeqRenderData context;
+  struct SeqRenderData context_cpy;
+
+  /* frame being rendered */
+  int cfra;
+} PrefetchWorker;
+
 typedef struct PrefetchJob {
   struct PrefetchJob *next, *prev;
 
   struct Main *bmain;
-  struct Main *bmain_eval;
   struct Scene *scene;
-  struct Scene *scene_eval;
-  struct Depsgraph *depsgraph;
 
   ThreadMutex prefetch_suspend_mutex;
   ThreadCondition prefetch_suspend_cond;
 
   ListBase threads;
 
-  /* context */
-  struct SeqRenderData context;
-  struct SeqRenderData context_cpy;
-  struct ListBase *seqbasep;
-  struct ListBase *seqbasep_cpy;
+  PrefetchWorker workers[SEQ_PREFETCH_WORKERS_MAX];
+  /* Workers used by current job and size of thread pool. */
+  int num_workers;
+  int num_workers_max;
+  int num_workers_running;
+  int num_workers_waiting;
+
+  /* Last known render cost of a frame, see BKE_sequencer_prefetch_start(). */
+  float cost;
 
-  /* prefetch area */
+  /* prefetch area, frames up to cfra + num_frames_prefetched are handed out to workers */
   float cfra;
   int num_frames_prefetched;
 
@@ -153,9 +174,15 @@ SeqRenderData *BKE_sequencer_prefetch_get_original_context(const SeqRenderData *
 {
   PrefetchJob *pfjob = seq_prefetch_job_get(context->scene);
 
-  return &pfjob->context;
+  for (int i = 0; i < pfjob->num_workers; i++) {
+    if (pfjob->workers[i].scene_eval == context->scene) {
+      return &pfjob->workers[i].context;
+    }
+  }
+  return &pfjob->workers[0].context;
 }
 
+
 static bool seq_prefetch_is_cache_full(Scene *scene)
 {
   PrefetchJob *pfjob = seq_prefetch_job_get(scene);
@@ -175,38 +202,51 @@ void BKE_sequencer_prefetch_get_time_range(Scene *scene, int *start, int *end)
   *end = pfjob->cfra + pfjob->num_frames_prefetched;
 }
 
-static void seq_prefetch_free_depsgraph(PrefetchJob *pfjob)
+static void seq_prefetch_free_depsgraph(PrefetchWorker *worker)
 {
-  if (pfjob->depsgraph != NULL) {
-    DEG_graph_free(pfjob->depsgraph);
+  if (worker->depsgraph != NULL) {
+    DEG_graph_free(worker->depsgraph);
   }
-  pfjob->depsgraph = NULL;
-  pfjob->scene_eval = NULL;
+  worker->depsgraph = NULL;
+  worker->scene_eval = NULL;
 }
 
-static void seq_prefetch_update_depsgraph(PrefetchJob *pfjob)
+static void seq_prefetch_update_depsgraph(PrefetchWorker *worker, int cfra)
 {
-  DEG_evaluate_on_framechange(
-      pfjob->bmain_eval, pfjob->depsgraph, pfjob->cfra + pfjob->num_frames_prefetched);
+  DEG_evaluate_on_framechange(worker->bmain_eval, worker->depsgraph, cfra);
 }
 
-static void seq_prefetch_init_depsgraph(PrefetchJob *pfjob)
+static void seq_prefetch_init_depsgraph(PrefetchWorker *worker)
 {
-  Main *bmain = pfjob->bmain_eval;
+  PrefetchJob *pfjob = worker->pfjob;
   Scene *scene = pfjob->scene;
   ViewLayer *view_layer = BKE_view_layer_default_render(scene);
 
-  pfjob->depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
-  DEG_debug_name_set(pfjob->depsgraph, "SEQUENCER PREFETCH");
+  if (worker->bmain_eval == NULL) {
+    worker->bmain_eval = BKE_main_new();
+  }
+  Main *bmain = worker->bmain_eval;
+
+  worker->depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
+  DEG_debug_name_set(worker->depsgraph, "SEQUENCER PREFETCH");
 
   /* Make sure there is a correct evaluated scene pointer. */
-  DEG_graph_build_for_render_pipeline(pfjob->depsgraph, bmain, scene, view_layer);
+  DEG_graph_build_for_render_pipeline(worker->depsgraph, bmain, scene, view_layer);
 
   /* Update immediately so we have proper evaluated scene. */
-  seq_prefetch_update_depsgraph(pfjob);
+  seq_prefetch_update_depsgraph(worker, pfjob->cfra + pfjob->num_frames_prefetched);
 
-  pfjob->scene_eval = DEG_get_evaluated_scene(pfjob->depsgraph);
-  pfjob->scene_eval->ed->cache_flag = 0;
+  worker->scene_eval = DEG_get_evaluated_scene(worker->depsgraph);
+  worker->scene_eval->ed->cache_flag = 0;
+}
+
+static void seq_prefetch_free_worker(PrefetchWorker *worker)
+{
+  seq_prefetch_free_depsgraph(worker);
+  if (worker->bmain_eval != NULL) {
+    BKE_main_free(worker->bmain_eval);
+    worker->bmain_eval = NULL;
+  }
 }
 
 static void seq_prefetch_update_area(PrefetchJob *pfjob)
@@ -231,6 +271,14 @@ static void seq_prefetch_update_area(PrefetchJob *pfjob)
   }
 }
 
+/* Must be called with prefetch_suspend_mutex locked. */
+static void seq_prefetch_update_state(PrefetchJob *pfjob)
+{
+  pfjob->waiting = pfjob->num_workers_waiting > 0 &&
+                   pfjob->num_workers_waiting == pfjob->num_workers_running;
+  pfjob->running = pfjob->num_workers_running > 0;
+}
+
 /* Use also to update scene and context changes
  * This function should almost always be called by cache invalidation, not directly.
  */
@@ -246,7 +294,7 @@ void BKE_sequencer_prefetch_stop(Scene *scene)
   pfjob->stop = true;
 
   while (pfjob->running) {
-    BLI_condition_notify_one(&pfjob->prefetch_suspend_cond);
+    BLI_condition_notify_all(&pfjob->prefetch_suspend_cond);
   }
 }
 
@@ -255,32 +303,36 @@ static void seq_prefetch_update_context(const SeqRenderData *context)
   PrefetchJob *pfjob;
   pfjob = seq_prefetch_job_get(context->scene);
 
-  BKE_sequencer_new_render_data(pfjob->bmain_eval,
-                                pfjob->depsgraph,
-                                pfjob->scene_eval,
-                                context->rectx,
-                                context->recty,
-                                context->preview_render_size,
-                                false,
-                                &pfjob->context_cpy);
-  pfjob->context_cpy.is_prefetch_render = true;
-  pfjob->context_cpy.task_id = SEQ_TASK_PREFETCH_RENDER;
-
-  BKE_sequencer_new_render_data(pfjob->bmain,
-                                pfjob->depsgraph,
-                                pfjob->scene,
-                                context->rectx,
-                                context->recty,
-                                context->preview_render_size,
-                                false,
-                                &pfjob->context);
-  pfjob->context.is_prefetch_render = false;
-
-  /* Same ID as prefetch context, because context will be swapped, but we still
-   * want to assign this ID to cache entries created in this thread.
-   * This is to allow "temp cache" work correctly for both threads.
-   */
-  pfjob->context.task_id = SEQ_TASK_PREFETCH_RENDER;
+  for (int i = 0; i < pfjob->num_workers; i++) {
+    PrefetchWorker *worker = &pfjob->workers[i];
+
+    BKE_sequencer_new_render_data(worker->bmain_eval,
+                                  worker->depsgraph,
+                                  worker->scene_eval,
+                                  context->rectx,
+                                  context->recty,
+                                  context->preview_render_size,
+                                  false,
+                                  &worker->context_cpy);
+    worker->context_cpy.is_prefetch_render = true;
+    worker->context_cpy.task_id = SEQ_TASK_PREFETCH_RENDER + i;
+
+    BKE_sequencer_new_render_data(pfjob->bmain,
+                                  worker->depsgraph,
+                                  pfjob->scene,
+                                  context->rectx,
+                                  context->recty,
+                                  context->preview_render_size,
+                                  false,
+                                  &worker->context);
+    worker->context.is_prefetch_render = false;
+
+    /* Same ID as prefetch context, because context will be swapped, but we still
+     * want to assign this ID to cache entries created in this thread.
+     * This is to allow "temp cache" work correctly for all threads.
+     */
+    worker->context.task_id = SEQ_TASK_PREFETCH_RENDER + i;
+  }
 }
 
 static void seq_prefetch_update_scene(Scene *scene)
@@ -291,8 +343,18 @@ static void seq_prefetch_update_scene(Scene *scene)
     return;
   }
 
-  seq_prefetch_free_depsgraph(pfjob);
-  seq_prefetch_init_depsgraph(pfjob);
+  for (int i = 0; i < pfjob->num_workers_max; i++) {
+    PrefetchWorker *worker = &pfjob->workers[i];
+
+    if (i < pfjob->num_workers) {
+      seq_prefetch_free_depsgraph(worker);
+      seq_prefetch_init_depsgraph(worker);
+    }
+    else {
+      /* Don't keep copies of the scene for idle workers. */
+      seq_prefetch_free_worker(worker);
+    }
+  }
 }
 
 static void seq_prefetch_resume(Scene *scene)
@@ -300,7 +362,7 @@ static void seq_prefetch_resume(Scene *scene)
   PrefetchJob *pfjob = seq_prefetch_job_get(scene);
 
   if (pfjob && pfjob->waiting) {
-    BLI_condition_notify_one(&pfjob->prefetch_suspend_cond);
+    BLI_condition_notify_all(&pfjob->prefetch_suspend_cond);
   }
 }
 
@@ -313,31 +375,61 @@ void BKE_sequencer_prefetch_free(Scene *scene)
 
   BKE_sequencer_prefetch_stop(scene);
 
-  BLI_threadpool_remove(&pfjob->threads, pfjob);
+  for (int i = 0; i < pfjob->num_workers_max; i++) {
+    BLI_threadpool_remove(&pfjob->threads, &pfjob->workers[i]);
+    seq_prefetch_free_worker(&pfjob->workers[i]);
+  }
   BLI_threadpool_end(&pfjob->threads);
   BLI_mutex_end(&pfjob->prefetch_suspend_mutex);
   BLI_condition_end(&pfjob->prefetch_suspend_cond);
-  seq_prefetch_free_depsgraph(pfjob);
-  BKE_main_free(pfjob->bmain_eval);
   MEM_freeN(pfjob);
   scene->ed->prefetch_job = NULL;
 }
 
+/* Hand out next frame to render. Workers take frames in turns, so they render
+ * interleaved frames and cached area grows without gaps.
+ * Must be called with prefetch_suspend_mutex locked. */
+static bool seq_prefetch_next_frame(PrefetchJob *pfjob, PrefetchWorker *worker)
+{
+  seq_prefetch_update_area(pfjob);
+
+  /* Avoid "collision" with main thread, but make sure to fetch at least few frames */
+  if (pfjob->num_frames_prefetched > 5 &&
+      (pfjob->cfra + pfjob->num_frames_prefetched - pfjob->scene->r.cfra) < 2) {
+    return false;
+  }
+
+  if (pfjob->cfra + pfjob->num_frames_prefetched > pfjob->scene->r.efra) {
+    return false;
+  }
+
+  worker->cfra = pfjob->cfra + pfjob->num_frames_prefetched;
+  pfjob->num_frames_prefetched++;
+  return true;
+}
+
 static void *seq_prefetch_frames(void *job)
 {
-  PrefetchJob *pfjob = (PrefetchJob *)job;
+  PrefetchWorker *worker = (PrefetchWorker *)job;
+  PrefetchJob *pfjob = worker->pfjob;
+  bool has_frame, has_rendered = false;
+  int cfra_rendered = 0;
+
+  BLI_mutex_lock(&pfjob->prefetch_suspend_mutex);
+  has_frame = !pfjob->stop && seq_prefetch_next_frame(pfjob, worker);
+  BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
 
-  while (pfjob->cfra + pfjob->num_frames_prefetched <= pfjob->scene->r.efra) {
-    pfjob->scene_eval->ed->prefetch_job = NULL;
+  while (has_frame) {
+    worker->scene_eval->ed->prefetch_job = NULL;
 
-    AnimData *adt = BKE_animdata_from_id(&pfjob->context_cpy.scene->id);
-    BKE_animsys_evaluate_animdata(pfjob->context_cpy.scene,
-                                  &pfjob->context_cpy.scene->id,
+    AnimData *adt = BKE_animdata_from_id(&worker->context_cpy.scene->id);
+    BKE_animsys_evaluate_animdata(worker->context_cpy.scene,
+                                  &worker->context_cpy.scene->id,
                                   adt,
-                                  pfjob->cfra + pfjob->num_frames_prefetched,
+                                  worker->cfra,
                                   ADT_RECALC_ALL,
                                   false);
-    seq_prefetch_update_depsgraph(pfjob);
+    seq_prefetch_update_depsgraph(worker, worker->cfra);
 
     /* This is quite hacky solution:
      * We need cross-reference original scene with copy for cache.
@@ -345,48 +437,66 @@ static void *seq_prefetch_frames(void *job)
      * Scene copy don't reference original scene. Perhaps, this could be done by depsgraph.
      * Set to NULL before return!
      */
-    pfjob->scene_eval->ed->prefetch_job = pfjob;
+    worker->scene_eval->ed->prefetch_job = pfjob;
 
-    ImBuf *ibuf = BKE_sequencer_give_ibuf(
-        &pfjob->context_cpy, pfjob->cfra + pfjob->num_frames_prefetched, 0);
-    BKE_sequencer_cache_free_temp_cache(
-        pfjob->scene, pfjob->context.task_id, pfjob->cfra + pfjob->num_frames_prefetched);
+    ImBuf *ibuf = BKE_sequencer_give_ibuf(&worker->context_cpy, worker->cfra, 0);
+    BKE_sequencer_cache_free_temp_cache(pfjob->scene, worker->context.task_id, worker->cfra);
     IMB_freeImBuf(ibuf);
+    cfra_rendered = worker->cfra;
+    has_rendered = true;
 
     /* suspend thread */
     BLI_mutex_lock(&pfjob->prefetch_suspend_mutex);
     while ((seq_prefetch_is_cache_full(pfjob->scene) || seq_prefetch_is_scrubbing(pfjob->bmain)) &&
            pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE && !pfjob->stop) {
-      pfjob->waiting = true;
+      pfjob->num_workers_waiting++;
+      seq_prefetch_update_state(pfjob);
       BLI_condition_wait(&pfjob->prefetch_suspend_cond, &pfjob->prefetch_suspend_mutex);
-      seq_prefetch_update_area(pfjob);
+      pfjob->num_workers_waiting--;
+      seq_prefetch_update_state(pfjob);
     }
-    pfjob->waiting = false;
-    BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
 
-    /* Avoid "collision" with main thread, but make sure to fetch at least few frames */
-    if (pfjob->num_frames_prefetched > 5 &&
-        (pfjob->cfra + pfjob->num_frames_prefetched - pfjob->scene->r.cfra) < 2) {
-      break;
-    }
-
-    if (!(pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) || pfjob->stop) {
-      break;
-    }
+    has_frame = (pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) && !pfjob->stop &&
+                seq_prefetch_next_frame(pfjob, worker);
+    BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
+  }
 
-    seq_prefetch_update_area(pfjob);
-    pfjob->num_frames_prefetched++;
+  if (has_rendered) {
+    BKE_sequencer_cache_free_temp_cache(pfjob->scene, worker->context.task_id, cfra_rendered);
   }
+  worker->scene_eval->ed->prefetch_job = NULL;
 
-  BKE_sequencer_cache_free_temp_cache(
-      pfjob->scene, pfjob->context.task_id, pfjob->cfra + pfjob->num_frames_prefetched);
-  pfjob->running = false;
-  pfjob->scene_eval->ed->prefetch_job = NULL;
+  /* Job may be restarted or freed as soon as last worker is done. */
+  BLI_mutex_lock(&pfjob->prefetch_suspend_mutex);
+  pfjob->num_workers_running--;
+  seq_prefetch_update_state(pfjob);
+  BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
 
   return 0;
 }
 
-static PrefetchJob *seq_prefetch_start(const SeqRenderData *context, float cfra)
+/* Leave one thread for drawing and main thread rendering. */
+static int seq_prefetch_num_workers_max(void)
+{
+  int num_workers_max = BLI_system_thread_count() - 1;
+  CLAMP(num_workers_max, 1, SEQ_PREFETCH_WORKERS_MAX);
+  return num_workers_max;
+}
+
+/* Use enough workers to keep up with playback. Cost is render time of a frame relative to
+ * frame duration, one extra worker lets prefetching get ahead of the playhead. */
+static int seq_prefetch_num_workers(PrefetchJob *pfjob)
+{
+  if (pfjob->cost <= 0.0f) {
+    return 1;
+  }
+
+  int num_workers = (int)ceilf(min_ff(pfjob->cost, (float)SEQ_PREFETCH_WORKERS_MAX)) + 1;
+  CLAMP(num_workers, 1, pfjob->num_workers_max);
+  return num_workers;
+}
+
+static PrefetchJob *seq_prefetch_start(const SeqRenderData *context, float cfra, float cost)
 {
   PrefetchJob *pfjob = seq_prefetch_job_get(context->scene);
 
@@ -395,31 +505,46 @@ static PrefetchJob *seq_prefetch_start(const SeqRenderData *context, float cfra)
       pfjob = (PrefetchJob *)MEM_callocN(sizeof(PrefetchJob), "PrefetchJob");
       context->scene->ed->prefetch_job = pfjob;
 
-      BLI_threadpool_init(&pfjob->threads, seq_prefetch_frames, 1);
+      pfjob->num_workers_max = seq_prefetch_num_workers_max();
+
+      BLI_threadpool_init(&pfjob->threads, seq_prefetch_frames, pfjob->num_workers_max);
       BLI_mutex_init(&pfjob->prefetch_suspend_mutex);
       BLI_condition_init(&pfjob->prefetch_suspend_cond);
 
       pfjob->bmain = context->bmain;
-      pfjob->bmain_eval = BKE_main_new();
-
       pfjob->scene = context->scene;
-      seq_prefetch_init_depsgraph(pfjob);
+
+      for (int i = 0; i < pfjob->num_workers_max; i++) {
+        pfjob->workers[i].pfjob = pfjob;
+      }
     }
   }
-  seq_prefetch_update_scene(context->scene);
-  seq_prefetch_update_context(context);
+
+  /* Cached frames don't report cost, keep the last measured one. */
+  if (cost > 0.0f) {
+    pfjob->cost = cost;
+  }
 
   pfjob->cfra = cfra;
   pfjob->num_frames_prefetched = 1;
+  pfjob->num_workers = seq_prefetch_num_workers(pfjob);
 
+  seq_prefetch_update_scene(context->scene);
+  seq_prefetch_update_context(context);
+
+  pfjob->num_workers_running = pfjob->num_workers;
+  pfjob->num_workers_waiting = 0;
   pfjob->waiting = false;
   pfjob->stop = false;
   pfjob->running = true;
 
-  if (&pfjob->threads) {
-    BLI_threadpool_remove(&pfjob->threads, pfjob);
+  for (int i = 0; i < pfjob->num_workers_max; i++) {
+    /* Join threads of previous run. */
+    BLI_threadpool_remove(&pfjob->threads, &pfjob->workers[i]);
+  }
+  for (int i = 0; i < pfjob->num_workers; i++) {
+    BLI_threadpool_insert(&pfjob->threads, &pfjob->workers[i]);
   }
-  BLI_threadpool_insert(&pfjob->threads, pfjob);
 
   return pfjob;
 }
@@ -438,12 +563,14 @@ void BKE_sequencer_prefetch_start(const SeqRenderData *context, float cfra, floa
     seq_prefetch_resume(scene);
     /* conditions to start:
      * prefetch enabled, prefetch not running, not scrubbing,
-     * not playing and rendering-expensive footage, cache storage enabled, has strips to render
+     * not playing footage too expensive for all workers to keep up with, cache storage enabled,
+     * has strips to render
      */
+    const bool too_expensive = playing && cost > 0.9f * seq_prefetch_num_workers_max();
     if ((ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) && !running && !scrubbing &&
-        !(playing && cost > 0.9) && ed->cache_flag & SEQ_CACHE_ALL_TYPES && has_strips) {
+        !too_expensive && ed->cache_flag & SEQ_CACHE_ALL_TYPES && has_strips) {
 
-      seq_prefetch_start(context, cfra);
+      seq_prefetch_start(context, cfra, cost);
     }
   }
 }
@@ -37,6 +37,8 @@
 #  endif
 
 #  include "BLI_math_base.h"
+#  include "BLI_task.h"
+#  include "BLI_threads.h"
 #  include "BLI_utildefines.h"
 
 #  include "BKE_global.h"
@@ -55,6 +57,7 @@
 #  include <libavformat/avformat.h>
 #  include <libavcodec/avcodec.h>
 #  include <libavutil/imgutils.h>
+#  include <libavutil/pixdesc.h>
 #  include <libavutil/rational.h>
 #  include <libavutil/samplefmt.h>
 #  include <libswscale/swscale.h>
@@ -63,6 +66,22 @@
 
 struct StampData;
 
+/* Frames waiting to be encoded, appending a frame blocks while all are in use. */
+#  define FFMPEG_ENCODE_QUEUE_SIZE 3
+/* Pixel format conversion is split into horizontal bands converted in parallel. Bands are
+ * converted with this many extra rows on either side, so vertical chroma filtering sees the same
+ * rows as when converting the whole image at once, and the band edges don't show. */
+#  define FFMPEG_CONVERT_BANDS_MAX 16
+#  define FFMPEG_CONVERT_BAND_MIN_HEIGHT 64
+#  define FFMPEG_CONVERT_BAND_OVERLAP 16
+
+typedef struct FFMpegEncodeFrame {
+  /* Image frame in Blender's own pixel format, may need conversion to the output pixel format. */
+  AVFrame *rgb_frame;
+  int pts;
+  double audio_pts;
+} FFMpegEncodeFrame;
+
 typedef struct FFMpegContext {
   int ffmpeg_type;
   int ffmpeg_codec;
@@ -83,9 +102,25 @@ typedef struct FFMpegContext {
   AVStream *audio_stream;
   AVFrame *current_frame; /* Image frame in output pixel format. */
 
-  /* Image frame in Blender's own pixel format, may need conversion to the output pixel format. */
-  AVFrame *img_convert_frame;
-  struct SwsContext *img_convert_ctx;
+  /* Conversion to the output pixel format, one context per band of the image.
+   * NULL when the output pixel format is Blender's internal one. With multiple bands, each one
+   * including its overlap is converted into its own frame first. */
+  struct SwsContext *img_convert_ctx[FFMPEG_CONVERT_BANDS_MAX];
+  AVFrame *img_convert_frames[FFMPEG_CONVERT_BANDS_MAX];
+  int img_convert_bands;
+  int img_convert_band_height;
+
+  /* Video frames are encoded and written by a separate thread, so the next frame can be
+   * prepared meanwhile. Frames in [encode_head, encode_head + encode_count) are owned by it. */
+  FFMpegEncodeFrame encode_frames[FFMPEG_ENCODE_QUEUE_SIZE];
+  int encode_head;
+  int encode_count;
+  bool encode_stop;
+  bool encode_error;
+  bool encode_autosplit;
+  ListBase encode_threads;
+  ThreadMutex encode_mutex;
+  ThreadCondition encode_cond;
 
   uint8_t *audio_input_buffer;
   uint8_t *audio_deinterleave_buffer;
@@ -116,6 +151,7 @@ static void ffmpeg_dict_set_float(AVDictionary **dict, const char *key, float va
 static void ffmpeg_set_expert_options(RenderData *rd);
 static void ffmpeg_filepath_get(
     FFMpegContext *context, char *string, struct RenderData *rd, bool preview, const char *suffix);
+static void ffmpeg_encode_thread_start(FFMpegContext *context);
 
 /* Delete a picture buffer */
 
@@ -337,8 +373,7 @@ static const char **get_file_extensions(int format)
 }
 
 /* Write a frame to the output file */
-static int write_video_frame(
-    FFMpegContext *context, RenderData *rd, int cfra, AVFrame *frame, ReportList *reports)
+static int write_video_frame(FFMpegContext *context, int cfra, AVFrame *frame)
 {
   int got_output;
   int ret, success = 1;
@@ -375,34 +410,16 @@ static int write_video_frame(
     success = 0;
   }
 
-  if (!success) {
-    BKE_report(reports, RPT_ERROR, "Error writing frame");
-  }
-
   return success;
 }
 
-/* read and encode a frame of audio from the buffer */
-static AVFrame *generate_video_frame(FFMpegContext *context,
-                                     const uint8_t *pixels,
-                                     ReportList *reports)
+/* Copy the Blender pixels into the FFmpeg datastructure, taking care of endianness and flipping
+ * the image vertically. */
+static void generate_video_frame(AVFrame *rgb_frame, const uint8_t *pixels)
 {
-  AVCodecContext *c = context->video_stream->codec;
-  int height = c->height;
-  AVFrame *rgb_frame;
-
-  if (context->img_convert_frame != NULL) {
-    /* Pixel format conversion is needed. */
-    rgb_frame = context->img_convert_frame;
-  }
-  else {
-    /* The output pixel format is Blender's internal pixel format. */
-    rgb_frame = context->current_frame;
-  }
-
-  /* Copy the Blender pixels into the FFmpeg datastructure, taking care of endianness and flipping
-   * the image vertically. */
+  int height = rgb_frame->height;
   int linesize = rgb_frame->linesize[0];
+
   for (int y = 0; y < height; y++) {
     uint8_t *target = rgb_frame->data[0] + linesize * (height - y - 1);
     const uint8_t *src = pixels + linesize * y;
@@ -425,22 +442,165 @@ static AVFrame *generate_video_frame(FFMpegContext *context,
 #    error ENDIAN_ORDER should either be L_ENDIAN or B_ENDIAN.
 #  endif
   }
+}
 
-  /* Convert to the output pixel format, if it's different that Blender's internal one. */
-  if (context->img_convert_frame != NULL) {
-    BLI_assert(context->img_convert_ctx != NULL);
-    sws_scale(context->img_convert_ctx,
-              (const uint8_t *const *)rgb_frame->data,
+typedef struct ConvertVideoFrameData {
+  FFMpegContext *context;
+  const AVFrame *rgb_frame;
+  /* Vertical subsampling and bytes per row of each plane of the output frame. */
+  int plane_shift[AV_NUM_DATA_POINTERS];
+  int plane_bytewidth[AV_NUM_DATA_POINTERS];
+} ConvertVideoFrameData;
+
+/* Rows of the image converted for a band, including the overlap with its neighbors. */
+static void video_convert_band_rows(
+    const FFMpegContext *context, int height, int band, int *r_y_start, int *r_y_end)
+{
+  const int y = band * context->img_convert_band_height;
+  const int y_end = min_ii(y + context->img_convert_band_height, height);
+
+  if (context->img_convert_bands == 1) {
+    *r_y_start = y;
+    *r_y_end = y_end;
+  }
+  else {
+    *r_y_start = max_ii(y - FFMPEG_CONVERT_BAND_OVERLAP, 0);
+    *r_y_end = min_ii(y_end + FFMPEG_CONVERT_BAND_OVERLAP, height);
+  }
+}
+
+static void convert_video_frame_band(void *__restrict userdata,
+                                     const int band,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ConvertVideoFrameData *data = userdata;
+  FFMpegContext *context = data->context;
+  const AVFrame *rgb_frame = data->rgb_frame;
+  AVFrame *out_frame = context->current_frame;
+  AVFrame *band_frame = context->img_convert_frames[band];
+  const int y = band * context->img_convert_band_height;
+  const int height = min_ii(context->img_convert_band_height, out_frame->height - y);
+  const uint8_t *src[AV_NUM_DATA_POINTERS] = {NULL};
+  int y_start, y_end;
+
+  video_convert_band_rows(context, out_frame->height, band, &y_start, &y_end);
+  src[0] = rgb_frame->data[0] + y_start * rgb_frame->linesize[0];
+
+  if (band_frame == NULL) {
+    sws_scale(context->img_convert_ctx[band],
+              (const uint8_t *const *)src,
               rgb_frame->linesize,
               0,
-              c->height,
-              context->current_frame->data,
-              context->current_frame->linesize);
+              y_end - y_start,
+              out_frame->data,
+              out_frame->linesize);
+    return;
+  }
+
+  sws_scale(context->img_convert_ctx[band],
+            (const uint8_t *const *)src,
+            rgb_frame->linesize,
+            0,
+            y_end - y_start,
+            band_frame->data,
+            band_frame->linesize);
+
+  /* Only keep the rows of the band itself, the overlap is converted by its neighbors. */
+  for (int i = 0; i < AV_NUM_DATA_POINTERS && out_frame->data[i]; i++) {
+    const int shift = data->plane_shift[i];
+    const int plane_y = y >> shift;
+    const int plane_height = ((y + height + (1 << shift) - 1) >> shift) - plane_y;
+    const int band_y = (y - y_start) >> shift;
+
+    av_image_copy_plane(out_frame->data[i] + plane_y * out_frame->linesize[i],
+                        out_frame->linesize[i],
+                        band_frame->data[i] + band_y * band_frame->linesize[i],
+                        band_frame->linesize[i],
+                        data->plane_bytewidth[i],
+                        plane_height);
+  }
+}
+
+/* Convert to the output pixel format, if it's different that Blender's internal one. */
+static AVFrame *convert_video_frame(FFMpegContext *context, AVFrame *rgb_frame)
+{
+  if (context->img_convert_bands == 0) {
+    return rgb_frame;
+  }
+
+  const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(context->current_frame->format);
+  ConvertVideoFrameData data = {context, rgb_frame, {0}, {0}};
+
+  /* Chroma planes of YUV formats may have fewer rows. */
+  if (!(desc->flags & AV_PIX_FMT_FLAG_RGB) && desc->nb_components >= 3) {
+    data.plane_shift[desc->comp[1].plane] = desc->log2_chroma_h;
+    data.plane_shift[desc->comp[2].plane] = desc->log2_chroma_h;
+  }
+  for (int i = 0; i < AV_NUM_DATA_POINTERS && context->current_frame->data[i]; i++) {
+    data.plane_bytewidth[i] = av_image_get_linesize(
+        context->current_frame->format, context->current_frame->width, i);
   }
 
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (context->img_convert_bands > 1);
+  BLI_task_parallel_range(0, context->img_convert_bands, &data, convert_video_frame_band, &settings);
+
   return context->current_frame;
 }
 
+/* Split the image into bands converted by separate contexts, band edges and the overlap between
+ * bands have to stay aligned to chroma rows of the output pixel format. */
+static void alloc_video_convert(FFMpegContext *context, AVCodecContext *c)
+{
+  const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(c->pix_fmt);
+  const int align = 1 << desc->log2_chroma_h;
+  int num_bands = min_ii(BLI_system_thread_count(), FFMPEG_CONVERT_BANDS_MAX);
+
+  num_bands = min_ii(num_bands, c->height / FFMPEG_CONVERT_BAND_MIN_HEIGHT);
+  if (num_bands < 1 || (desc->flags & (AV_PIX_FMT_FLAG_PAL | AV_PIX_FMT_FLAG_BITSTREAM))) {
+    num_bands = 1;
+  }
+
+  int band_height = (c->height + num_bands - 1) / num_bands;
+  band_height = (band_height + align - 1) & ~(align - 1);
+  num_bands = (c->height + band_height - 1) / band_height;
+
+  context->img_convert_bands = num_bands;
+  context->img_convert_band_height = band_height;
+
+  for (int band = 0; band < num_bands; band++) {
+    int y_start, y_end;
+    video_convert_band_rows(context, c->height, band, &y_start, &y_end);
+
+    const int height = y_end - y_start;
+    if (num_bands > 1) {
+      context->img_convert_frames[band] = alloc_picture(c->pix_fmt, c->width, height);
+    }
+    context->img_convert_ctx[band] = sws_getContext(c->width,
+                                                    height,
+                                                    AV_PIX_FMT_RGBA,
+                                                    c->width,
+                                                    height,
+                                                    c->pix_fmt,
+                                                    SWS_BICUBIC,
+                                                    NULL,
+                                                    NULL,
+                                                    NULL);
+  }
+}
+
+static void free_video_convert(FFMpegContext *context)
+{
+  for (int band = 0; band < context->img_convert_bands; band++) {
+    sws_freeContext(context->img_convert_ctx[band]);
+    context->img_convert_ctx[band] = NULL;
+    delete_picture(context->img_convert_frames[band]);
+    context->img_convert_frames[band] = NULL;
+  }
+  context->img_convert_bands = 0;
+}
+
 static void set_ffmpeg_property_option(AVCodecContext *c,
                                        IDProperty *prop,
                                        AVDictionary **dictionary)
@@ -538,6 +698,30 @@ static void set_ffmpeg_properties(RenderData *rd,
 
 /* prepare a video stream for the output file */
 
+/* Use the threading the encoder supports, frame threads are preferred as they don't change
+ * the encoded bitstream. Encoders doing their own threading (x264, libvpx) pick the number
+ * of threads themselves. */
+static void ffmpeg_codec_threads_setup(AVCodecContext *c, const AVCodec *codec)
+{
+  if (codec->capabilities & AV_CODEC_CAP_AUTO_THREADS) {
+    c->thread_count = 0;
+    c->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+  }
+  else if (codec->capabilities & AV_CODEC_CAP_FRAME_THREADS) {
+    c->thread_count = BLI_system_thread_count();
+    c->thread_type = FF_THREAD_FRAME;
+  }
+  else if (codec->capabilities & AV_CODEC_CAP_SLICE_THREADS) {
+    c->thread_count = BLI_system_thread_count();
+    c->thread_type = FF_THREAD_SLICE;
+  }
+  else {
+    c->thread_count = 1;
+  }
+
+  PRINT("Encoder %s using %d threads\n", codec->name, c->thread_count);
+}
+
 static AVStream *alloc_video_stream(FFMpegContext *context,
                                     RenderData *rd,
                                     int codec_id,
@@ -563,8 +747,6 @@ static AVStream *alloc_video_stream(FFMpegContext *context,
   /* Set up the codec context */
 
   c = st->codec;
-  c->thread_count = 0;
-  c->thread_type = FF_THREAD_FRAME;
 
   c->codec_id = codec_id;
   c->codec_type = AVMEDIA_TYPE_VIDEO;
@@ -651,6 +833,8 @@ static AVStream *alloc_video_stream(FFMpegContext *context,
     return NULL;
   }
 
+  ffmpeg_codec_threads_setup(c, codec);
+
   /* Be sure to use the correct pixel format(e.g. RGB, YUV) */
 
   if (codec->pix_fmts) {
@@ -730,22 +914,11 @@ static AVStream *alloc_video_stream(FFMpegContext *context,
 
   if (c->pix_fmt == AV_PIX_FMT_RGBA) {
     /* Output pixel format is the same we use internally, no conversion necessary. */
-    context->img_convert_frame = NULL;
-    context->img_convert_ctx = NULL;
+    context->img_convert_bands = 0;
   }
   else {
-    /* Output pixel format is different, allocate frame for conversion. */
-    context->img_convert_frame = alloc_picture(AV_PIX_FMT_RGBA, c->width, c->height);
-    context->img_convert_ctx = sws_getContext(c->width,
-                                              c->height,
-                                              AV_PIX_FMT_RGBA,
-                                              c->width,
-                                              c->height,
-                                              c->pix_fmt,
-                                              SWS_BICUBIC,
-                                              NULL,
-                                              NULL,
-                                              NULL);
+    /* Output pixel format is different, allocate contexts for conversion. */
+    alloc_video_convert(context, c);
   }
 
   return st;
@@ -1339,6 +1512,11 @@ int BKE_ffmpeg_start(void *context_v,
 #    endif
   }
 #  endif
+
+  if (success && context->video_stream) {
+    ffmpeg_encode_thread_start(context);
+  }
+
   return success;
 }
 
@@ -1357,6 +1535,98 @@ static void write_audio_frames(FFMpegContext *context, double to_pts)
 }
 #  endif
 
+/* **********************************************************************
+ * * encoding thread
+ * ********************************************************************** */
+
+static void *ffmpeg_encode_thread(void *context_v)
+{
+  FFMpegContext *context = context_v;
+
+  BLI_mutex_lock(&context->encode_mutex);
+  while (true) {
+    while (context->encode_count == 0 && !context->encode_stop) {
+      BLI_condition_wait(&context->encode_cond, &context->encode_mutex);
+    }
+    /* Queued frames are still written when stopping. */
+    if (context->encode_count == 0) {
+      break;
+    }
+    FFMpegEncodeFrame *encode_frame = &context->encode_frames[context->encode_head];
+    BLI_mutex_unlock(&context->encode_mutex);
+
+    AVFrame *avframe = convert_video_frame(context, encode_frame->rgb_frame);
+    bool success = write_video_frame(context, encode_frame->pts, avframe);
+
+#  ifdef WITH_AUDASPACE
+    write_audio_frames(context, encode_frame->audio_pts);
+#  endif
+
+    bool autosplit = context->ffmpeg_autosplit &&
+                     avio_tell(context->outfile->pb) > FFMPEG_AUTOSPLIT_SIZE;
+
+    BLI_mutex_lock(&context->encode_mutex);
+    context->encode_head = (context->encode_head + 1) % FFMPEG_ENCODE_QUEUE_SIZE;
+    context->encode_count--;
+    if (!success) {
+      context->encode_error = true;
+    }
+    if (autosplit) {
+      context->encode_autosplit = true;
+    }
+    BLI_condition_notify_all(&context->encode_cond);
+  }
+  BLI_mutex_unlock(&context->encode_mutex);
+
+  return NULL;
+}
+
+static void ffmpeg_encode_thread_start(FFMpegContext *context)
+{
+  AVCodecContext *c = context->video_stream->codec;
+
+  for (int i = 0; i < FFMPEG_ENCODE_QUEUE_SIZE; i++) {
+    context->encode_frames[i].rgb_frame = alloc_picture(AV_PIX_FMT_RGBA, c->width, c->height);
+  }
+  context->encode_head = 0;
+  context->encode_count = 0;
+  context->encode_stop = false;
+  context->encode_error = false;
+  context->encode_autosplit = false;
+
+  BLI_mutex_init(&context->encode_mutex);
+  BLI_condition_init(&context->encode_cond);
+  BLI_threadpool_init(&context->encode_threads, ffmpeg_encode_thread, 1);
+  BLI_threadpool_insert(&context->encode_threads, context);
+}
+
+/* Write the queued frames and stop the encoding thread, returns true if writing any frame
+ * failed since errors were last reported. */
+static bool ffmpeg_encode_thread_end(FFMpegContext *context)
+{
+  if (BLI_listbase_is_empty(&context->encode_threads)) {
+    return false;
+  }
+
+  BLI_mutex_lock(&context->encode_mutex);
+  context->encode_stop = true;
+  BLI_condition_notify_all(&context->encode_cond);
+  BLI_mutex_unlock(&context->encode_mutex);
+
+  BLI_threadpool_end(&context->encode_threads);
+  BLI_condition_end(&context->encode_cond);
+  BLI_mutex_end(&context->encode_mutex);
+
+  for (int i = 0; i < FFMPEG_ENCODE_QUEUE_SIZE; i++) {
+    delete_picture(context->encode_frames[i].rgb_frame);
+    context->encode_frames[i].rgb_frame = NULL;
+  }
+
+  const bool encode_error = context->encode_error;
+  context->encode_error = false;
+  return encode_error;
+}
+
 int BKE_ffmpeg_append(void *context_v,
                       RenderData *rd,
                       int start_frame,
@@ -1368,7 +1638,6 @@ int BKE_ffmpeg_append(void *context_v,
                       ReportList *reports)
 {
   FFMpegContext *context = context_v;
-  AVFrame *avframe;
   int success = 1;
 
   PRINT("Writing frame %i, render width=%d, render height=%d\n", frame, rectx, recty);
@@ -1376,22 +1645,86 @@ int BKE_ffmpeg_append(void *context_v,
   /* why is this done before writing the video frame and again at end_ffmpeg? */
   //  write_audio_frames(frame / (((double)rd->frs_sec) / rd->frs_sec_base));
 
+  /* Encoding thread noticed the file got too large, continue in a new one. */
+  bool autosplit = false;
   if (context->video_stream) {
-    avframe = generate_video_frame(context, (unsigned char *)pixels, reports);
-    success = (avframe && write_video_frame(context, rd, frame - start_frame, avframe, reports));
-
-    if (context->ffmpeg_autosplit) {
-      if (avio_tell(context->outfile->pb) > FFMPEG_AUTOSPLIT_SIZE) {
-        end_ffmpeg_impl(context, true);
-        context->ffmpeg_autosplit_count++;
-        success &= start_ffmpeg_impl(context, rd, rectx, recty, suffix, reports);
+    BLI_mutex_lock(&context->encode_mutex);
+    autosplit = context->encode_autosplit;
+    BLI_mutex_unlock(&context->encode_mutex);
+  }
+
+  if (autosplit) {
+    /* Finish the current file and its encoding thread, then start both over for the next file,
+     * like BKE_ffmpeg_start() does. */
+    if (ffmpeg_encode_thread_end(context)) {
+      BKE_report(reports, RPT_ERROR, "Error writing frame");
+      success = 0;
+    }
+
+    end_ffmpeg_impl(context, true);
+    context->ffmpeg_autosplit_count++;
+
+    if (start_ffmpeg_impl(context, rd, rectx, recty, suffix, reports)) {
+      if (context->video_stream) {
+        ffmpeg_encode_thread_start(context);
       }
     }
+    else {
+      success = 0;
+    }
   }
 
+  const double audio_pts = (frame - start_frame) /
+                           (((double)rd->frs_sec) / (double)rd->frs_sec_base);
+
+  if (context->video_stream) {
+    FFMpegEncodeFrame *encode_frame;
+
+    /* Starting the file failed, there is no encoding thread to hand the frame to. */
+    if (BLI_listbase_is_empty(&context->encode_threads)) {
+      return 0;
+    }
+
+    /* Wait for a free frame, this limits how far rendering can get ahead of encoding. */
+    BLI_mutex_lock(&context->encode_mutex);
+    while (context->encode_count == FFMPEG_ENCODE_QUEUE_SIZE) {
+      BLI_condition_wait(&context->encode_cond, &context->encode_mutex);
+    }
+    encode_frame = &context->encode_frames[(context->encode_head + context->encode_count) %
+                                           FFMPEG_ENCODE_QUEUE_SIZE];
+    BLI_mutex_unlock(&context->encode_mutex);
+
+    generate_video_frame(encode_frame->rgb_frame, (const uint8_t *)pixels);
+    encode_frame->pts = frame - start_frame;
+    encode_frame->audio_pts = audio_pts;
+
+    BLI_mutex_lock(&context->encode_mutex);
+    context->encode_count++;
+    BLI_condition_notify_all(&context->encode_cond);
+
+    /* Nothing is appended after the last frame, wait for it to be written so that errors
+     * are still reported here rather than lost when the movie is closed. */
+    const int end_frame = context->ffmpeg_preview ? rd->pefra : rd->efra;
+    if (frame + max_ii(rd->frame_step, 1) > end_frame) {
+      while (context->encode_count > 0) {
+        BLI_condition_wait(&context->encode_cond, &context->encode_mutex);
+      }
+    }
+
+    /* Errors are reported for the frames encoded so far. */
+    const bool encode_error = context->encode_error;
+    context->encode_error = false;
+    BLI_mutex_unlock(&context->encode_mutex);
+
+    if (encode_error) {
+      BKE_report(reports, RPT_ERROR, "Error writing frame");
+      success = 0;
+    }
+  }
 #  ifdef WITH_AUDASPACE
-  write_audio_frames(context,
-                     (frame - start_frame) / (((double)rd->frs_sec) / (double)rd->frs_sec_base));
+  else {
+    write_audio_frames(context, audio_pts);
+  }
 #  endif
   return success;
 }
@@ -1436,10 +1769,6 @@ static void end_ffmpeg_impl(FFMpegContext *context, int is_autosplit)
     delete_picture(context->current_frame);
     context->current_frame = NULL;
   }
-  if (context->img_convert_frame != NULL) {
-    delete_picture(context->img_convert_frame);
-    context->img_convert_frame = NULL;
-  }
 
   if (context->outfile != NULL && context->outfile->oformat) {
     if (!(context->outfile->oformat->flags & AVFMT_NOFILE)) {
@@ -1466,15 +1795,15 @@ static void end_ffmpeg_impl(FFMpegContext *context, int is_autosplit)
     context->audio_deinterleave_buffer = NULL;
   }
 
-  if (context->img_convert_ctx != NULL) {
-    sws_freeContext(context->img_convert_ctx);
-    context->img_convert_ctx = NULL;
-  }
+  free_video_convert(context);
 }
 
 void BKE_ffmpeg_end(void *context_v)
 {
   FFMpegContext *context = context_v;
+
+  /* There are no reports here, errors writing the last queued frames are ignored. */
+  ffmpeg_encode_thread_end(context);
   end_ffmpeg_impl(context, false);
 }
 
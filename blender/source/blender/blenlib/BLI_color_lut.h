@@ -0,0 +1,44 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __BLI_COLOR_LUT_H__
+#define __BLI_COLOR_LUT_H__
+
+/** \file
+ * \ingroup bli
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct ColorLUT3D ColorLUT3D;
+
+/**
+ * Evaluate the exact transform in place, for \a len RGB triples.
+ */
+typedef void (*ColorLUTBakeFn)(void *userdata, float (*rgb)[3], int len);
+
+ColorLUT3D *BLI_color_lut_bake(int size, float range_max, ColorLUTBakeFn bake_fn, void *userdata);
+void BLI_color_lut_free(ColorLUT3D *lut);
+
+bool BLI_color_lut_apply_v3(const ColorLUT3D *lut, float rgb[3]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BLI_COLOR_LUT_H__ */
@@ -72,6 +72,9 @@
 #  define KDOPBVH_THREAD_LEAF_THRESHOLD 1024
 #endif
 
+/* Minimum number of branches in one level of the tree for its refit to be threaded. */
+#define KDOPBVH_THREAD_BRANCH_LEVEL_THRESHOLD 64
+
 /* -------------------------------------------------------------------- */
 /** \name Struct Definitions
  * \{ */
@@ -1031,6 +1034,14 @@ bool BLI_bvhtree_update_node(
   return true;
 }
 
+static void bvhtree_update_tree_task_cb(void *__restrict userdata,
+                                        const int j,
+                                        const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  BVHTree *tree = userdata;
+  node_join(tree, tree->nodes[tree->totleaf + j]);
+}
+
 /* call BLI_bvhtree_update_node() first for every node/point/triangle */
 void BLI_bvhtree_update_tree(BVHTree *tree)
 {
@@ -1038,11 +1049,36 @@ void BLI_bvhtree_update_tree(BVHTree *tree)
    * TRICKY: the way we build the tree all the childs have an index greater than the parent
    * This allows us todo a bottom up update by starting on the bigger numbered branch */
 
-  BVHNode **root = tree->nodes + tree->totleaf;
-  BVHNode **index = tree->nodes + tree->totleaf + tree->totbranch - 1;
+  if (tree->totleaf > KDOPBVH_THREAD_LEAF_THRESHOLD) {
+    /* The implicit tree stores branches level by level (see #non_recursive_bvh_div_nodes),
+     * branches of one level don't depend on each other so they are joined in parallel,
+     * starting from the deepest level. */
+    const int tree_offset = 2 - tree->tree_type;
+    int level_first[32];
+    int level, totlevel = 0;
+
+    for (int i = 1; i <= tree->totbranch; i = i * tree->tree_type + tree_offset) {
+      BLI_assert(totlevel < (int)ARRAY_SIZE(level_first));
+      level_first[totlevel++] = i - 1;
+    }
+
+    for (level = totlevel - 1; level >= 0; level--) {
+      const int first = level_first[level];
+      const int last = (level + 1 < totlevel) ? level_first[level + 1] : tree->totbranch;
 
-  for (; index >= root; index--) {
-    node_join(tree, *index);
+      TaskParallelSettings settings;
+      BLI_parallel_range_settings_defaults(&settings);
+      settings.use_threading = (last - first) > KDOPBVH_THREAD_BRANCH_LEVEL_THRESHOLD;
+      BLI_task_parallel_range(first, last, tree, bvhtree_update_tree_task_cb, &settings);
+    }
+  }
+  else {
+    BVHNode **root = tree->nodes + tree->totleaf;
+    BVHNode **index = tree->nodes + tree->totleaf + tree->totbranch - 1;
+
+    for (; index >= root; index--) {
+      node_join(tree, *index);
+    }
   }
 }
 /**
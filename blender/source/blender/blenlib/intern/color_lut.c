@@ -0,0 +1,205 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup bli
+ *
+ * 3D lookup table approximating a color transform that is expensive to evaluate,
+ * such as an OpenColorIO view and display transform.
+ *
+ * - Inputs go through a logarithmic shaper first, so the table has more samples
+ *   in the darks and can cover values above one.
+ * - The table is interpolated with tetrahedral interpolation, which only uses
+ *   four of the eight samples of a cell and keeps the diagonal of the cube
+ *   (neutral colors) exact.
+ * - Colors outside of the shaper range are rejected,
+ *   the caller is expected to evaluate the exact transform for those.
+ */
+
+#include <math.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_color_lut.h"
+#include "BLI_math_base.h"
+#include "BLI_utildefines.h"
+
+#include "BLI_strict_flags.h"
+
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
+/* Offset of the shaper, so zero maps to the first sample. */
+#define COLOR_LUT_SHAPER_OFFSET (1.0f / 1024.0f)
+
+struct ColorLUT3D {
+  /* Number of samples along each axis. */
+  int size;
+  float range_max;
+  /* Shaper: u = (log2(x + offset) - shaper_min) * shaper_scale. */
+  float shaper_min;
+  float shaper_scale;
+  /* size^3 samples of RGB padded to 4 floats, red varying fastest. */
+  float (*table)[4];
+};
+
+/**
+ * Create a table of \a size samples along each axis, covering colors from zero to about
+ * \a range_max. \a bake_fn is called once with all samples.
+ */
+ColorLUT3D *BLI_color_lut_bake(int size, float range_max, ColorLUTBakeFn bake_fn, void *userdata)
+{
+  BLI_assert(size >= 2 && range_max > 0.0f);
+
+  const int table_len = size * size * size;
+  ColorLUT3D *lut = MEM_callocN(sizeof(*lut), __func__);
+  lut->size = size;
+  lut->shaper_min = log2f(COLOR_LUT_SHAPER_OFFSET);
+
+  /* Display transforms commonly clip at one, put a sample exactly there so the
+   * kink isn't smoothed over. The range is adjusted to match. */
+  const float shaper_one = log2f(1.0f + COLOR_LUT_SHAPER_OFFSET) - lut->shaper_min;
+  const float shaper_max = log2f(range_max + COLOR_LUT_SHAPER_OFFSET) - lut->shaper_min;
+  const int samples_one = max_ii((int)roundf((float)(size - 1) * shaper_one / shaper_max), 1);
+  lut->shaper_scale = (float)samples_one / shaper_one;
+  lut->range_max = exp2f(lut->shaper_min + (float)(size - 1) / lut->shaper_scale) -
+                   COLOR_LUT_SHAPER_OFFSET;
+  lut->table = MEM_mallocN_aligned(sizeof(*lut->table) * (size_t)table_len, 16, __func__);
+
+  /* Inverse of the shaper at every sample. */
+  float *axis = MEM_mallocN(sizeof(*axis) * (size_t)size, __func__);
+  for (int i = 0; i < size; i++) {
+    axis[i] = exp2f(lut->shaper_min + (float)i / lut->shaper_scale) - COLOR_LUT_SHAPER_OFFSET;
+  }
+  axis[0] = 0.0f;
+
+  float(*rgb)[3] = MEM_mallocN(sizeof(*rgb) * (size_t)table_len, __func__);
+  int index = 0;
+  for (int b = 0; b < size; b++) {
+    for (int g = 0; g < size; g++) {
+      for (int r = 0; r < size; r++, index++) {
+        rgb[index][0] = axis[r];
+        rgb[index][1] = axis[g];
+        rgb[index][2] = axis[b];
+      }
+    }
+  }
+
+  bake_fn(userdata, rgb, table_len);
+
+  for (index = 0; index < table_len; index++) {
+    lut->table[index][0] = rgb[index][0];
+    lut->table[index][1] = rgb[index][1];
+    lut->table[index][2] = rgb[index][2];
+    lut->table[index][3] = 0.0f;
+  }
+
+  MEM_freeN(rgb);
+  MEM_freeN(axis);
+
+  return lut;
+}
+
+void BLI_color_lut_free(ColorLUT3D *lut)
+{
+  MEM_freeN(lut->table);
+  MEM_freeN(lut);
+}
+
+/**
+ * Transform \a rgb in place.
+ *
+ * \return false when the color is outside of the range of the table,
+ * \a rgb is left unchanged in that case.
+ */
+bool BLI_color_lut_apply_v3(const ColorLUT3D *lut, float rgb[3])
+{
+  /* Written so NaN is rejected too. */
+  if (!(rgb[0] >= 0.0f && rgb[1] >= 0.0f && rgb[2] >= 0.0f && rgb[0] <= lut->range_max &&
+        rgb[1] <= lut->range_max && rgb[2] <= lut->range_max)) {
+    return false;
+  }
+
+  const int size = lut->size;
+  int co[3];
+  float d[3];
+
+  for (int i = 0; i < 3; i++) {
+    const float u = (log2f(rgb[i] + COLOR_LUT_SHAPER_OFFSET) - lut->shaper_min) *
+                    lut->shaper_scale;
+    co[i] = min_ii(max_ii((int)u, 0), size - 2);
+    d[i] = clamp_f(u - (float)co[i], 0.0f, 1.0f);
+  }
+
+  /* Steps to the neighbor sample along each axis. */
+  const int step[3] = {1, size, size * size};
+  const int base = co[0] + co[1] * step[1] + co[2] * step[2];
+
+  /* Pick the tetrahedron containing the point, by walking the axes from the
+   * largest to the smallest fraction. */
+  int a0, a1, a2;
+  if (d[0] >= d[1]) {
+    if (d[1] >= d[2]) {
+      a0 = 0, a1 = 1, a2 = 2;
+    }
+    else if (d[0] >= d[2]) {
+      a0 = 0, a1 = 2, a2 = 1;
+    }
+    else {
+      a0 = 2, a1 = 0, a2 = 1;
+    }
+  }
+  else {
+    if (d[2] >= d[1]) {
+      a0 = 2, a1 = 1, a2 = 0;
+    }
+    else if (d[2] >= d[0]) {
+      a0 = 1, a1 = 2, a2 = 0;
+    }
+    else {
+      a0 = 1, a1 = 0, a2 = 2;
+    }
+  }
+
+  const float *c0 = lut->table[base];
+  const float *c1 = lut->table[base + step[a0]];
+  const float *c2 = lut->table[base + step[a0] + step[a1]];
+  const float *c3 = lut->table[base + step[0] + step[1] + step[2]];
+  const float w0 = 1.0f - d[a0];
+  const float w1 = d[a0] - d[a1];
+  const float w2 = d[a1] - d[a2];
+  const float w3 = d[a2];
+
+#ifdef __SSE2__
+  __m128 result = _mm_mul_ps(_mm_load_ps(c0), _mm_set1_ps(w0));
+  result = _mm_add_ps(result, _mm_mul_ps(_mm_load_ps(c1), _mm_set1_ps(w1)));
+  result = _mm_add_ps(result, _mm_mul_ps(_mm_load_ps(c2), _mm_set1_ps(w2)));
+  result = _mm_add_ps(result, _mm_mul_ps(_mm_load_ps(c3), _mm_set1_ps(w3)));
+
+  float result_v4[4];
+  _mm_storeu_ps(result_v4, result);
+  rgb[0] = result_v4[0];
+  rgb[1] = result_v4[1];
+  rgb[2] = result_v4[2];
+#else
+  for (int i = 0; i < 3; i++) {
+    rgb[i] = c0[i] * w0 + c1[i] * w1 + c2[i] * w2 + c3[i] * w3;
+  }
+#endif
+
+  return true;
+}
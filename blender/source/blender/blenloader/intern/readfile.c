@@ -4813,6 +4813,7 @@ static void direct_link_particlesystems(FileData *fd, ListBase *particles)
     psys->free_edit = NULL;
     psys->pathcache = NULL;
     psys->childcache = NULL;
+    psys->child_interp_cache = NULL;
     BLI_listbase_clear(&psys->pathcachebufs);
     BLI_listbase_clear(&psys->childcachebufs);
     psys->pdd = NULL;
@@ -7306,6 +7307,7 @@ static void direct_link_area(FileData *fd, ScrArea *area)
       }
       soops->treehash = NULL;
       soops->tree.first = soops->tree.last = NULL;
+      soops->tree_content_stamp = 0;
     }
     else if (sl->spacetype == SPACE_IMAGE) {
       SpaceImage *sima = (SpaceImage *)sl;
@@ -7698,6 +7700,7 @@ static void direct_link_windowmanager(FileData *fd, wmWindowManager *wm)
   BLI_listbase_clear(&wm->operators);
   BLI_listbase_clear(&wm->paintcursors);
   BLI_listbase_clear(&wm->queue);
+  wm->notifier_queue_set = NULL;
   BKE_reports_init(&wm->reports, RPT_STORE);
 
   BLI_listbase_clear(&wm->keyconfigs);
@@ -8128,6 +8131,8 @@ static void lib_link_workspace_layout_restore(struct IDNameLib_Map *id_map,
               so->storeflag |= SO_TREESTORE_REBUILD;
             }
           }
+          /* The tree points to the old ids, it must be rebuilt on next draw. */
+          so->tree_content_stamp = 0;
         }
         else if (sl->spacetype == SPACE_NODE) {
           SpaceNode *snode = (SpaceNode *)sl;
@@ -60,6 +60,10 @@ eEvaluationMode DEG_get_mode(const Depsgraph *graph);
 /* Get time that depsgraph is being evaluated or was last evaluated at. */
 float DEG_get_ctime(const Depsgraph *graph);
 
+/* Get a number which changes every time relations of the graph are built, which happens when
+ * objects or collections are added, removed or re-parented. Unique among all graphs. */
+uint32_t DEG_get_relations_stamp(const Depsgraph *graph);
+
 /* ********************* DEG evaluated data ******************* */
 
 /* Check if given ID type was tagged for update. */
@@ -147,8 +151,9 @@ typedef struct DEGObjectIterData {
   struct Object *dupli_parent;
   /* List of duplicated objects. */
   struct ListBase *dupli_list;
-  /* Next duplicated object to step into. */
+  /* Next duplicated object to step into, and the end of the dupli-list array. */
   struct DupliObject *dupli_object_next;
+  struct DupliObject *dupli_object_end;
   /* Corresponds to current object: current iterator object is evaluated from
    * this duplicated object. */
   struct DupliObject *dupli_object_current;
@@ -147,6 +147,9 @@ struct Depsgraph {
   /* Indicates whether relations needs to be updated. */
   bool need_update;
 
+  /* Unique among all graphs, changes every time relations are built. */
+  uint32_t relations_stamp;
+
   /* Indicates which ID types were updated. */
   char id_type_updated[MAX_LIBARRAY];
 
@@ -32,6 +32,8 @@
 #include "PIL_time.h"
 #include "PIL_time_utildefines.h"
 
+#include "atomic_ops.h"
+
 extern "C" {
 #include "DNA_cachefile_types.h"
 #include "DNA_object_types.h"
@@ -222,6 +224,8 @@ static void graph_build_finalize_common(DEG::Depsgraph *deg_graph, Main *bmain)
 #endif
   /* Relations are up to date. */
   deg_graph->need_update = false;
+  static uint32_t relations_stamp = 0;
+  deg_graph->relations_stamp = atomic_add_and_fetch_uint32(&relations_stamp, 1);
 }
 
 /* Build depsgraph for the given scene layer, and dump results in given graph container. */
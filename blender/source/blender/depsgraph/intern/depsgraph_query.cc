@@ -75,6 +75,12 @@ float DEG_get_ctime(const Depsgraph *graph)
   return deg_graph->ctime;
 }
 
+uint32_t DEG_get_relations_stamp(const Depsgraph *graph)
+{
+  const DEG::Depsgraph *deg_graph = reinterpret_cast<const DEG::Depsgraph *>(graph);
+  return deg_graph->relations_stamp;
+}
+
 bool DEG_id_type_updated(const Depsgraph *graph, short id_type)
 {
   const DEG::Depsgraph *deg_graph = reinterpret_cast<const DEG::Depsgraph *>(graph);
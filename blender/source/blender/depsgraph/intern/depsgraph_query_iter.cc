@@ -120,12 +120,10 @@ static bool deg_object_hide_original(eEvaluationMode eval_mode, Object *ob, Dupl
 bool deg_objects_dupli_iterator_next(BLI_Iterator *iter)
 {
   DEGObjectIterData *data = (DEGObjectIterData *)iter->data;
-  while (data->dupli_object_next != NULL) {
-    DupliObject *dob = data->dupli_object_next;
+  while (data->dupli_object_next != data->dupli_object_end) {
+    DupliObject *dob = data->dupli_object_next++;
     Object *obd = dob->ob;
 
-    data->dupli_object_next = data->dupli_object_next->next;
-
     if (dob->no_draw) {
       continue;
     }
@@ -223,8 +221,10 @@ void deg_iterator_objects_step(BLI_Iterator *iter, DEG::IDNode *id_node)
   if (ob_visibility & OB_VISIBLE_INSTANCES) {
     if ((data->flag & DEG_ITER_OBJECT_FLAG_DUPLI) && (object->transflag & OB_DUPLI)) {
       data->dupli_parent = object;
+      int dupli_len;
       data->dupli_list = object_duplilist(data->graph, data->scene, object);
-      data->dupli_object_next = (DupliObject *)data->dupli_list->first;
+      data->dupli_object_next = object_duplilist_array(data->dupli_list, &dupli_len);
+      data->dupli_object_end = data->dupli_object_next + dupli_len;
     }
   }
 
@@ -252,6 +252,7 @@ void DEG_iterator_objects_begin(BLI_Iterator *iter, DEGObjectIterData *data)
   data->dupli_parent = NULL;
   data->dupli_list = NULL;
   data->dupli_object_next = NULL;
+  data->dupli_object_end = NULL;
   data->dupli_object_current = NULL;
   data->scene = DEG_get_evaluated_scene(depsgraph);
   data->id_node_index = 0;
@@ -284,6 +285,7 @@ void DEG_iterator_objects_next(BLI_Iterator *iter)
         data->dupli_parent = NULL;
         data->dupli_list = NULL;
         data->dupli_object_next = NULL;
+        data->dupli_object_end = NULL;
         data->dupli_object_current = NULL;
         deg_invalidate_iterator_work_data(data);
       }
@@ -34,6 +34,7 @@
 #include "BLI_alloca.h"
 #include "BLI_edgehash.h"
 #include "BLI_task.h"
+#include "BLI_threads.h"
 #include "BLI_jitter_2d.h"
 
 #include "DNA_mesh_types.h"
@@ -2024,12 +2025,19 @@ static float loop_edge_factor_get(const float f_no[3],
   return d;
 }
 
+/* Float format used by #extract_edge_fac_finish on AMD drivers. It is initialized by the
+ * init callback, which runs under the extract init lock, not by the finish callback. */
+static GPUVertFormat extract_edge_fac_amd_format = {0};
+
 static void *extract_edge_fac_init(const MeshRenderData *mr, void *buf)
 {
   static GPUVertFormat format = {0};
   if (format.attr_len == 0) {
     GPU_vertformat_attr_add(&format, "wd", GPU_COMP_U8, 1, GPU_FETCH_INT_TO_FLOAT_UNIT);
   }
+  if (GPU_crappy_amd_driver() && extract_edge_fac_amd_format.attr_len == 0) {
+    GPU_vertformat_attr_add(&extract_edge_fac_amd_format, "wd", GPU_COMP_F32, 1, GPU_FETCH_FLOAT);
+  }
   GPUVertBuf *vbo = buf;
   GPU_vertbuf_init_with_format(vbo, &format);
   GPU_vertbuf_data_alloc(vbo, mr->loop_len + mr->loop_loose_len);
@@ -2136,16 +2144,12 @@ static void extract_edge_fac_finish(const MeshRenderData *mr, void *buf, void *_
     /* Some AMD drivers strangely crash with VBOs with a one byte format.
      * To workaround we reinit the vbo with another format and convert
      * all bytes to floats. */
-    static GPUVertFormat format = {0};
-    if (format.attr_len == 0) {
-      GPU_vertformat_attr_add(&format, "wd", GPU_COMP_F32, 1, GPU_FETCH_FLOAT);
-    }
     /* We keep the data reference in data->vbo_data. */
     vbo->data = NULL;
     GPU_vertbuf_clear(vbo);
 
     int buf_len = mr->loop_len + mr->loop_loose_len;
-    GPU_vertbuf_init_with_format(vbo, &format);
+    GPU_vertbuf_init_with_format(vbo, &extract_edge_fac_amd_format);
     GPU_vertbuf_data_alloc(vbo, buf_len);
 
     float *fdata = (float *)vbo->data;
@@ -4262,6 +4266,17 @@ static void extract_range_task_create(
   BLI_task_pool_push(task_pool, extract_run, taskdata, true, TASK_PRIORITY_HIGH);
 }
 
+/* Extract init callbacks lazily initialize static vertex formats. While the draw manager
+ * extracts several meshes at once the init step is serialized, see
+ * #DRW_mesh_batch_cache_threaded_set. */
+static ThreadMutex extract_init_lock = BLI_MUTEX_INITIALIZER;
+static bool extract_init_use_lock = false;
+
+void DRW_mesh_batch_cache_threaded_set(bool threaded)
+{
+  extract_init_use_lock = threaded;
+}
+
 static void extract_task_create(TaskPool *task_pool,
                                 const MeshRenderData *mr,
                                 const MeshExtract *extract,
@@ -4273,7 +4288,14 @@ static void extract_task_create(TaskPool *task_pool,
   taskdata->mr = mr;
   taskdata->extract = extract;
   taskdata->buf = buf;
-  taskdata->user_data = extract->init(mr, buf);
+  if (extract_init_use_lock) {
+    BLI_mutex_lock(&extract_init_lock);
+    taskdata->user_data = extract->init(mr, buf);
+    BLI_mutex_unlock(&extract_init_lock);
+  }
+  else {
+    taskdata->user_data = extract->init(mr, buf);
+  }
   taskdata->iter_type = mesh_extract_iter_type(extract);
   taskdata->task_counter = task_counter;
   taskdata->start = 0;
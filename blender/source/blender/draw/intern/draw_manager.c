@@ -23,10 +23,12 @@
 #include <stdio.h>
 
 #include "BLI_alloca.h"
+#include "BLI_linklist.h"
 #include "BLI_listbase.h"
 #include "BLI_memblock.h"
 #include "BLI_rect.h"
 #include "BLI_string.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
 #include "BLF_api.h"
@@ -761,6 +763,75 @@ void DRW_viewport_request_redraw(void)
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Batch Cache Generation
+ *
+ * Engines only request batches while populating the cache. The actual generation is
+ * delayed until all objects have been populated so that objects that do not share
+ * data can be processed in parallel. Populating itself stays serial, engines keep
+ * global state in their cache_populate callbacks.
+ * \{ */
+
+static void drw_batch_cache_generate_delayed(Object *ob)
+{
+  BLI_linklist_prepend(&DST.batch_cache_delayed, ob);
+}
+
+static void drw_batch_cache_generate_cb(void *__restrict userdata,
+                                        const int i,
+                                        const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  Object **objects = userdata;
+  drw_batch_cache_generate_requested(objects[i]);
+}
+
+static void drw_batch_cache_generate_delayed_all(void)
+{
+  if (DST.batch_cache_delayed == NULL) {
+    return;
+  }
+
+  const int objects_len = BLI_linklist_count(DST.batch_cache_delayed);
+  Object **objects = MEM_mallocN(sizeof(*objects) * objects_len, __func__);
+  int objects_parallel_len = 0;
+  LinkNode *objects_serial = NULL;
+
+  GSet *data_set = BLI_gset_ptr_new_ex(__func__, (uint)objects_len);
+  for (LinkNode *node = DST.batch_cache_delayed; node; node = node->next) {
+    Object *ob = node->link;
+    /* Objects sharing the same data also share the same batch cache, so only the first
+     * one can be processed in parallel. Only meshes are supported for now. */
+    if (ob->type == OB_MESH && BLI_gset_add(data_set, ob->data)) {
+      objects[objects_parallel_len++] = ob;
+    }
+    else {
+      BLI_linklist_prepend(&objects_serial, ob);
+    }
+  }
+  BLI_gset_free(data_set, NULL);
+  BLI_linklist_free(DST.batch_cache_delayed, NULL);
+  DST.batch_cache_delayed = NULL;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (objects_parallel_len > 1);
+  settings.scheduling_mode = TASK_SCHEDULING_DYNAMIC;
+  settings.min_iter_per_thread = 1;
+  DRW_mesh_batch_cache_threaded_set(settings.use_threading);
+  BLI_task_parallel_range(0, objects_parallel_len, objects, drw_batch_cache_generate_cb, &settings);
+  DRW_mesh_batch_cache_threaded_set(false);
+
+  /* Remaining objects in population order. */
+  for (LinkNode *node = objects_serial; node; node = node->next) {
+    drw_batch_cache_generate_requested(node->link);
+  }
+  BLI_linklist_free(objects_serial, NULL);
+
+  MEM_freeN(objects);
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Duplis
  * \{ */
@@ -807,7 +878,7 @@ static void drw_duplidata_free(void)
 {
   if (DST.dupli_ghash != NULL) {
     BLI_ghash_free(DST.dupli_ghash,
-                   (void (*)(void *key))drw_batch_cache_generate_requested,
+                   (void (*)(void *key))drw_batch_cache_generate_delayed,
                    duplidata_value_free);
     DST.dupli_ghash = NULL;
   }
@@ -1106,6 +1177,18 @@ static void drw_engines_cache_init(void)
   }
 }
 
+static void drw_engines_view_update(void)
+{
+  for (LinkData *link = DST.enabled_engines.first; link; link = link->next) {
+    DrawEngineType *engine = link->data;
+    ViewportEngineData *data = drw_viewport_engine_data_ensure(engine);
+
+    if (engine->view_update) {
+      engine->view_update(data);
+    }
+  }
+}
+
 static void drw_engines_world_update(Scene *scene)
 {
   if (scene->world == NULL) {
@@ -1154,7 +1237,7 @@ static void drw_engines_cache_populate(Object *ob)
   /* TODO: in the future it would be nice to generate once for all viewports.
    * But we need threaded DRW manager first. */
   if (!DST.dupli_source) {
-    drw_batch_cache_generate_requested(ob);
+    drw_batch_cache_generate_delayed(ob);
   }
 
   /* ... and clearing it here too because this draw data is
@@ -1164,6 +1247,8 @@ static void drw_engines_cache_populate(Object *ob)
 
 static void drw_engines_cache_finish(void)
 {
+  drw_batch_cache_generate_delayed_all();
+
   int i = 0;
   for (LinkData *link = DST.enabled_engines.first; link; link = link->next, i++) {
     DrawEngineType *engine = link->data;
@@ -1631,6 +1716,13 @@ void DRW_draw_render_loop_ex(struct Depsgraph *depsgraph,
   drw_engines_enable(view_layer, engine_type, gpencil_engine_needed);
   drw_engines_data_validate();
 
+  /* Upload textures of images loaded in the background. Engines accumulating
+   * samples have to start over when one arrived since this viewport was drawn. */
+  GPU_image_load_update();
+  if (GPU_viewport_image_load_check(viewport)) {
+    drw_engines_view_update();
+  }
+
   /* Update ubos */
   DRW_globals_update();
 
@@ -1646,6 +1738,9 @@ void DRW_draw_render_loop_ex(struct Depsgraph *depsgraph,
   /* Cache filling */
   {
     PROFILE_START(stime);
+    /* Placeholders are fine in the viewport, but one-shot offscreen renders
+     * (viewport render, thumbnails, Python offscreen drawing) need the image. */
+    GPU_set_image_load_async(!DST.options.is_image_render);
     drw_engines_cache_init();
     drw_engines_world_update(scene);
 
@@ -1668,6 +1763,7 @@ void DRW_draw_render_loop_ex(struct Depsgraph *depsgraph,
 
     drw_duplidata_free();
     drw_engines_cache_finish();
+    GPU_set_image_load_async(false);
 
     DRW_render_instance_buffer_finish();
 
@@ -1799,6 +1895,12 @@ void DRW_draw_render_loop_ex(struct Depsgraph *depsgraph,
 
   drw_viewport_cache_resize();
 
+  if (GPU_image_load_pending()) {
+    /* Finished images left over by the upload time limit, jobs that are still running
+     * redraw through the window manager once they are done. */
+    DRW_viewport_request_redraw();
+  }
+
 #ifdef DEBUG
   /* Avoid accidental reuse. */
   drw_state_ensure_not_reused(&DST);
@@ -2133,13 +2235,14 @@ void DRW_render_object_iter(
       }
       callback(vedata, ob, engine, depsgraph);
       if (!DST.dupli_source) {
-        drw_batch_cache_generate_requested(ob);
+        drw_batch_cache_generate_delayed(ob);
       }
     }
   }
   DEG_OBJECT_ITER_FOR_RENDER_ENGINE_END;
 
   drw_duplidata_free();
+  drw_batch_cache_generate_delayed_all();
 }
 
 /* Assume a valid gl context is bound (and that the gl_context_mutex has been acquired).
@@ -454,6 +454,8 @@ typedef struct DRWManager {
   struct Object *dupli_origin;
   /** Ghash containing original objects. */
   struct GHash *dupli_ghash;
+  /** Objects waiting for their batch cache to be generated. */
+  struct LinkNode *batch_cache_delayed;
   /** TODO(fclem) try to remove usage of this. */
   DRWInstanceData *object_instance_data[MAX_INSTANCE_DATA_SIZE];
   /* Array of dupli_data (one for each enabled engine) to handle duplis. */
@@ -502,6 +504,8 @@ typedef struct DRWManager {
   DRWView *view_active;
   DRWView *view_previous;
   uint primary_view_ct;
+  /** Time spent computing culling during this redraw (in ms). */
+  double culling_time;
   /** TODO(fclem) Remove this. Only here to support
    * shaders without common_view_lib.glsl */
   DRWViewUboStorage view_storage_cpy;
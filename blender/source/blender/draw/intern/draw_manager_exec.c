@@ -25,6 +25,7 @@
 #include "BLI_math.h"
 #include "BLI_math_bits.h"
 #include "BLI_memblock.h"
+#include "BLI_task.h"
 
 #include "BKE_global.h"
 
@@ -37,6 +38,10 @@
 #  include "GPU_select.h"
 #endif
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 void DRW_select_load_id(uint id)
 {
 #ifdef USE_GPU_SELECT
@@ -564,49 +569,254 @@ void DRW_culling_frustum_planes_get(const DRWView *view, float planes[6][4])
   memcpy(planes, view->frustum_planes, sizeof(float) * 6 * 4);
 }
 
-static void draw_compute_culling(DRWView *view)
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Culling Computation
+ *
+ * Culling states are processed one resource chunk at a time. Each chunk is
+ * gathered into a Structure of Arrays so the sphere tests can run on several
+ * elements at once, and all dirty views are tested in the same pass to avoid
+ * reading the culling states once per view. Chunks are processed in parallel.
+ * \{ */
+
+/* Frustum data of a single view, laid out for the batched tests. */
+typedef struct DRWCullingViewData {
+  float bsphere_center[3];
+  float bsphere_radius;
+  float planes[6][4];
+  uint32_t culling_mask;
+} DRWCullingViewData;
+
+typedef struct DRWCullingData {
+  BLI_memblock *cullstates;
+  int cullstates_len;
+  DRWCullingViewData views[MAX_CULLED_VIEWS];
+  int views_len;
+  /* Union of the culling mask of all views computed in this pass. */
+  uint32_t views_mask;
+} DRWCullingData;
+
+/* Bounding spheres of a resource chunk as Structure of Arrays.
+ * Length is padded to a multiple of 4 for the SIMD loop. */
+typedef struct DRWCullingSoA {
+  float center_x[DRW_RESOURCE_CHUNK_LEN];
+  float center_y[DRW_RESOURCE_CHUNK_LEN];
+  float center_z[DRW_RESOURCE_CHUNK_LEN];
+  float radius[DRW_RESOURCE_CHUNK_LEN];
+} DRWCullingSoA;
+
+BLI_STATIC_ASSERT((DRW_RESOURCE_CHUNK_LEN % 4) == 0, "Chunk length must be a multiple of 4")
+
+/* Same test as draw_culling_sphere_test() for 4 spheres at once.
+ * Returns a 4bit mask of the visible spheres. Negative radius bypass the test. */
+BLI_INLINE int draw_culling_sphere_test_x4(const DRWCullingViewData *vdata,
+                                           const DRWCullingSoA *soa,
+                                           const int i)
 {
-  view = view->parent ? view->parent : view;
+#ifdef __SSE2__
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 cx = _mm_loadu_ps(&soa->center_x[i]);
+  const __m128 cy = _mm_loadu_ps(&soa->center_y[i]);
+  const __m128 cz = _mm_loadu_ps(&soa->center_z[i]);
+  const __m128 rad = _mm_loadu_ps(&soa->radius[i]);
 
-  /* TODO(fclem) multithread this. */
-  /* TODO(fclem) compute all dirty views at once. */
-  if (!view->is_dirty) {
-    return;
+  /* Do a rough test first: Sphere VS Sphere intersect. */
+  const __m128 dx = _mm_sub_ps(cx, _mm_set1_ps(vdata->bsphere_center[0]));
+  const __m128 dy = _mm_sub_ps(cy, _mm_set1_ps(vdata->bsphere_center[1]));
+  const __m128 dz = _mm_sub_ps(cz, _mm_set1_ps(vdata->bsphere_center[2]));
+  const __m128 center_dist_sq = _mm_add_ps(
+      _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+  const __m128 radius_sum = _mm_add_ps(rad, _mm_set1_ps(vdata->bsphere_radius));
+  __m128 visible = _mm_cmple_ps(center_dist_sq, _mm_mul_ps(radius_sum, radius_sum));
+
+  /* Test against the 6 frustum planes. */
+  const __m128 neg_rad = _mm_sub_ps(zero, rad);
+  for (int p = 0; p < 6; p++) {
+    const float *plane = vdata->planes[p];
+    __m128 dist = _mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(plane[0])), _mm_set1_ps(plane[3]));
+    dist = _mm_add_ps(dist, _mm_mul_ps(cy, _mm_set1_ps(plane[1])));
+    dist = _mm_add_ps(dist, _mm_mul_ps(cz, _mm_set1_ps(plane[2])));
+    visible = _mm_and_ps(visible, _mm_cmpge_ps(dist, neg_rad));
+  }
+
+  /* Bypass test if radius is negative. */
+  visible = _mm_or_ps(visible, _mm_cmplt_ps(rad, zero));
+
+  return _mm_movemask_ps(visible);
+#else
+  int visible_mask = 0;
+  for (int j = 0; j < 4; j++) {
+    const BoundSphere bsphere = {
+        .center = {soa->center_x[i + j], soa->center_y[i + j], soa->center_z[i + j]},
+        .radius = soa->radius[i + j],
+    };
+    const BoundSphere frustum_bsphere = {
+        .center = {UNPACK3(vdata->bsphere_center)},
+        .radius = vdata->bsphere_radius,
+    };
+    if (draw_culling_sphere_test(&frustum_bsphere, vdata->planes, &bsphere)) {
+      visible_mask |= (1 << j);
+    }
+  }
+  return visible_mask;
+#endif
+}
+
+static void draw_compute_culling_chunk_cb(void *__restrict userdata,
+                                          const int chunk,
+                                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const DRWCullingData *data = userdata;
+  DRWCullingSoA soa;
+
+  const int elem_start = chunk * DRW_RESOURCE_CHUNK_LEN;
+  const int elem_len = min_ii(data->cullstates_len - elem_start, DRW_RESOURCE_CHUNK_LEN);
+  const int elem_len_x4 = (elem_len + 3) & ~3;
+
+  DRWCullingState *cullstates = BLI_memblock_elem_get(data->cullstates, chunk, 0);
+
+  /* Gather. */
+  for (int i = 0; i < elem_len; i++) {
+    const BoundSphere *bsphere = &cullstates[i].bsphere;
+    soa.center_x[i] = bsphere->center[0];
+    soa.center_y[i] = bsphere->center[1];
+    soa.center_z[i] = bsphere->center[2];
+    soa.radius[i] = bsphere->radius;
+  }
+  /* Padding is never written back. */
+  for (int i = elem_len; i < elem_len_x4; i++) {
+    soa.center_x[i] = soa.center_y[i] = soa.center_z[i] = 0.0f;
+    soa.radius[i] = -1.0f;
+  }
+
+  uint32_t culled_mask[DRW_RESOURCE_CHUNK_LEN];
+  memset(culled_mask, 0, sizeof(*culled_mask) * (size_t)elem_len_x4);
+
+  for (int v = 0; v < data->views_len; v++) {
+    const DRWCullingViewData *vdata = &data->views[v];
+    for (int i = 0; i < elem_len_x4; i += 4) {
+      const int visible = draw_culling_sphere_test_x4(vdata, &soa, i);
+      for (int j = 0; j < 4; j++) {
+        if ((visible & (1 << j)) == 0) {
+          culled_mask[i + j] |= vdata->culling_mask;
+        }
+      }
+    }
   }
 
+  /* Scatter. */
+  for (int i = 0; i < elem_len; i++) {
+    cullstates[i].mask = (cullstates[i].mask & ~data->views_mask) | culled_mask[i];
+  }
+}
+
+/* Views using a visibility callback are processed afterward on the calling thread
+ * because the callbacks are not required to be thread safe. */
+static void draw_compute_culling_visibility_fn(DRWView *view)
+{
   BLI_memblock_iter iter;
   BLI_memblock_iternew(DST.vmempool->cullstates, &iter);
   DRWCullingState *cull;
   while ((cull = BLI_memblock_iterstep(&iter))) {
     if (cull->bsphere.radius < 0.0) {
-      cull->mask = 0;
+      continue;
     }
-    else {
-      bool culled = !draw_culling_sphere_test(
-          &view->frustum_bsphere, view->frustum_planes, &cull->bsphere);
+    bool culled = (cull->mask & view->culling_mask) != 0;
+    culled = !view->visibility_fn(!culled, cull->user_data);
+    SET_FLAG_FROM_TEST(cull->mask, culled, view->culling_mask);
+  }
+}
 
 #ifdef DRW_DEBUG_CULLING
-      if (G.debug_value != 0) {
-        if (culled) {
-          DRW_debug_sphere(
-              cull->bsphere.center, cull->bsphere.radius, (const float[4]){1, 0, 0, 1});
-        }
-        else {
-          DRW_debug_sphere(
-              cull->bsphere.center, cull->bsphere.radius, (const float[4]){0, 1, 0, 1});
-        }
-      }
+static void draw_compute_culling_debug(DRWView *view)
+{
+  if (G.debug_value == 0) {
+    return;
+  }
+  BLI_memblock_iter iter;
+  BLI_memblock_iternew(DST.vmempool->cullstates, &iter);
+  DRWCullingState *cull;
+  while ((cull = BLI_memblock_iterstep(&iter))) {
+    if (cull->bsphere.radius < 0.0) {
+      continue;
+    }
+    if ((cull->mask & view->culling_mask) != 0) {
+      DRW_debug_sphere(cull->bsphere.center, cull->bsphere.radius, (const float[4]){1, 0, 0, 1});
+    }
+    else {
+      DRW_debug_sphere(cull->bsphere.center, cull->bsphere.radius, (const float[4]){0, 1, 0, 1});
+    }
+  }
+}
 #endif
 
-      if (view->visibility_fn) {
-        culled = !view->visibility_fn(!culled, cull->user_data);
-      }
+static void draw_compute_culling(DRWView *view)
+{
+  view = view->parent ? view->parent : view;
+
+  if (!view->is_dirty) {
+    return;
+  }
+
+  PROFILE_START(stime);
+
+  /* Compute all dirty views at once. The other views would be computed later anyway
+   * and this avoids going through all the culling states again. */
+  DRWView *dirty_views[MAX_CULLED_VIEWS];
+  int dirty_views_len = 0;
+
+  DRWCullingData data = {
+      .cullstates = DST.vmempool->cullstates,
+  };
+
+  BLI_memblock_iter iter;
+  BLI_memblock_iternew(DST.vmempool->views, &iter);
+  DRWView *dirty_view;
+  while ((dirty_view = BLI_memblock_iterstep(&iter))) {
+    if (dirty_view->parent != NULL || !dirty_view->is_dirty) {
+      continue;
+    }
+    dirty_view->is_dirty = false;
+    if (dirty_view->culling_mask == 0) {
+      continue;
+    }
+    DRWCullingViewData *vdata = &data.views[data.views_len++];
+    copy_v3_v3(vdata->bsphere_center, dirty_view->frustum_bsphere.center);
+    vdata->bsphere_radius = dirty_view->frustum_bsphere.radius;
+    memcpy(vdata->planes, dirty_view->frustum_planes, sizeof(vdata->planes));
+    vdata->culling_mask = dirty_view->culling_mask;
+    data.views_mask |= dirty_view->culling_mask;
+    dirty_views[dirty_views_len++] = dirty_view;
+  }
+  /* The active view is always part of the memblock. */
+  BLI_assert(!view->is_dirty);
+
+  BLI_memblock_iternew(DST.vmempool->cullstates, &iter);
+  data.cullstates_len = iter.end_index;
+
+  if (data.views_len > 0 && data.cullstates_len > 0) {
+    const int chunk_len = (data.cullstates_len + DRW_RESOURCE_CHUNK_LEN - 1) /
+                          DRW_RESOURCE_CHUNK_LEN;
 
-      SET_FLAG_FROM_TEST(cull->mask, culled, view->culling_mask);
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = (chunk_len > 1);
+    settings.min_iter_per_thread = 1;
+    BLI_task_parallel_range(0, chunk_len, &data, draw_compute_culling_chunk_cb, &settings);
+  }
+
+  for (int v = 0; v < dirty_views_len; v++) {
+    if (dirty_views[v]->visibility_fn) {
+      draw_compute_culling_visibility_fn(dirty_views[v]);
     }
   }
 
-  view->is_dirty = false;
+#ifdef DRW_DEBUG_CULLING
+  draw_compute_culling_debug(view);
+#endif
+
+  PROFILE_END_ACCUM(DST.culling_time, stime);
 }
 
 /** \} */
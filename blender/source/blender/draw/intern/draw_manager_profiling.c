@@ -295,6 +295,13 @@ void DRW_stats_draw(const rcti *rect)
   draw_stat_5row(rect, u++, v, col_label, sizeof(col_label));
   sprintf(time_to_txt, "%.2fms", *cache_time);
   draw_stat_5row(rect, u++, v, time_to_txt, sizeof(time_to_txt));
+  v++;
+
+  u = 0;
+  sprintf(col_label, "Culling Time");
+  draw_stat_5row(rect, u++, v, col_label, sizeof(col_label));
+  sprintf(time_to_txt, "%.2fms", DST.culling_time);
+  draw_stat_5row(rect, u++, v, time_to_txt, sizeof(time_to_txt));
   v += 2;
 
   /* ------------------------------------------ */
@@ -112,6 +112,9 @@ typedef struct RenderJob {
   ReportList *reports;
   int orig_layer;
   int last_layer;
+  /* Combined pass of the shown layer in the main render result, engine tiles are merged into it
+   * before they are displayed. Set by #render_image_update_pass_and_layer. */
+  const float *merged_rectf;
   ScrArea *sa;
   ColorManagedViewSettings view_settings;
   ColorManagedDisplaySettings display_settings;
@@ -132,6 +135,7 @@ static void image_buffer_rect_update(RenderJob *rj,
   int ymin, ymax, xmin, xmax;
   int rymin, rxmin;
   int linear_stride, linear_offset_x, linear_offset_y;
+  bool use_ibuf_buffer;
   ColorManagedViewSettings *view_settings;
   ColorManagedDisplaySettings *display_settings;
 
@@ -231,6 +235,13 @@ static void image_buffer_rect_update(RenderJob *rj,
       return;
     }
 
+    /* The image float buffer may already hold the result, either because it is the buffer
+     * engine tiles are merged into or because it is the buffer being updated. */
+    use_ibuf_buffer = (ibuf->rect_float != NULL &&
+                       (ibuf->rect_float == rj->merged_rectf ||
+                        (rectf == ibuf->rect_float && rr->rectx == ibuf->x &&
+                         rr->tilerect.xmin == 0 && rr->tilerect.ymin == 0)));
+
     rectf += 4 * (rr->rectx * ymin + xmin);
     linear_stride = rr->rectx;
     linear_offset_x = rxmin;
@@ -241,23 +252,39 @@ static void image_buffer_rect_update(RenderJob *rj,
     linear_stride = ibuf->x;
     linear_offset_x = 0;
     linear_offset_y = 0;
+    use_ibuf_buffer = true;
   }
 
   view_settings = &scene->view_settings;
   display_settings = &scene->display_settings;
 
-  IMB_partial_display_buffer_update(ibuf,
-                                    rectf,
-                                    NULL,
-                                    linear_stride,
-                                    linear_offset_x,
-                                    linear_offset_y,
-                                    view_settings,
-                                    display_settings,
-                                    rxmin,
-                                    rymin,
-                                    rxmin + xmax,
-                                    rymin + ymax);
+  /* Regions of the float buffer the image buffer displays are only marked dirty.
+   * Engines can update the same tile many times between redraws, the display
+   * buffer conversion then happens once for everything that changed, on worker
+   * threads, when the image editor acquires the display buffer for drawing. */
+  if (use_ibuf_buffer) {
+    IMB_partial_display_buffer_update_delayed_view(ibuf,
+                                                   view_settings,
+                                                   display_settings,
+                                                   rxmin,
+                                                   rymin,
+                                                   rxmin + xmax,
+                                                   rymin + ymax);
+    return;
+  }
+
+  IMB_partial_display_buffer_update_threaded(ibuf,
+                                             rectf,
+                                             NULL,
+                                             linear_stride,
+                                             linear_offset_x,
+                                             linear_offset_y,
+                                             view_settings,
+                                             display_settings,
+                                             rxmin,
+                                             rymin,
+                                             rxmin + xmax,
+                                             rymin + ymax);
 }
 
 /* ****************************** render invoking ***************** */
@@ -432,6 +459,10 @@ static void make_renderinfo_string(const RenderStats *rs,
 
   spos += sprintf(spos, TIP_("Time:%s "), info_time_str);
 
+  if (rs->output_fps > 0.0f) {
+    spos += sprintf(spos, TIP_("| Output:%.2f fps "), rs->output_fps);
+  }
+
   /* statistics */
   if (rs->statstr) {
     if (rs->statstr[0]) {
@@ -571,6 +602,8 @@ static void render_image_update_pass_and_layer(RenderJob *rj, RenderResult *rr,
     matched_sa = first_sa;
   }
 
+  rj->merged_rectf = NULL;
+
   if (matched_sa) {
     SpaceImage *sima = matched_sa->spacedata.first;
     RenderResult *main_rr = RE_AcquireResultRead(rj->re);
@@ -581,6 +614,12 @@ static void render_image_update_pass_and_layer(RenderJob *rj, RenderResult *rr,
           &main_rr->layers, (char *)rr->renlay->name, offsetof(RenderLayer, name));
       sima->iuser.layer = layer;
       rj->last_layer = layer;
+
+      RenderLayer *main_rl = BLI_findlink(&main_rr->layers, layer);
+      if (main_rl) {
+        rj->merged_rectf = RE_RenderLayerGetPass(
+            main_rl, RE_PASSNAME_COMBINED, RE_GetActiveRenderView(rj->re));
+      }
     }
 
     iuser->pass = sima->iuser.pass;
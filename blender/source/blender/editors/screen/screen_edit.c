@@ -49,6 +49,8 @@
 #include "WM_api.h"
 #include "WM_types.h"
 
+#include "IMB_imbuf.h"
+
 #include "ED_screen.h"
 #include "ED_screen_types.h"
 #include "ED_clip.h"
@@ -1451,6 +1453,11 @@ void ED_screen_animation_timer(bContext *C, int redraws, int refresh, int sync,
   if (stopscreen) {
     WM_event_remove_timer(wm, win, stopscreen->animtimer);
     stopscreen->animtimer = NULL;
+
+    if (!enable) {
+      /* Frames movies decoded ahead for playback are not needed anymore. */
+      IMB_anim_decode_ahead_release_all();
+    }
   }
 
   if (enable) {
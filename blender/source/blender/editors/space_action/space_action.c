@@ -880,6 +880,8 @@ void ED_spacetype_action(void)
   art->init = action_header_region_init;
   art->draw = action_header_region_draw;
   art->listener = action_header_region_listener;
+  art->listener_categories = NOTE_CATEGORY_FLAG(NC_ANIMATION) | NOTE_CATEGORY_FLAG(NC_ID) |
+                             NOTE_CATEGORY_FLAG(NC_SCENE) | NOTE_CATEGORY_FLAG(NC_SCREEN);
 
   BLI_addhead(&st->regiontypes, art);
 
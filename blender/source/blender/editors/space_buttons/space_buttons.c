@@ -623,6 +623,7 @@ void ED_spacetype_buttons(void)
   art->layout = buttons_main_region_layout;
   art->draw = ED_region_panels_draw;
   art->listener = buttons_main_region_listener;
+  art->listener_categories = NOTE_CATEGORY_FLAG(NC_SCREEN);
   art->keymapflag = ED_KEYMAP_UI | ED_KEYMAP_FRAMES;
 #ifndef USE_HEADER_CONTEXT_PATH
   buttons_context_register(art);
@@ -1380,6 +1380,7 @@ void ED_spacetype_clip(void)
   art->init = clip_main_region_init;
   art->draw = clip_main_region_draw;
   art->listener = clip_main_region_listener;
+  art->listener_categories = NOTE_CATEGORY_FLAG(NC_GPENCIL);
   art->keymapflag = ED_KEYMAP_GIZMO | ED_KEYMAP_FRAMES | ED_KEYMAP_UI | ED_KEYMAP_GPENCIL;
 
   BLI_addhead(&st->regiontypes, art);
@@ -1403,6 +1404,7 @@ void ED_spacetype_clip(void)
   art->init = clip_properties_region_init;
   art->draw = clip_properties_region_draw;
   art->listener = clip_properties_region_listener;
+  art->listener_categories = NOTE_CATEGORY_FLAG(NC_BRUSH) | NOTE_CATEGORY_FLAG(NC_GPENCIL);
   BLI_addhead(&st->regiontypes, art);
   ED_clip_buttons_register(art);
 
@@ -1412,6 +1414,8 @@ void ED_spacetype_clip(void)
   art->prefsizex = UI_SIDEBAR_PANEL_WIDTH;
   art->keymapflag = ED_KEYMAP_FRAMES | ED_KEYMAP_UI;
   art->listener = clip_props_region_listener;
+  art->listener_categories = NOTE_CATEGORY_FLAG(NC_GPENCIL) | NOTE_CATEGORY_FLAG(NC_SCENE) |
+                             NOTE_CATEGORY_FLAG(NC_SPACE) | NOTE_CATEGORY_FLAG(NC_WM);
   art->init = clip_tools_region_init;
   art->draw = clip_tools_region_draw;
 
@@ -1426,6 +1430,7 @@ void ED_spacetype_clip(void)
   art->init = clip_header_region_init;
   art->draw = clip_header_region_draw;
   art->listener = clip_header_region_listener;
+  art->listener_categories = NOTE_CATEGORY_FLAG(NC_SCENE);
 
   BLI_addhead(&st->regiontypes, art);
 
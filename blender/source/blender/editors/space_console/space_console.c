@@ -330,6 +330,7 @@ void ED_spacetype_console(void)
   art->draw = console_main_region_draw;
   art->cursor = console_cursor;
   art->listener = console_main_region_listener;
+  art->listener_categories = NOTE_CATEGORY_FLAG(NC_SPACE);
 
   BLI_addhead(&st->regiontypes, art);
 
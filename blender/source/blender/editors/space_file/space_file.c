@@ -719,6 +719,7 @@ void ED_spacetype_file(void)
   art->init = file_main_region_init;
   art->draw = file_main_region_draw;
   art->listener = file_main_region_listener;
+  art->listener_categories = NOTE_CATEGORY_FLAG(NC_SPACE);
   art->message_subscribe = file_main_region_message_subscribe;
   art->keymapflag = ED_KEYMAP_UI | ED_KEYMAP_VIEW2D;
   BLI_addhead(&st->regiontypes, art);
@@ -738,6 +739,7 @@ void ED_spacetype_file(void)
   art->regionid = RGN_TYPE_UI;
   art->keymapflag = ED_KEYMAP_UI;
   art->listener = file_ui_region_listener;
+  art->listener_categories = NOTE_CATEGORY_FLAG(NC_SPACE);
   art->init = file_ui_region_init;
   art->draw = file_ui_region_draw;
   BLI_addhead(&st->regiontypes, art);
@@ -747,6 +749,7 @@ void ED_spacetype_file(void)
   art->regionid = RGN_TYPE_EXECUTE;
   art->keymapflag = ED_KEYMAP_UI;
   art->listener = file_ui_region_listener;
+  art->listener_categories = NOTE_CATEGORY_FLAG(NC_SPACE);
   art->init = file_execution_region_init;
   art->draw = file_execution_region_draw;
   BLI_addhead(&st->regiontypes, art);
@@ -2930,7 +2930,7 @@ static int image_scale_exec(bContext *C, wmOperator *op)
   ED_image_undo_push_begin_with_image(op->type->name, ima, ibuf);
 
   ibuf->userflags |= IB_DISPLAY_BUFFER_INVALID;
-  IMB_scaleImBuf(ibuf, size[0], size[1]);
+  IMB_scaleImBuf_filter(ibuf, size[0], size[1], RNA_enum_get(op->ptr, "filter"));
   BKE_image_release_ibuf(ima, ibuf, NULL);
 
   ED_image_undo_push_end();
@@ -2958,6 +2958,12 @@ void IMAGE_OT_resize(wmOperatorType *ot)
 
   /* properties */
   RNA_def_int_vector(ot->srna, "size", 2, NULL, 1, INT_MAX, "Size", "", 1, SHRT_MAX);
+  RNA_def_enum(ot->srna,
+               "filter",
+               rna_enum_image_scale_filter_items,
+               IMB_SCALE_FILTER_BOX,
+               "Filter",
+               "Filter used to compute the new pixels");
 
   /* flags */
   ot->flag = OPTYPE_REGISTER;
@@ -1051,6 +1051,9 @@ void ED_spacetype_image(void)
   art->init = image_main_region_init;
   art->draw = image_main_region_draw;
   art->listener = image_main_region_listener;
+  art->listener_categories = NOTE_CATEGORY_FLAG(NC_GEOM) | NOTE_CATEGORY_FLAG(NC_GPENCIL) |
+                             NOTE_CATEGORY_FLAG(NC_IMAGE) | NOTE_CATEGORY_FLAG(NC_MATERIAL) |
+                             NOTE_CATEGORY_FLAG(NC_SCREEN);
   BLI_addhead(&st->regiontypes, art);
 
   /* regions: listview/buttons/scopes */
@@ -1059,6 +1062,10 @@ void ED_spacetype_image(void)
   art->prefsizex = UI_SIDEBAR_PANEL_WIDTH;
   art->keymapflag = ED_KEYMAP_UI | ED_KEYMAP_FRAMES;
   art->listener = image_buttons_region_listener;
+  art->listener_categories = NOTE_CATEGORY_FLAG(NC_BRUSH) | NOTE_CATEGORY_FLAG(NC_GPENCIL) |
+                             NOTE_CATEGORY_FLAG(NC_IMAGE) | NOTE_CATEGORY_FLAG(NC_MATERIAL) |
+                             NOTE_CATEGORY_FLAG(NC_NODE) | NOTE_CATEGORY_FLAG(NC_SCENE) |
+                             NOTE_CATEGORY_FLAG(NC_TEXTURE);
   art->message_subscribe = ED_area_do_mgs_subscribe_for_tool_ui;
   art->init = image_buttons_region_init;
   art->layout = image_buttons_region_layout;
@@ -1075,6 +1082,9 @@ void ED_spacetype_image(void)
   art->prefsizey = 50; /* XXX */
   art->keymapflag = ED_KEYMAP_UI | ED_KEYMAP_FRAMES;
   art->listener = image_tools_region_listener;
+  art->listener_categories = NOTE_CATEGORY_FLAG(NC_BRUSH) | NOTE_CATEGORY_FLAG(NC_GPENCIL) |
+                             NOTE_CATEGORY_FLAG(NC_IMAGE) | NOTE_CATEGORY_FLAG(NC_NODE) |
+                             NOTE_CATEGORY_FLAG(NC_SCENE);
   art->message_subscribe = ED_region_generic_tools_region_message_subscribe;
   art->snap_size = ED_region_generic_tools_region_snap_size;
   art->init = image_tools_region_init;
@@ -1087,6 +1097,8 @@ void ED_spacetype_image(void)
   art->prefsizey = HEADERY;
   art->keymapflag = ED_KEYMAP_UI | ED_KEYMAP_VIEW2D | ED_KEYMAP_FRAMES | ED_KEYMAP_HEADER;
   art->listener = image_header_region_listener;
+  art->listener_categories = NOTE_CATEGORY_FLAG(NC_BRUSH) | NOTE_CATEGORY_FLAG(NC_GEOM) |
+                             NOTE_CATEGORY_FLAG(NC_SCENE);
   art->init = image_header_region_init;
   art->draw = image_header_region_draw;
   art->message_subscribe = ED_area_do_mgs_subscribe_for_tool_header;
@@ -1098,6 +1110,8 @@ void ED_spacetype_image(void)
   art->prefsizey = HEADERY;
   art->keymapflag = ED_KEYMAP_UI | ED_KEYMAP_VIEW2D | ED_KEYMAP_FRAMES | ED_KEYMAP_HEADER;
   art->listener = image_header_region_listener;
+  art->listener_categories = NOTE_CATEGORY_FLAG(NC_BRUSH) | NOTE_CATEGORY_FLAG(NC_GEOM) |
+                             NOTE_CATEGORY_FLAG(NC_SCENE);
   art->init = image_header_region_init;
   art->draw = image_header_region_draw;
 
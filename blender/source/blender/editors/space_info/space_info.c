@@ -304,6 +304,7 @@ void ED_spacetype_info(void)
   art->init = info_main_region_init;
   art->draw = info_main_region_draw;
   art->listener = info_main_region_listener;
+  art->listener_categories = NOTE_CATEGORY_FLAG(NC_SPACE);
 
   BLI_addhead(&st->regiontypes, art);
 
@@ -314,6 +315,9 @@ void ED_spacetype_info(void)
 
   art->keymapflag = ED_KEYMAP_UI | ED_KEYMAP_VIEW2D | ED_KEYMAP_FRAMES | ED_KEYMAP_HEADER;
   art->listener = info_header_listener;
+  art->listener_categories = NOTE_CATEGORY_FLAG(NC_ID) | NOTE_CATEGORY_FLAG(NC_SCENE) |
+                             NOTE_CATEGORY_FLAG(NC_SCREEN) | NOTE_CATEGORY_FLAG(NC_SPACE) |
+                             NOTE_CATEGORY_FLAG(NC_WM);
   art->message_subscribe = info_header_region_message_subscribe;
   art->init = info_header_region_init;
   art->draw = info_header_region_draw;
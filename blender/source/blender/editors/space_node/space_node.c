@@ -979,6 +979,12 @@ void ED_spacetype_node(void)
   art->keymapflag = ED_KEYMAP_UI | ED_KEYMAP_GIZMO | ED_KEYMAP_TOOL | ED_KEYMAP_VIEW2D |
                     ED_KEYMAP_FRAMES | ED_KEYMAP_GPENCIL;
   art->listener = node_region_listener;
+  art->listener_categories = NOTE_CATEGORY_FLAG(NC_GPENCIL) | NOTE_CATEGORY_FLAG(NC_ID) |
+                             NOTE_CATEGORY_FLAG(NC_LINESTYLE) | NOTE_CATEGORY_FLAG(NC_MATERIAL) |
+                             NOTE_CATEGORY_FLAG(NC_NODE) | NOTE_CATEGORY_FLAG(NC_OBJECT) |
+                             NOTE_CATEGORY_FLAG(NC_SCENE) | NOTE_CATEGORY_FLAG(NC_SCREEN) |
+                             NOTE_CATEGORY_FLAG(NC_SPACE) | NOTE_CATEGORY_FLAG(NC_TEXTURE) |
+                             NOTE_CATEGORY_FLAG(NC_WM) | NOTE_CATEGORY_FLAG(NC_WORLD);
   art->cursor = node_cursor;
   art->event_cursor = true;
 
@@ -990,6 +996,12 @@ void ED_spacetype_node(void)
   art->prefsizey = HEADERY;
   art->keymapflag = ED_KEYMAP_UI | ED_KEYMAP_VIEW2D | ED_KEYMAP_FRAMES | ED_KEYMAP_HEADER;
   art->listener = node_region_listener;
+  art->listener_categories = NOTE_CATEGORY_FLAG(NC_GPENCIL) | NOTE_CATEGORY_FLAG(NC_ID) |
+                             NOTE_CATEGORY_FLAG(NC_LINESTYLE) | NOTE_CATEGORY_FLAG(NC_MATERIAL) |
+                             NOTE_CATEGORY_FLAG(NC_NODE) | NOTE_CATEGORY_FLAG(NC_OBJECT) |
+                             NOTE_CATEGORY_FLAG(NC_SCENE) | NOTE_CATEGORY_FLAG(NC_SCREEN) |
+                             NOTE_CATEGORY_FLAG(NC_SPACE) | NOTE_CATEGORY_FLAG(NC_TEXTURE) |
+                             NOTE_CATEGORY_FLAG(NC_WM) | NOTE_CATEGORY_FLAG(NC_WORLD);
   art->init = node_header_region_init;
   art->draw = node_header_region_draw;
 
@@ -1001,6 +1013,12 @@ void ED_spacetype_node(void)
   art->prefsizex = UI_SIDEBAR_PANEL_WIDTH;
   art->keymapflag = ED_KEYMAP_UI | ED_KEYMAP_FRAMES;
   art->listener = node_region_listener;
+  art->listener_categories = NOTE_CATEGORY_FLAG(NC_GPENCIL) | NOTE_CATEGORY_FLAG(NC_ID) |
+                             NOTE_CATEGORY_FLAG(NC_LINESTYLE) | NOTE_CATEGORY_FLAG(NC_MATERIAL) |
+                             NOTE_CATEGORY_FLAG(NC_NODE) | NOTE_CATEGORY_FLAG(NC_OBJECT) |
+                             NOTE_CATEGORY_FLAG(NC_SCENE) | NOTE_CATEGORY_FLAG(NC_SCREEN) |
+                             NOTE_CATEGORY_FLAG(NC_SPACE) | NOTE_CATEGORY_FLAG(NC_TEXTURE) |
+                             NOTE_CATEGORY_FLAG(NC_WM) | NOTE_CATEGORY_FLAG(NC_WORLD);
   art->message_subscribe = ED_area_do_mgs_subscribe_for_tool_ui;
   art->init = node_buttons_region_init;
   art->draw = node_buttons_region_draw;
@@ -1015,6 +1033,12 @@ void ED_spacetype_node(void)
   art->prefsizey = 50; /* XXX */
   art->keymapflag = ED_KEYMAP_UI | ED_KEYMAP_FRAMES;
   art->listener = node_region_listener;
+  art->listener_categories = NOTE_CATEGORY_FLAG(NC_GPENCIL) | NOTE_CATEGORY_FLAG(NC_ID) |
+                             NOTE_CATEGORY_FLAG(NC_LINESTYLE) | NOTE_CATEGORY_FLAG(NC_MATERIAL) |
+                             NOTE_CATEGORY_FLAG(NC_NODE) | NOTE_CATEGORY_FLAG(NC_OBJECT) |
+                             NOTE_CATEGORY_FLAG(NC_SCENE) | NOTE_CATEGORY_FLAG(NC_SCREEN) |
+                             NOTE_CATEGORY_FLAG(NC_SPACE) | NOTE_CATEGORY_FLAG(NC_TEXTURE) |
+                             NOTE_CATEGORY_FLAG(NC_WM) | NOTE_CATEGORY_FLAG(NC_WORLD);
   art->message_subscribe = ED_region_generic_tools_region_message_subscribe;
   art->snap_size = ED_region_generic_tools_region_snap_size;
   art->init = node_toolbar_region_init;
@@ -154,6 +154,29 @@ void outliner_item_openclose(TreeElement *te, bool open, bool toggle_all)
 
   if (toggle_all) {
     outliner_flag_set(&te->subtree, TSE_CLOSED, !open);
+
+    /* Children that are only built once their parent is open (see #TE_LAZY_CLOSED). */
+    if (open) {
+      tselem->flag |= TSE_OPEN_SUBTREE;
+    }
+    else {
+      tselem->flag &= ~TSE_OPEN_SUBTREE;
+    }
+  }
+}
+
+/* Children of closed elements may not have been built (see #TE_LAZY_CLOSED),
+ * only rebuild the tree when opening needs them, otherwise redraw what is there.
+ * Search filtering depends on the open state, so always rebuild while searching. */
+static void outliner_item_openclose_tag_redraw(
+    SpaceOutliner *soops, ARegion *ar, TreeElement *te, bool open, bool toggle_all)
+{
+  if (soops->search_string[0] != '\0' ||
+      (open && (toggle_all || (te->flag & TE_LAZY_CLOSED)))) {
+    ED_region_tag_redraw(ar);
+  }
+  else {
+    ED_region_tag_redraw_no_rebuild(ar);
   }
 }
 
@@ -182,7 +205,7 @@ static int outliner_item_openclose_modal(bContext *C, wmOperator *op, const wmEv
       /* Only toggle openclose on the same level as the first clicked element */
       if (te->xs == data->x_location) {
         outliner_item_openclose(te, data->open, false);
-        ED_region_tag_redraw(ar);
+        outliner_item_openclose_tag_redraw(soops, ar, te, data->open, false);
       }
     }
 
@@ -221,7 +244,7 @@ static int outliner_item_openclose_invoke(bContext *C, wmOperator *op, const wmE
                       (toggle_all && (outliner_flag_is_any_test(&te->subtree, TSE_CLOSED, 1)));
 
     outliner_item_openclose(te, open, toggle_all);
-    ED_region_tag_redraw(ar);
+    outliner_item_openclose_tag_redraw(soops, ar, te, open, toggle_all);
 
     /* Only toggle once for single click toggling */
     if (event->type == LEFTMOUSE) {
@@ -1227,8 +1250,9 @@ void outliner_set_coordinates(ARegion *ar, SpaceOutliner *soops)
   }
 }
 
-/* return 1 when levels were opened */
-static int outliner_open_back(TreeElement *te)
+/* return 1 when levels were opened, r_rebuild is set when an opened level
+ * didn't build its children (see #TE_LAZY_CLOSED) */
+static int outliner_open_back(TreeElement *te, bool *r_rebuild)
 {
   TreeStoreElem *tselem;
   int retval = 0;
@@ -1238,6 +1262,9 @@ static int outliner_open_back(TreeElement *te)
     if (tselem->flag & TSE_CLOSED) {
       tselem->flag &= ~TSE_CLOSED;
       retval = 1;
+      if (te->flag & TE_LAZY_CLOSED) {
+        *r_rebuild = true;
+      }
     }
   }
   return retval;
@@ -1279,18 +1306,19 @@ static TreeElement *outliner_show_active_get_element(bContext *C,
   return te;
 }
 
-static void outliner_show_active(SpaceOutliner *so, ARegion *ar, TreeElement *te, ID *id)
+static void outliner_show_active(
+    SpaceOutliner *so, ARegion *ar, TreeElement *te, ID *id, bool *r_rebuild)
 {
   /* open up tree to active object/bone */
   if (TREESTORE(te)->id == id) {
-    if (outliner_open_back(te)) {
+    if (outliner_open_back(te, r_rebuild)) {
       outliner_set_coordinates(ar, so);
     }
     return;
   }
 
   for (TreeElement *ten = te->subtree.first; ten; ten = ten->next) {
-    outliner_show_active(so, ar, ten, id);
+    outliner_show_active(so, ar, ten, id, r_rebuild);
   }
 }
 
@@ -1302,13 +1330,14 @@ static int outliner_show_active_exec(bContext *C, wmOperator *UNUSED(op))
   View2D *v2d = &ar->v2d;
 
   TreeElement *active_element = outliner_show_active_get_element(C, so, view_layer);
+  bool rebuild = false;
 
   if (active_element) {
     ID *id = TREESTORE(active_element)->id;
 
     /* Expand all elements in the outliner with matching ID */
     for (TreeElement *te = so->tree.first; te; te = te->next) {
-      outliner_show_active(so, ar, te, id);
+      outliner_show_active(so, ar, te, id, &rebuild);
     }
 
     /* Center view on first element found */
@@ -1322,7 +1351,13 @@ static int outliner_show_active_exec(bContext *C, wmOperator *UNUSED(op))
     return OPERATOR_CANCELLED;
   }
 
-  ED_region_tag_redraw_no_rebuild(ar);
+  /* Opened elements may need children that were never built. */
+  if (rebuild) {
+    ED_region_tag_redraw(ar);
+  }
+  else {
+    ED_region_tag_redraw_no_rebuild(ar);
+  }
 
   return OPERATOR_FINISHED;
 }
@@ -1458,7 +1493,8 @@ static void outliner_find_panel(
     tselem = TREESTORE(te);
     if (tselem) {
       /* expand branches so that it will be visible, we need to get correct coordinates */
-      if (outliner_open_back(soops, te)) {
+      bool rebuild = false;
+      if (outliner_open_back(te, &rebuild)) {
         outliner_set_coordinates(ar, soops);
       }
 
@@ -1486,7 +1522,12 @@ static void outliner_find_panel(
       soops->search_flags = flags;
 
       /* redraw */
-      ED_region_tag_redraw_no_rebuild(ar);
+      if (rebuild) {
+        ED_region_tag_redraw(ar);
+      }
+      else {
+        ED_region_tag_redraw_no_rebuild(ar);
+      }
     }
   }
   else {
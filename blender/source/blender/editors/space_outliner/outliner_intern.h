@@ -141,6 +141,8 @@ enum {
   /* Child elements of the same type in the icon-row are drawn merged as one icon.
    * This flag is set for an element that is part of these merged child icons. */
   TE_ICONROW_MERGED = (1 << 7),
+  /* Descendants of the element are opened as they are added, see #TSE_OPEN_SUBTREE. */
+  TE_OPEN_SUBTREE = (1 << 8),
 };
 
 /* button events */
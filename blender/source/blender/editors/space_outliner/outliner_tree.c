@@ -52,6 +52,7 @@
 #include "BLI_utildefines.h"
 #include "BLI_mempool.h"
 #include "BLI_fnmatch.h"
+#include "BLI_ghash.h"
 
 #include "BLT_translation.h"
 
@@ -62,10 +63,12 @@
 #include "BKE_main.h"
 #include "BKE_modifier.h"
 #include "BKE_outliner_treehash.h"
+#include "BKE_scene.h"
 #include "BKE_sequencer.h"
 
 #include "DEG_depsgraph.h"
 #include "DEG_depsgraph_build.h"
+#include "DEG_depsgraph_query.h"
 
 #include "ED_armature.h"
 #include "ED_screen.h"
@@ -229,6 +232,17 @@ void outliner_free_tree_element(TreeElement *element, ListBase *parent_subtree)
 static TreeElement *outliner_add_element(
     SpaceOutliner *soops, ListBase *lb, void *idv, TreeElement *parent, short type, short index);
 
+/* First closed element from \a parent up, NULL if elements added to \a parent are drawn. */
+static TreeElement *outliner_closed_ancestor(SpaceOutliner *soops, TreeElement *parent)
+{
+  for (TreeElement *te = parent; te; te = te->parent) {
+    if (!TSELEM_OPEN(TREESTORE(te), soops)) {
+      return te;
+    }
+  }
+  return NULL;
+}
+
 /* -------------------------------------------------------- */
 
 /* special handling of hierarchical non-lib data */
@@ -371,24 +385,31 @@ static void outliner_add_object_contents(SpaceOutliner *soops,
           // char *str;
 
           tenla1->name = IFACE_("Constraints");
-          for (con = pchan->constraints.first; con; con = con->next, const_index++) {
-            ten1 = outliner_add_element(
-                soops, &tenla1->subtree, ob, tenla1, TSE_CONSTRAINT, const_index);
+          if (TSELEM_OPEN(TREESTORE(tenla1), soops)) {
+            for (con = pchan->constraints.first; con; con = con->next, const_index++) {
+              ten1 = outliner_add_element(
+                  soops, &tenla1->subtree, ob, tenla1, TSE_CONSTRAINT, const_index);
 #if 0 /* disabled as it needs to be reworked for recoded constraints system */
-            target = get_constraint_target(con, &str);
-            if (str && str[0]) {
-              ten1->name = str;
-            }
-            else if (target) {
-              ten1->name = target->id.name + 2;
-            }
-            else {
+              target = get_constraint_target(con, &str);
+              if (str && str[0]) {
+                ten1->name = str;
+              }
+              else if (target) {
+                ten1->name = target->id.name + 2;
+              }
+              else {
+                ten1->name = con->name;
+              }
+#endif
               ten1->name = con->name;
+              ten1->directdata = con;
+              /* possible add all other types links? */
             }
-#endif
-            ten1->name = con->name;
-            ten1->directdata = con;
-            /* possible add all other types links? */
+          }
+          else {
+            /* built on demand, keep the unique ids stable for the bones that follow */
+            tenla1->flag |= TE_LAZY_CLOSED;
+            const_index += BLI_listbase_count(&pchan->constraints);
           }
         }
       }
@@ -418,11 +439,17 @@ static void outliner_add_object_contents(SpaceOutliner *soops,
       int a = 0;
 
       ten_bonegrp->name = IFACE_("Bone Groups");
-      for (agrp = ob->pose->agroups.first; agrp; agrp = agrp->next, a++) {
-        TreeElement *ten;
-        ten = outliner_add_element(soops, &ten_bonegrp->subtree, ob, ten_bonegrp, TSE_POSEGRP, a);
-        ten->name = agrp->name;
-        ten->directdata = agrp;
+      if (TSELEM_OPEN(TREESTORE(ten_bonegrp), soops)) {
+        for (agrp = ob->pose->agroups.first; agrp; agrp = agrp->next, a++) {
+          TreeElement *ten;
+          ten = outliner_add_element(
+              soops, &ten_bonegrp->subtree, ob, ten_bonegrp, TSE_POSEGRP, a);
+          ten->name = agrp->name;
+          ten->directdata = agrp;
+        }
+      }
+      else {
+        ten_bonegrp->flag |= TE_LAZY_CLOSED;
       }
     }
   }
@@ -440,23 +467,28 @@ static void outliner_add_object_contents(SpaceOutliner *soops,
     int a;
 
     tenla->name = IFACE_("Constraints");
-    for (con = ob->constraints.first, a = 0; con; con = con->next, a++) {
-      ten = outliner_add_element(soops, &tenla->subtree, ob, tenla, TSE_CONSTRAINT, a);
+    if (TSELEM_OPEN(TREESTORE(tenla), soops)) {
+      for (con = ob->constraints.first, a = 0; con; con = con->next, a++) {
+        ten = outliner_add_element(soops, &tenla->subtree, ob, tenla, TSE_CONSTRAINT, a);
 #if 0 /* disabled due to constraints system targets recode... code here needs review */
-      target = get_constraint_target(con, &str);
-      if (str && str[0]) {
-        ten->name = str;
-      }
-      else if (target) {
-        ten->name = target->id.name + 2;
-      }
-      else {
+        target = get_constraint_target(con, &str);
+        if (str && str[0]) {
+          ten->name = str;
+        }
+        else if (target) {
+          ten->name = target->id.name + 2;
+        }
+        else {
+          ten->name = con->name;
+        }
+#endif
         ten->name = con->name;
+        ten->directdata = con;
+        /* possible add all other types links? */
       }
-#endif
-      ten->name = con->name;
-      ten->directdata = con;
-      /* possible add all other types links? */
+    }
+    else {
+      tenla->flag |= TE_LAZY_CLOSED;
     }
   }
 
@@ -466,37 +498,42 @@ static void outliner_add_object_contents(SpaceOutliner *soops,
     int index;
 
     ten_mod->name = IFACE_("Modifiers");
-    for (index = 0, md = ob->modifiers.first; md; index++, md = md->next) {
-      TreeElement *ten = outliner_add_element(
-          soops, &ten_mod->subtree, ob, ten_mod, TSE_MODIFIER, index);
-      ten->name = md->name;
-      ten->directdata = md;
-
-      if (md->type == eModifierType_Lattice) {
-        outliner_add_element(
-            soops, &ten->subtree, ((LatticeModifierData *)md)->object, ten, TSE_LINKED_OB, 0);
-      }
-      else if (md->type == eModifierType_Curve) {
-        outliner_add_element(
-            soops, &ten->subtree, ((CurveModifierData *)md)->object, ten, TSE_LINKED_OB, 0);
-      }
-      else if (md->type == eModifierType_Armature) {
-        outliner_add_element(
-            soops, &ten->subtree, ((ArmatureModifierData *)md)->object, ten, TSE_LINKED_OB, 0);
-      }
-      else if (md->type == eModifierType_Hook) {
-        outliner_add_element(
-            soops, &ten->subtree, ((HookModifierData *)md)->object, ten, TSE_LINKED_OB, 0);
-      }
-      else if (md->type == eModifierType_ParticleSystem) {
-        ParticleSystem *psys = ((ParticleSystemModifierData *)md)->psys;
-        TreeElement *ten_psys;
+    if (TSELEM_OPEN(TREESTORE(ten_mod), soops)) {
+      for (index = 0, md = ob->modifiers.first; md; index++, md = md->next) {
+        TreeElement *ten = outliner_add_element(
+            soops, &ten_mod->subtree, ob, ten_mod, TSE_MODIFIER, index);
+        ten->name = md->name;
+        ten->directdata = md;
+
+        if (md->type == eModifierType_Lattice) {
+          outliner_add_element(
+              soops, &ten->subtree, ((LatticeModifierData *)md)->object, ten, TSE_LINKED_OB, 0);
+        }
+        else if (md->type == eModifierType_Curve) {
+          outliner_add_element(
+              soops, &ten->subtree, ((CurveModifierData *)md)->object, ten, TSE_LINKED_OB, 0);
+        }
+        else if (md->type == eModifierType_Armature) {
+          outliner_add_element(
+              soops, &ten->subtree, ((ArmatureModifierData *)md)->object, ten, TSE_LINKED_OB, 0);
+        }
+        else if (md->type == eModifierType_Hook) {
+          outliner_add_element(
+              soops, &ten->subtree, ((HookModifierData *)md)->object, ten, TSE_LINKED_OB, 0);
+        }
+        else if (md->type == eModifierType_ParticleSystem) {
+          ParticleSystem *psys = ((ParticleSystemModifierData *)md)->psys;
+          TreeElement *ten_psys;
 
-        ten_psys = outliner_add_element(soops, &ten->subtree, ob, te, TSE_LINKED_PSYS, 0);
-        ten_psys->directdata = psys;
-        ten_psys->name = psys->part->id.name + 2;
+          ten_psys = outliner_add_element(soops, &ten->subtree, ob, te, TSE_LINKED_PSYS, 0);
+          ten_psys->directdata = psys;
+          ten_psys->name = psys->part->id.name + 2;
+        }
       }
     }
+    else {
+      ten_mod->flag |= TE_LAZY_CLOSED;
+    }
   }
 
   /* vertex groups */
@@ -507,10 +544,15 @@ static void outliner_add_object_contents(SpaceOutliner *soops,
     int a;
 
     tenla->name = IFACE_("Vertex Groups");
-    for (defgroup = ob->defbase.first, a = 0; defgroup; defgroup = defgroup->next, a++) {
-      ten = outliner_add_element(soops, &tenla->subtree, ob, tenla, TSE_DEFGROUP, a);
-      ten->name = defgroup->name;
-      ten->directdata = defgroup;
+    if (TSELEM_OPEN(TREESTORE(tenla), soops)) {
+      for (defgroup = ob->defbase.first, a = 0; defgroup; defgroup = defgroup->next, a++) {
+        ten = outliner_add_element(soops, &tenla->subtree, ob, tenla, TSE_DEFGROUP, a);
+        ten->name = defgroup->name;
+        ten->directdata = defgroup;
+      }
+    }
+    else {
+      tenla->flag |= TE_LAZY_CLOSED;
     }
   }
 
@@ -542,7 +584,16 @@ static void outliner_add_id_contents(SpaceOutliner *soops,
       break;
     }
     case ID_OB: {
-      outliner_add_object_contents(soops, te, tselem, (Object *)id);
+      /* Contents of objects below a closed element are not drawn, not even in the icon row of
+       * that element, so only build them once it is opened. Objects in edit and pose mode stay
+       * complete, Show Active looks up their bones in the tree. */
+      TreeElement *te_closed = outliner_closed_ancestor(soops, te->parent);
+      if (te_closed && ((Object *)id)->mode == OB_MODE_OBJECT) {
+        te_closed->flag |= TE_LAZY_CLOSED;
+      }
+      else {
+        outliner_add_object_contents(soops, te, tselem, (Object *)id);
+      }
       break;
     }
     case ID_ME: {
@@ -801,6 +852,16 @@ static TreeElement *outliner_add_element(
     tselem->flag |= TSE_CHILDSEARCH;
   }
 
+  /* Toggling all children open also opens the ones only built by this rebuild. */
+  if (tselem->flag & TSE_OPEN_SUBTREE) {
+    tselem->flag &= ~TSE_OPEN_SUBTREE;
+    te->flag |= TE_OPEN_SUBTREE;
+  }
+  else if (parent && (parent->flag & TE_OPEN_SUBTREE)) {
+    tselem->flag &= ~TSE_CLOSED;
+    te->flag |= TE_OPEN_SUBTREE;
+  }
+
   te->parent = parent;
   te->index = index;  // for data arrays
   if (ELEM(type, TSE_SEQUENCE, TSE_SEQ_STRIP, TSE_SEQUENCE_DUP)) {
@@ -2256,6 +2317,19 @@ static void outliner_filter_tree(SpaceOutliner *soops, ViewLayer *view_layer)
 
 /* Main entry point for building the tree data-structure that the outliner represents */
 // TODO: split each mode into its own function?
+/* Changes when objects or collections are added, removed or re-parented, which rebuilds the
+ * relations of the depsgraph. Redraws that skip the rebuild can tell whether the tree is still
+ * valid this way. Zero when there is no depsgraph to tell. */
+static uint outliner_content_stamp(Main *bmain, Scene *scene, ViewLayer *view_layer)
+{
+  Depsgraph *depsgraph = (view_layer) ? BKE_scene_get_depsgraph(bmain, scene, view_layer, false) :
+                                        NULL;
+  if (depsgraph == NULL) {
+    return 0;
+  }
+  return DEG_get_relations_stamp(depsgraph);
+}
+
 void outliner_build_tree(
     Main *mainvar, Scene *scene, ViewLayer *view_layer, SpaceOutliner *soops, ARegion *ar)
 {
@@ -2279,9 +2353,15 @@ void outliner_build_tree(
     BKE_outliner_treehash_rebuild_from_treestore(soops->treehash, soops->treestore);
   }
 
-  if (ar->do_draw & RGN_DRAW_NO_REBUILD) {
+  /* Selection changes only redraw, but some operators change the scene contents and then only
+   * send selection notifiers, e.g. duplicate. */
+  const uint content_stamp = outliner_content_stamp(mainvar, scene, view_layer);
+
+  if ((ar->do_draw & RGN_DRAW_NO_REBUILD) && content_stamp != 0 &&
+      content_stamp == (uint)soops->tree_content_stamp) {
     return;
   }
+  soops->tree_content_stamp = (int)content_stamp;
 
   OutlinerTreeElementFocus focus;
   outliner_store_scrolling_position(soops, ar, &focus);
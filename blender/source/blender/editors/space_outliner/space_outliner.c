@@ -106,17 +106,28 @@ static void outliner_main_region_free(ARegion *UNUSED(ar))
 }
 
 static void outliner_main_region_listener(wmWindow *UNUSED(win),
-                                          ScrArea *UNUSED(sa),
+                                          ScrArea *sa,
                                           ARegion *ar,
                                           wmNotifier *wmn,
                                           const Scene *UNUSED(scene))
 {
+  SpaceOutliner *soops = sa->spacedata.first;
+
   /* context changes */
   switch (wmn->category) {
     case NC_SCENE:
       switch (wmn->data) {
         case ND_OB_ACTIVE:
         case ND_OB_SELECT:
+          /* Selection is synced on the existing tree, unless it decides which objects are
+           * listed. outliner_build_tree() still rebuilds if the scene contents changed. */
+          if (soops->filter_state == SO_FILTER_OB_ALL && soops->search_string[0] == '\0') {
+            ED_region_tag_redraw_no_rebuild(ar);
+          }
+          else {
+            ED_region_tag_redraw(ar);
+          }
+          break;
         case ND_OB_VISIBLE:
         case ND_OB_RENDER:
         case ND_MODE:
@@ -353,6 +364,7 @@ static SpaceLink *outliner_duplicate(SpaceLink *sl)
   BLI_listbase_clear(&soutlinern->tree);
   soutlinern->treestore = NULL;
   soutlinern->treehash = NULL;
+  soutlinern->tree_content_stamp = 0;
 
   soutlinern->flag |= (soutliner->flag & SO_SYNC_SELECT);
   soutlinern->sync_select_dirty = WM_OUTLINER_SYNC_SELECT_FROM_ALL;
@@ -429,6 +441,13 @@ void ED_spacetype_outliner(void)
   art->draw = outliner_main_region_draw;
   art->free = outliner_main_region_free;
   art->listener = outliner_main_region_listener;
+  art->listener_categories = NOTE_CATEGORY_FLAG(NC_ANIMATION) | NOTE_CATEGORY_FLAG(NC_GEOM) |
+                             NOTE_CATEGORY_FLAG(NC_GPENCIL) | NOTE_CATEGORY_FLAG(NC_GROUP) |
+                             NOTE_CATEGORY_FLAG(NC_ID) | NOTE_CATEGORY_FLAG(NC_LAMP) |
+                             NOTE_CATEGORY_FLAG(NC_MASK) | NOTE_CATEGORY_FLAG(NC_MATERIAL) |
+                             NOTE_CATEGORY_FLAG(NC_OBJECT) | NOTE_CATEGORY_FLAG(NC_PAINTCURVE) |
+                             NOTE_CATEGORY_FLAG(NC_SCENE) | NOTE_CATEGORY_FLAG(NC_SCREEN) |
+                             NOTE_CATEGORY_FLAG(NC_SPACE) | NOTE_CATEGORY_FLAG(NC_TEXT);
   art->message_subscribe = outliner_main_region_message_subscribe;
   BLI_addhead(&st->regiontypes, art);
 
@@ -442,6 +461,7 @@ void ED_spacetype_outliner(void)
   art->draw = outliner_header_region_draw;
   art->free = outliner_header_region_free;
   art->listener = outliner_header_region_listener;
+  art->listener_categories = NOTE_CATEGORY_FLAG(NC_SCENE) | NOTE_CATEGORY_FLAG(NC_SPACE);
   BLI_addhead(&st->regiontypes, art);
 
   BKE_spacetype_register(st);
@@ -831,6 +831,9 @@ void ED_spacetype_sequencer(void)
   art->init = sequencer_main_region_init;
   art->draw = sequencer_main_region_draw;
   art->listener = sequencer_main_region_listener;
+  art->listener_categories = NOTE_CATEGORY_FLAG(NC_ANIMATION) | NOTE_CATEGORY_FLAG(NC_ID) |
+                             NOTE_CATEGORY_FLAG(NC_SCENE) | NOTE_CATEGORY_FLAG(NC_SCREEN) |
+                             NOTE_CATEGORY_FLAG(NC_SPACE);
   art->message_subscribe = sequencer_main_region_message_subscribe;
   art->keymapflag = ED_KEYMAP_VIEW2D | ED_KEYMAP_FRAMES | ED_KEYMAP_ANIMATION;
 
@@ -842,6 +845,9 @@ void ED_spacetype_sequencer(void)
   art->init = sequencer_preview_region_init;
   art->draw = sequencer_preview_region_draw;
   art->listener = sequencer_preview_region_listener;
+  art->listener_categories = NOTE_CATEGORY_FLAG(NC_ANIMATION) | NOTE_CATEGORY_FLAG(NC_GPENCIL) |
+                             NOTE_CATEGORY_FLAG(NC_ID) | NOTE_CATEGORY_FLAG(NC_MASK) |
+                             NOTE_CATEGORY_FLAG(NC_SCENE) | NOTE_CATEGORY_FLAG(NC_SPACE);
   art->keymapflag = ED_KEYMAP_GIZMO | ED_KEYMAP_VIEW2D | ED_KEYMAP_FRAMES | ED_KEYMAP_GPENCIL;
   BLI_addhead(&st->regiontypes, art);
 
@@ -851,6 +857,8 @@ void ED_spacetype_sequencer(void)
   art->prefsizex = UI_SIDEBAR_PANEL_WIDTH * 1.3f;
   art->keymapflag = ED_KEYMAP_UI | ED_KEYMAP_FRAMES;
   art->listener = sequencer_buttons_region_listener;
+  art->listener_categories = NOTE_CATEGORY_FLAG(NC_GPENCIL) | NOTE_CATEGORY_FLAG(NC_ID) |
+                             NOTE_CATEGORY_FLAG(NC_SCENE) | NOTE_CATEGORY_FLAG(NC_SPACE);
   art->init = sequencer_buttons_region_init;
   art->draw = sequencer_buttons_region_draw;
   BLI_addhead(&st->regiontypes, art);
@@ -866,6 +874,9 @@ void ED_spacetype_sequencer(void)
   art->init = sequencer_header_region_init;
   art->draw = sequencer_header_region_draw;
   art->listener = sequencer_main_region_listener;
+  art->listener_categories = NOTE_CATEGORY_FLAG(NC_ANIMATION) | NOTE_CATEGORY_FLAG(NC_ID) |
+                             NOTE_CATEGORY_FLAG(NC_SCENE) | NOTE_CATEGORY_FLAG(NC_SCREEN) |
+                             NOTE_CATEGORY_FLAG(NC_SPACE);
 
   BLI_addhead(&st->regiontypes, art);
 
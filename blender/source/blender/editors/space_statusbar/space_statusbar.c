@@ -175,6 +175,9 @@ void ED_spacetype_statusbar(void)
   art->layout = ED_region_header_layout;
   art->draw = ED_region_header_draw;
   art->listener = statusbar_header_region_listener;
+  art->listener_categories = NOTE_CATEGORY_FLAG(NC_ID) | NOTE_CATEGORY_FLAG(NC_SCENE) |
+                             NOTE_CATEGORY_FLAG(NC_SCREEN) | NOTE_CATEGORY_FLAG(NC_SPACE) |
+                             NOTE_CATEGORY_FLAG(NC_WM);
   art->message_subscribe = statusbar_header_region_message_subscribe;
   BLI_addhead(&st->regiontypes, art);
 
@@ -264,6 +264,8 @@ void ED_spacetype_topbar(void)
   art->layout = ED_region_header_layout;
   art->draw = ED_region_header_draw;
   art->listener = topbar_main_region_listener;
+  art->listener_categories = NOTE_CATEGORY_FLAG(NC_GPENCIL) | NOTE_CATEGORY_FLAG(NC_SCENE) |
+                             NOTE_CATEGORY_FLAG(NC_SPACE) | NOTE_CATEGORY_FLAG(NC_WM);
   art->prefsizex = UI_UNIT_X * 5; /* Mainly to avoid glitches */
   art->keymapflag = ED_KEYMAP_UI | ED_KEYMAP_VIEW2D | ED_KEYMAP_HEADER;
 
@@ -276,6 +278,8 @@ void ED_spacetype_topbar(void)
   art->prefsizex = UI_UNIT_X * 5; /* Mainly to avoid glitches */
   art->keymapflag = ED_KEYMAP_UI | ED_KEYMAP_VIEW2D | ED_KEYMAP_HEADER;
   art->listener = topbar_header_listener;
+  art->listener_categories = NOTE_CATEGORY_FLAG(NC_SCENE) | NOTE_CATEGORY_FLAG(NC_SCREEN) |
+                             NOTE_CATEGORY_FLAG(NC_SPACE) | NOTE_CATEGORY_FLAG(NC_WM);
   art->message_subscribe = topbar_header_region_message_subscribe;
   art->init = topbar_header_region_init;
   art->layout = ED_region_header_layout;
@@ -1562,6 +1562,16 @@ void ED_spacetype_view3d(void)
   art->free = view3d_main_region_free;
   art->duplicate = view3d_main_region_duplicate;
   art->listener = view3d_main_region_listener;
+  art->listener_categories = NOTE_CATEGORY_FLAG(NC_ANIMATION) | NOTE_CATEGORY_FLAG(NC_BRUSH) |
+                             NOTE_CATEGORY_FLAG(NC_CAMERA) | NOTE_CATEGORY_FLAG(NC_GEOM) |
+                             NOTE_CATEGORY_FLAG(NC_GPENCIL) | NOTE_CATEGORY_FLAG(NC_GROUP) |
+                             NOTE_CATEGORY_FLAG(NC_ID) | NOTE_CATEGORY_FLAG(NC_IMAGE) |
+                             NOTE_CATEGORY_FLAG(NC_LAMP) | NOTE_CATEGORY_FLAG(NC_LIGHTPROBE) |
+                             NOTE_CATEGORY_FLAG(NC_MATERIAL) | NOTE_CATEGORY_FLAG(NC_MOVIECLIP) |
+                             NOTE_CATEGORY_FLAG(NC_OBJECT) | NOTE_CATEGORY_FLAG(NC_SCENE) |
+                             NOTE_CATEGORY_FLAG(NC_SCREEN) | NOTE_CATEGORY_FLAG(NC_SPACE) |
+                             NOTE_CATEGORY_FLAG(NC_TEXTURE) | NOTE_CATEGORY_FLAG(NC_WM) |
+                             NOTE_CATEGORY_FLAG(NC_WORLD);
   art->message_subscribe = view3d_main_region_message_subscribe;
   art->cursor = view3d_main_region_cursor;
   art->lock = 1; /* can become flag, see BKE_spacedata_draw_locks */
@@ -1573,6 +1583,12 @@ void ED_spacetype_view3d(void)
   art->prefsizex = UI_SIDEBAR_PANEL_WIDTH;
   art->keymapflag = ED_KEYMAP_UI | ED_KEYMAP_FRAMES;
   art->listener = view3d_buttons_region_listener;
+  art->listener_categories = NOTE_CATEGORY_FLAG(NC_ANIMATION) | NOTE_CATEGORY_FLAG(NC_BRUSH) |
+                             NOTE_CATEGORY_FLAG(NC_GEOM) | NOTE_CATEGORY_FLAG(NC_GPENCIL) |
+                             NOTE_CATEGORY_FLAG(NC_ID) | NOTE_CATEGORY_FLAG(NC_IMAGE) |
+                             NOTE_CATEGORY_FLAG(NC_MATERIAL) | NOTE_CATEGORY_FLAG(NC_OBJECT) |
+                             NOTE_CATEGORY_FLAG(NC_SCENE) | NOTE_CATEGORY_FLAG(NC_SPACE) |
+                             NOTE_CATEGORY_FLAG(NC_TEXTURE);
   art->message_subscribe = ED_area_do_mgs_subscribe_for_tool_ui;
   art->init = view3d_buttons_region_init;
   art->layout = view3d_buttons_region_layout;
@@ -1588,6 +1604,12 @@ void ED_spacetype_view3d(void)
   art->prefsizey = 50; /* XXX */
   art->keymapflag = ED_KEYMAP_UI | ED_KEYMAP_FRAMES;
   art->listener = view3d_buttons_region_listener;
+  art->listener_categories = NOTE_CATEGORY_FLAG(NC_ANIMATION) | NOTE_CATEGORY_FLAG(NC_BRUSH) |
+                             NOTE_CATEGORY_FLAG(NC_GEOM) | NOTE_CATEGORY_FLAG(NC_GPENCIL) |
+                             NOTE_CATEGORY_FLAG(NC_ID) | NOTE_CATEGORY_FLAG(NC_IMAGE) |
+                             NOTE_CATEGORY_FLAG(NC_MATERIAL) | NOTE_CATEGORY_FLAG(NC_OBJECT) |
+                             NOTE_CATEGORY_FLAG(NC_SCENE) | NOTE_CATEGORY_FLAG(NC_SPACE) |
+                             NOTE_CATEGORY_FLAG(NC_TEXTURE);
   art->message_subscribe = ED_region_generic_tools_region_message_subscribe;
   art->snap_size = ED_region_generic_tools_region_snap_size;
   art->init = view3d_tools_region_init;
@@ -1600,6 +1622,9 @@ void ED_spacetype_view3d(void)
   art->prefsizey = HEADERY;
   art->keymapflag = ED_KEYMAP_UI | ED_KEYMAP_VIEW2D | ED_KEYMAP_FRAMES | ED_KEYMAP_HEADER;
   art->listener = view3d_header_region_listener;
+  art->listener_categories = NOTE_CATEGORY_FLAG(NC_BRUSH) | NOTE_CATEGORY_FLAG(NC_GPENCIL) |
+                             NOTE_CATEGORY_FLAG(NC_SCENE) | NOTE_CATEGORY_FLAG(NC_SPACE) |
+                             NOTE_CATEGORY_FLAG(NC_WM);
   art->message_subscribe = ED_area_do_mgs_subscribe_for_tool_header;
   art->init = view3d_header_region_init;
   art->draw = view3d_header_region_draw;
@@ -1611,6 +1636,9 @@ void ED_spacetype_view3d(void)
   art->prefsizey = HEADERY;
   art->keymapflag = ED_KEYMAP_UI | ED_KEYMAP_VIEW2D | ED_KEYMAP_FRAMES | ED_KEYMAP_HEADER;
   art->listener = view3d_header_region_listener;
+  art->listener_categories = NOTE_CATEGORY_FLAG(NC_BRUSH) | NOTE_CATEGORY_FLAG(NC_GPENCIL) |
+                             NOTE_CATEGORY_FLAG(NC_SCENE) | NOTE_CATEGORY_FLAG(NC_SPACE) |
+                             NOTE_CATEGORY_FLAG(NC_WM);
   art->message_subscribe = view3d_header_region_message_subscribe;
   art->init = view3d_header_region_init;
   art->draw = view3d_header_region_draw;
@@ -46,6 +46,7 @@
 #include "BLI_listbase.h"
 #include "BLI_string.h"
 #include "BLI_ghash.h"
+#include "BLI_task.h"
 #include "BLI_utildefines_stack.h"
 #include "BLI_memarena.h"
 
@@ -3595,10 +3596,77 @@ static eRedrawFlag handleEventShear(TransInfo *t, const wmEvent *event)
   return status;
 }
 
+static void transdata_elem_shear(const TransInfo *t,
+                                 const TransDataContainer *tc,
+                                 TransData *td,
+                                 const float totmat[3][3],
+                                 const bool is_local_center)
+{
+  float vec[3], tmat[3][3];
+  const float *center, *co;
+
+  if (t->flag & T_EDIT) {
+    mul_m3_series(tmat, td->smtx, totmat, td->mtx);
+  }
+  else {
+    copy_m3_m3(tmat, totmat);
+  }
+
+  if (is_local_center) {
+    center = td->center;
+    co = td->loc;
+  }
+  else {
+    center = tc->center_local;
+    co = td->center;
+  }
+
+  sub_v3_v3v3(vec, co, center);
+
+  mul_m3_v3(tmat, vec);
+
+  add_v3_v3(vec, center);
+  sub_v3_v3(vec, co);
+
+  if (t->options & CTX_GPENCIL_STROKES) {
+    /* grease pencil multiframe falloff */
+    bGPDstroke *gps = (bGPDstroke *)td->extra;
+    if (gps != NULL) {
+      mul_v3_fl(vec, td->factor * gps->runtime.multi_frame_falloff);
+    }
+    else {
+      mul_v3_fl(vec, td->factor);
+    }
+  }
+  else {
+    mul_v3_fl(vec, td->factor);
+  }
+
+  add_v3_v3v3(td->loc, td->iloc, vec);
+}
+
+struct TransDataArgs_Shear {
+  const TransInfo *t;
+  const TransDataContainer *tc;
+  float totmat[3][3];
+  bool is_local_center;
+};
+
+static void transdata_elem_shear_fn(void *__restrict iter_data_v,
+                                    const int iter,
+                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  struct TransDataArgs_Shear *data = iter_data_v;
+  TransData *td = &data->tc->data[iter];
+  if (td->flag & TD_SKIP) {
+    return;
+  }
+  transdata_elem_shear(data->t, data->tc, td, data->totmat, data->is_local_center);
+}
+
 static void applyShear(TransInfo *t, const int UNUSED(mval[2]))
 {
-  float vec[3];
-  float smat[3][3], tmat[3][3], totmat[3][3], axismat[3][3], axismat_inv[3][3];
+  float smat[3][3], totmat[3][3], axismat[3][3], axismat_inv[3][3];
   float value;
   int i;
   char str[UI_MAX_DRAW_STR];
@@ -3640,56 +3708,31 @@ static void applyShear(TransInfo *t, const int UNUSED(mval[2]))
   mul_m3_series(totmat, axismat_inv, smat, axismat);
 
   FOREACH_TRANS_DATA_CONTAINER (t, tc) {
-    TransData *td = tc->data;
-    for (i = 0; i < tc->data_len; i++, td++) {
-      const float *center, *co;
-
-      if (td->flag & TD_NOACTION) {
-        break;
-      }
-
-      if (td->flag & TD_SKIP) {
-        continue;
-      }
-
-      if (t->flag & T_EDIT) {
-        mul_m3_series(tmat, td->smtx, totmat, td->mtx);
-      }
-      else {
-        copy_m3_m3(tmat, totmat);
-      }
-
-      if (is_local_center) {
-        center = td->center;
-        co = td->loc;
-      }
-      else {
-        center = tc->center_local;
-        co = td->center;
-      }
-
-      sub_v3_v3v3(vec, co, center);
-
-      mul_m3_v3(tmat, vec);
-
-      add_v3_v3(vec, center);
-      sub_v3_v3(vec, co);
-
-      if (t->options & CTX_GPENCIL_STROKES) {
-        /* grease pencil multiframe falloff */
-        bGPDstroke *gps = (bGPDstroke *)td->extra;
-        if (gps != NULL) {
-          mul_v3_fl(vec, td->factor * gps->runtime.multi_frame_falloff);
+    if (!transdata_use_threading(t, tc)) {
+      TransData *td = tc->data;
+      for (i = 0; i < tc->data_len; i++, td++) {
+        if (td->flag & TD_NOACTION) {
+          break;
         }
-        else {
-          mul_v3_fl(vec, td->factor);
+
+        if (td->flag & TD_SKIP) {
+          continue;
         }
-      }
-      else {
-        mul_v3_fl(vec, td->factor);
-      }
 
-      add_v3_v3v3(td->loc, td->iloc, vec);
+        transdata_elem_shear(t, tc, td, totmat, is_local_center);
+      }
+    }
+    else {
+      struct TransDataArgs_Shear data = {
+          .t = t,
+          .tc = tc,
+          .is_local_center = is_local_center,
+      };
+      copy_m3_m3(data.totmat, totmat);
+      TaskParallelSettings settings;
+      BLI_parallel_range_settings_defaults(&settings);
+      BLI_task_parallel_range(
+          0, transdata_action_len(tc), &data, transdata_elem_shear_fn, &settings);
     }
   }
 
@@ -3958,6 +4001,24 @@ static void ElementResize(TransInfo *t, TransDataContainer *tc, TransData *td, f
   constraintTransLim(t, td);
 }
 
+struct TransDataArgs_Resize {
+  TransInfo *t;
+  TransDataContainer *tc;
+  float mat[3][3];
+};
+
+static void transdata_elem_resize_fn(void *__restrict iter_data_v,
+                                     const int iter,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  struct TransDataArgs_Resize *data = iter_data_v;
+  TransData *td = &data->tc->data[iter];
+  if (td->flag & TD_SKIP) {
+    return;
+  }
+  ElementResize(data->t, data->tc, td, data->mat);
+}
+
 static void applyResize(TransInfo *t, const int UNUSED(mval[2]))
 {
   float mat[3][3];
@@ -4005,17 +4066,30 @@ static void applyResize(TransInfo *t, const int UNUSED(mval[2]))
   copy_m3_m3(t->mat, mat);  // used in gizmo
 
   FOREACH_TRANS_DATA_CONTAINER (t, tc) {
-    TransData *td = tc->data;
-    for (i = 0; i < tc->data_len; i++, td++) {
-      if (td->flag & TD_NOACTION) {
-        break;
-      }
+    if (!transdata_use_threading(t, tc)) {
+      TransData *td = tc->data;
+      for (i = 0; i < tc->data_len; i++, td++) {
+        if (td->flag & TD_NOACTION) {
+          break;
+        }
 
-      if (td->flag & TD_SKIP) {
-        continue;
-      }
+        if (td->flag & TD_SKIP) {
+          continue;
+        }
 
-      ElementResize(t, tc, td, mat);
+        ElementResize(t, tc, td, mat);
+      }
+    }
+    else {
+      struct TransDataArgs_Resize data = {
+          .t = t,
+          .tc = tc,
+      };
+      copy_m3_m3(data.mat, mat);
+      TaskParallelSettings settings;
+      BLI_parallel_range_settings_defaults(&settings);
+      BLI_task_parallel_range(
+          0, transdata_action_len(tc), &data, transdata_elem_resize_fn, &settings);
     }
   }
 
@@ -4191,10 +4265,43 @@ static void initToSphere(TransInfo *t)
   t->val /= (float)t->data_len_all;
 }
 
-static void applyToSphere(TransInfo *t, const int UNUSED(mval[2]))
+static void transdata_elem_to_sphere(const TransInfo *t,
+                                     const TransDataContainer *tc,
+                                     TransData *td,
+                                     const float ratio)
 {
   float vec[3];
-  float ratio, radius;
+  sub_v3_v3v3(vec, td->iloc, tc->center_local);
+
+  const float radius = normalize_v3(vec);
+  const float tratio = ratio * td->factor;
+
+  mul_v3_fl(vec, radius * (1.0f - tratio) + t->val * tratio);
+
+  add_v3_v3v3(td->loc, tc->center_local, vec);
+}
+
+struct TransDataArgs_ToSphere {
+  const TransInfo *t;
+  const TransDataContainer *tc;
+  float ratio;
+};
+
+static void transdata_elem_to_sphere_fn(void *__restrict iter_data_v,
+                                        const int iter,
+                                        const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  struct TransDataArgs_ToSphere *data = iter_data_v;
+  TransData *td = &data->tc->data[iter];
+  if (td->flag & TD_SKIP) {
+    return;
+  }
+  transdata_elem_to_sphere(data->t, data->tc, td, data->ratio);
+}
+
+static void applyToSphere(TransInfo *t, const int UNUSED(mval[2]))
+{
+  float ratio;
   int i;
   char str[UI_MAX_DRAW_STR];
 
@@ -4222,26 +4329,30 @@ static void applyToSphere(TransInfo *t, const int UNUSED(mval[2]))
   }
 
   FOREACH_TRANS_DATA_CONTAINER (t, tc) {
-    TransData *td = tc->data;
-    for (i = 0; i < tc->data_len; i++, td++) {
-      float tratio;
-      if (td->flag & TD_NOACTION) {
-        break;
-      }
-
-      if (td->flag & TD_SKIP) {
-        continue;
-      }
-
-      sub_v3_v3v3(vec, td->iloc, tc->center_local);
-
-      radius = normalize_v3(vec);
-
-      tratio = ratio * td->factor;
+    if (!transdata_use_threading(t, tc)) {
+      TransData *td = tc->data;
+      for (i = 0; i < tc->data_len; i++, td++) {
+        if (td->flag & TD_NOACTION) {
+          break;
+        }
 
-      mul_v3_fl(vec, radius * (1.0f - tratio) + t->val * tratio);
+        if (td->flag & TD_SKIP) {
+          continue;
+        }
 
-      add_v3_v3v3(td->loc, tc->center_local, vec);
+        transdata_elem_to_sphere(t, tc, td, ratio);
+      }
+    }
+    else {
+      struct TransDataArgs_ToSphere data = {
+          .t = t,
+          .tc = tc,
+          .ratio = ratio,
+      };
+      TaskParallelSettings settings;
+      BLI_parallel_range_settings_defaults(&settings);
+      BLI_task_parallel_range(
+          0, transdata_action_len(tc), &data, transdata_elem_to_sphere_fn, &settings);
     }
   }
 
@@ -4582,6 +4693,95 @@ static float large_rotation_limit(float angle)
   return angle;
 }
 
+static void transdata_elem_rotate(TransInfo *t,
+                                  TransDataContainer *tc,
+                                  TransData *td,
+                                  const float axis[3],
+                                  const float angle,
+                                  const float angle_step,
+                                  const bool is_large_rotation,
+                                  float mat[3][3])
+{
+  float axis_final[3];
+  float mat_final[3][3];
+  /* Use the default rotation matrix unless this element needs its own. */
+  bool use_mat_final = false;
+
+  copy_v3_v3(axis_final, axis);
+
+  float angle_final = angle;
+  if (t->con.applyRot) {
+    t->con.applyRot(t, tc, td, axis_final, NULL);
+    angle_final = angle * td->factor;
+    /* Even though final angle might be identical to orig value,
+     * we have to update the rotation matrix in that case... */
+    use_mat_final = true;
+  }
+  else if (t->flag & T_PROP_EDIT) {
+    angle_final = angle * td->factor;
+  }
+
+  /* Rotation is very likely to be above 180°, we need to do rotation by steps.
+   * Note that this is only needed when doing 'absolute' rotation
+   * (i.e. from initial rotation again, typically when using numinput).
+   * regular incremental rotation (from mouse/widget/...) will be called often enough,
+   * hence steps are small enough to be properly handled without that complicated trick.
+   * Note that we can only do that kind of stepped rotation if we have initial rotation values
+   * (and access to some actual rotation value storage).
+   * Otherwise, just assume it's useless (e.g. in case of mesh/UV/etc. editing).
+   * Also need to be in Euler rotation mode, the others never allow more than one turn anyway.
+   */
+  if (is_large_rotation && td->ext != NULL && td->ext->rotOrder == ROT_MODE_EUL) {
+    copy_v3_v3(td->ext->rot, td->ext->irot);
+    for (float angle_progress = angle_step; fabsf(angle_progress) < fabsf(angle_final);
+         angle_progress += angle_step) {
+      axis_angle_normalized_to_mat3(mat_final, axis_final, angle_progress);
+      ElementRotation(t, tc, td, mat_final, t->around);
+    }
+    use_mat_final = true;
+  }
+  else if (angle_final != angle) {
+    use_mat_final = true;
+  }
+
+  if (use_mat_final) {
+    axis_angle_normalized_to_mat3(mat_final, axis_final, angle_final);
+    ElementRotation(t, tc, td, mat_final, t->around);
+  }
+  else {
+    ElementRotation(t, tc, td, mat, t->around);
+  }
+}
+
+struct TransDataArgs_Rotate {
+  TransInfo *t;
+  TransDataContainer *tc;
+  float axis[3];
+  float angle;
+  float angle_step;
+  bool is_large_rotation;
+  float mat[3][3];
+};
+
+static void transdata_elem_rotate_fn(void *__restrict iter_data_v,
+                                     const int iter,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  struct TransDataArgs_Rotate *data = iter_data_v;
+  TransData *td = &data->tc->data[iter];
+  if (td->flag & TD_SKIP) {
+    return;
+  }
+  transdata_elem_rotate(data->t,
+                        data->tc,
+                        td,
+                        data->axis,
+                        data->angle,
+                        data->angle_step,
+                        data->is_large_rotation,
+                        data->mat);
+}
+
 static void applyRotationValue(TransInfo *t,
                                float angle,
                                float axis[3],
@@ -4602,63 +4802,36 @@ static void applyRotationValue(TransInfo *t,
   }
 
   axis_angle_normalized_to_mat3(mat, axis, angle);
-  /* Counter for needed updates (when we need to update to non-default matrix,
-   * we also need another update on next iteration to go back to default matrix,
-   * hence the '2' value used here, instead of a mere boolean). */
-  short do_update_matrix = 0;
 
   FOREACH_TRANS_DATA_CONTAINER (t, tc) {
-    TransData *td = tc->data;
-    for (i = 0; i < tc->data_len; i++, td++) {
-      if (td->flag & TD_NOACTION) {
-        break;
-      }
-
-      if (td->flag & TD_SKIP) {
-        continue;
-      }
+    if (!transdata_use_threading(t, tc)) {
+      TransData *td = tc->data;
+      for (i = 0; i < tc->data_len; i++, td++) {
+        if (td->flag & TD_NOACTION) {
+          break;
+        }
 
-      float angle_final = angle;
-      if (t->con.applyRot) {
-        t->con.applyRot(t, tc, td, axis, NULL);
-        angle_final = angle * td->factor;
-        /* Even though final angle might be identical to orig value,
-         * we have to update the rotation matrix in that case... */
-        do_update_matrix = 2;
-      }
-      else if (t->flag & T_PROP_EDIT) {
-        angle_final = angle * td->factor;
-      }
-
-      /* Rotation is very likely to be above 180°, we need to do rotation by steps.
-       * Note that this is only needed when doing 'absolute' rotation
-       * (i.e. from initial rotation again, typically when using numinput).
-       * regular incremental rotation (from mouse/widget/...) will be called often enough,
-       * hence steps are small enough to be properly handled without that complicated trick.
-       * Note that we can only do that kind of stepped rotation if we have initial rotation values
-       * (and access to some actual rotation value storage).
-       * Otherwise, just assume it's useless (e.g. in case of mesh/UV/etc. editing).
-       * Also need to be in Euler rotation mode, the others never allow more than one turn anyway.
-       */
-      if (is_large_rotation && td->ext != NULL && td->ext->rotOrder == ROT_MODE_EUL) {
-        copy_v3_v3(td->ext->rot, td->ext->irot);
-        for (float angle_progress = angle_step; fabsf(angle_progress) < fabsf(angle_final);
-             angle_progress += angle_step) {
-          axis_angle_normalized_to_mat3(mat, axis, angle_progress);
-          ElementRotation(t, tc, td, mat, t->around);
+        if (td->flag & TD_SKIP) {
+          continue;
         }
-        do_update_matrix = 2;
-      }
-      else if (angle_final != angle) {
-        do_update_matrix = 2;
-      }
 
-      if (do_update_matrix > 0) {
-        axis_angle_normalized_to_mat3(mat, axis, angle_final);
-        do_update_matrix--;
+        transdata_elem_rotate(t, tc, td, axis, angle, angle_step, is_large_rotation, mat);
       }
-
-      ElementRotation(t, tc, td, mat, t->around);
+    }
+    else {
+      struct TransDataArgs_Rotate data = {
+          .t = t,
+          .tc = tc,
+          .angle = angle,
+          .angle_step = angle_step,
+          .is_large_rotation = is_large_rotation,
+      };
+      copy_v3_v3(data.axis, axis);
+      copy_m3_m3(data.mat, mat);
+      TaskParallelSettings settings;
+      BLI_parallel_range_settings_defaults(&settings);
+      BLI_task_parallel_range(
+          0, transdata_action_len(tc), &data, transdata_elem_rotate_fn, &settings);
     }
   }
 }
@@ -5191,11 +5364,109 @@ static void headerTranslation(TransInfo *t, const float vec[3], char str[UI_MAX_
   }
 }
 
+static void transdata_elem_translate(TransInfo *t,
+                                     TransDataContainer *tc,
+                                     TransData *td,
+                                     const float vec[3],
+                                     const bool apply_snap_align_rotation,
+                                     const float pivot[3])
+{
+  float tvec[3];
+  float rotate_offset[3] = {0};
+  bool use_rotate_offset = false;
+
+  /* handle snapping rotation before doing the translation */
+  if (apply_snap_align_rotation) {
+    float mat[3][3];
+
+    if (validSnappingNormal(t)) {
+      const float *original_normal;
+
+      /* In pose mode, we want to align normals with Y axis of bones... */
+      if (t->flag & T_POSE) {
+        original_normal = td->axismtx[1];
+      }
+      else {
+        original_normal = td->axismtx[2];
+      }
+
+      rotation_between_vecs_to_mat3(mat, original_normal, t->tsnap.snapNormal);
+    }
+    else {
+      unit_m3(mat);
+    }
+
+    ElementRotation_ex(t, tc, td, mat, pivot);
+
+    if (td->loc) {
+      use_rotate_offset = true;
+      sub_v3_v3v3(rotate_offset, td->loc, td->iloc);
+    }
+  }
+
+  if (t->con.applyVec) {
+    float pvec[3];
+    t->con.applyVec(t, tc, td, vec, tvec, pvec);
+  }
+  else {
+    copy_v3_v3(tvec, vec);
+  }
+
+  if (use_rotate_offset) {
+    add_v3_v3(tvec, rotate_offset);
+  }
+
+  mul_m3_v3(td->smtx, tvec);
+
+  if (t->options & CTX_GPENCIL_STROKES) {
+    /* grease pencil multiframe falloff */
+    bGPDstroke *gps = (bGPDstroke *)td->extra;
+    if (gps != NULL) {
+      mul_v3_fl(tvec, td->factor * gps->runtime.multi_frame_falloff);
+    }
+    else {
+      mul_v3_fl(tvec, td->factor);
+    }
+  }
+  else {
+    /* proportional editing falloff */
+    mul_v3_fl(tvec, td->factor);
+  }
+
+  protectedTransBits(td->protectflag, tvec);
+
+  if (td->loc) {
+    add_v3_v3v3(td->loc, td->iloc, tvec);
+  }
+
+  constraintTransLim(t, td);
+}
+
+struct TransDataArgs_Translate {
+  TransInfo *t;
+  TransDataContainer *tc;
+  float pivot[3];
+  float vec[3];
+  bool apply_snap_align_rotation;
+};
+
+static void transdata_elem_translate_fn(void *__restrict iter_data_v,
+                                        const int iter,
+                                        const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  struct TransDataArgs_Translate *data = iter_data_v;
+  TransData *td = &data->tc->data[iter];
+  if (td->flag & TD_SKIP) {
+    return;
+  }
+  transdata_elem_translate(
+      data->t, data->tc, td, data->vec, data->apply_snap_align_rotation, data->pivot);
+}
+
 static void applyTranslationValue(TransInfo *t, const float vec[3])
 {
   const bool apply_snap_align_rotation = usingSnappingNormal(
       t);  // && (t->tsnap.status & POINT_INIT);
-  float tvec[3];
 
   /* The ideal would be "apply_snap_align_rotation" only when a snap point is found
    * so, maybe inside this function is not the best place to apply this rotation.
@@ -5211,84 +5482,34 @@ static void applyTranslationValue(TransInfo *t, const float vec[3])
       }
     }
 
-    TransData *td = tc->data;
-    for (int i = 0; i < tc->data_len; i++, td++) {
-      if (td->flag & TD_NOACTION) {
-        break;
-      }
-
-      if (td->flag & TD_SKIP) {
-        continue;
-      }
-
-      float rotate_offset[3] = {0};
-      bool use_rotate_offset = false;
-
-      /* handle snapping rotation before doing the translation */
-      if (apply_snap_align_rotation) {
-        float mat[3][3];
-
-        if (validSnappingNormal(t)) {
-          const float *original_normal;
-
-          /* In pose mode, we want to align normals with Y axis of bones... */
-          if (t->flag & T_POSE) {
-            original_normal = td->axismtx[1];
-          }
-          else {
-            original_normal = td->axismtx[2];
-          }
-
-          rotation_between_vecs_to_mat3(mat, original_normal, t->tsnap.snapNormal);
-        }
-        else {
-          unit_m3(mat);
+    if (!transdata_use_threading(t, tc)) {
+      TransData *td = tc->data;
+      for (int i = 0; i < tc->data_len; i++, td++) {
+        if (td->flag & TD_NOACTION) {
+          break;
         }
 
-        ElementRotation_ex(t, tc, td, mat, pivot);
-
-        if (td->loc) {
-          use_rotate_offset = true;
-          sub_v3_v3v3(rotate_offset, td->loc, td->iloc);
+        if (td->flag & TD_SKIP) {
+          continue;
         }
-      }
 
-      if (t->con.applyVec) {
-        float pvec[3];
-        t->con.applyVec(t, tc, td, vec, tvec, pvec);
+        transdata_elem_translate(t, tc, td, vec, apply_snap_align_rotation, pivot);
       }
-      else {
-        copy_v3_v3(tvec, vec);
-      }
-
-      if (use_rotate_offset) {
-        add_v3_v3(tvec, rotate_offset);
-      }
-
-      mul_m3_v3(td->smtx, tvec);
-
-      if (t->options & CTX_GPENCIL_STROKES) {
-        /* grease pencil multiframe falloff */
-        bGPDstroke *gps = (bGPDstroke *)td->extra;
-        if (gps != NULL) {
-          mul_v3_fl(tvec, td->factor * gps->runtime.multi_frame_falloff);
-        }
-        else {
-          mul_v3_fl(tvec, td->factor);
-        }
-      }
-      else {
-        /* proportional editing falloff */
-        mul_v3_fl(tvec, td->factor);
-      }
-
-      protectedTransBits(td->protectflag, tvec);
-
-      if (td->loc) {
-        add_v3_v3v3(td->loc, td->iloc, tvec);
+    }
+    else {
+      struct TransDataArgs_Translate data = {
+          .t = t,
+          .tc = tc,
+          .apply_snap_align_rotation = apply_snap_align_rotation,
+      };
+      copy_v3_v3(data.vec, vec);
+      if (apply_snap_align_rotation) {
+        copy_v3_v3(data.pivot, pivot);
       }
-
-      constraintTransLim(t, td);
+      TaskParallelSettings settings;
+      BLI_parallel_range_settings_defaults(&settings);
+      BLI_task_parallel_range(
+          0, transdata_action_len(tc), &data, transdata_elem_translate_fn, &settings);
     }
   }
 }
@@ -881,6 +881,9 @@ enum {
 #define T_PROP_SIZE_MIN 1e-6f
 #define T_PROP_SIZE_MAX 1e12f
 
+/** Minimum amount of elements per container to transform them in parallel. */
+#define TRANSDATA_THREAD_LIMIT 1024
+
 bool initTransform(struct bContext *C,
                    struct TransInfo *t,
                    struct wmOperator *op,
@@ -1000,6 +1003,8 @@ void drawLine(TransInfo *t, const float center[3], const float dir[3], char axis
 void applyTransObjects(TransInfo *t);
 void restoreTransObjects(TransInfo *t);
 void recalcData(TransInfo *t);
+bool transdata_use_threading(const TransInfo *t, const TransDataContainer *tc);
+int transdata_action_len(const TransDataContainer *tc);
 
 void calculateCenter2D(TransInfo *t);
 void calculateCenterLocal(TransInfo *t, const float center_global[3]);
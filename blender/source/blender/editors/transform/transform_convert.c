@@ -34,6 +34,7 @@
 #include "BLI_listbase.h"
 #include "BLI_string.h"
 #include "BLI_kdtree.h"
+#include "BLI_task.h"
 
 #include "BKE_animsys.h"
 #include "BKE_armature.h"
@@ -189,6 +190,69 @@ static void sort_trans_data_selected_first(TransInfo *t)
   }
 }
 
+struct PropDistData {
+  const TransDataContainer *tc;
+  const KDTree_3d *td_tree;
+  TransData **td_table;
+  const float *proj_vec;
+  bool use_island;
+  bool with_dist;
+};
+
+static void set_prop_dist_nearest_cb(void *__restrict userdata,
+                                     const int a,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const struct PropDistData *data = userdata;
+  const TransDataContainer *tc = data->tc;
+  TransData *td = &tc->data[a];
+
+  if (td->flag & TD_SELECTED) {
+    return;
+  }
+
+  float vec[3];
+
+  if (data->use_island) {
+    if (tc->use_local_mat) {
+      mul_v3_m4v3(vec, tc->mat, td->iloc);
+    }
+    else {
+      mul_v3_m3v3(vec, td->mtx, td->iloc);
+    }
+  }
+  else {
+    if (tc->use_local_mat) {
+      mul_v3_m4v3(vec, tc->mat, td->center);
+    }
+    else {
+      mul_v3_m3v3(vec, td->mtx, td->center);
+    }
+  }
+
+  if (data->proj_vec) {
+    float vec_p[3];
+    project_v3_v3v3(vec_p, vec, data->proj_vec);
+    sub_v3_v3(vec, vec_p);
+  }
+
+  KDTreeNearest_3d nearest;
+  const int td_index = BLI_kdtree_3d_find_nearest(data->td_tree, vec, &nearest);
+
+  td->rdist = -1.0f;
+  if (td_index != -1) {
+    td->rdist = nearest.dist;
+    if (data->use_island) {
+      copy_v3_v3(td->center, data->td_table[td_index]->center);
+      copy_m3_m3(td->axismtx, data->td_table[td_index]->axismtx);
+    }
+  }
+
+  if (data->with_dist) {
+    td->dist = td->rdist;
+  }
+}
+
 /**
  * Distance calculated from not-selected vertex to nearest selected vertex.
  */
@@ -278,52 +342,20 @@ static void set_prop_dist(TransInfo *t, const bool with_dist)
   BLI_kdtree_3d_balance(td_tree);
 
   /* For each non-selected vertex, find distance to the nearest selected vertex. */
+  struct PropDistData data = {
+      .td_tree = td_tree,
+      .td_table = td_table,
+      .proj_vec = proj_vec,
+      .use_island = use_island,
+      .with_dist = with_dist,
+  };
   FOREACH_TRANS_DATA_CONTAINER (t, tc) {
-    TransData *td = tc->data;
-    for (a = 0; a < tc->data_len; a++, td++) {
-      if ((td->flag & TD_SELECTED) == 0) {
-        float vec[3];
-
-        if (use_island) {
-          if (tc->use_local_mat) {
-            mul_v3_m4v3(vec, tc->mat, td->iloc);
-          }
-          else {
-            mul_v3_m3v3(vec, td->mtx, td->iloc);
-          }
-        }
-        else {
-          if (tc->use_local_mat) {
-            mul_v3_m4v3(vec, tc->mat, td->center);
-          }
-          else {
-            mul_v3_m3v3(vec, td->mtx, td->center);
-          }
-        }
-
-        if (proj_vec) {
-          float vec_p[3];
-          project_v3_v3v3(vec_p, vec, proj_vec);
-          sub_v3_v3(vec, vec_p);
-        }
+    data.tc = tc;
 
-        KDTreeNearest_3d nearest;
-        const int td_index = BLI_kdtree_3d_find_nearest(td_tree, vec, &nearest);
-
-        td->rdist = -1.0f;
-        if (td_index != -1) {
-          td->rdist = nearest.dist;
-          if (use_island) {
-            copy_v3_v3(td->center, td_table[td_index]->center);
-            copy_m3_m3(td->axismtx, td_table[td_index]->axismtx);
-          }
-        }
-
-        if (with_dist) {
-          td->dist = td->rdist;
-        }
-      }
-    }
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = (tc->data_len >= TRANSDATA_THREAD_LIMIT);
+    BLI_task_parallel_range(0, tc->data_len, &data, set_prop_dist_nearest_cb, &settings);
   }
 
   BLI_kdtree_3d_free(td_tree);
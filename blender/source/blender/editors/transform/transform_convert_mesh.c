@@ -31,7 +31,8 @@
 #include "BLI_bitmap.h"
 #include "BLI_math.h"
 #include "BLI_memarena.h"
-#include "BLI_linklist_stack.h"
+#include "BLI_heap_simple.h"
+#include "BLI_task.h"
 
 #include "BKE_context.h"
 #include "BKE_crazyspace.h"
@@ -66,39 +67,173 @@ struct TransIslandData {
 };
 
 /* -------------------------------------------------------------------- */
-/** \name Edit Mesh Verts Transform Creation
+/** \name Edit Mesh Connectivity Distance
  *
+ * Shortest distance along edges (and quad diagonals) to the selection, computed with a
+ * multi-source Dijkstra. Connected groups of vertices are independent from each other
+ * so each group containing a selection is solved in its own task.
  * \{ */
 
-static bool bmesh_test_dist_add(BMVert *v,
-                                BMVert *v_other,
-                                float *dists,
-                                const float *dists_prev,
-                                /* optionally track original index */
-                                int *index,
-                                const int *index_prev,
-                                const float mtx[3][3])
+struct ConnectivityDistData {
+  const float (*mtx)[3];
+  float *dists;
+  int *index;
+  /* Vertices of all groups, #group_index stores (start, length) pairs into it. */
+  BMVert **group_verts;
+  int (*group_index)[2];
+};
+
+static void editmesh_connectivity_distance_relax(HeapSimple *heap,
+                                                 BMVert *v,
+                                                 BMVert *v_other,
+                                                 const struct ConnectivityDistData *data)
 {
   if ((BM_elem_flag_test(v_other, BM_ELEM_SELECT) == 0) &&
       (BM_elem_flag_test(v_other, BM_ELEM_HIDDEN) == 0)) {
     const int i = BM_elem_index_get(v);
     const int i_other = BM_elem_index_get(v_other);
     float vec[3];
-    float dist_other;
     sub_v3_v3v3(vec, v->co, v_other->co);
-    mul_m3_v3(mtx, vec);
+    mul_m3_v3(data->mtx, vec);
 
-    dist_other = dists_prev[i] + len_v3(vec);
-    if (dist_other < dists[i_other]) {
-      dists[i_other] = dist_other;
-      if (index != NULL) {
-        index[i_other] = index_prev[i];
+    const float dist_other = data->dists[i] + len_v3(vec);
+    if (dist_other < data->dists[i_other]) {
+      data->dists[i_other] = dist_other;
+      if (data->index != NULL) {
+        data->index[i_other] = data->index[i];
+      }
+      BLI_heapsimple_insert(heap, dist_other, v_other);
+    }
+  }
+}
+
+static void editmesh_connectivity_distance_group_cb(void *__restrict userdata,
+                                                    const int group,
+                                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const struct ConnectivityDistData *data = userdata;
+  BMVert **verts = &data->group_verts[data->group_index[group][0]];
+  const int verts_len = data->group_index[group][1];
+
+  HeapSimple *heap = BLI_heapsimple_new_ex((uint)verts_len);
+
+  for (int i = 0; i < verts_len; i++) {
+    if (BM_elem_flag_test(verts[i], BM_ELEM_SELECT)) {
+      BLI_heapsimple_insert(heap, 0.0f, verts[i]);
+    }
+  }
+
+  while (!BLI_heapsimple_is_empty(heap)) {
+    const float dist = BLI_heapsimple_top_value(heap);
+    BMVert *v = BLI_heapsimple_pop_min(heap);
+
+    /* Skip outdated entries, vertices are inserted again when their distance decreases. */
+    if (dist > data->dists[BM_elem_index_get(v)]) {
+      continue;
+    }
+
+    /* connected edge-verts */
+    if (v->e != NULL) {
+      BMEdge *e_iter, *e_first;
+
+      e_iter = e_first = v->e;
+
+      /* would normally use BM_EDGES_OF_VERT, but this runs so often,
+       * its faster to iterate on the data directly */
+      do {
+        if (BM_elem_flag_test(e_iter, BM_ELEM_HIDDEN) == 0) {
+
+          /* edge distance */
+          editmesh_connectivity_distance_relax(heap, v, BM_edge_other_vert(e_iter, v), data);
+
+          /* face distance */
+          if (e_iter->l) {
+            BMLoop *l_iter_radial, *l_first_radial;
+            /**
+             * imaginary edge diagonally across quad,
+             * \note, this takes advantage of the rules of winding that we
+             * know 2 or more of a verts edges wont reference the same face twice.
+             * Also, if the edge is hidden, the face will be hidden too.
+             */
+            l_iter_radial = l_first_radial = e_iter->l;
+
+            do {
+              if ((l_iter_radial->v == v) && (l_iter_radial->f->len == 4) &&
+                  (BM_elem_flag_test(l_iter_radial->f, BM_ELEM_HIDDEN) == 0)) {
+                editmesh_connectivity_distance_relax(
+                    heap, v, l_iter_radial->next->next->v, data);
+              }
+            } while ((l_iter_radial = l_iter_radial->radial_next) != l_first_radial);
+          }
+        }
+      } while ((e_iter = BM_DISK_EDGE_NEXT(e_iter, v)) != e_first);
+    }
+  }
+
+  BLI_heapsimple_free(heap, NULL);
+}
+
+/**
+ * Gather the groups of connected (non hidden) vertices that contain at least one selected
+ * vertex, other vertices can't be reached and keep their initial distance.
+ *
+ * \return the number of groups.
+ */
+static int editmesh_connectivity_groups_calc(BMesh *bm,
+                                             BMVert ***r_group_verts,
+                                             int (**r_group_index)[2])
+{
+  BMVert **group_verts = MEM_mallocN(sizeof(*group_verts) * bm->totvert, __func__);
+  int(*group_index)[2] = MEM_mallocN(sizeof(*group_index) * bm->totvert, __func__);
+  int group_verts_len = 0;
+  int group_len = 0;
+
+  BLI_bitmap *visited = BLI_BITMAP_NEW(bm->totvert, __func__);
+
+  BMIter viter;
+  BMVert *v_init;
+  BM_ITER_MESH (v_init, &viter, bm, BM_VERTS_OF_MESH) {
+    if (BM_elem_flag_test(v_init, BM_ELEM_SELECT) == 0 ||
+        BM_elem_flag_test(v_init, BM_ELEM_HIDDEN) ||
+        BLI_BITMAP_TEST(visited, BM_elem_index_get(v_init))) {
+      continue;
+    }
+
+    /* Flood fill, #group_verts is used as the stack. */
+    const int group_start = group_verts_len;
+    BLI_BITMAP_ENABLE(visited, BM_elem_index_get(v_init));
+    group_verts[group_verts_len++] = v_init;
+
+    for (int i = group_start; i < group_verts_len; i++) {
+      BMVert *v = group_verts[i];
+      if (v->e == NULL) {
+        continue;
       }
-      return true;
+      BMEdge *e_iter, *e_first;
+      e_iter = e_first = v->e;
+      do {
+        if (BM_elem_flag_test(e_iter, BM_ELEM_HIDDEN) == 0) {
+          BMVert *v_other = BM_edge_other_vert(e_iter, v);
+          const int i_other = BM_elem_index_get(v_other);
+          if (!BLI_BITMAP_TEST(visited, i_other) &&
+              (BM_elem_flag_test(v_other, BM_ELEM_HIDDEN) == 0)) {
+            BLI_BITMAP_ENABLE(visited, i_other);
+            group_verts[group_verts_len++] = v_other;
+          }
+        }
+      } while ((e_iter = BM_DISK_EDGE_NEXT(e_iter, v)) != e_first);
     }
+
+    group_index[group_len][0] = group_start;
+    group_index[group_len][1] = group_verts_len - group_start;
+    group_len++;
   }
 
-  return false;
+  MEM_freeN(visited);
+
+  *r_group_verts = group_verts;
+  *r_group_index = group_index;
+  return group_len;
 }
 
 /**
@@ -111,141 +246,54 @@ static void editmesh_set_connectivity_distance(BMesh *bm,
                                                float *dists,
                                                int *index)
 {
-  BLI_LINKSTACK_DECLARE(queue, BMVert *);
-
-  /* any BM_ELEM_TAG'd vertex is in 'queue_next', so we don't add in twice */
-  BLI_LINKSTACK_DECLARE(queue_next, BMVert *);
-
-  BLI_LINKSTACK_INIT(queue);
-  BLI_LINKSTACK_INIT(queue_next);
-
   {
     BMIter viter;
     BMVert *v;
     int i;
 
     BM_ITER_MESH_INDEX (v, &viter, bm, BM_VERTS_OF_MESH, i) {
-      float dist;
       BM_elem_index_set(v, i); /* set_inline */
       BM_elem_flag_disable(v, BM_ELEM_TAG);
 
       if (BM_elem_flag_test(v, BM_ELEM_SELECT) == 0 || BM_elem_flag_test(v, BM_ELEM_HIDDEN)) {
-        dist = FLT_MAX;
-        if (index != NULL) {
-          index[i] = i;
-        }
+        dists[i] = FLT_MAX;
       }
       else {
-        BLI_LINKSTACK_PUSH(queue, v);
-        dist = 0.0f;
-        if (index != NULL) {
-          index[i] = i;
-        }
-      }
-
-      dists[i] = dist;
-    }
-    bm->elem_index_dirty &= ~BM_VERT;
-  }
-
-  /* need to be very careful of feedback loops here, store previous dist's to avoid feedback */
-  float *dists_prev = MEM_dupallocN(dists);
-  int *index_prev = MEM_dupallocN(index); /* may be NULL */
-
-  do {
-    BMVert *v;
-    LinkNode *lnk;
-
-    /* this is correct but slow to do each iteration,
-     * instead sync the dist's while clearing BM_ELEM_TAG (below) */
-#if 0
-    memcpy(dists_prev, dists, sizeof(float) * bm->totvert);
-#endif
-
-    while ((v = BLI_LINKSTACK_POP(queue))) {
-      BLI_assert(dists[BM_elem_index_get(v)] != FLT_MAX);
-
-      /* connected edge-verts */
-      if (v->e != NULL) {
-        BMEdge *e_iter, *e_first;
-
-        e_iter = e_first = v->e;
-
-        /* would normally use BM_EDGES_OF_VERT, but this runs so often,
-         * its faster to iterate on the data directly */
-        do {
-
-          if (BM_elem_flag_test(e_iter, BM_ELEM_HIDDEN) == 0) {
-
-            /* edge distance */
-            {
-              BMVert *v_other = BM_edge_other_vert(e_iter, v);
-              if (bmesh_test_dist_add(v, v_other, dists, dists_prev, index, index_prev, mtx)) {
-                if (BM_elem_flag_test(v_other, BM_ELEM_TAG) == 0) {
-                  BM_elem_flag_enable(v_other, BM_ELEM_TAG);
-                  BLI_LINKSTACK_PUSH(queue_next, v_other);
-                }
-              }
-            }
-
-            /* face distance */
-            if (e_iter->l) {
-              BMLoop *l_iter_radial, *l_first_radial;
-              /**
-               * imaginary edge diagonally across quad,
-               * \note, this takes advantage of the rules of winding that we
-               * know 2 or more of a verts edges wont reference the same face twice.
-               * Also, if the edge is hidden, the face will be hidden too.
-               */
-              l_iter_radial = l_first_radial = e_iter->l;
-
-              do {
-                if ((l_iter_radial->v == v) && (l_iter_radial->f->len == 4) &&
-                    (BM_elem_flag_test(l_iter_radial->f, BM_ELEM_HIDDEN) == 0)) {
-                  BMVert *v_other = l_iter_radial->next->next->v;
-                  if (bmesh_test_dist_add(v, v_other, dists, dists_prev, index, index_prev, mtx)) {
-                    if (BM_elem_flag_test(v_other, BM_ELEM_TAG) == 0) {
-                      BM_elem_flag_enable(v_other, BM_ELEM_TAG);
-                      BLI_LINKSTACK_PUSH(queue_next, v_other);
-                    }
-                  }
-                }
-              } while ((l_iter_radial = l_iter_radial->radial_next) != l_first_radial);
-            }
-          }
-        } while ((e_iter = BM_DISK_EDGE_NEXT(e_iter, v)) != e_first);
+        dists[i] = 0.0f;
       }
-    }
-
-    /* clear for the next loop */
-    for (lnk = queue_next; lnk; lnk = lnk->next) {
-      BMVert *v_link = lnk->link;
-      const int i = BM_elem_index_get(v_link);
-
-      BM_elem_flag_disable(v_link, BM_ELEM_TAG);
-
-      /* keep in sync, avoid having to do full memcpy each iteration */
-      dists_prev[i] = dists[i];
       if (index != NULL) {
-        index_prev[i] = index[i];
+        index[i] = i;
       }
     }
+    bm->elem_index_dirty &= ~BM_VERT;
+  }
 
-    BLI_LINKSTACK_SWAP(queue, queue_next);
-
-    /* none should be tagged now since 'queue_next' is empty */
-    BLI_assert(BM_iter_mesh_count_flag(BM_VERTS_OF_MESH, bm, BM_ELEM_TAG, true) == 0);
-
-  } while (BLI_LINKSTACK_SIZE(queue));
+  struct ConnectivityDistData data = {
+      .mtx = mtx,
+      .dists = dists,
+      .index = index,
+  };
+  const int group_len = editmesh_connectivity_groups_calc(
+      bm, &data.group_verts, &data.group_index);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (bm->totvert >= TRANSDATA_THREAD_LIMIT);
+  settings.scheduling_mode = TASK_SCHEDULING_DYNAMIC;
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(
+      0, group_len, &data, editmesh_connectivity_distance_group_cb, &settings);
+
+  MEM_freeN(data.group_verts);
+  MEM_freeN(data.group_index);
+}
 
-  BLI_LINKSTACK_FREE(queue);
-  BLI_LINKSTACK_FREE(queue_next);
+/** \} */
 
-  MEM_freeN(dists_prev);
-  if (index_prev != NULL) {
-    MEM_freeN(index_prev);
-  }
-}
+/* -------------------------------------------------------------------- */
+/** \name Edit Mesh Verts Transform Creation
+ *
+ * \{ */
 
 static struct TransIslandData *editmesh_islands_info_calc(BMEditMesh *em,
                                                           int *r_island_tot,
@@ -637,6 +685,139 @@ static void VertsToTransData(TransInfo *t,
   }
 }
 
+struct TransDataArgs_EditVerts {
+  TransInfo *t;
+  TransDataContainer *tc;
+  BMEditMesh *em;
+  TransData *tob;
+  TransDataExtension *tx;
+  /** Element index of each vertex, -1 for vertices that aren't transformed. */
+  int *vert_tob_index;
+  int prop_mode;
+  int cd_vert_bweight_offset;
+  bool is_snap_rotate;
+  struct TransIslandData *island_info;
+  int *island_vert_map;
+  float *dists;
+  int *dists_index;
+  float (*quats)[4];
+  float (*defmats)[3][3];
+  float mtx[3][3], smtx[3][3];
+};
+
+static bool editmesh_vert_use_trans_data(BMVert *eve,
+                                         const int a,
+                                         const int prop_mode,
+                                         const BLI_bitmap *mirror_bitmap)
+{
+  if (BM_elem_flag_test(eve, BM_ELEM_HIDDEN)) {
+    return false;
+  }
+  if (mirror_bitmap && BLI_BITMAP_TEST(mirror_bitmap, a)) {
+    return false;
+  }
+  return prop_mode || BM_elem_flag_test(eve, BM_ELEM_SELECT);
+}
+
+static void editmesh_vert_to_trans_data(const struct TransDataArgs_EditVerts *data,
+                                        BMVert *eve,
+                                        const int a,
+                                        TransData *tob,
+                                        TransDataExtension *tx)
+{
+  TransInfo *t = data->t;
+  TransDataContainer *tc = data->tc;
+  const int prop_mode = data->prop_mode;
+  struct TransIslandData *v_island = NULL;
+  float *bweight = (data->cd_vert_bweight_offset != -1) ?
+                       BM_ELEM_CD_GET_VOID_P(eve, data->cd_vert_bweight_offset) :
+                       NULL;
+
+  if (data->island_info) {
+    const int connected_index = (data->dists_index && data->dists_index[a] != -1) ?
+                                    data->dists_index[a] :
+                                    a;
+    v_island = (data->island_vert_map[connected_index] != -1) ?
+                   &data->island_info[data->island_vert_map[connected_index]] :
+                   NULL;
+  }
+
+  /* Do not use the island center in case we are using islands
+   * only to get axis for snap/rotate to normal... */
+  VertsToTransData(t, tob, tx, data->em, eve, bweight, v_island, data->is_snap_rotate);
+
+  /* selected */
+  if (BM_elem_flag_test(eve, BM_ELEM_SELECT)) {
+    tob->flag |= TD_SELECTED;
+  }
+
+  if (prop_mode) {
+    if (prop_mode & T_PROP_CONNECTED) {
+      tob->dist = data->dists[a];
+    }
+    else {
+      tob->flag |= TD_NOTCONNECTED;
+      tob->dist = FLT_MAX;
+    }
+  }
+
+  /* CrazySpace */
+  const bool use_quats = data->quats && BM_elem_flag_test(eve, BM_ELEM_TAG);
+  if (use_quats || data->defmats) {
+    float mat[3][3], qmat[3][3], imat[3][3];
+
+    /* Use both or either quat and defmat correction. */
+    if (use_quats) {
+      quat_to_mat3(qmat, data->quats[BM_elem_index_get(eve)]);
+
+      if (data->defmats) {
+        mul_m3_series(mat, data->defmats[a], qmat, data->mtx);
+      }
+      else {
+        mul_m3_m3m3(mat, data->mtx, qmat);
+      }
+    }
+    else {
+      mul_m3_m3m3(mat, data->mtx, data->defmats[a]);
+    }
+
+    invert_m3_m3(imat, mat);
+
+    copy_m3_m3(tob->smtx, imat);
+    copy_m3_m3(tob->mtx, mat);
+  }
+  else {
+    copy_m3_m3(tob->smtx, data->smtx);
+    copy_m3_m3(tob->mtx, data->mtx);
+  }
+
+  if (tc->mirror.use_mirror_any) {
+    if (tc->mirror.axis_x && fabsf(tob->loc[0]) < TRANSFORM_MAXDIST_MIRROR) {
+      tob->flag |= TD_MIRROR_EDGE_X;
+    }
+    if (tc->mirror.axis_y && fabsf(tob->loc[1]) < TRANSFORM_MAXDIST_MIRROR) {
+      tob->flag |= TD_MIRROR_EDGE_Y;
+    }
+    if (tc->mirror.axis_z && fabsf(tob->loc[2]) < TRANSFORM_MAXDIST_MIRROR) {
+      tob->flag |= TD_MIRROR_EDGE_Z;
+    }
+  }
+}
+
+static void editmesh_verts_to_trans_data_fn(void *__restrict userdata,
+                                            const int a,
+                                            const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const struct TransDataArgs_EditVerts *data = userdata;
+  const int tob_index = data->vert_tob_index[a];
+  if (tob_index == -1) {
+    return;
+  }
+  BMVert *eve = BM_vert_at_index(data->em->bm, a);
+  editmesh_vert_to_trans_data(
+      data, eve, a, &data->tob[tob_index], data->tx ? &data->tx[tob_index] : NULL);
+}
+
 void createTransEditVerts(TransInfo *t)
 {
   FOREACH_TRANS_DATA_CONTAINER (t, tc) {
@@ -801,91 +982,53 @@ void createTransEditVerts(TransInfo *t)
       }
     }
 
-    BM_ITER_MESH_INDEX (eve, &iter, bm, BM_VERTS_OF_MESH, a) {
-      if (BM_elem_flag_test(eve, BM_ELEM_HIDDEN)) {
-        continue;
-      }
-      if (mirror_bitmap && BLI_BITMAP_TEST(mirror_bitmap, a)) {
-        continue;
+    struct TransDataArgs_EditVerts data = {
+        .t = t,
+        .tc = tc,
+        .em = em,
+        .tob = tob,
+        .tx = tx,
+        .prop_mode = prop_mode,
+        .cd_vert_bweight_offset = cd_vert_bweight_offset,
+        .is_snap_rotate = is_snap_rotate,
+        .island_info = island_info,
+        .island_vert_map = island_vert_map,
+        .dists = dists,
+        .dists_index = dists_index,
+        .quats = quats,
+        .defmats = defmats,
+    };
+    copy_m3_m3(data.mtx, mtx);
+    copy_m3_m3(data.smtx, smtx);
+
+    if (data_len >= TRANSDATA_THREAD_LIMIT) {
+      /* Find the element of each vertex first, then fill the elements in parallel. */
+      data.vert_tob_index = MEM_mallocN(sizeof(int) * bm->totvert, __func__);
+      int tob_index = 0;
+      BM_ITER_MESH_INDEX (eve, &iter, bm, BM_VERTS_OF_MESH, a) {
+        data.vert_tob_index[a] = editmesh_vert_use_trans_data(eve, a, prop_mode, mirror_bitmap) ?
+                                     tob_index++ :
+                                     -1;
       }
-      if (prop_mode || BM_elem_flag_test(eve, BM_ELEM_SELECT)) {
-        struct TransIslandData *v_island = NULL;
-        float *bweight = (cd_vert_bweight_offset != -1) ?
-                             BM_ELEM_CD_GET_VOID_P(eve, cd_vert_bweight_offset) :
-                             NULL;
-
-        if (island_info) {
-          const int connected_index = (dists_index && dists_index[a] != -1) ? dists_index[a] : a;
-          v_island = (island_vert_map[connected_index] != -1) ?
-                         &island_info[island_vert_map[connected_index]] :
-                         NULL;
-        }
-
-        /* Do not use the island center in case we are using islands
-         * only to get axis for snap/rotate to normal... */
-        VertsToTransData(t, tob, tx, em, eve, bweight, v_island, is_snap_rotate);
-        if (tx) {
-          tx++;
-        }
-
-        /* selected */
-        if (BM_elem_flag_test(eve, BM_ELEM_SELECT)) {
-          tob->flag |= TD_SELECTED;
-        }
-
-        if (prop_mode) {
-          if (prop_mode & T_PROP_CONNECTED) {
-            tob->dist = dists[a];
-          }
-          else {
-            tob->flag |= TD_NOTCONNECTED;
-            tob->dist = FLT_MAX;
-          }
-        }
-
-        /* CrazySpace */
-        const bool use_quats = quats && BM_elem_flag_test(eve, BM_ELEM_TAG);
-        if (use_quats || defmats) {
-          float mat[3][3], qmat[3][3], imat[3][3];
-
-          /* Use both or either quat and defmat correction. */
-          if (use_quats) {
-            quat_to_mat3(qmat, quats[BM_elem_index_get(eve)]);
-
-            if (defmats) {
-              mul_m3_series(mat, defmats[a], qmat, mtx);
-            }
-            else {
-              mul_m3_m3m3(mat, mtx, qmat);
-            }
-          }
-          else {
-            mul_m3_m3m3(mat, mtx, defmats[a]);
-          }
+      BLI_assert(tob_index == data_len);
 
-          invert_m3_m3(imat, mat);
+      BM_mesh_elem_table_ensure(bm, BM_VERT);
 
-          copy_m3_m3(tob->smtx, imat);
-          copy_m3_m3(tob->mtx, mat);
-        }
-        else {
-          copy_m3_m3(tob->smtx, smtx);
-          copy_m3_m3(tob->mtx, mtx);
-        }
+      TaskParallelSettings settings;
+      BLI_parallel_range_settings_defaults(&settings);
+      BLI_task_parallel_range(0, bm->totvert, &data, editmesh_verts_to_trans_data_fn, &settings);
 
-        if (tc->mirror.use_mirror_any) {
-          if (tc->mirror.axis_x && fabsf(tob->loc[0]) < TRANSFORM_MAXDIST_MIRROR) {
-            tob->flag |= TD_MIRROR_EDGE_X;
-          }
-          if (tc->mirror.axis_y && fabsf(tob->loc[1]) < TRANSFORM_MAXDIST_MIRROR) {
-            tob->flag |= TD_MIRROR_EDGE_Y;
-          }
-          if (tc->mirror.axis_z && fabsf(tob->loc[2]) < TRANSFORM_MAXDIST_MIRROR) {
-            tob->flag |= TD_MIRROR_EDGE_Z;
+      MEM_freeN(data.vert_tob_index);
+    }
+    else {
+      BM_ITER_MESH_INDEX (eve, &iter, bm, BM_VERTS_OF_MESH, a) {
+        if (editmesh_vert_use_trans_data(eve, a, prop_mode, mirror_bitmap)) {
+          editmesh_vert_to_trans_data(&data, eve, a, tob, tx);
+          if (tx) {
+            tx++;
           }
+          tob++;
         }
-
-        tob++;
       }
     }
 
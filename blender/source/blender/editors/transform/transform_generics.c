@@ -48,6 +48,7 @@
 #include "BLI_math.h"
 #include "BLI_blenlib.h"
 #include "BLI_rand.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "PIL_time.h"
@@ -128,6 +129,83 @@ void getViewVector(const TransInfo *t, const float coord[3], float vec[3])
 
 /* ************************** GENERICS **************************** */
 
+/**
+ * Per element callbacks of large edit-mode data (mesh, UV, curve points...) are run in
+ * parallel. Objects and bones evaluate constraints which are not thread safe.
+ */
+bool transdata_use_threading(const TransInfo *t, const TransDataContainer *tc)
+{
+  return (tc->data_len >= TRANSDATA_THREAD_LIMIT) && (t->flag & T_POINTS);
+}
+
+/**
+ * The amount of elements the per element loops handle. The serial loops stop at the first
+ * element tagged #TD_NOACTION, parallel ranges must stop there as well.
+ */
+int transdata_action_len(const TransDataContainer *tc)
+{
+  for (int i = 0; i < tc->data_len; i++) {
+    if (tc->data[i].flag & TD_NOACTION) {
+      return i;
+    }
+  }
+  return tc->data_len;
+}
+
+struct TransDataArgs_ClipMirror {
+  TransDataContainer *tc;
+  bool use_mirror_ob;
+  int axis;
+  float tolerance[3];
+  float mtx[4][4], imtx[4][4];
+};
+
+static void transdata_elem_clip_mirror_fn(void *__restrict iter_data_v,
+                                          const int iter,
+                                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const struct TransDataArgs_ClipMirror *data = iter_data_v;
+  TransData *td = &data->tc->data[iter];
+  const int axis = data->axis;
+  int clip;
+  float loc[3], iloc[3];
+
+  copy_v3_v3(loc, td->loc);
+  copy_v3_v3(iloc, td->iloc);
+
+  if (data->use_mirror_ob) {
+    mul_m4_v3(data->mtx, loc);
+    mul_m4_v3(data->mtx, iloc);
+  }
+
+  clip = 0;
+  if (axis & 1) {
+    if (fabsf(iloc[0]) <= data->tolerance[0] || loc[0] * iloc[0] < 0.0f) {
+      loc[0] = 0.0f;
+      clip = 1;
+    }
+  }
+
+  if (axis & 2) {
+    if (fabsf(iloc[1]) <= data->tolerance[1] || loc[1] * iloc[1] < 0.0f) {
+      loc[1] = 0.0f;
+      clip = 1;
+    }
+  }
+  if (axis & 4) {
+    if (fabsf(iloc[2]) <= data->tolerance[2] || loc[2] * iloc[2] < 0.0f) {
+      loc[2] = 0.0f;
+      clip = 1;
+    }
+  }
+  if (clip) {
+    if (data->use_mirror_ob) {
+      mul_m4_v3(data->imtx, loc);
+    }
+    copy_v3_v3(td->loc, loc);
+  }
+}
+
 static void clipMirrorModifier(TransInfo *t)
 {
   FOREACH_TRANS_DATA_CONTAINER (t, tc) {
@@ -155,68 +233,34 @@ static void clipMirrorModifier(TransInfo *t)
             tolerance[2] = mmd->tolerance;
           }
           if (axis) {
-            float mtx[4][4], imtx[4][4];
-            int i;
+            struct TransDataArgs_ClipMirror data = {
+                .tc = tc,
+                .use_mirror_ob = (mmd->mirror_ob != NULL),
+                .axis = axis,
+            };
+            copy_v3_v3(data.tolerance, tolerance);
 
             if (mmd->mirror_ob) {
               float obinv[4][4];
 
               invert_m4_m4(obinv, mmd->mirror_ob->obmat);
-              mul_m4_m4m4(mtx, obinv, ob->obmat);
-              invert_m4_m4(imtx, mtx);
+              mul_m4_m4m4(data.mtx, obinv, ob->obmat);
+              invert_m4_m4(data.imtx, data.mtx);
             }
 
-            TransData *td = tc->data;
-            for (i = 0; i < tc->data_len; i++, td++) {
-              int clip;
-              float loc[3], iloc[3];
-
-              if (td->flag & TD_NOACTION) {
-                break;
-              }
-              if (td->loc == NULL) {
+            TaskParallelSettings settings;
+            BLI_parallel_range_settings_defaults(&settings);
+            settings.use_threading = transdata_use_threading(t, tc);
+            /* Like the serial loop, stop at the first element without a location. */
+            int data_len = transdata_action_len(tc);
+            for (int i = 0; i < data_len; i++) {
+              if (tc->data[i].loc == NULL) {
+                data_len = i;
                 break;
               }
-
-              if (td->flag & TD_SKIP) {
-                continue;
-              }
-
-              copy_v3_v3(loc, td->loc);
-              copy_v3_v3(iloc, td->iloc);
-
-              if (mmd->mirror_ob) {
-                mul_m4_v3(mtx, loc);
-                mul_m4_v3(mtx, iloc);
-              }
-
-              clip = 0;
-              if (axis & 1) {
-                if (fabsf(iloc[0]) <= tolerance[0] || loc[0] * iloc[0] < 0.0f) {
-                  loc[0] = 0.0f;
-                  clip = 1;
-                }
-              }
-
-              if (axis & 2) {
-                if (fabsf(iloc[1]) <= tolerance[1] || loc[1] * iloc[1] < 0.0f) {
-                  loc[1] = 0.0f;
-                  clip = 1;
-                }
-              }
-              if (axis & 4) {
-                if (fabsf(iloc[2]) <= tolerance[2] || loc[2] * iloc[2] < 0.0f) {
-                  loc[2] = 0.0f;
-                  clip = 1;
-                }
-              }
-              if (clip) {
-                if (mmd->mirror_ob) {
-                  mul_m4_v3(imtx, loc);
-                }
-                copy_v3_v3(td->loc, loc);
-              }
             }
+
+            BLI_task_parallel_range(0, data_len, &data, transdata_elem_clip_mirror_fn, &settings);
           }
         }
       }
@@ -224,33 +268,51 @@ static void clipMirrorModifier(TransInfo *t)
   }
 }
 
+static void transdata_elem_mirror_edge_fn(void *__restrict iter_data_v,
+                                          const int iter,
+                                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  TransDataContainer *tc = iter_data_v;
+  TransData *td = &tc->data[iter];
+
+  if (td->flag & (TD_MIRROR_EDGE_X | TD_MIRROR_EDGE_Y | TD_MIRROR_EDGE_Z)) {
+    if (td->flag & TD_MIRROR_EDGE_X) {
+      td->loc[0] = 0.0f;
+    }
+    if (td->flag & TD_MIRROR_EDGE_Y) {
+      td->loc[1] = 0.0f;
+    }
+    if (td->flag & TD_MIRROR_EDGE_Z) {
+      td->loc[2] = 0.0f;
+    }
+  }
+}
+
+static void transdata_elem_mirror_fn(void *__restrict iter_data_v,
+                                     const int iter,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  TransDataContainer *tc = iter_data_v;
+  TransDataMirror *tdm = &tc->mirror.data[iter];
+
+  tdm->loc_dst[0] = tdm->loc_src[0] * tdm->sign_x;
+  tdm->loc_dst[1] = tdm->loc_src[1] * tdm->sign_y;
+  tdm->loc_dst[2] = tdm->loc_src[2] * tdm->sign_z;
+}
+
 /* assumes obedit set to mesh object */
 static void transform_apply_to_mirror(TransInfo *t)
 {
   FOREACH_TRANS_DATA_CONTAINER (t, tc) {
     if (tc->mirror.use_mirror_any) {
-      int i;
-      TransData *td;
-      for (i = 0, td = tc->data; i < tc->data_len; i++, td++) {
-        if (td->flag & (TD_MIRROR_EDGE_X | TD_MIRROR_EDGE_Y | TD_MIRROR_EDGE_Z)) {
-          if (td->flag & TD_MIRROR_EDGE_X) {
-            td->loc[0] = 0.0f;
-          }
-          if (td->flag & TD_MIRROR_EDGE_Y) {
-            td->loc[1] = 0.0f;
-          }
-          if (td->flag & TD_MIRROR_EDGE_Z) {
-            td->loc[2] = 0.0f;
-          }
-        }
-      }
+      TaskParallelSettings settings;
+      BLI_parallel_range_settings_defaults(&settings);
 
-      TransDataMirror *tdm;
-      for (i = 0, tdm = tc->mirror.data; i < tc->mirror.data_len; i++, tdm++) {
-        tdm->loc_dst[0] = tdm->loc_src[0] * tdm->sign_x;
-        tdm->loc_dst[1] = tdm->loc_src[1] * tdm->sign_y;
-        tdm->loc_dst[2] = tdm->loc_src[2] * tdm->sign_z;
-      }
+      settings.use_threading = transdata_use_threading(t, tc);
+      BLI_task_parallel_range(0, tc->data_len, tc, transdata_elem_mirror_edge_fn, &settings);
+
+      settings.use_threading = (tc->mirror.data_len >= TRANSDATA_THREAD_LIMIT);
+      BLI_task_parallel_range(0, tc->mirror.data_len, tc, transdata_elem_mirror_fn, &settings);
     }
   }
 }
@@ -39,6 +39,7 @@
 
 #include "BLI_math.h"
 #include "BLI_blenlib.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "GPU_immediate.h"
@@ -338,6 +339,9 @@ eRedrawFlag handleSnapping(TransInfo *t, const wmEvent *event)
 
 void applyProject(TransInfo *t)
 {
+  /* Stays single threaded, the snap object context builds and caches the BVH trees of the
+   * objects it casts against on demand. */
+
   /* XXX FLICKER IN OBJECT MODE */
   if ((t->tsnap.project) && activeSnap(t) && (t->flag & T_NO_PROJECT) == 0) {
     float tvec[3];
@@ -420,11 +424,54 @@ void applyProject(TransInfo *t)
   }
 }
 
+struct TransDataArgs_GridAbsolute {
+  TransInfo *t;
+  TransDataContainer *tc;
+  float grid_size;
+};
+
+static void transdata_elem_grid_absolute_fn(void *__restrict iter_data_v,
+                                            const int iter,
+                                            const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const struct TransDataArgs_GridAbsolute *data = iter_data_v;
+  TransInfo *t = data->t;
+  TransDataContainer *tc = data->tc;
+  TransData *td = &tc->data[iter];
+  float iloc[3], loc[3], tvec[3];
+
+  if (td->flag & TD_SKIP) {
+    return;
+  }
+
+  if ((t->flag & T_PROP_EDIT) && (td->factor == 0.0f)) {
+    return;
+  }
+
+  copy_v3_v3(iloc, td->loc);
+  if (tc->use_local_mat) {
+    mul_m4_v3(tc->mat, iloc);
+  }
+  else if (t->flag & T_OBJECT) {
+    BKE_object_eval_transform_all(t->depsgraph, t->scene, td->ob);
+    copy_v3_v3(iloc, td->ob->obmat[3]);
+  }
+
+  mul_v3_v3fl(loc, iloc, 1.0f / data->grid_size);
+  loc[0] = roundf(loc[0]);
+  loc[1] = roundf(loc[1]);
+  loc[2] = roundf(loc[2]);
+  mul_v3_fl(loc, data->grid_size);
+
+  sub_v3_v3v3(tvec, loc, iloc);
+  mul_m3_v3(td->smtx, tvec);
+  add_v3_v3(td->loc, tvec);
+}
+
 void applyGridAbsolute(TransInfo *t)
 {
   float grid_size = 0.0f;
   GearsType grid_action;
-  int i;
 
   if (!(activeSnap(t) && (t->tsnap.mode & (SCE_SNAP_MODE_INCREMENT | SCE_SNAP_MODE_GRID)))) {
     return;
@@ -452,42 +499,18 @@ void applyGridAbsolute(TransInfo *t)
   }
 
   FOREACH_TRANS_DATA_CONTAINER (t, tc) {
-    TransData *td;
-
-    for (i = 0, td = tc->data; i < tc->data_len; i++, td++) {
-      float iloc[3], loc[3], tvec[3];
-
-      if (td->flag & TD_NOACTION) {
-        break;
-      }
-
-      if (td->flag & TD_SKIP) {
-        continue;
-      }
-
-      if ((t->flag & T_PROP_EDIT) && (td->factor == 0.0f)) {
-        continue;
-      }
-
-      copy_v3_v3(iloc, td->loc);
-      if (tc->use_local_mat) {
-        mul_m4_v3(tc->mat, iloc);
-      }
-      else if (t->flag & T_OBJECT) {
-        BKE_object_eval_transform_all(t->depsgraph, t->scene, td->ob);
-        copy_v3_v3(iloc, td->ob->obmat[3]);
-      }
-
-      mul_v3_v3fl(loc, iloc, 1.0f / grid_size);
-      loc[0] = roundf(loc[0]);
-      loc[1] = roundf(loc[1]);
-      loc[2] = roundf(loc[2]);
-      mul_v3_fl(loc, grid_size);
-
-      sub_v3_v3v3(tvec, loc, iloc);
-      mul_m3_v3(td->smtx, tvec);
-      add_v3_v3(td->loc, tvec);
-    }
+    struct TransDataArgs_GridAbsolute data = {
+        .t = t,
+        .tc = tc,
+        .grid_size = grid_size,
+    };
+
+    /* Objects are evaluated on the way, only edit-mode data is snapped in parallel. */
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = transdata_use_threading(t, tc);
+    BLI_task_parallel_range(
+        0, transdata_action_len(tc), &data, transdata_elem_grid_absolute_fn, &settings);
   }
 }
 
@@ -29,6 +29,7 @@
 #include "BLI_convexhull_2d.h"
 #include "BLI_polyfill_2d.h"
 #include "BLI_polyfill_2d_beautify.h"
+#include "BLI_task.h"
 
 #include "uvedit_parametrizer.h"
 
@@ -203,6 +204,8 @@ typedef struct PChart {
 
 enum PChartFlag {
   PCHART_HAS_PINS = 1,
+  /** The LSCM matrix is factorized, solving again only needs the pinned UV's. */
+  PCHART_LSCM_FACTORIZED = 2,
 };
 
 enum PHandleState {
@@ -3231,6 +3234,28 @@ static PBool p_chart_lscm_solve(PHandle *handle, PChart *chart)
     }
   }
 
+  if (chart->flag & PCHART_LSCM_FACTORIZED) {
+    /* Live unwrap: the system doesn't change while pins are moved,
+     * re-solve with the factorization of the first solve. */
+    for (v = chart->verts; v; v = v->nextlink) {
+      if (v->flag & PVERT_PIN) {
+        EIG_linear_solver_variable_set(context, 0, 2 * v->u.id, v->uv[0]);
+        EIG_linear_solver_variable_set(context, 0, 2 * v->u.id + 1, v->uv[1]);
+      }
+    }
+
+    if (EIG_linear_solver_solve(context)) {
+      p_chart_lscm_load_solution(chart);
+      return P_TRUE;
+    }
+
+    for (v = chart->verts; v; v = v->nextlink) {
+      v->uv[0] = 0.0f;
+      v->uv[1] = 0.0f;
+    }
+    return P_FALSE;
+  }
+
   if (chart->u.lscm.pin1) {
     EIG_linear_solver_variable_lock(context, 2 * pin1->u.id);
     EIG_linear_solver_variable_lock(context, 2 * pin1->u.id + 1);
@@ -3343,6 +3368,7 @@ static PBool p_chart_lscm_solve(PHandle *handle, PChart *chart)
 
   if (EIG_linear_solver_solve(context)) {
     p_chart_lscm_load_solution(chart);
+    chart->flag |= PCHART_LSCM_FACTORIZED;
     return P_TRUE;
   }
   else {
@@ -3369,6 +3395,7 @@ static void p_chart_lscm_end(PChart *chart)
   chart->u.lscm.context = NULL;
   chart->u.lscm.pin1 = NULL;
   chart->u.lscm.pin2 = NULL;
+  chart->flag &= ~PCHART_LSCM_FACTORIZED;
 }
 
 /* Stretch */
@@ -4547,47 +4574,84 @@ void param_construct_end(ParamHandle *handle, ParamBool fill, ParamBool impl)
   phandle->state = PHANDLE_STATE_CONSTRUCTED;
 }
 
+/* Charts are independent, each one is set up and solved in its own task. */
+typedef struct PLscmTaskData {
+  PHandle *phandle;
+  PBool live, abf;
+} PLscmTaskData;
+
+static void p_lscm_task_settings(TaskParallelSettings *settings, const PHandle *phandle)
+{
+  BLI_parallel_range_settings_defaults(settings);
+  settings->use_threading = (phandle->ncharts > 1);
+  /* Chart sizes vary a lot. */
+  settings->scheduling_mode = TASK_SCHEDULING_DYNAMIC;
+}
+
+static void p_lscm_begin_chart_cb(void *__restrict userdata,
+                                  const int i,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const PLscmTaskData *data = userdata;
+  PChart *chart = data->phandle->charts[i];
+  PFace *f;
+
+  for (f = chart->faces; f; f = f->nextlink) {
+    p_face_backup_uvs(f);
+  }
+  p_chart_lscm_begin(chart, data->live, data->abf);
+}
+
 void param_lscm_begin(ParamHandle *handle, ParamBool live, ParamBool abf)
 {
   PHandle *phandle = (PHandle *)handle;
-  PFace *f;
-  int i;
 
   param_assert(phandle->state == PHANDLE_STATE_CONSTRUCTED);
   phandle->state = PHANDLE_STATE_LSCM;
 
-  for (i = 0; i < phandle->ncharts; i++) {
-    for (f = phandle->charts[i]->faces; f; f = f->nextlink) {
-      p_face_backup_uvs(f);
+  PLscmTaskData data = {
+      .phandle = phandle,
+      .live = (PBool)live,
+      .abf = (PBool)abf,
+  };
+  TaskParallelSettings settings;
+  p_lscm_task_settings(&settings, phandle);
+  BLI_task_parallel_range(0, phandle->ncharts, &data, p_lscm_begin_chart_cb, &settings);
+}
+
+static void p_lscm_solve_chart_cb(void *__restrict userdata,
+                                  const int i,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const PLscmTaskData *data = userdata;
+  PChart *chart = data->phandle->charts[i];
+  PBool result;
+
+  if (chart->u.lscm.context) {
+    result = p_chart_lscm_solve(data->phandle, chart);
+
+    if (result && !(chart->flag & PCHART_HAS_PINS)) {
+      p_chart_rotate_minimum_area(chart);
+    }
+
+    if (!result || (chart->u.lscm.pin1)) {
+      p_chart_lscm_end(chart);
     }
-    p_chart_lscm_begin(phandle->charts[i], (PBool)live, (PBool)abf);
   }
 }
 
 void param_lscm_solve(ParamHandle *handle)
 {
   PHandle *phandle = (PHandle *)handle;
-  PChart *chart;
-  int i;
-  PBool result;
 
   param_assert(phandle->state == PHANDLE_STATE_LSCM);
 
-  for (i = 0; i < phandle->ncharts; i++) {
-    chart = phandle->charts[i];
-
-    if (chart->u.lscm.context) {
-      result = p_chart_lscm_solve(phandle, chart);
-
-      if (result && !(chart->flag & PCHART_HAS_PINS)) {
-        p_chart_rotate_minimum_area(chart);
-      }
-
-      if (!result || (chart->u.lscm.pin1)) {
-        p_chart_lscm_end(chart);
-      }
-    }
-  }
+  PLscmTaskData data = {
+      .phandle = phandle,
+  };
+  TaskParallelSettings settings;
+  p_lscm_task_settings(&settings, phandle);
+  BLI_task_parallel_range(0, phandle->ncharts, &data, p_lscm_solve_chart_cb, &settings);
 }
 
 void param_lscm_end(ParamHandle *handle)
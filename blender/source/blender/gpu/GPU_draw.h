@@ -83,6 +83,16 @@ void GPU_free_images(struct Main *bmain);
 void GPU_free_images_anim(struct Main *bmain);
 void GPU_free_images_old(struct Main *bmain);
 
+/* Background image loading
+ * - textures of file images are prepared on worker threads,
+ *   a placeholder is used until they are uploaded */
+void GPU_set_image_load_async(bool enable);
+void GPU_image_load_update(void);
+bool GPU_image_load_pending(void);
+bool GPU_image_load_finished(void);
+unsigned int GPU_image_load_generation(void);
+void GPU_image_load_wait(struct Image *ima);
+
 /* smoke drawing functions */
 void GPU_free_smoke(struct SmokeModifierData *smd);
 void GPU_free_smoke_velocity(struct SmokeModifierData *smd);
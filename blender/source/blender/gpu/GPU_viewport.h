@@ -119,6 +119,9 @@ typedef struct GPUViewport {
 
   /* Profiling data */
   double cache_time;
+
+  /* Last seen GPU_image_load_generation. */
+  unsigned int image_load_generation;
 } GPUViewport;
 #else
 typedef struct GPUViewport GPUViewport;
@@ -148,6 +151,7 @@ double *GPU_viewport_cache_time_get(GPUViewport *viewport);
 
 void GPU_viewport_tag_update(GPUViewport *viewport);
 bool GPU_viewport_do_update(GPUViewport *viewport);
+bool GPU_viewport_image_load_check(GPUViewport *viewport);
 
 GPUTexture *GPU_viewport_color_texture(GPUViewport *viewport);
 
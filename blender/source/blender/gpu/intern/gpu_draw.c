@@ -33,6 +33,7 @@
 #include "BLI_blenlib.h"
 #include "BLI_linklist.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
@@ -71,11 +72,14 @@
 
 #include "PIL_time.h"
 
+#include "gpu_private.h"
+
 #ifdef WITH_SMOKE
 #  include "smoke_API.h"
 #endif
 
 static void gpu_free_image_immediate(Image *ima);
+static void gpu_image_load_cancel(Image *ima);
 
 //* Checking powers of two for images since OpenGL ES requires it */
 #ifdef WITH_DDS
@@ -116,7 +120,9 @@ static struct GPUTextureState {
   bool texpaint;
 
   float anisotropic;
-} GTS = {1, 0, 0, 1.0f};
+  /* load image textures in the background, see GPU_set_image_load_async */
+  bool image_load_async;
+} GTS = {1, 0, 0, 1.0f, 0};
 
 /* Mipmap settings */
 
@@ -461,6 +467,566 @@ static void gpu_texture_update_from_ibuf(Image *ima, ImBuf *ibuf, int x, int y,
   }
 }
 
+static GPUTexture *gpu_texture_from_blender_sync(Image *ima, ImageUser *iuser, int textarget)
+{
+  GPUTexture **tex = gpu_get_image_gputexture(ima, textarget);
+
+  /* check if we have a valid image buffer */
+  uint bindcode = 0;
+  ImBuf *ibuf = BKE_image_acquire_ibuf(ima, iuser, NULL);
+  if (ibuf == NULL) {
+    *tex = GPU_texture_from_bindcode(textarget, bindcode);
+    return *tex;
+  }
+
+  bindcode = gpu_texture_create_from_ibuf(ima, ibuf, textarget);
+
+  BKE_image_release_ibuf(ima, ibuf, NULL);
+
+  *tex = GPU_texture_from_bindcode(textarget, bindcode);
+
+  GPU_texture_orig_size_set(*tex, ibuf->x, ibuf->y);
+
+  return *tex;
+}
+
+/* -------------------------------------------------------------------- */
+/** \name Background Image Loading
+ *
+ * Decoding an image file, converting it to the texture colorspace and building
+ * its mipmaps can take a long time for large images. When enabled, textures of
+ * file images are prepared by a job on a worker thread and a placeholder is
+ * returned in the meantime. #GPU_image_load_update uploads finished jobs on the
+ * main thread, where the GL context lives.
+ *
+ * Jobs are owned by the main thread, workers only touch their own job.
+ * \{ */
+
+/* Maximum number of jobs running at the same time. */
+#define GPU_IMAGE_LOAD_MAX_JOBS 4
+/* Time spent uploading finished jobs per update, at least one job is uploaded. */
+#define GPU_IMAGE_LOAD_UPLOAD_TIME 0.01
+#define GPU_IMAGE_LOAD_MAX_MIPS 32
+
+typedef enum eGPUImageLoadState {
+  GPU_IMAGE_LOAD_QUEUED = 0,
+  GPU_IMAGE_LOAD_RUNNING,
+  GPU_IMAGE_LOAD_DONE,
+} eGPUImageLoadState;
+
+typedef struct GPUImageLoad {
+  struct GPUImageLoad *next, *prev;
+
+  Image *ima;
+  ImageUser iuser;
+  bool use_iuser;
+  /* Image was freed or changed, the result is discarded. */
+  bool cancelled;
+  eGPUImageLoadState state;
+
+  /* Settings copied on the main thread. */
+  short alpha_mode;
+  bool use_mipmap;
+
+  /* Preview of the image shown until the texture is uploaded, may be NULL. */
+  GPUTexture *placeholder;
+
+  /* Result, written by the worker. */
+  ImBuf *mips[GPU_IMAGE_LOAD_MAX_MIPS];
+  int mips_len;
+  int orig_size[2];
+  bool use_srgb;
+  /* Image can't be prepared in the background (DDS), upload it the regular way. */
+  bool use_sync;
+} GPUImageLoad;
+
+static struct {
+  TaskPool *pool;
+  ListBase jobs;
+  /* Shared placeholder for images without preview. */
+  GPUTexture *placeholder;
+  /* Number of textures uploaded so far, see #GPU_image_load_generation. */
+  uint generation;
+  /* Jobs finished since the last #GPU_image_load_finished, set by workers. */
+  bool finished;
+} image_load = {NULL};
+
+/* Protects the state of jobs. */
+static ThreadMutex image_load_mutex = BLI_MUTEX_INITIALIZER;
+/* Signaled with #image_load_mutex held whenever a job is done. */
+static ThreadCondition image_load_done_cond = PTHREAD_COND_INITIALIZER;
+/* Image files are loaded with the global image lock held, which is a spin lock.
+ * Only one job waits on it at a time so the others don't spin while they could
+ * convert the images they already have. */
+static ThreadMutex image_load_decode_mutex = BLI_MUTEX_INITIALIZER;
+
+static void gpu_image_load_free(GPUImageLoad *load)
+{
+  for (int i = 0; i < load->mips_len; i++) {
+    IMB_freeImBuf(load->mips[i]);
+  }
+  if (load->placeholder) {
+    GPU_texture_free(load->placeholder);
+  }
+  MEM_freeN(load);
+}
+
+static void gpu_image_load_convert(GPUImageLoad *load, ImBuf *ibuf)
+{
+#ifdef WITH_DDS
+  if (ibuf->ftype == IMB_FTYPE_DDS) {
+    load->use_sync = true;
+    return;
+  }
+#endif
+
+  /* Same conversion as #gpu_texture_create_from_ibuf, into a buffer owned by the
+   * job since the image buffer may be freed once released. */
+  ImBuf *tex_ibuf = NULL;
+
+  if (ibuf->rect_float == NULL) {
+    if (IMB_colormanagement_space_is_data(ibuf->rect_colorspace)) {
+      tex_ibuf = IMB_allocFromBuffer(ibuf->rect, NULL, ibuf->x, ibuf->y, 4);
+    }
+    else {
+      load->use_srgb = !IMB_colormanagement_space_is_scene_linear(ibuf->rect_colorspace);
+
+      tex_ibuf = IMB_allocImBuf(ibuf->x, ibuf->y, 32, IB_rect);
+      if (tex_ibuf) {
+        const bool store_premultiplied = (load->alpha_mode == IMA_ALPHA_PREMUL);
+        IMB_colormanagement_imbuf_to_byte_texture((uchar *)tex_ibuf->rect,
+                                                  0,
+                                                  0,
+                                                  ibuf->x,
+                                                  ibuf->y,
+                                                  ibuf,
+                                                  load->use_srgb,
+                                                  store_premultiplied);
+      }
+    }
+  }
+  else {
+    const bool store_premultiplied = (load->alpha_mode != IMA_ALPHA_STRAIGHT);
+
+    if (ibuf->channels != 4 || !store_premultiplied) {
+      tex_ibuf = IMB_allocImBuf(ibuf->x, ibuf->y, 32, IB_rectfloat);
+      if (tex_ibuf) {
+        IMB_colormanagement_imbuf_to_float_texture(
+            tex_ibuf->rect_float, 0, 0, ibuf->x, ibuf->y, ibuf, store_premultiplied);
+      }
+    }
+    else {
+      tex_ibuf = IMB_allocFromBuffer(NULL, ibuf->rect_float, ibuf->x, ibuf->y, 4);
+    }
+  }
+
+  if (tex_ibuf == NULL) {
+    load->use_sync = true;
+    return;
+  }
+
+  load->orig_size[0] = ibuf->x;
+  load->orig_size[1] = ibuf->y;
+
+  if (is_over_resolution_limit(GL_TEXTURE_2D, ibuf->x, ibuf->y)) {
+    IMB_scaleImBuf(
+        tex_ibuf, smaller_power_of_2_limit(ibuf->x), smaller_power_of_2_limit(ibuf->y));
+  }
+
+  load->mips[0] = tex_ibuf;
+  load->mips_len = 1;
+
+  /* Byte textures stored with the sRGB transfer function are left to the driver,
+   * so their mipmaps are filtered in linear space. */
+  if (load->use_mipmap && !load->use_srgb) {
+    while (load->mips_len < GPU_IMAGE_LOAD_MAX_MIPS) {
+      ImBuf *mip = load->mips[load->mips_len - 1];
+      if (mip->x <= 1 && mip->y <= 1) {
+        break;
+      }
+      load->mips[load->mips_len++] = IMB_onehalf(mip);
+    }
+  }
+}
+
+static void gpu_image_load_task(TaskPool *__restrict UNUSED(pool),
+                                void *taskdata,
+                                int UNUSED(threadid))
+{
+  GPUImageLoad *load = taskdata;
+
+  BLI_mutex_lock(&image_load_mutex);
+  const bool cancelled = load->cancelled;
+  BLI_mutex_unlock(&image_load_mutex);
+
+  if (!cancelled) {
+    ImageUser *iuser = load->use_iuser ? &load->iuser : NULL;
+
+    BLI_mutex_lock(&image_load_decode_mutex);
+    ImBuf *ibuf = BKE_image_acquire_ibuf(load->ima, iuser, NULL);
+    BLI_mutex_unlock(&image_load_decode_mutex);
+
+    if (ibuf) {
+      gpu_image_load_convert(load, ibuf);
+      BKE_image_release_ibuf(load->ima, ibuf, NULL);
+    }
+  }
+
+  BLI_mutex_lock(&image_load_mutex);
+  load->state = GPU_IMAGE_LOAD_DONE;
+  image_load.finished = true;
+  BLI_condition_notify_all(&image_load_done_cond);
+  BLI_mutex_unlock(&image_load_mutex);
+}
+
+static void gpu_image_load_schedule(void)
+{
+  int running = 0;
+
+  BLI_mutex_lock(&image_load_mutex);
+  for (GPUImageLoad *load = image_load.jobs.first; load; load = load->next) {
+    if (load->state == GPU_IMAGE_LOAD_RUNNING) {
+      running++;
+    }
+  }
+  for (GPUImageLoad *load = image_load.jobs.first; load && running < GPU_IMAGE_LOAD_MAX_JOBS;
+       load = load->next) {
+    if (load->state == GPU_IMAGE_LOAD_QUEUED) {
+      load->state = GPU_IMAGE_LOAD_RUNNING;
+      BLI_task_pool_push(image_load.pool, gpu_image_load_task, load, false, TASK_PRIORITY_LOW);
+      running++;
+    }
+  }
+  BLI_mutex_unlock(&image_load_mutex);
+}
+
+static GPUImageLoad *gpu_image_load_find(Image *ima)
+{
+  for (GPUImageLoad *load = image_load.jobs.first; load; load = load->next) {
+    if (load->ima == ima && !load->cancelled) {
+      return load;
+    }
+  }
+  return NULL;
+}
+
+static GPUTexture *gpu_image_load_placeholder_create(Image *ima)
+{
+  uint bindcode = 0;
+  PreviewImage *prv = ima->preview;
+
+  if (prv && prv->rect[ICON_SIZE_PREVIEW] && prv->w[ICON_SIZE_PREVIEW] > 0 &&
+      prv->h[ICON_SIZE_PREVIEW] > 0) {
+    /* Previews are display referred byte images, close enough to sRGB. */
+    GPU_create_gl_tex(&bindcode,
+                      prv->rect[ICON_SIZE_PREVIEW],
+                      NULL,
+                      (int)prv->w[ICON_SIZE_PREVIEW],
+                      (int)prv->h[ICON_SIZE_PREVIEW],
+                      GL_TEXTURE_2D,
+                      false,
+                      true,
+                      NULL);
+    return GPU_texture_from_bindcode(GL_TEXTURE_2D, bindcode);
+  }
+
+  return NULL;
+}
+
+static GPUTexture *gpu_image_load_placeholder_default(void)
+{
+  if (image_load.placeholder == NULL) {
+    uchar color[4] = {128, 128, 128, 255};
+    uint bindcode = 0;
+    GPU_create_gl_tex(&bindcode, (uint *)color, NULL, 1, 1, GL_TEXTURE_2D, false, true, NULL);
+    image_load.placeholder = GPU_texture_from_bindcode(GL_TEXTURE_2D, bindcode);
+  }
+  return image_load.placeholder;
+}
+
+static bool gpu_image_load_use(Image *ima, int textarget)
+{
+  /* Generated, viewer and render result images are cheap to get or must be up to
+   * date, sequences and movies need the current frame. Multilayer images are left
+   * out, their buffers point into the render result which can be freed while the
+   * job converts them. */
+  if (!(GTS.image_load_async && !G.background && textarget == GL_TEXTURE_2D &&
+        BLI_thread_is_main() && ima->source == IMA_SRC_FILE && ima->type == IMA_TYPE_IMAGE)) {
+    return false;
+  }
+  /* Images only become multilayer once the file is loaded, until then load OpenEXR files
+   * here, so the type is known before any job touches them. */
+  if (BLI_path_extension_check(ima->name, ".exr") && !BKE_image_has_loaded_ibuf(ima)) {
+    return false;
+  }
+  return true;
+}
+
+static GPUTexture *gpu_image_load_begin(Image *ima, ImageUser *iuser)
+{
+  GPUImageLoad *load = gpu_image_load_find(ima);
+
+  if (load == NULL) {
+    if (image_load.pool == NULL) {
+      image_load.pool = BLI_task_pool_create_background(BLI_task_scheduler_get(), NULL);
+    }
+
+    load = MEM_callocN(sizeof(*load), __func__);
+    load->ima = ima;
+    if (iuser) {
+      load->iuser = *iuser;
+      load->use_iuser = true;
+    }
+    load->alpha_mode = ima->alpha_mode;
+    load->use_mipmap = GPU_get_mipmap();
+    load->placeholder = gpu_image_load_placeholder_create(ima);
+
+    BLI_mutex_lock(&image_load_mutex);
+    BLI_addtail(&image_load.jobs, load);
+    BLI_mutex_unlock(&image_load_mutex);
+
+    gpu_image_load_schedule();
+  }
+
+  return (load->placeholder) ? load->placeholder : gpu_image_load_placeholder_default();
+}
+
+static void gpu_image_load_upload(GPUImageLoad *load)
+{
+  Image *ima = load->ima;
+  GPUTexture **tex = gpu_get_image_gputexture(ima, GL_TEXTURE_2D);
+
+  if (*tex) {
+    /* Loaded some other way in the meantime. */
+    return;
+  }
+
+  if (load->use_sync) {
+    gpu_texture_from_blender_sync(ima, load->use_iuser ? &load->iuser : NULL, GL_TEXTURE_2D);
+    return;
+  }
+
+  if (load->mips_len == 0) {
+    /* No valid image buffer, return a dummy texture so we don't keep trying. */
+    *tex = GPU_texture_from_bindcode(GL_TEXTURE_2D, 0);
+    return;
+  }
+
+  const bool use_float = (load->mips[0]->rect_float != NULL);
+  GLenum internal_format = (use_float) ? GL_RGBA16F :
+                                         (load->use_srgb) ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+  uint bindcode = 0;
+
+  glGenTextures(1, (GLuint *)&bindcode);
+  glBindTexture(GL_TEXTURE_2D, bindcode);
+
+  for (int level = 0; level < load->mips_len; level++) {
+    ImBuf *mip = load->mips[level];
+    if (use_float) {
+      glTexImage2D(GL_TEXTURE_2D,
+                   level,
+                   internal_format,
+                   mip->x,
+                   mip->y,
+                   0,
+                   GL_RGBA,
+                   GL_FLOAT,
+                   mip->rect_float);
+    }
+    else {
+      glTexImage2D(GL_TEXTURE_2D,
+                   level,
+                   internal_format,
+                   mip->x,
+                   mip->y,
+                   0,
+                   GL_RGBA,
+                   GL_UNSIGNED_BYTE,
+                   mip->rect);
+    }
+  }
+
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, gpu_get_mipmap_filter(1));
+
+  if (load->use_mipmap) {
+    if (load->mips_len == 1) {
+      glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, gpu_get_mipmap_filter(0));
+    ima->gpuflag |= IMA_GPU_MIPMAP_COMPLETE;
+  }
+  else {
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  }
+
+  if (GLEW_EXT_texture_filter_anisotropic) {
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, GPU_get_anisotropic());
+  }
+
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  *tex = GPU_texture_from_bindcode(GL_TEXTURE_2D, bindcode);
+  GPU_texture_orig_size_set(*tex, load->orig_size[0], load->orig_size[1]);
+}
+
+/* Discard the job of an image, running jobs are only flagged since the caller
+ * may hold the image lock the worker is waiting on. */
+static void gpu_image_load_cancel(Image *ima)
+{
+  if (image_load.pool == NULL || !BLI_thread_is_main()) {
+    return;
+  }
+
+  BLI_mutex_lock(&image_load_mutex);
+  GPUImageLoad *load = gpu_image_load_find(ima);
+  if (load) {
+    if (load->state == GPU_IMAGE_LOAD_RUNNING) {
+      load->cancelled = true;
+      load = NULL;
+    }
+    else {
+      BLI_remlink(&image_load.jobs, load);
+    }
+  }
+  BLI_mutex_unlock(&image_load_mutex);
+
+  if (load) {
+    gpu_image_load_free(load);
+  }
+}
+
+/* Load textures of file images in the background while enabled, only used for
+ * drawing in the viewport where a placeholder can be shown for a while. */
+void GPU_set_image_load_async(bool enable)
+{
+  GTS.image_load_async = enable;
+}
+
+/* Upload textures of finished jobs and start queued ones, main thread only. */
+void GPU_image_load_update(void)
+{
+  if (image_load.pool == NULL || !BLI_thread_is_main()) {
+    return;
+  }
+
+  const double start_time = PIL_check_seconds_timer();
+  bool uploaded = false;
+
+  GPUImageLoad *load = image_load.jobs.first;
+  while (load) {
+    GPUImageLoad *load_next = load->next;
+
+    BLI_mutex_lock(&image_load_mutex);
+    const bool done = (load->state == GPU_IMAGE_LOAD_DONE);
+    BLI_mutex_unlock(&image_load_mutex);
+
+    if (done && !load->cancelled) {
+      if (uploaded && PIL_check_seconds_timer() - start_time > GPU_IMAGE_LOAD_UPLOAD_TIME) {
+        break;
+      }
+      gpu_image_load_upload(load);
+      image_load.generation++;
+      uploaded = true;
+    }
+
+    if (done) {
+      BLI_mutex_lock(&image_load_mutex);
+      BLI_remlink(&image_load.jobs, load);
+      BLI_mutex_unlock(&image_load_mutex);
+      gpu_image_load_free(load);
+    }
+
+    load = load_next;
+  }
+
+  gpu_image_load_schedule();
+}
+
+/* Finished jobs are left for the next update once its time is used up,
+ * drawing should be refreshed until they are uploaded. */
+bool GPU_image_load_pending(void)
+{
+  bool pending = false;
+
+  BLI_mutex_lock(&image_load_mutex);
+  for (GPUImageLoad *load = image_load.jobs.first; load; load = load->next) {
+    if (load->state == GPU_IMAGE_LOAD_DONE) {
+      pending = true;
+      break;
+    }
+  }
+  BLI_mutex_unlock(&image_load_mutex);
+
+  return pending;
+}
+
+/* Jobs finished since the last call, checked by the window manager in its main loop
+ * to redraw the viewports that upload them. Main thread only. */
+bool GPU_image_load_finished(void)
+{
+  if (image_load.pool == NULL) {
+    return false;
+  }
+
+  BLI_mutex_lock(&image_load_mutex);
+  const bool finished = image_load.finished;
+  image_load.finished = false;
+  BLI_mutex_unlock(&image_load_mutex);
+
+  return finished;
+}
+
+/* Changes every time a texture loaded in the background is uploaded. */
+uint GPU_image_load_generation(void)
+{
+  return image_load.generation;
+}
+
+/* Wait for a job still reading from the image, needed before freeing it.
+ * Must not be called with the image lock held. */
+void GPU_image_load_wait(Image *ima)
+{
+  if (image_load.pool == NULL || !BLI_thread_is_main()) {
+    return;
+  }
+
+  BLI_mutex_lock(&image_load_mutex);
+  bool running;
+  do {
+    running = false;
+    for (GPUImageLoad *load = image_load.jobs.first; load; load = load->next) {
+      if (load->ima == ima && load->state == GPU_IMAGE_LOAD_RUNNING) {
+        running = true;
+        break;
+      }
+    }
+    if (running) {
+      BLI_condition_wait(&image_load_done_cond, &image_load_mutex);
+    }
+  } while (running);
+  BLI_mutex_unlock(&image_load_mutex);
+}
+
+void gpu_image_load_exit(void)
+{
+  if (image_load.pool) {
+    BLI_task_pool_work_and_wait(image_load.pool);
+    BLI_task_pool_free(image_load.pool);
+    image_load.pool = NULL;
+  }
+
+  while (image_load.jobs.first) {
+    gpu_image_load_free(BLI_pophead(&image_load.jobs));
+  }
+
+  if (image_load.placeholder) {
+    GPU_texture_free(image_load.placeholder);
+    image_load.placeholder = NULL;
+  }
+}
+
+/** \} */
+
 GPUTexture *GPU_texture_from_blender(Image *ima, ImageUser *iuser, int textarget)
 {
   if (ima == NULL) {
@@ -484,28 +1050,18 @@ GPUTexture *GPU_texture_from_blender(Image *ima, ImageUser *iuser, int textarget
 
   /* Check if we have a valid image. If not, we return a dummy
    * texture with zero bindcode so we don't keep trying. */
-  uint bindcode = 0;
   if (ima->ok == 0) {
-    *tex = GPU_texture_from_bindcode(textarget, bindcode);
+    *tex = GPU_texture_from_bindcode(textarget, 0);
     return *tex;
   }
 
-  /* check if we have a valid image buffer */
-  ImBuf *ibuf = BKE_image_acquire_ibuf(ima, iuser, NULL);
-  if (ibuf == NULL) {
-    *tex = GPU_texture_from_bindcode(textarget, bindcode);
-    return *tex;
+  if (gpu_image_load_use(ima, textarget)) {
+    return gpu_image_load_begin(ima, iuser);
   }
 
-  bindcode = gpu_texture_create_from_ibuf(ima, ibuf, textarget);
-
-  BKE_image_release_ibuf(ima, ibuf, NULL);
-
-  *tex = GPU_texture_from_bindcode(textarget, bindcode);
+  gpu_image_load_cancel(ima);
 
-  GPU_texture_orig_size_set(*tex, ibuf->x, ibuf->y);
-
-  return *tex;
+  return gpu_texture_from_blender_sync(ima, iuser, textarget);
 }
 
 GPUTexture *GPU_texture_from_movieclip(MovieClip *clip, MovieClipUser *cuser, int textarget)
@@ -1323,6 +1879,8 @@ void GPU_free_unused_buffers(Main *bmain)
 
 static void gpu_free_image_immediate(Image *ima)
 {
+  gpu_image_load_cancel(ima);
+
   for (int i = 0; i < TEXTARGET_COUNT; i++) {
     /* free glsl image binding */
     if (ima->gputexture[i]) {
@@ -69,6 +69,8 @@ void GPU_exit(void)
 {
   gpu_pbvh_exit();
 
+  gpu_image_load_exit();
+
   if (!G.background) {
     immDestroy();
   }
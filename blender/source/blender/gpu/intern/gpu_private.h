@@ -33,6 +33,9 @@ void gpu_extensions_exit(void);
 void gpu_debug_init(void);
 void gpu_debug_exit(void);
 
+/* gpu_draw.c */
+void gpu_image_load_exit(void);
+
 /* gpu_framebuffer.c */
 void gpu_framebuffer_module_init(void);
 void gpu_framebuffer_module_exit(void);
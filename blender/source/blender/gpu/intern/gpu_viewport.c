@@ -34,6 +34,7 @@
 #include "DNA_vec_types.h"
 #include "DNA_userdef_types.h"
 
+#include "GPU_draw.h"
 #include "GPU_framebuffer.h"
 #include "GPU_glew.h"
 #include "GPU_immediate.h"
@@ -87,6 +88,9 @@ struct GPUViewport {
 
   /* Profiling data */
   double cache_time;
+
+  /* Last seen GPU_image_load_generation. */
+  uint image_load_generation;
 };
 #endif
 
@@ -115,6 +119,15 @@ bool GPU_viewport_do_update(GPUViewport *viewport)
   return ret;
 }
 
+/* Returns true when textures loaded in the background arrived since the last call. */
+bool GPU_viewport_image_load_check(GPUViewport *viewport)
+{
+  const uint generation = GPU_image_load_generation();
+  bool ret = (viewport->image_load_generation != generation);
+  viewport->image_load_generation = generation;
+  return ret;
+}
+
 GPUViewport *GPU_viewport_create(void)
 {
   GPUViewport *viewport = MEM_callocN(sizeof(GPUViewport), "GPUViewport");
@@ -288,6 +288,15 @@ void IMB_partial_display_buffer_update_threaded(
 void IMB_partial_display_buffer_update_delayed(
     struct ImBuf *ibuf, int xmin, int ymin, int xmax, int ymax);
 
+void IMB_partial_display_buffer_update_delayed_view(
+    struct ImBuf *ibuf,
+    const struct ColorManagedViewSettings *view_settings,
+    const struct ColorManagedDisplaySettings *display_settings,
+    int xmin,
+    int ymin,
+    int xmax,
+    int ymax);
+
 /* ** Pixel processor functions ** */
 struct ColormanageProcessor *IMB_colormanagement_display_processor_new(
     const struct ColorManagedViewSettings *view_settings,
@@ -396,6 +396,13 @@ struct ImBuf *IMB_anim_previewframe(struct anim *anim);
  */
 void IMB_free_anim(struct anim *anim);
 
+/**
+ * Free the frames decoded ahead for all movies, called when playback stops.
+ *
+ * \attention Defined in anim_movie.c
+ */
+void IMB_anim_decode_ahead_release_all(void);
+
 /**
  *
  * \attention Defined in filter.c
@@ -440,6 +447,22 @@ struct ImBuf *IMB_onehalf(struct ImBuf *ibuf1);
  */
 bool IMB_scaleImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy);
 
+typedef enum eIMBScaleFilter {
+  /* Area average when scaling down, linear interpolation when scaling up. */
+  IMB_SCALE_FILTER_BOX = 0,
+  IMB_SCALE_FILTER_BILINEAR = 1,
+  IMB_SCALE_FILTER_LANCZOS = 2,
+} eIMBScaleFilter;
+
+/**
+ *
+ * \attention Defined in scaling.c
+ */
+bool IMB_scaleImBuf_filter(struct ImBuf *ibuf,
+                           unsigned int newx,
+                           unsigned int newy,
+                           eIMBScaleFilter filter);
+
 /**
  *
  * \attention Defined in scaling.c
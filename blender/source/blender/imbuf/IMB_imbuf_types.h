@@ -291,6 +291,8 @@ enum {
   IB_alphamode_ignore = 1 << 15,
   IB_thumbnail = 1 << 16,
   IB_multiview = 1 << 17,
+  /** multilayer passes are read on demand, see #IMB_exr_begin_read_lazy */
+  IB_multilayer_lazy = 1 << 18,
 };
 
 /** \} */
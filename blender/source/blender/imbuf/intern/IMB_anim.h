@@ -84,6 +84,7 @@
 struct IDProperty;
 struct _AviMovie;
 struct anim_index;
+struct anim_decode_ahead;
 
 struct anim {
   int ib_flags;
@@ -137,6 +138,9 @@ struct anim {
   int64_t last_pts;
   int64_t next_pts;
   AVPacket next_packet;
+
+  /* Frames decoded in the background around the last requested one, see anim_movie.c. */
+  struct anim_decode_ahead *decode_ahead;
 #endif
 
   char index_dir[768];
@@ -153,4 +157,10 @@ struct anim {
   struct IDProperty *metadata;
 };
 
+/* Decode-ahead worker of FFmpeg anims, see anim_movie.c. The decoder state and the indices are
+ * shared with the worker, access them under the decode lock once the anim is read from. */
+void imb_anim_decode_ahead_release(struct anim *anim);
+void imb_anim_decode_lock(struct anim *anim);
+void imb_anim_decode_unlock(struct anim *anim);
+
 #endif
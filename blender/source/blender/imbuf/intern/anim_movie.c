@@ -59,8 +59,11 @@
 #endif
 
 #include "BLI_utildefines.h"
+#include "BLI_listbase.h"
 #include "BLI_string.h"
 #include "BLI_path_util.h"
+#include "BLI_math_base.h"
+#include "BLI_threads.h"
 
 #include "MEM_guardedalloc.h"
 
@@ -205,6 +208,7 @@ static void free_anim_avi(struct anim *anim)
 
 #ifdef WITH_FFMPEG
 static void free_anim_ffmpeg(struct anim *anim);
+static void anim_decode_ahead_release_all(void);
 #endif
 
 void IMB_free_anim(struct anim *anim)
@@ -229,6 +233,27 @@ void IMB_free_anim(struct anim *anim)
   MEM_freeN(anim);
 }
 
+void IMB_anim_decode_ahead_release_all(void)
+{
+#ifdef WITH_FFMPEG
+  anim_decode_ahead_release_all();
+#endif
+}
+
+#ifndef WITH_FFMPEG
+void imb_anim_decode_ahead_release(struct anim *UNUSED(anim))
+{
+}
+
+void imb_anim_decode_lock(struct anim *UNUSED(anim))
+{
+}
+
+void imb_anim_decode_unlock(struct anim *UNUSED(anim))
+{
+}
+#endif
+
 void IMB_close_anim(struct anim *anim)
 {
   if (anim == NULL) {
@@ -559,6 +584,19 @@ static int startffmpeg(struct anim *anim)
 
   pCodecCtx->workaround_bugs = 1;
 
+  /* Let the decoder use all cores, scanning forward from a key frame after a seek is the
+   * most expensive part of fetching a random frame. */
+  pCodecCtx->thread_count = BLI_system_thread_count();
+  if (pCodec->capabilities & AV_CODEC_CAP_AUTO_THREADS) {
+    pCodecCtx->thread_count = 0;
+  }
+  if (pCodec->capabilities & AV_CODEC_CAP_FRAME_THREADS) {
+    pCodecCtx->thread_type = FF_THREAD_FRAME;
+  }
+  else if (pCodec->capabilities & AV_CODEC_CAP_SLICE_THREADS) {
+    pCodecCtx->thread_type = FF_THREAD_SLICE;
+  }
+
   if (avcodec_open2(pCodecCtx, pCodec, NULL) < 0) {
     avformat_close_input(&pFormatCtx);
     return -1;
@@ -1207,12 +1245,443 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
   return anim->last_frame;
 }
 
+/* -------------------------------------------------------------------- */
+/* Decode-ahead
+ *
+ * Once an anim is read frame after frame (playback, rendering, scrubbing one frame at a time) a
+ * worker thread keeps decoding a small window of frames around the last requested one. Requests
+ * inside the window are served from memory without touching the decoder, anything else is
+ * decoded on the calling thread like before. The decoder state of the anim is shared, so both
+ * sides hold decode_mutex while they use it.
+ *
+ * The worker and its frames are released again when playback stops, see
+ * IMB_anim_decode_ahead_release_all(), and when the anim is freed.
+ */
+
+/* Upper bound for the memory used by the frames of all windows together. A window reserves its
+ * frames when its worker starts and gives them back when released, anims that can't get the
+ * minimum number of frames don't decode ahead. */
+#define ANIM_DECODE_AHEAD_MEM_LIMIT (256 * 1024 * 1024)
+#define ANIM_DECODE_AHEAD_FRAMES_MIN 3
+#define ANIM_DECODE_AHEAD_FRAMES_MAX 16
+
+typedef struct AnimDecodedFrame {
+  struct ImBuf *ibuf;
+  int position;
+} AnimDecodedFrame;
+
+struct anim_decode_ahead {
+  struct anim_decode_ahead *next, *prev;
+  struct anim *anim;
+
+  /* Guards the FFmpeg decoder state of the anim. */
+  ThreadMutex decode_mutex;
+
+  /* Guards everything below. */
+  ThreadMutex mutex;
+  ThreadCondition cond;
+  ListBase threads;
+  bool running, stop;
+  /* Set when decoding a frame of the window failed, cleared when the playhead moves. */
+  bool stalled;
+
+  IMB_Timecode_Type tc;
+  int playhead;
+  int direction;
+  /* Positions [run_next, run_end) still to be decoded in one go when playing backwards. */
+  int run_next, run_end;
+
+  AnimDecodedFrame frames[ANIM_DECODE_AHEAD_FRAMES_MAX];
+  /* Frames reserved from the memory budget, 0 while the worker isn't running. */
+  int frames_len;
+  size_t frame_size;
+};
+
+/* All windows, so they can be released when playback stops. */
+static ListBase anim_decode_ahead_list = {NULL, NULL};
+static ThreadMutex anim_decode_ahead_list_mutex = BLI_MUTEX_INITIALIZER;
+
+/* Memory reserved by all windows, see ANIM_DECODE_AHEAD_MEM_LIMIT. */
+static size_t anim_decode_ahead_mem_used = 0;
+static ThreadMutex anim_decode_ahead_mem_mutex = BLI_MUTEX_INITIALIZER;
+
+static struct anim_decode_ahead *anim_decode_ahead_create(struct anim *anim)
+{
+  struct anim_decode_ahead *da = MEM_callocN(sizeof(*da), "anim decode ahead");
+
+  da->anim = anim;
+  BLI_mutex_init(&da->decode_mutex);
+  BLI_mutex_init(&da->mutex);
+  BLI_condition_init(&da->cond);
+
+  da->tc = IMB_TC_NONE;
+  da->playhead = -1;
+  da->direction = 1;
+  da->frame_size = max_zz((size_t)anim->x * (size_t)anim->y * 4, 1);
+
+  BLI_mutex_lock(&anim_decode_ahead_list_mutex);
+  BLI_addtail(&anim_decode_ahead_list, da);
+  BLI_mutex_unlock(&anim_decode_ahead_list_mutex);
+
+  return da;
+}
+
+/* Reserve the frames of the window from the memory budget shared by all anims, returns false
+ * when not enough of it is left. */
+static bool anim_decode_ahead_reserve(struct anim_decode_ahead *da)
+{
+  BLI_mutex_lock(&anim_decode_ahead_mem_mutex);
+  const size_t mem_free = ANIM_DECODE_AHEAD_MEM_LIMIT - anim_decode_ahead_mem_used;
+  const int frames_len = (int)min_zz(mem_free / da->frame_size, ANIM_DECODE_AHEAD_FRAMES_MAX);
+  if (frames_len >= ANIM_DECODE_AHEAD_FRAMES_MIN) {
+    anim_decode_ahead_mem_used += (size_t)frames_len * da->frame_size;
+    da->frames_len = frames_len;
+  }
+  BLI_mutex_unlock(&anim_decode_ahead_mem_mutex);
+
+  return da->frames_len != 0;
+}
+
+static void anim_decode_ahead_unreserve(struct anim_decode_ahead *da)
+{
+  BLI_mutex_lock(&anim_decode_ahead_mem_mutex);
+  anim_decode_ahead_mem_used -= (size_t)da->frames_len * da->frame_size;
+  BLI_mutex_unlock(&anim_decode_ahead_mem_mutex);
+
+  da->frames_len = 0;
+}
+
+static void anim_decode_ahead_clear(struct anim_decode_ahead *da)
+{
+  for (int i = 0; i < da->frames_len; i++) {
+    if (da->frames[i].ibuf) {
+      IMB_freeImBuf(da->frames[i].ibuf);
+      da->frames[i].ibuf = NULL;
+    }
+  }
+  da->run_next = da->run_end = 0;
+}
+
+/* Range of positions worth keeping, most of it in the direction the playhead moves. */
+static void anim_decode_ahead_window(const struct anim_decode_ahead *da,
+                                     int *r_first,
+                                     int *r_last)
+{
+  int ahead = (da->frames_len * 3) / 4;
+  int behind = da->frames_len - 1 - ahead;
+
+  if (da->direction < 0) {
+    SWAP(int, ahead, behind);
+  }
+
+  *r_first = max_ii(da->playhead - behind, 0);
+  *r_last = min_ii(da->playhead + ahead, da->anim->duration_in_frames - 1);
+}
+
+static AnimDecodedFrame *anim_decode_ahead_find(struct anim_decode_ahead *da, int position)
+{
+  for (int i = 0; i < da->frames_len; i++) {
+    if (da->frames[i].ibuf && da->frames[i].position == position) {
+      return &da->frames[i];
+    }
+  }
+  return NULL;
+}
+
+/* Next position the worker should decode, -1 when there is nothing to do. */
+static int anim_decode_ahead_next_position(struct anim_decode_ahead *da)
+{
+  int first, last, position;
+
+  if (da->stalled || da->playhead < 0) {
+    return -1;
+  }
+
+  anim_decode_ahead_window(da, &first, &last);
+
+  if (da->direction >= 0) {
+    for (position = da->playhead + 1; position <= last; position++) {
+      if (anim_decode_ahead_find(da, position) == NULL) {
+        return position;
+      }
+    }
+    for (position = first; position < da->playhead; position++) {
+      if (anim_decode_ahead_find(da, position) == NULL) {
+        return position;
+      }
+    }
+    return -1;
+  }
+
+  /* Playing backwards, every frame decoded before the previously decoded one needs a seek.
+   * Instead of decoding the frame that enters the window each time the playhead moves, wait
+   * until half of the frames behind the playhead are used up and then decode the gap in
+   * increasing order, which costs one seek per run of frames. */
+  if (da->run_next >= da->run_end) {
+    int cached = da->playhead;
+    while (cached > first && anim_decode_ahead_find(da, cached - 1)) {
+      cached--;
+    }
+    if (cached > first && (da->playhead - cached) * 2 <= da->playhead - first) {
+      da->run_next = first;
+      da->run_end = cached;
+    }
+  }
+  for (; da->run_next < da->run_end; da->run_next++) {
+    /* The playhead moved past the rest of the run, or jumped away from it. */
+    if (da->run_next < first || da->run_next >= da->playhead) {
+      da->run_next = da->run_end = 0;
+      break;
+    }
+    if (anim_decode_ahead_find(da, da->run_next) == NULL) {
+      return da->run_next;
+    }
+  }
+  for (position = da->playhead + 1; position <= last; position++) {
+    if (anim_decode_ahead_find(da, position) == NULL) {
+      return position;
+    }
+  }
+
+  return -1;
+}
+
+static void anim_decode_ahead_store(struct anim_decode_ahead *da,
+                                    int position,
+                                    IMB_Timecode_Type tc,
+                                    struct ImBuf *ibuf)
+{
+  int first, last;
+
+  anim_decode_ahead_window(da, &first, &last);
+
+  if (tc != da->tc || position < first || position > last ||
+      anim_decode_ahead_find(da, position)) {
+    return;
+  }
+
+  /* The window is never larger than the slot array, so there is always either a free slot or
+   * one holding a frame the playhead has moved away from. */
+  for (int i = 0; i < da->frames_len; i++) {
+    AnimDecodedFrame *frame = &da->frames[i];
+
+    if (frame->ibuf == NULL || frame->position < first || frame->position > last) {
+      if (frame->ibuf) {
+        IMB_freeImBuf(frame->ibuf);
+      }
+      IMB_refImBuf(ibuf);
+      frame->ibuf = ibuf;
+      frame->position = position;
+      return;
+    }
+  }
+
+  BLI_assert(!"anim decode-ahead: no free slot in window");
+}
+
+static void *anim_decode_ahead_thread(void *data)
+{
+  struct anim_decode_ahead *da = data;
+
+  BLI_mutex_lock(&da->mutex);
+
+  while (!da->stop) {
+    const int position = anim_decode_ahead_next_position(da);
+    const IMB_Timecode_Type tc = da->tc;
+    struct ImBuf *ibuf;
+
+    if (position == -1) {
+      BLI_condition_wait(&da->cond, &da->mutex);
+      continue;
+    }
+
+    BLI_mutex_unlock(&da->mutex);
+
+    BLI_mutex_lock(&da->decode_mutex);
+    ibuf = ffmpeg_fetchibuf(da->anim, position, tc);
+    BLI_mutex_unlock(&da->decode_mutex);
+
+    BLI_mutex_lock(&da->mutex);
+
+    if (ibuf) {
+      anim_decode_ahead_store(da, position, tc, ibuf);
+      IMB_freeImBuf(ibuf);
+    }
+    else {
+      da->stalled = true;
+    }
+  }
+
+  BLI_mutex_unlock(&da->mutex);
+
+  return NULL;
+}
+
+/* Stop the worker and free the decoded frames, the window starts over like for a newly opened
+ * anim. Callers hold anim_decode_ahead_list_mutex, so only one of them joins the worker. */
+static void anim_decode_ahead_release(struct anim_decode_ahead *da)
+{
+  BLI_mutex_lock(&da->mutex);
+  const bool running = da->running;
+  da->stop = true;
+  BLI_condition_notify_all(&da->cond);
+  BLI_mutex_unlock(&da->mutex);
+
+  if (running) {
+    BLI_threadpool_end(&da->threads);
+  }
+
+  BLI_mutex_lock(&da->mutex);
+  anim_decode_ahead_clear(da);
+  anim_decode_ahead_unreserve(da);
+  da->running = false;
+  da->stop = false;
+  da->stalled = false;
+  da->playhead = -1;
+  da->direction = 1;
+  BLI_mutex_unlock(&da->mutex);
+}
+
+static void anim_decode_ahead_free(struct anim *anim)
+{
+  struct anim_decode_ahead *da = anim->decode_ahead;
+
+  if (da == NULL) {
+    return;
+  }
+
+  BLI_mutex_lock(&anim_decode_ahead_list_mutex);
+  anim_decode_ahead_release(da);
+  BLI_remlink(&anim_decode_ahead_list, da);
+  BLI_mutex_unlock(&anim_decode_ahead_list_mutex);
+
+  BLI_condition_end(&da->cond);
+  BLI_mutex_end(&da->mutex);
+  BLI_mutex_end(&da->decode_mutex);
+
+  MEM_freeN(da);
+  anim->decode_ahead = NULL;
+}
+
+void imb_anim_decode_ahead_release(struct anim *anim)
+{
+  if (anim->decode_ahead) {
+    BLI_mutex_lock(&anim_decode_ahead_list_mutex);
+    anim_decode_ahead_release(anim->decode_ahead);
+    BLI_mutex_unlock(&anim_decode_ahead_list_mutex);
+  }
+}
+
+void imb_anim_decode_lock(struct anim *anim)
+{
+  if (anim->decode_ahead) {
+    BLI_mutex_lock(&anim->decode_ahead->decode_mutex);
+  }
+}
+
+void imb_anim_decode_unlock(struct anim *anim)
+{
+  if (anim->decode_ahead) {
+    BLI_mutex_unlock(&anim->decode_ahead->decode_mutex);
+  }
+}
+
+static void anim_decode_ahead_release_all(void)
+{
+  BLI_mutex_lock(&anim_decode_ahead_list_mutex);
+  LISTBASE_FOREACH (struct anim_decode_ahead *, da, &anim_decode_ahead_list) {
+    anim_decode_ahead_release(da);
+  }
+  BLI_mutex_unlock(&anim_decode_ahead_list_mutex);
+}
+
+/* Fetch a frame, going through the decode-ahead window. */
+static ImBuf *ffmpeg_fetchibuf_ahead(struct anim *anim, int position, IMB_Timecode_Type tc)
+{
+  struct anim_decode_ahead *da;
+  struct ImBuf *ibuf = NULL;
+
+  if (anim->decode_ahead == NULL) {
+    anim->decode_ahead = anim_decode_ahead_create(anim);
+  }
+  da = anim->decode_ahead;
+
+  BLI_mutex_lock(&da->mutex);
+
+  if (tc != da->tc) {
+    anim_decode_ahead_clear(da);
+    da->tc = tc;
+  }
+
+  if (position != da->playhead) {
+    /* Only start decoding ahead once the anim is actually read frame after frame, random
+     * access (thumbnails, single frame renders) shouldn't pay for a thread and cached frames. */
+    if (!da->running && !da->stop && da->playhead != -1 && abs(position - da->playhead) == 1 &&
+        anim_decode_ahead_reserve(da)) {
+      BLI_threadpool_init(&da->threads, anim_decode_ahead_thread, 1);
+      BLI_threadpool_insert(&da->threads, da);
+      da->running = true;
+    }
+
+    da->direction = (position > da->playhead) ? 1 : -1;
+    da->playhead = position;
+    da->stalled = false;
+    BLI_condition_notify_one(&da->cond);
+  }
+
+  if (da->running) {
+    AnimDecodedFrame *frame = anim_decode_ahead_find(da, position);
+    if (frame) {
+      ibuf = frame->ibuf;
+      IMB_refImBuf(ibuf);
+    }
+  }
+
+  BLI_mutex_unlock(&da->mutex);
+
+  if (ibuf) {
+    av_log(anim->pFormatCtx, AV_LOG_DEBUG, "FETCH: pos=%d decoded ahead\n", position);
+    return ibuf;
+  }
+
+  BLI_mutex_lock(&da->decode_mutex);
+
+  /* The worker may have been decoding this very frame while we waited for the decoder. */
+  BLI_mutex_lock(&da->mutex);
+  if (da->running) {
+    AnimDecodedFrame *frame = anim_decode_ahead_find(da, position);
+    if (frame) {
+      ibuf = frame->ibuf;
+      IMB_refImBuf(ibuf);
+    }
+  }
+  BLI_mutex_unlock(&da->mutex);
+
+  if (ibuf == NULL) {
+    ibuf = ffmpeg_fetchibuf(anim, position, tc);
+  }
+
+  BLI_mutex_unlock(&da->decode_mutex);
+
+  if (ibuf) {
+    BLI_mutex_lock(&da->mutex);
+    if (da->running) {
+      anim_decode_ahead_store(da, position, tc, ibuf);
+    }
+    BLI_mutex_unlock(&da->mutex);
+  }
+
+  return ibuf;
+}
+
 static void free_anim_ffmpeg(struct anim *anim)
 {
   if (anim == NULL) {
     return;
   }
 
+  anim_decode_ahead_free(anim);
+
   if (anim->pCodecCtx) {
     avcodec_close(anim->pCodecCtx);
     avformat_close_input(&anim->pFormatCtx);
@@ -1393,10 +1862,8 @@ struct ImBuf *IMB_anim_absolute(struct anim *anim,
 #endif
 #ifdef WITH_FFMPEG
     case ANIM_FFMPEG:
-      ibuf = ffmpeg_fetchibuf(anim, position, tc);
-      if (ibuf) {
-        anim->curposition = position;
-      }
+      /* The decoder updates curposition itself, possibly from the decode-ahead thread. */
+      ibuf = ffmpeg_fetchibuf_ahead(anim, position, tc);
       filter_y = 0; /* done internally */
       break;
 #endif
@@ -1406,7 +1873,7 @@ struct ImBuf *IMB_anim_absolute(struct anim *anim,
     if (filter_y) {
       IMB_filtery(ibuf);
     }
-    BLI_snprintf(ibuf->name, sizeof(ibuf->name), "%s.%04d", anim->name, anim->curposition + 1);
+    BLI_snprintf(ibuf->name, sizeof(ibuf->name), "%s.%04d", anim->name, position + 1);
   }
   return (ibuf);
 }
@@ -1416,16 +1883,18 @@ struct ImBuf *IMB_anim_absolute(struct anim *anim,
 int IMB_anim_get_duration(struct anim *anim, IMB_Timecode_Type tc)
 {
   struct anim_index *idx;
+  int duration;
+
   if (tc == IMB_TC_NONE) {
     return anim->duration_in_frames;
   }
 
+  imb_anim_decode_lock(anim);
   idx = IMB_anim_open_index(anim, tc);
-  if (!idx) {
-    return anim->duration_in_frames;
-  }
+  duration = idx ? IMB_indexer_get_duration(idx) : anim->duration_in_frames;
+  imb_anim_decode_unlock(anim);
 
-  return IMB_indexer_get_duration(idx);
+  return duration;
 }
 
 bool IMB_anim_get_fps(struct anim *anim, short *frs_sec, float *frs_sec_base, bool no_av_base)
@@ -32,6 +32,7 @@
 #include "DNA_movieclip_types.h"
 #include "DNA_scene_types.h"
 #include "DNA_space_types.h"
+#include "DNA_userdef_types.h"
 
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
@@ -43,9 +44,11 @@
 #include "MEM_guardedalloc.h"
 
 #include "BLI_blenlib.h"
+#include "BLI_color_lut.h"
 #include "BLI_math.h"
 #include "BLI_math_color.h"
 #include "BLI_string.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_rect.h"
 
@@ -97,10 +100,38 @@ static float imbuf_linear_srgb_to_xyz[3][3] = {{0.0f}};
  */
 static pthread_mutex_t processor_lock = BLI_MUTEX_INITIALIZER;
 
+/* Display transforms baked into a 3D LUT, used for display buffers when
+ * USER_DISPLAY_TRANSFORM_LUT is set. */
+#define DISPLAY_LUT_SIZE 65
+#define DISPLAY_LUT_RANGE 64.0f
+/* Smaller images are quicker to transform than to bake a LUT for. */
+#define DISPLAY_LUT_MIN_PIXELS (DISPLAY_LUT_SIZE * DISPLAY_LUT_SIZE * DISPLAY_LUT_SIZE * 4)
+#define DISPLAY_LUT_MAX_CACHED 4
+
+typedef struct ColormanageDisplayLUT {
+  struct ColormanageDisplayLUT *next, *prev;
+
+  /* Settings of the baked transform. */
+  char look[MAX_COLORSPACE_NAME];
+  char view[MAX_COLORSPACE_NAME];
+  char display[MAX_COLORSPACE_NAME];
+  float exposure;
+  float gamma;
+
+  ColorLUT3D *lut;
+  /* Number of processors using the LUT, it is not freed while in use. */
+  int users;
+} ColormanageDisplayLUT;
+
+/* Most recently used first, protected by processor_lock. */
+static ListBase global_display_luts = {NULL, NULL};
+
 typedef struct ColormanageProcessor {
   OCIO_ConstProcessorRcPtr *processor;
   CurveMapping *curve_mapping;
   bool is_data_result;
+  /* Approximation of the processor for display buffers, may be NULL. */
+  ColormanageDisplayLUT *display_lut;
 } ColormanageProcessor;
 
 static struct global_glsl_state {
@@ -742,6 +773,12 @@ void colormanagement_exit(void)
   memset(&global_glsl_state, 0, sizeof(global_glsl_state));
   memset(&global_color_picking_state, 0, sizeof(global_color_picking_state));
 
+  LISTBASE_FOREACH (ColormanageDisplayLUT *, display_lut, &global_display_luts) {
+    BLI_assert(display_lut->users == 0);
+    BLI_color_lut_free(display_lut->lut);
+  }
+  BLI_freelistN(&global_display_luts);
+
   colormanage_free_config();
 }
 
@@ -1403,6 +1440,147 @@ bool IMB_colormanagement_space_name_is_data(const char *name)
   return (colorspace && colorspace->is_data);
 }
 
+/*********************** Baked display transforms *************************/
+
+typedef struct DisplayLUTBakeData {
+  OCIO_ConstProcessorRcPtr *processor;
+  float (*rgb)[3];
+  int len;
+} DisplayLUTBakeData;
+
+#define DISPLAY_LUT_BAKE_CHUNK 4096
+
+static void display_lut_bake_cb(void *__restrict userdata,
+                                const int chunk,
+                                const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  DisplayLUTBakeData *data = userdata;
+  const int start = chunk * DISPLAY_LUT_BAKE_CHUNK;
+  const int len = min_ii(DISPLAY_LUT_BAKE_CHUNK, data->len - start);
+
+  OCIO_PackedImageDesc *img = OCIO_createOCIO_PackedImageDesc((float *)data->rgb[start],
+                                                              len,
+                                                              1,
+                                                              3,
+                                                              sizeof(float),
+                                                              3 * sizeof(float),
+                                                              (size_t)len * 3 * sizeof(float));
+  OCIO_processorApply(data->processor, img);
+  OCIO_PackedImageDescRelease(img);
+}
+
+static void display_lut_bake(void *userdata, float (*rgb)[3], int len)
+{
+  DisplayLUTBakeData data = {
+      .processor = userdata,
+      .rgb = rgb,
+      .len = len,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  BLI_task_parallel_range(0,
+                          (len + DISPLAY_LUT_BAKE_CHUNK - 1) / DISPLAY_LUT_BAKE_CHUNK,
+                          &data,
+                          display_lut_bake_cb,
+                          &settings);
+}
+
+/* Get the baked display transform matching the settings, or bake it. The processor
+ * itself is used for baking, curve mapping is applied separately so it isn't part
+ * of the key. */
+static ColormanageDisplayLUT *colormanage_display_lut_acquire(
+    OCIO_ConstProcessorRcPtr *processor,
+    const ColorManagedViewSettings *view_settings,
+    const ColorManagedDisplaySettings *display_settings)
+{
+  ColormanageDisplayLUT *display_lut;
+
+  BLI_mutex_lock(&processor_lock);
+
+  for (display_lut = global_display_luts.first; display_lut; display_lut = display_lut->next) {
+    if (STREQ(display_lut->look, view_settings->look) &&
+        STREQ(display_lut->view, view_settings->view_transform) &&
+        STREQ(display_lut->display, display_settings->display_device) &&
+        display_lut->exposure == view_settings->exposure &&
+        display_lut->gamma == view_settings->gamma) {
+      break;
+    }
+  }
+
+  if (display_lut) {
+    BLI_remlink(&global_display_luts, display_lut);
+  }
+  else {
+    /* Baking is done with the lock held, so threads asking for the same
+     * transform don't bake it twice. */
+    display_lut = MEM_callocN(sizeof(*display_lut), __func__);
+    STRNCPY(display_lut->look, view_settings->look);
+    STRNCPY(display_lut->view, view_settings->view_transform);
+    STRNCPY(display_lut->display, display_settings->display_device);
+    display_lut->exposure = view_settings->exposure;
+    display_lut->gamma = view_settings->gamma;
+    display_lut->lut = BLI_color_lut_bake(
+        DISPLAY_LUT_SIZE, DISPLAY_LUT_RANGE, display_lut_bake, processor);
+
+    /* Free least recently used LUTs no longer in use. */
+    int tot = 1;
+    ColormanageDisplayLUT *lut_iter = global_display_luts.first;
+    while (lut_iter) {
+      ColormanageDisplayLUT *lut_next = lut_iter->next;
+      if (++tot > DISPLAY_LUT_MAX_CACHED && lut_iter->users == 0) {
+        BLI_remlink(&global_display_luts, lut_iter);
+        BLI_color_lut_free(lut_iter->lut);
+        MEM_freeN(lut_iter);
+      }
+      lut_iter = lut_next;
+    }
+  }
+
+  BLI_addhead(&global_display_luts, display_lut);
+  display_lut->users++;
+
+  BLI_mutex_unlock(&processor_lock);
+
+  return display_lut;
+}
+
+/* Use a baked LUT instead of the exact transform when computing display
+ * buffers of \a pixels_len pixels, if enabled in the preferences. */
+static void colormanage_processor_use_display_lut(
+    ColormanageProcessor *cm_processor,
+    const ColorManagedViewSettings *view_settings,
+    const ColorManagedDisplaySettings *display_settings,
+    size_t pixels_len)
+{
+  if ((U.flag & USER_DISPLAY_TRANSFORM_LUT) == 0 || cm_processor->processor == NULL ||
+      cm_processor->is_data_result || view_settings == NULL ||
+      pixels_len < DISPLAY_LUT_MIN_PIXELS) {
+    return;
+  }
+
+  cm_processor->display_lut = colormanage_display_lut_acquire(
+      cm_processor->processor, view_settings, display_settings);
+}
+
+/* Same as the OCIO processor, falls back to it for colors outside the LUT range. */
+BLI_INLINE void colormanage_processor_apply_display_lut(ColormanageProcessor *cm_processor,
+                                                        float *pixel,
+                                                        bool predivide)
+{
+  if (predivide && pixel[3] != 1.0f && pixel[3] != 0.0f) {
+    const float alpha = pixel[3];
+    mul_v3_fl(pixel, 1.0f / alpha);
+    if (!BLI_color_lut_apply_v3(cm_processor->display_lut->lut, pixel)) {
+      OCIO_processorApplyRGB(cm_processor->processor, pixel);
+    }
+    mul_v3_fl(pixel, alpha);
+  }
+  else if (!BLI_color_lut_apply_v3(cm_processor->display_lut->lut, pixel)) {
+    OCIO_processorApplyRGB(cm_processor->processor, pixel);
+  }
+}
+
 /*********************** Threaded display buffer transform routines *************************/
 
 typedef struct DisplayBufferThread {
@@ -1748,6 +1926,8 @@ static void colormanage_display_buffer_process_ex(
 
   if (skip_transform == false) {
     cm_processor = IMB_colormanagement_display_processor_new(view_settings, display_settings);
+    colormanage_processor_use_display_lut(
+        cm_processor, view_settings, display_settings, (size_t)ibuf->x * ibuf->y);
   }
 
   display_buffer_apply_threaded(ibuf,
@@ -2625,6 +2805,7 @@ unsigned char *IMB_display_buffer_acquire(ImBuf *ibuf,
   ColormanageCacheDisplaySettings cache_display_settings;
   ColorManagedViewSettings default_view_settings;
   const ColorManagedViewSettings *applied_view_settings;
+  rcti invalid_rect;
 
   *cache_handle = NULL;
 
@@ -2654,7 +2835,13 @@ unsigned char *IMB_display_buffer_acquire(ImBuf *ibuf,
   colormanage_view_settings_to_cache(ibuf, &cache_view_settings, applied_view_settings);
   colormanage_display_settings_to_cache(&cache_display_settings, display_settings);
 
-  if (ibuf->invalid_rect.xmin != ibuf->invalid_rect.xmax) {
+  /* The invalid region can be extended from other threads, i.e. by render jobs. */
+  BLI_thread_lock(LOCK_COLORMANAGE);
+  invalid_rect = ibuf->invalid_rect;
+  BLI_rcti_init(&ibuf->invalid_rect, 0, 0, 0, 0);
+  BLI_thread_unlock(LOCK_COLORMANAGE);
+
+  if (invalid_rect.xmin != invalid_rect.xmax) {
     if ((ibuf->userflags & IB_DISPLAY_BUFFER_INVALID) == 0) {
       IMB_partial_display_buffer_update_threaded(ibuf,
                                                  ibuf->rect_float,
@@ -2664,13 +2851,11 @@ unsigned char *IMB_display_buffer_acquire(ImBuf *ibuf,
                                                  0,
                                                  applied_view_settings,
                                                  display_settings,
-                                                 ibuf->invalid_rect.xmin,
-                                                 ibuf->invalid_rect.ymin,
-                                                 ibuf->invalid_rect.xmax,
-                                                 ibuf->invalid_rect.ymax);
+                                                 invalid_rect.xmin,
+                                                 invalid_rect.ymin,
+                                                 invalid_rect.xmax,
+                                                 invalid_rect.ymax);
     }
-
-    BLI_rcti_init(&ibuf->invalid_rect, 0, 0, 0, 0);
   }
 
   BLI_thread_lock(LOCK_COLORMANAGE);
@@ -3579,6 +3764,8 @@ static void imb_partial_display_buffer_update_ex(
 
     if (!skip_transform) {
       cm_processor = IMB_colormanagement_display_processor_new(view_settings, display_settings);
+      colormanage_processor_use_display_lut(
+          cm_processor, view_settings, display_settings, (size_t)(xmax - xmin) * (ymax - ymin));
     }
 
     if (do_threads) {
@@ -3682,8 +3869,12 @@ void IMB_partial_display_buffer_update_threaded(
                                        do_threads);
 }
 
+/* Accumulate a region to be updated the next time a display buffer is acquired,
+ * safe to call from other threads than the one drawing the buffer. */
 void IMB_partial_display_buffer_update_delayed(ImBuf *ibuf, int xmin, int ymin, int xmax, int ymax)
 {
+  BLI_thread_lock(LOCK_COLORMANAGE);
+
   if (ibuf->invalid_rect.xmin == ibuf->invalid_rect.xmax) {
     BLI_rcti_init(&ibuf->invalid_rect, xmin, xmax, ymin, ymax);
   }
@@ -3692,6 +3883,42 @@ void IMB_partial_display_buffer_update_delayed(ImBuf *ibuf, int xmin, int ymin,
     BLI_rcti_init(&rect, xmin, xmax, ymin, ymax);
     BLI_rcti_union(&ibuf->invalid_rect, &rect);
   }
+
+  BLI_thread_unlock(LOCK_COLORMANAGE);
+}
+
+/* Same as #IMB_partial_display_buffer_update_delayed, display buffers of all other views and
+ * displays are marked invalid right away, like a partial update of the given view does. */
+void IMB_partial_display_buffer_update_delayed_view(
+    ImBuf *ibuf,
+    const ColorManagedViewSettings *view_settings,
+    const ColorManagedDisplaySettings *display_settings,
+    int xmin,
+    int ymin,
+    int xmax,
+    int ymax)
+{
+  if (ibuf->display_buffer_flags) {
+    ColormanageCacheViewSettings cache_view_settings;
+    ColormanageCacheDisplaySettings cache_display_settings;
+
+    colormanage_view_settings_to_cache(ibuf, &cache_view_settings, view_settings);
+    colormanage_display_settings_to_cache(&cache_display_settings, display_settings);
+
+    const unsigned int view_flag = 1 << (cache_view_settings.view - 1);
+    const int display_index = cache_display_settings.display - 1;
+
+    BLI_thread_lock(LOCK_COLORMANAGE);
+
+    /* Mark all other buffers as invalid, this one stays as valid as it was. */
+    const unsigned int flag = ibuf->display_buffer_flags[display_index] & view_flag;
+    memset(ibuf->display_buffer_flags, 0, global_tot_display * sizeof(unsigned int));
+    ibuf->display_buffer_flags[display_index] |= flag;
+
+    BLI_thread_unlock(LOCK_COLORMANAGE);
+  }
+
+  IMB_partial_display_buffer_update_delayed(ibuf, xmin, ymin, xmax, ymax);
 }
 
 /*********************** Pixel processor functions *************************/
@@ -3769,7 +3996,10 @@ void IMB_colormanagement_processor_apply_v4_predivide(ColormanageProcessor *cm_p
     BKE_curvemapping_evaluate_premulRGBF(cm_processor->curve_mapping, pixel, pixel);
   }
 
-  if (cm_processor->processor) {
+  if (cm_processor->display_lut) {
+    colormanage_processor_apply_display_lut(cm_processor, pixel, true);
+  }
+  else if (cm_processor->processor) {
     OCIO_processorApplyRGBA_predivide(cm_processor->processor, pixel);
   }
 }
@@ -3780,7 +4010,10 @@ void IMB_colormanagement_processor_apply_v3(ColormanageProcessor *cm_processor,
     BKE_curvemapping_evaluate_premulRGBF(cm_processor->curve_mapping, pixel, pixel);
   }
 
-  if (cm_processor->processor) {
+  if (cm_processor->display_lut) {
+    colormanage_processor_apply_display_lut(cm_processor, pixel, false);
+  }
+  else if (cm_processor->processor) {
     OCIO_processorApplyRGB(cm_processor->processor, pixel);
   }
 }
@@ -3826,7 +4059,15 @@ void IMB_colormanagement_processor_apply(ColormanageProcessor *cm_processor,
     }
   }
 
-  if (cm_processor->processor && channels >= 3) {
+  if (cm_processor->display_lut && channels >= 3) {
+    const size_t pixels_len = (size_t)width * height;
+    float *pixel = buffer;
+
+    for (size_t i = 0; i < pixels_len; i++, pixel += channels) {
+      colormanage_processor_apply_display_lut(cm_processor, pixel, predivide && channels == 4);
+    }
+  }
+  else if (cm_processor->processor && channels >= 3) {
     OCIO_PackedImageDesc *img;
 
     /* apply OCIO processor */
@@ -3869,6 +4110,11 @@ void IMB_colormanagement_processor_apply_byte(
 
 void IMB_colormanagement_processor_free(ColormanageProcessor *cm_processor)
 {
+  if (cm_processor->display_lut) {
+    BLI_mutex_lock(&processor_lock);
+    cm_processor->display_lut->users--;
+    BLI_mutex_unlock(&processor_lock);
+  }
   if (cm_processor->curve_mapping) {
     BKE_curvemapping_free(cm_processor->curve_mapping);
   }
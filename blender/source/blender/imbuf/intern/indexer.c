@@ -30,6 +30,10 @@
 #include "BLI_string.h"
 #include "BLI_fileops.h"
 #include "BLI_ghash.h"
+#include "BLI_listbase.h"
+#include "BLI_math_base.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 
 #include "IMB_indexer.h"
 #include "IMB_anim.h"
@@ -711,6 +715,8 @@ typedef struct FFmpegIndexBuilderContext {
   double pts_time_base;
   int frameno, frameno_gapless;
   int start_pts_set;
+  /* Set when the segmented build couldn't complete, the output is discarded. */
+  bool build_failed;
 } FFmpegIndexBuilderContext;
 
 static IndexBuildContext *index_ffmpeg_create_context(struct anim *anim,
@@ -818,6 +824,8 @@ static void index_rebuild_ffmpeg_finish(FFmpegIndexBuilderContext *context, int
 {
   int i;
 
+  stop = stop || context->build_failed;
+
   for (i = 0; i < context->num_indexers; i++) {
     if (context->tcs_in_use & tc_types[i]) {
       IMB_index_builder_finish(context->indexer[i], stop);
@@ -836,6 +844,39 @@ static void index_rebuild_ffmpeg_finish(FFmpegIndexBuilderContext *context, int
   MEM_freeN(context);
 }
 
+static void index_rebuild_ffmpeg_add_index_entry(FFmpegIndexBuilderContext *context,
+                                                 unsigned char *buffer,
+                                                 int data_size,
+                                                 unsigned long long s_pos,
+                                                 unsigned long long s_dts,
+                                                 unsigned long long pts)
+{
+  int i;
+
+  if (!context->start_pts_set) {
+    context->start_pts = pts;
+    context->start_pts_set = true;
+  }
+
+  context->frameno = floor(
+      (pts - context->start_pts) * context->pts_time_base * context->frame_rate + 0.5);
+
+  for (i = 0; i < context->num_indexers; i++) {
+    if (context->tcs_in_use & tc_types[i]) {
+      int tc_frameno = context->frameno;
+
+      if (tc_types[i] == IMB_TC_RECORD_RUN_NO_GAPS) {
+        tc_frameno = context->frameno_gapless;
+      }
+
+      IMB_index_builder_proc_frame(
+          context->indexer[i], buffer, data_size, tc_frameno, s_pos, s_dts, pts);
+    }
+  }
+
+  context->frameno_gapless++;
+}
+
 static void index_rebuild_ffmpeg_proc_decoded_frame(FFmpegIndexBuilderContext *context,
                                                     AVPacket *curr_packet,
                                                     AVFrame *in_frame)
@@ -849,14 +890,6 @@ static void index_rebuild_ffmpeg_proc_decoded_frame(FFmpegIndexBuilderContext *c
     add_to_proxy_output_ffmpeg(context->proxy_ctx[i], in_frame);
   }
 
-  if (!context->start_pts_set) {
-    context->start_pts = pts;
-    context->start_pts_set = true;
-  }
-
-  context->frameno = floor(
-      (pts - context->start_pts) * context->pts_time_base * context->frame_rate + 0.5);
-
   /* decoding starts *always* on I-Frames,
    * so: P-Frames won't work, even if all the
    * information is in place, when we seek
@@ -869,25 +902,8 @@ static void index_rebuild_ffmpeg_proc_decoded_frame(FFmpegIndexBuilderContext *c
     s_dts = context->last_seek_pos_dts;
   }
 
-  for (i = 0; i < context->num_indexers; i++) {
-    if (context->tcs_in_use & tc_types[i]) {
-      int tc_frameno = context->frameno;
-
-      if (tc_types[i] == IMB_TC_RECORD_RUN_NO_GAPS) {
-        tc_frameno = context->frameno_gapless;
-      }
-
-      IMB_index_builder_proc_frame(context->indexer[i],
-                                   curr_packet->data,
-                                   curr_packet->size,
-                                   tc_frameno,
-                                   s_pos,
-                                   s_dts,
-                                   pts);
-    }
-  }
-
-  context->frameno_gapless++;
+  index_rebuild_ffmpeg_add_index_entry(
+      context, curr_packet->data, curr_packet->size, s_pos, s_dts, pts);
 }
 
 static int index_rebuild_ffmpeg(FFmpegIndexBuilderContext *context,
@@ -968,6 +984,678 @@ static int index_rebuild_ffmpeg(FFmpegIndexBuilderContext *context,
   return 1;
 }
 
+/* ----------------------------------------------------------------------
+ * - ffmpeg rebuilder, segmented
+ *
+ * The stream is read once without decoding and split at key frames into segments which are
+ * decoded, scaled and encoded in parallel. Finished segments are merged in stream order into the
+ * proxy files and time code indices.
+ *
+ * A segment owns the frames presented from its first key frame up to the first key frame of the
+ * next segment. Frames presented before a key frame but stored after it (open GOPs) reference
+ * the pictures before that key frame, so every segment also decodes the first group of pictures
+ * of the next segment and drops all frames it doesn't own.
+ * ---------------------------------------------------------------------- */
+
+/* Segments start at the first key frame after this many packets... */
+#define PROXY_SEGMENT_MIN_PACKETS 250
+/* ...or this many bytes of packet data, for intra-only codecs with large packets. */
+#define PROXY_SEGMENT_MIN_SIZE ((size_t)64 << 20)
+/* Input packet data of dispatched segments kept in memory at most. Reading waits for
+ * segments to finish once it's reached, a single segment is always let through. */
+#define PROXY_SEGMENT_MAX_INPUT_SIZE ((size_t)512 << 20)
+
+typedef struct ProxySegmentPackets {
+  AVPacket *packets;
+  int num, alloc;
+  /* Sum of the data sizes of the packets. */
+  size_t size;
+} ProxySegmentPackets;
+
+typedef struct ProxySegmentFrame {
+  unsigned long long seek_pos;
+  unsigned long long seek_pos_dts;
+  unsigned long long pts;
+} ProxySegmentFrame;
+
+typedef struct ProxySegment {
+  struct ProxySegment *next, *prev;
+
+  ProxySegmentPackets packets;
+  /* Copy of the first group of pictures of the next segment. */
+  ProxySegmentPackets trailing;
+  /* Number of packets in the first group of pictures, 0 while it's being read. */
+  int first_gop_num;
+
+  int64_t pts_start, pts_end;
+  bool has_pts_start, has_pts_end;
+  /* Stream position of the last packet, for progress reports. */
+  int64_t end_pos;
+  /* Size of the input packets, counted in the builder from dispatch until they're freed. */
+  size_t input_size;
+
+  /* Results, valid once the segment is done. */
+  ProxySegmentFrame *frames;
+  int frames_num, frames_alloc;
+  ProxySegmentPackets proxy_packets[IMB_PROXY_MAX_SLOT];
+  bool done;
+} ProxySegment;
+
+typedef struct ProxySegmentBuilder {
+  FFmpegIndexBuilderContext *context;
+  TaskPool *task_pool;
+  short *job_stop;
+
+  /* Guards the fields below and done flags of segments. */
+  ThreadMutex mutex;
+  ThreadCondition cond;
+  /* Dispatched segments which are not merged yet, in stream order. */
+  ListBase segments;
+  int segments_num, segments_max;
+  /* Input packet data of dispatched segments which isn't freed yet. */
+  size_t input_size;
+  bool stop, failed;
+} ProxySegmentBuilder;
+
+/* Decoding and encoding state of a single segment task. */
+typedef struct ProxySegmentEncoder {
+  AVCodecContext *c;
+  struct SwsContext *sws_ctx;
+  AVFrame *frame;
+  int orig_height;
+} ProxySegmentEncoder;
+
+typedef struct ProxySegmentDecoder {
+  ProxySegment *segment;
+  AVCodecContext *codec_ctx;
+  AVFrame *frame;
+  ProxySegmentEncoder encoders[IMB_PROXY_MAX_SLOT];
+
+  unsigned long long seek_pos;
+  unsigned long long last_seek_pos;
+  unsigned long long seek_pos_dts;
+  unsigned long long last_seek_pos_dts;
+  unsigned long long seek_pos_pts;
+} ProxySegmentDecoder;
+
+static void proxy_segment_packets_append(ProxySegmentPackets *list, const AVPacket *packet)
+{
+  if (list->num == list->alloc) {
+    list->alloc = max_ii(list->alloc * 2, 64);
+    list->packets = MEM_reallocN(list->packets, sizeof(*list->packets) * list->alloc);
+  }
+  list->packets[list->num++] = *packet;
+  list->size += (size_t)packet->size;
+}
+
+static void proxy_segment_packets_free(ProxySegmentPackets *list)
+{
+  int i;
+
+  for (i = 0; i < list->num; i++) {
+    av_free_packet(&list->packets[i]);
+  }
+  MEM_SAFE_FREE(list->packets);
+  list->num = list->alloc = 0;
+  list->size = 0;
+}
+
+static void proxy_segment_free(ProxySegment *segment)
+{
+  int i;
+
+  proxy_segment_packets_free(&segment->packets);
+  proxy_segment_packets_free(&segment->trailing);
+  for (i = 0; i < IMB_PROXY_MAX_SLOT; i++) {
+    proxy_segment_packets_free(&segment->proxy_packets[i]);
+  }
+  MEM_SAFE_FREE(segment->frames);
+  MEM_freeN(segment);
+}
+
+static bool proxy_segment_encoder_init(ProxySegmentEncoder *enc,
+                                       const struct proxy_output_ctx *ctx,
+                                       const AVCodecContext *in_codec_ctx)
+{
+  const int width = ctx->c->width;
+  const int height = ctx->c->height;
+
+  enc->c = avcodec_alloc_context3(ctx->codec);
+  enc->c->codec_type = AVMEDIA_TYPE_VIDEO;
+  enc->c->codec_id = ctx->c->codec_id;
+  enc->c->width = width;
+  enc->c->height = height;
+  enc->c->pix_fmt = ctx->c->pix_fmt;
+  enc->c->sample_aspect_ratio = ctx->c->sample_aspect_ratio;
+  enc->c->time_base = ctx->c->time_base;
+  enc->c->qmin = ctx->c->qmin;
+  enc->c->qmax = ctx->c->qmax;
+  enc->c->flags = ctx->c->flags;
+  /* Segments are already encoded in parallel. */
+  enc->c->thread_count = 1;
+
+  if (avcodec_open2(enc->c, ctx->codec, NULL) < 0) {
+    avcodec_free_context(&enc->c);
+    return false;
+  }
+
+  enc->orig_height = ctx->orig_height;
+
+  if (ctx->sws_ctx) {
+    enc->frame = av_frame_alloc();
+    avpicture_fill((AVPicture *)enc->frame,
+                   MEM_mallocN(avpicture_get_size(enc->c->pix_fmt, round_up(width, 16), height),
+                               "alloc proxy segment frame"),
+                   enc->c->pix_fmt,
+                   round_up(width, 16),
+                   height);
+
+    enc->sws_ctx = sws_getContext(in_codec_ctx->width,
+                                  enc->orig_height,
+                                  in_codec_ctx->pix_fmt,
+                                  width,
+                                  height,
+                                  enc->c->pix_fmt,
+                                  SWS_FAST_BILINEAR,
+                                  NULL,
+                                  NULL,
+                                  NULL);
+  }
+
+  return true;
+}
+
+static void proxy_segment_encoder_free(ProxySegmentEncoder *enc)
+{
+  if (enc->c) {
+    avcodec_free_context(&enc->c);
+  }
+  if (enc->sws_ctx) {
+    sws_freeContext(enc->sws_ctx);
+    MEM_freeN(enc->frame->data[0]);
+    av_free(enc->frame);
+  }
+}
+
+static void proxy_segment_encode(ProxySegmentEncoder *enc,
+                                 AVFrame *frame,
+                                 ProxySegmentPackets *r_packets)
+{
+  AVPacket packet = {0};
+  int got_output = 0;
+
+  av_init_packet(&packet);
+
+  if (enc->sws_ctx && frame &&
+      (frame->data[0] || frame->data[1] || frame->data[2] || frame->data[3])) {
+    sws_scale(enc->sws_ctx,
+              (const uint8_t *const *)frame->data,
+              frame->linesize,
+              0,
+              enc->orig_height,
+              enc->frame->data,
+              enc->frame->linesize);
+  }
+
+  frame = enc->sws_ctx ? (frame ? enc->frame : 0) : frame;
+
+  if (frame) {
+    frame->pts = r_packets->num;
+  }
+
+  if (avcodec_encode_video2(enc->c, &packet, frame, &got_output) < 0) {
+    fprintf(stderr, "Error encoding proxy frame %d\n", r_packets->num);
+    return;
+  }
+
+  if (got_output) {
+    proxy_segment_packets_append(r_packets, &packet);
+  }
+}
+
+static void proxy_segment_decoded_frame(FFmpegIndexBuilderContext *context,
+                                        ProxySegmentDecoder *dec)
+{
+  ProxySegment *segment = dec->segment;
+  const int64_t pts = av_get_pts_from_frame(context->iFormatCtx, dec->frame);
+  ProxySegmentFrame *frame;
+  int i;
+
+  if ((segment->has_pts_start && pts < segment->pts_start) ||
+      (segment->has_pts_end && pts >= segment->pts_end)) {
+    /* Belongs to a neighbor segment. */
+    return;
+  }
+
+  if (segment->frames_num == segment->frames_alloc) {
+    segment->frames_alloc = max_ii(segment->frames_alloc * 2, 64);
+    segment->frames = MEM_reallocN(segment->frames,
+                                   sizeof(*segment->frames) * segment->frames_alloc);
+  }
+
+  /* Same seek position rules as index_rebuild_ffmpeg_proc_decoded_frame. */
+  frame = &segment->frames[segment->frames_num++];
+  frame->pts = pts;
+  if ((unsigned long long)pts < dec->seek_pos_pts) {
+    frame->seek_pos = dec->last_seek_pos;
+    frame->seek_pos_dts = dec->last_seek_pos_dts;
+  }
+  else {
+    frame->seek_pos = dec->seek_pos;
+    frame->seek_pos_dts = dec->seek_pos_dts;
+  }
+
+  for (i = 0; i < context->num_proxy_sizes; i++) {
+    if (dec->encoders[i].c) {
+      proxy_segment_encode(&dec->encoders[i], dec->frame, &segment->proxy_packets[i]);
+    }
+  }
+}
+
+static bool proxy_segment_decoder_init(FFmpegIndexBuilderContext *context,
+                                       ProxySegmentDecoder *dec)
+{
+  int i;
+
+  dec->codec_ctx = avcodec_alloc_context3(context->iCodec);
+  avcodec_copy_context(dec->codec_ctx, context->iCodecCtx);
+  dec->codec_ctx->workaround_bugs = 1;
+  /* Segments are already decoded in parallel. */
+  dec->codec_ctx->thread_count = 1;
+
+  if (avcodec_open2(dec->codec_ctx, context->iCodec, NULL) < 0) {
+    return false;
+  }
+
+  dec->frame = av_frame_alloc();
+
+  for (i = 0; i < context->num_proxy_sizes; i++) {
+    if (context->proxy_ctx[i]) {
+      if (!proxy_segment_encoder_init(
+              &dec->encoders[i], context->proxy_ctx[i], context->iCodecCtx)) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+static void proxy_segment_decoder_free(ProxySegmentDecoder *dec)
+{
+  int i;
+
+  for (i = 0; i < IMB_PROXY_MAX_SLOT; i++) {
+    proxy_segment_encoder_free(&dec->encoders[i]);
+  }
+  if (dec->frame) {
+    av_frame_free(&dec->frame);
+  }
+  if (dec->codec_ctx) {
+    avcodec_free_context(&dec->codec_ctx);
+  }
+}
+
+static bool proxy_segment_builder_stopped(ProxySegmentBuilder *builder)
+{
+  BLI_mutex_lock(&builder->mutex);
+  const bool stop = builder->stop;
+  BLI_mutex_unlock(&builder->mutex);
+  /* The job flag is set without locking, like for all jobs. */
+  return stop || *builder->job_stop;
+}
+
+static bool proxy_segment_builder_failed(ProxySegmentBuilder *builder)
+{
+  BLI_mutex_lock(&builder->mutex);
+  const bool failed = builder->failed;
+  BLI_mutex_unlock(&builder->mutex);
+  return failed;
+}
+
+/* Whether a segment with input_size bytes of packets has to wait for others to be merged. */
+static bool proxy_segment_builder_is_full(const ProxySegmentBuilder *builder,
+                                          int max_segments,
+                                          size_t input_size)
+{
+  if (builder->segments_num >= max_segments) {
+    return true;
+  }
+  return builder->segments_num > 0 &&
+         builder->input_size + input_size > PROXY_SEGMENT_MAX_INPUT_SIZE;
+}
+
+static void index_rebuild_ffmpeg_segment_task(TaskPool *__restrict pool,
+                                              void *taskdata,
+                                              int UNUSED(threadid))
+{
+  ProxySegmentBuilder *builder = BLI_task_pool_userdata(pool);
+  FFmpegIndexBuilderContext *context = builder->context;
+  ProxySegment *segment = taskdata;
+  ProxySegmentDecoder dec = {NULL};
+  bool ok;
+  int i;
+
+  dec.segment = segment;
+
+  /* Opening and closing codecs isn't thread safe with older FFmpeg versions. */
+  BLI_mutex_lock(&builder->mutex);
+  ok = proxy_segment_decoder_init(context, &dec);
+  BLI_mutex_unlock(&builder->mutex);
+
+  if (ok) {
+    const ProxySegmentPackets *lists[2] = {&segment->packets, &segment->trailing};
+    AVPacket flush_packet;
+    int list_index, frame_finished;
+
+    for (list_index = 0; list_index < 2; list_index++) {
+      const ProxySegmentPackets *list = lists[list_index];
+
+      for (i = 0; i < list->num && !proxy_segment_builder_stopped(builder); i++) {
+        const AVPacket *packet = &list->packets[i];
+
+        if (packet->flags & AV_PKT_FLAG_KEY) {
+          dec.last_seek_pos = dec.seek_pos;
+          dec.last_seek_pos_dts = dec.seek_pos_dts;
+          dec.seek_pos = packet->pos;
+          dec.seek_pos_dts = packet->dts;
+          dec.seek_pos_pts = packet->pts;
+        }
+
+        frame_finished = 0;
+        avcodec_decode_video2(dec.codec_ctx, dec.frame, &frame_finished, packet);
+
+        if (frame_finished) {
+          proxy_segment_decoded_frame(context, &dec);
+        }
+      }
+    }
+
+    /* Pictures still stuck in the decoder. */
+    memset(&flush_packet, 0, sizeof(flush_packet));
+    av_init_packet(&flush_packet);
+
+    if (!proxy_segment_builder_stopped(builder)) {
+      do {
+        frame_finished = 0;
+        avcodec_decode_video2(dec.codec_ctx, dec.frame, &frame_finished, &flush_packet);
+
+        if (frame_finished) {
+          proxy_segment_decoded_frame(context, &dec);
+        }
+      } while (frame_finished);
+
+      for (i = 0; i < context->num_proxy_sizes; i++) {
+        if (dec.encoders[i].c) {
+          int num_prev;
+          do {
+            num_prev = segment->proxy_packets[i].num;
+            proxy_segment_encode(&dec.encoders[i], NULL, &segment->proxy_packets[i]);
+          } while (segment->proxy_packets[i].num != num_prev);
+        }
+      }
+    }
+  }
+  else {
+    fprintf(stderr, "Couldn't open decoder or proxy encoder for segment, proxy not built!\n");
+  }
+
+  BLI_mutex_lock(&builder->mutex);
+  proxy_segment_decoder_free(&dec);
+  BLI_mutex_unlock(&builder->mutex);
+
+  /* Input packets aren't needed anymore, free them early. */
+  proxy_segment_packets_free(&segment->packets);
+  proxy_segment_packets_free(&segment->trailing);
+
+  BLI_mutex_lock(&builder->mutex);
+  builder->input_size -= segment->input_size;
+  segment->done = true;
+  if (!ok) {
+    builder->failed = true;
+  }
+  BLI_condition_notify_all(&builder->cond);
+  BLI_mutex_unlock(&builder->mutex);
+}
+
+static void proxy_output_ffmpeg_write_packet(struct proxy_output_ctx *ctx, AVPacket *packet)
+{
+  const int64_t frameno = ctx->cfra++;
+
+  packet->pts = av_rescale_q(frameno, ctx->c->time_base, ctx->st->time_base);
+  packet->dts = packet->pts;
+  packet->stream_index = ctx->st->index;
+
+  /* The muxer takes ownership of the packet data. */
+  if (av_interleaved_write_frame(ctx->of, packet) != 0) {
+    fprintf(stderr,
+            "Error writing proxy frame %d "
+            "into '%s'\n",
+            ctx->cfra - 1,
+            ctx->of->filename);
+  }
+  memset(packet, 0, sizeof(*packet));
+}
+
+static void index_rebuild_ffmpeg_segment_merge(FFmpegIndexBuilderContext *context,
+                                               ProxySegment *segment)
+{
+  int i, j;
+
+  for (i = 0; i < segment->frames_num; i++) {
+    const ProxySegmentFrame *frame = &segment->frames[i];
+    index_rebuild_ffmpeg_add_index_entry(
+        context, NULL, 0, frame->seek_pos, frame->seek_pos_dts, frame->pts);
+  }
+
+  for (i = 0; i < context->num_proxy_sizes; i++) {
+    if (context->proxy_ctx[i]) {
+      for (j = 0; j < segment->proxy_packets[i].num; j++) {
+        proxy_output_ffmpeg_write_packet(context->proxy_ctx[i],
+                                         &segment->proxy_packets[i].packets[j]);
+      }
+    }
+  }
+}
+
+/* Merge finished segments in stream order, waiting for them as long as there are
+ * max_segments or more in flight, or a segment with input_size bytes of packets
+ * doesn't fit in memory next to them. */
+static void proxy_segment_builder_merge(ProxySegmentBuilder *builder,
+                                        int max_segments,
+                                        size_t input_size,
+                                        short *do_update,
+                                        float *progress,
+                                        uint64_t stream_size)
+{
+  BLI_mutex_lock(&builder->mutex);
+
+  while (builder->segments.first) {
+    ProxySegment *segment = builder->segments.first;
+
+    if (!segment->done) {
+      if (!proxy_segment_builder_is_full(builder, max_segments, input_size)) {
+        break;
+      }
+      BLI_condition_wait(&builder->cond, &builder->mutex);
+      continue;
+    }
+
+    BLI_remlink(&builder->segments, segment);
+    builder->segments_num--;
+    const bool failed = builder->failed;
+    BLI_mutex_unlock(&builder->mutex);
+
+    if (!proxy_segment_builder_stopped(builder) && !failed) {
+      float next_progress;
+
+      index_rebuild_ffmpeg_segment_merge(builder->context, segment);
+
+      next_progress = (float)((int)floor(((double)segment->end_pos) * 100 /
+                                             ((double)stream_size) +
+                                         0.5)) /
+                      100;
+      if (*progress != next_progress) {
+        *progress = next_progress;
+        *do_update = true;
+      }
+    }
+    proxy_segment_free(segment);
+
+    BLI_mutex_lock(&builder->mutex);
+  }
+
+  BLI_mutex_unlock(&builder->mutex);
+}
+
+static void proxy_segment_builder_dispatch(ProxySegmentBuilder *builder,
+                                           ProxySegment *segment,
+                                           const ProxySegment *next,
+                                           short *do_update,
+                                           float *progress,
+                                           uint64_t stream_size)
+{
+  if (next) {
+    const int num = next->first_gop_num ? next->first_gop_num : next->packets.num;
+    int i;
+
+    for (i = 0; i < num; i++) {
+      AVPacket packet;
+      av_copy_packet(&packet, &next->packets.packets[i]);
+      proxy_segment_packets_append(&segment->trailing, &packet);
+    }
+  }
+
+  /* Keep the amount of packets and encoded frames in memory bounded. */
+  segment->input_size = segment->packets.size + segment->trailing.size;
+  proxy_segment_builder_merge(
+      builder, builder->segments_max, segment->input_size, do_update, progress, stream_size);
+
+  BLI_mutex_lock(&builder->mutex);
+  BLI_addtail(&builder->segments, segment);
+  builder->segments_num++;
+  builder->input_size += segment->input_size;
+  BLI_mutex_unlock(&builder->mutex);
+
+  BLI_task_pool_push(
+      builder->task_pool, index_rebuild_ffmpeg_segment_task, segment, false, TASK_PRIORITY_LOW);
+}
+
+static int index_rebuild_ffmpeg_segmented(FFmpegIndexBuilderContext *context,
+                                          short *stop,
+                                          short *do_update,
+                                          float *progress)
+{
+  ProxySegmentBuilder builder = {NULL};
+  ProxySegment *current, *pending = NULL;
+  AVPacket next_packet;
+  uint64_t stream_size;
+
+  memset(&next_packet, 0, sizeof(AVPacket));
+
+  stream_size = avio_size(context->iFormatCtx->pb);
+
+  context->frame_rate = av_q2d(av_guess_frame_rate(context->iFormatCtx, context->iStream, NULL));
+  context->pts_time_base = av_q2d(context->iStream->time_base);
+
+  builder.context = context;
+  builder.job_stop = stop;
+  builder.segments_max = BLI_system_thread_count();
+  BLI_mutex_init(&builder.mutex);
+  BLI_condition_init(&builder.cond);
+  builder.task_pool = BLI_task_pool_create_background(BLI_task_scheduler_get(), &builder);
+
+  current = MEM_callocN(sizeof(ProxySegment), "proxy segment");
+
+  while (!*stop && !proxy_segment_builder_failed(&builder) &&
+         av_read_frame(context->iFormatCtx, &next_packet) >= 0) {
+    if (next_packet.stream_index != context->videoStream) {
+      av_free_packet(&next_packet);
+      continue;
+    }
+
+    /* The packet is kept around after reading the next one. */
+    av_dup_packet(&next_packet);
+
+    if (next_packet.flags & AV_PKT_FLAG_KEY) {
+      if ((current->packets.num >= PROXY_SEGMENT_MIN_PACKETS ||
+           current->packets.size >= PROXY_SEGMENT_MIN_SIZE) &&
+          next_packet.pts != AV_NOPTS_VALUE &&
+          (!current->has_pts_start || next_packet.pts > current->pts_start)) {
+        /* This key frame starts a new segment. */
+        current->pts_end = next_packet.pts;
+        current->has_pts_end = true;
+        if (current->first_gop_num == 0) {
+          current->first_gop_num = current->packets.num;
+        }
+
+        if (pending) {
+          proxy_segment_builder_dispatch(
+              &builder, pending, current, do_update, progress, stream_size);
+        }
+        pending = current;
+
+        current = MEM_callocN(sizeof(ProxySegment), "proxy segment");
+        current->pts_start = next_packet.pts;
+        current->has_pts_start = true;
+      }
+      else if (current->first_gop_num == 0 && current->packets.num > 0) {
+        current->first_gop_num = current->packets.num;
+
+        /* The previous segment has everything it needs now. */
+        if (pending) {
+          proxy_segment_builder_dispatch(
+              &builder, pending, current, do_update, progress, stream_size);
+          pending = NULL;
+        }
+      }
+    }
+
+    if (next_packet.pos >= 0) {
+      current->end_pos = next_packet.pos;
+    }
+    proxy_segment_packets_append(&current->packets, &next_packet);
+    memset(&next_packet, 0, sizeof(AVPacket));
+  }
+
+  av_free_packet(&next_packet);
+
+  if (!*stop && !proxy_segment_builder_failed(&builder)) {
+    if (pending) {
+      proxy_segment_builder_dispatch(&builder, pending, current, do_update, progress, stream_size);
+      pending = NULL;
+    }
+    proxy_segment_builder_dispatch(&builder, current, NULL, do_update, progress, stream_size);
+    current = NULL;
+  }
+  else {
+    BLI_mutex_lock(&builder.mutex);
+    builder.stop = true;
+    BLI_mutex_unlock(&builder.mutex);
+  }
+
+  if (pending) {
+    proxy_segment_free(pending);
+  }
+  if (current) {
+    proxy_segment_free(current);
+  }
+
+  /* Wait for all segments, merging them as they finish. */
+  proxy_segment_builder_merge(&builder, 1, 0, do_update, progress, stream_size);
+
+  BLI_task_pool_work_and_wait(builder.task_pool);
+  BLI_task_pool_free(builder.task_pool);
+  BLI_condition_end(&builder.cond);
+  BLI_mutex_end(&builder.mutex);
+
+  if (builder.failed) {
+    context->build_failed = true;
+  }
+
+  return 1;
+}
+
 #endif
 
 /* ----------------------------------------------------------------------
@@ -1228,7 +1916,13 @@ void IMB_anim_index_rebuild(struct IndexBuildContext *context,
   switch (context->anim_type) {
 #ifdef WITH_FFMPEG
     case ANIM_FFMPEG:
-      index_rebuild_ffmpeg((FFmpegIndexBuilderContext *)context, stop, do_update, progress);
+      if (BLI_system_thread_count() > 1) {
+        index_rebuild_ffmpeg_segmented(
+            (FFmpegIndexBuilderContext *)context, stop, do_update, progress);
+      }
+      else {
+        index_rebuild_ffmpeg((FFmpegIndexBuilderContext *)context, stop, do_update, progress);
+      }
       break;
 #endif
 #ifdef WITH_AVI
@@ -1264,6 +1958,10 @@ void IMB_free_indices(struct anim *anim)
 {
   int i;
 
+  /* The decode-ahead worker reads through the indices, and its frames may have been looked up
+   * through the old ones. */
+  imb_anim_decode_ahead_release(anim);
+
   for (i = 0; i < IMB_PROXY_MAX_SLOT; i++) {
     if (anim->proxy_anim[i]) {
       IMB_close_anim(anim->proxy_anim[i]);
@@ -1339,13 +2037,16 @@ struct anim_index *IMB_anim_open_index(struct anim *anim, IMB_Timecode_Type tc)
 
 int IMB_anim_index_get_frame_index(struct anim *anim, IMB_Timecode_Type tc, int position)
 {
-  struct anim_index *idx = IMB_anim_open_index(anim, tc);
+  struct anim_index *idx;
 
-  if (!idx) {
-    return position;
+  imb_anim_decode_lock(anim);
+  idx = IMB_anim_open_index(anim, tc);
+  if (idx) {
+    position = IMB_indexer_get_frame_index(idx, position);
   }
+  imb_anim_decode_unlock(anim);
 
-  return IMB_indexer_get_frame_index(idx, position);
+  return position;
 }
 
 IMB_Proxy_Size IMB_anim_proxy_get_existing(struct anim *anim)
@@ -102,6 +102,7 @@ using namespace Imath;
 extern "C" {
 /* prototype */
 static struct ExrPass *imb_exr_get_pass(ListBase *lb, char *passname);
+static void imb_exr_pass_set_rect(struct ExrHandle *data, struct ExrPass *pass, float *rect);
 static bool exr_has_multiview(MultiPartInputFile &file);
 static bool exr_has_multipart_file(MultiPartInputFile &file);
 static bool exr_has_alpha(MultiPartInputFile &file);
@@ -647,6 +648,9 @@ typedef struct ExrHandle {
   ListBase layers;   /* hierarchical, pointing in end to ExrChannel */
 
   int num_half_channels; /* used during filr save, allows faster temporary buffers allocation */
+
+  /* Multilayer passes are only read on request, see IMB_exr_read_pass(). */
+  bool lazy;
 } ExrHandle;
 
 /* flattened out channel */
@@ -1011,6 +1015,64 @@ int IMB_exr_begin_read(void *handle, const char *filename, int *width, int *heig
   return 0;
 }
 
+/* Handles loaded with IB_multilayer_lazy only have their layers and passes set up,
+ * the memory they were loaded from is gone. Reopen the file so passes can be read with
+ * IMB_exr_read_pass(). When the file changed in the meantime all passes are left black,
+ * like a failed read. */
+bool IMB_exr_begin_read_lazy(void *handle, const char *filename)
+{
+  ExrHandle *data = (ExrHandle *)handle;
+  IStream *file_stream = NULL;
+  MultiPartInputFile *file = NULL;
+
+  if (!data->lazy) {
+    return false;
+  }
+
+  try {
+    file_stream = new IFileStream(filename);
+    file = new MultiPartInputFile(*file_stream);
+
+    Box2i dw = file->header(0).dataWindow();
+    if (file->parts() != data->ifile->parts() || dw != data->ifile->header(0).dataWindow()) {
+      throw Iex::InputExc("file changed since it was loaded");
+    }
+  }
+  catch (const std::exception &exc) {
+    std::cerr << "OpenEXR-lazy read: ERROR: " << exc.what() << std::endl;
+    delete file;
+    delete file_stream;
+    file = NULL;
+    file_stream = NULL;
+  }
+
+  /* The stream of the loaded memory, only its headers are still valid. */
+  delete data->ifile;
+  delete data->ifile_stream;
+  data->ifile = file;
+  data->ifile_stream = file_stream;
+
+  if (file == NULL) {
+    ExrLayer *lay;
+    ExrPass *pass;
+
+    for (lay = (ExrLayer *)data->layers.first; lay; lay = lay->next) {
+      for (pass = (ExrPass *)lay->passes.first; pass; pass = pass->next) {
+        if (pass->totchan) {
+          imb_exr_pass_set_rect(
+              data,
+              pass,
+              (float *)MEM_mapallocN(data->width * data->height * pass->totchan * sizeof(float),
+                                     "pass rect"));
+        }
+      }
+    }
+    data->lazy = false;
+  }
+
+  return data->lazy;
+}
+
 /* still clumsy name handling, layers/channels can be ordered as list in list later */
 /* passname here is the raw channel name without the layer */
 void IMB_exr_set_channel(
@@ -1207,17 +1269,43 @@ void IMB_exrtile_write_channels(
   }
 }
 
-void IMB_exr_read_channels(void *handle)
+/* check if exr was saved with previous versions of blender which flipped images */
+static bool imb_exr_is_flipped(ExrHandle *data)
 {
-  ExrHandle *data = (ExrHandle *)handle;
-  int numparts = data->ifile->parts();
-
-  /* check if exr was saved with previous versions of blender which flipped images */
   const StringAttribute *ta = data->ifile->header(0).findTypedAttribute<StringAttribute>(
       "BlenderMultiChannel");
 
   /* 'previous multilayer attribute, flipped. */
-  short flip = (ta && STREQLEN(ta->value().c_str(), "Blender V2.43", 13));
+  return (ta && STREQLEN(ta->value().c_str(), "Blender V2.43", 13));
+}
+
+static void imb_exr_insert_read_slice(
+    ExrHandle *data, ExrChannel *echan, const Box2i &dw, bool flip, FrameBuffer &frameBuffer)
+{
+  float *rect = echan->rect;
+  size_t xstride = echan->xstride * sizeof(float);
+  size_t ystride = echan->ystride * sizeof(float);
+
+  if (!flip) {
+    /* Inverse correct first pixel for data-window coordinates. */
+    rect -= echan->xstride * (dw.min.x - dw.min.y * data->width);
+    /* move to last scanline to flip to Blender convention */
+    rect += echan->xstride * (data->height - 1) * data->width;
+    ystride = -ystride;
+  }
+  else {
+    /* Inverse correct first pixel for data-window coordinates. */
+    rect -= echan->xstride * (dw.min.x + dw.min.y * data->width);
+  }
+
+  frameBuffer.insert(echan->m->internal_name, Slice(Imf::FLOAT, (char *)rect, xstride, ystride));
+}
+
+void IMB_exr_read_channels(void *handle)
+{
+  ExrHandle *data = (ExrHandle *)handle;
+  int numparts = data->ifile->parts();
+  const bool flip = imb_exr_is_flipped(data);
 
   exr_printf(
       "\nIMB_exr_read_channels\n%s %-6s %-22s "
@@ -1249,24 +1337,7 @@ void IMB_exr_read_channels(void *handle)
                  echan->m->internal_name.c_str());
 
       if (echan->rect) {
-        float *rect = echan->rect;
-        size_t xstride = echan->xstride * sizeof(float);
-        size_t ystride = echan->ystride * sizeof(float);
-
-        if (!flip) {
-          /* Inverse correct first pixel for data-window coordinates. */
-          rect -= echan->xstride * (dw.min.x - dw.min.y * data->width);
-          /* move to last scanline to flip to Blender convention */
-          rect += echan->xstride * (data->height - 1) * data->width;
-          ystride = -ystride;
-        }
-        else {
-          /* Inverse correct first pixel for data-window coordinates. */
-          rect -= echan->xstride * (dw.min.x + dw.min.y * data->width);
-        }
-
-        frameBuffer.insert(echan->m->internal_name,
-                           Slice(Imf::FLOAT, (char *)rect, xstride, ystride));
+        imb_exr_insert_read_slice(data, echan, dw, flip, frameBuffer);
       }
       else {
         printf("warning, channel with no rect set %s\n", echan->m->internal_name.c_str());
@@ -1286,6 +1357,85 @@ void IMB_exr_read_channels(void *handle)
   }
 }
 
+/* Decodes the channels of a single pass of a lazily read handle, only the parts
+ * containing the pass are touched and of those only the pass channels converted.
+ * Scanline blocks or tiles are located through the chunk offset tables of the file
+ * and decompressed by the OpenEXR global thread pool. The caller owns the returned
+ * buffer, NULL is returned when the pass doesn't exist or can't be read. */
+float *IMB_exr_read_pass(void *handle,
+                         const char *layname,
+                         const char *passname,
+                         const char *viewname)
+{
+  ExrHandle *data = (ExrHandle *)handle;
+  ExrLayer *lay = (ExrLayer *)BLI_findstring(&data->layers, layname, offsetof(ExrLayer, name));
+  ExrPass *pass;
+
+  if (lay == NULL || !data->lazy) {
+    return NULL;
+  }
+
+  for (pass = (ExrPass *)lay->passes.first; pass; pass = pass->next) {
+    if (STREQ(pass->internal_name, passname) && STREQ(pass->view, viewname)) {
+      break;
+    }
+  }
+
+  if (pass == NULL || pass->totchan == 0) {
+    return NULL;
+  }
+
+  const bool flip = imb_exr_is_flipped(data);
+  float *rect = (float *)MEM_mapallocN(
+      sizeof(float) * data->width * data->height * pass->totchan, "pass rect");
+  bool ok = true;
+  imb_exr_pass_set_rect(data, pass, rect);
+
+  for (int i = 0; i < data->ifile->parts(); i++) {
+    FrameBuffer frameBuffer;
+    Box2i dw = data->ifile->header(i).dataWindow();
+    bool has_channels = false;
+
+    for (int a = 0; a < pass->totchan; a++) {
+      if (pass->chan[a]->m->part_number == i) {
+        imb_exr_insert_read_slice(data, pass->chan[a], dw, flip, frameBuffer);
+        has_channels = true;
+      }
+    }
+
+    if (!has_channels) {
+      continue;
+    }
+
+    try {
+      InputPart in(*data->ifile, i);
+      in.setFrameBuffer(frameBuffer);
+      in.readPixels(dw.min.y, dw.max.y);
+    }
+    catch (const std::exception &exc) {
+      std::cerr << "OpenEXR-readPixels: ERROR: " << exc.what() << std::endl;
+      ok = false;
+      break;
+    }
+  }
+
+  /* Ownership goes to the caller, the pass can be read again. */
+  imb_exr_pass_set_rect(data, pass, NULL);
+
+  if (!ok) {
+    MEM_freeN(rect);
+    return NULL;
+  }
+
+  return rect;
+}
+
+bool IMB_exr_has_lazy_passes(void *handle)
+{
+  ExrHandle *data = (ExrHandle *)handle;
+  return data->lazy;
+}
+
 void IMB_exr_multilayer_convert(void *handle,
                                 void *base,
                                 void *(*addview)(void *base, const char *str),
@@ -1527,17 +1677,77 @@ static ExrPass *imb_exr_get_pass(ListBase *lb, char *passname)
   return pass;
 }
 
-/* creates channels, makes a hierarchy and assigns memory to channels */
-static ExrHandle *imb_exr_begin_read_mem(IStream &file_stream,
-                                         MultiPartInputFile &file,
-                                         int width,
-                                         int height)
+/* Points the channels of a pass into its buffer, with some heuristics to merge
+ * the channels in interleaved RGB(A), XYZ(W) or UVA order. */
+static void imb_exr_pass_set_rect(ExrHandle *data, ExrPass *pass, float *rect)
+{
+  ExrChannel *echan;
+  int a;
+
+  pass->rect = rect;
+
+  if (pass->totchan == 1) {
+    echan = pass->chan[0];
+    echan->rect = rect;
+    echan->xstride = 1;
+    echan->ystride = data->width;
+    pass->chan_id[0] = echan->chan_id;
+  }
+  else {
+    char lookup[256];
+
+    memset(lookup, 0, sizeof(lookup));
+
+    /* we can have RGB(A), XYZ(W), UVA */
+    if (pass->totchan == 3 || pass->totchan == 4) {
+      if (pass->chan[0]->chan_id == 'B' || pass->chan[1]->chan_id == 'B' ||
+          pass->chan[2]->chan_id == 'B') {
+        lookup[(unsigned int)'R'] = 0;
+        lookup[(unsigned int)'G'] = 1;
+        lookup[(unsigned int)'B'] = 2;
+        lookup[(unsigned int)'A'] = 3;
+      }
+      else if (pass->chan[0]->chan_id == 'Y' || pass->chan[1]->chan_id == 'Y' ||
+               pass->chan[2]->chan_id == 'Y') {
+        lookup[(unsigned int)'X'] = 0;
+        lookup[(unsigned int)'Y'] = 1;
+        lookup[(unsigned int)'Z'] = 2;
+        lookup[(unsigned int)'W'] = 3;
+      }
+      else {
+        lookup[(unsigned int)'U'] = 0;
+        lookup[(unsigned int)'V'] = 1;
+        lookup[(unsigned int)'A'] = 2;
+      }
+      for (a = 0; a < pass->totchan; a++) {
+        echan = pass->chan[a];
+        echan->rect = rect ? rect + lookup[(unsigned int)echan->chan_id] : NULL;
+        echan->xstride = pass->totchan;
+        echan->ystride = data->width * pass->totchan;
+        pass->chan_id[(unsigned int)lookup[(unsigned int)echan->chan_id]] = echan->chan_id;
+      }
+    }
+    else { /* unknown */
+      for (a = 0; a < pass->totchan; a++) {
+        echan = pass->chan[a];
+        echan->rect = rect ? rect + a : NULL;
+        echan->xstride = pass->totchan;
+        echan->ystride = data->width * pass->totchan;
+        pass->chan_id[a] = echan->chan_id;
+      }
+    }
+  }
+}
+
+/* creates channels, makes a hierarchy and assigns memory to channels,
+ * for lazy reading pass memory is only assigned by IMB_exr_read_pass() */
+static ExrHandle *imb_exr_begin_read_mem(
+    IStream &file_stream, MultiPartInputFile &file, int width, int height, bool lazy)
 {
   ExrLayer *lay;
   ExrPass *pass;
   ExrChannel *echan;
   ExrHandle *data = (ExrHandle *)IMB_exr_get_handle();
-  int a;
   char layname[EXR_TOT_MAXNAME], passname[EXR_TOT_MAXNAME];
 
   data->ifile_stream = &file_stream;
@@ -1602,63 +1812,18 @@ static ExrHandle *imb_exr_begin_read_mem(IStream &file_stream,
   for (lay = (ExrLayer *)data->layers.first; lay; lay = lay->next) {
     for (pass = (ExrPass *)lay->passes.first; pass; pass = pass->next) {
       if (pass->totchan) {
-        pass->rect = (float *)MEM_mapallocN(width * height * pass->totchan * sizeof(float),
-                                            "pass rect");
-        if (pass->totchan == 1) {
-          echan = pass->chan[0];
-          echan->rect = pass->rect;
-          echan->xstride = 1;
-          echan->ystride = width;
-          pass->chan_id[0] = echan->chan_id;
-        }
-        else {
-          char lookup[256];
-
-          memset(lookup, 0, sizeof(lookup));
-
-          /* we can have RGB(A), XYZ(W), UVA */
-          if (pass->totchan == 3 || pass->totchan == 4) {
-            if (pass->chan[0]->chan_id == 'B' || pass->chan[1]->chan_id == 'B' ||
-                pass->chan[2]->chan_id == 'B') {
-              lookup[(unsigned int)'R'] = 0;
-              lookup[(unsigned int)'G'] = 1;
-              lookup[(unsigned int)'B'] = 2;
-              lookup[(unsigned int)'A'] = 3;
-            }
-            else if (pass->chan[0]->chan_id == 'Y' || pass->chan[1]->chan_id == 'Y' ||
-                     pass->chan[2]->chan_id == 'Y') {
-              lookup[(unsigned int)'X'] = 0;
-              lookup[(unsigned int)'Y'] = 1;
-              lookup[(unsigned int)'Z'] = 2;
-              lookup[(unsigned int)'W'] = 3;
-            }
-            else {
-              lookup[(unsigned int)'U'] = 0;
-              lookup[(unsigned int)'V'] = 1;
-              lookup[(unsigned int)'A'] = 2;
-            }
-            for (a = 0; a < pass->totchan; a++) {
-              echan = pass->chan[a];
-              echan->rect = pass->rect + lookup[(unsigned int)echan->chan_id];
-              echan->xstride = pass->totchan;
-              echan->ystride = width * pass->totchan;
-              pass->chan_id[(unsigned int)lookup[(unsigned int)echan->chan_id]] = echan->chan_id;
-            }
-          }
-          else { /* unknown */
-            for (a = 0; a < pass->totchan; a++) {
-              echan = pass->chan[a];
-              echan->rect = pass->rect + a;
-              echan->xstride = pass->totchan;
-              echan->ystride = width * pass->totchan;
-              pass->chan_id[a] = echan->chan_id;
-            }
-          }
+        float *rect = NULL;
+        if (!lazy) {
+          rect = (float *)MEM_mapallocN(width * height * pass->totchan * sizeof(float),
+                                        "pass rect");
         }
+        imb_exr_pass_set_rect(data, pass, rect);
       }
     }
   }
 
+  data->lazy = lazy;
+
   return data;
 }
 
@@ -1939,9 +2104,12 @@ struct ImBuf *imb_load_openexr(const unsigned char *mem,
         /* Only enters with IB_multilayer flag set. */
         if (is_multi && ((flags & IB_thumbnail) == 0)) {
           /* constructs channels for reading, allocates memory in channels */
-          ExrHandle *handle = imb_exr_begin_read_mem(*membuf, *file, width, height);
+          const bool lazy = (flags & IB_multilayer_lazy) != 0;
+          ExrHandle *handle = imb_exr_begin_read_mem(*membuf, *file, width, height, lazy);
           if (handle) {
-            IMB_exr_read_channels(handle);
+            if (!lazy) {
+              IMB_exr_read_channels(handle);
+            }
             ibuf->userdata = handle; /* potential danger, the caller has to check for this! */
           }
         }
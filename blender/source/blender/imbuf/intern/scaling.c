@@ -22,9 +22,17 @@
  * \ingroup imbuf
  */
 
+#include <string.h>
+
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 #include "BLI_utildefines.h"
+#include "BLI_math_base.h"
 #include "BLI_math_color.h"
 #include "BLI_math_interp.h"
+#include "BLI_task.h"
 #include "MEM_guardedalloc.h"
 
 #include "imbuf.h"
@@ -906,646 +914,912 @@ static bool q_scale_linear_interpolation(struct ImBuf *ibuf, int newx, int newy)
   return true;
 }
 
-static ImBuf *scaledownx(struct ImBuf *ibuf, int newx)
-{
-  const int do_rect = (ibuf->rect != NULL);
-  const int do_float = (ibuf->rect_float != NULL);
-  const size_t rect_size = ibuf->x * ibuf->y * 4;
-
-  uchar *rect, *_newrect, *newrect;
-  float *rectf, *_newrectf, *newrectf;
-  float sample, add, val[4], nval[4], valf[4], nvalf[4];
-  int x, y;
-
-  rectf = _newrectf = newrectf = NULL;
-  rect = _newrect = newrect = NULL;
-  nval[0] = nval[1] = nval[2] = nval[3] = 0.0f;
-  nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
-
-  if (!do_rect && !do_float) {
-    return (ibuf);
-  }
-
-  if (do_rect) {
-    _newrect = MEM_mallocN(newx * ibuf->y * sizeof(uchar) * 4, "scaledownx");
-    if (_newrect == NULL) {
-      return (ibuf);
-    }
-  }
-  if (do_float) {
-    _newrectf = MEM_mallocN(newx * ibuf->y * sizeof(float) * 4, "scaledownxf");
-    if (_newrectf == NULL) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
-      }
-      return (ibuf);
-    }
-  }
-
-  add = (ibuf->x - 0.01) / newx;
+/* -------------------------------------------------------------------- */
+/* Separable scaling
+ *
+ * Images are scaled one axis at a time. Horizontal passes are split over rows, vertical passes
+ * over strips of columns which are walked row by row, so memory is always read in order. A pixel
+ * is handled as four floats at once, using SSE2 when available.
+ *
+ * The box filter passes do per pixel exactly the same arithmetic as the serial loops they
+ * replace, so their output is identical.
+ */
 
-  if (do_rect) {
-    rect = (uchar *)ibuf->rect;
-    newrect = _newrect;
-  }
-  if (do_float) {
-    rectf = ibuf->rect_float;
-    newrectf = _newrectf;
-  }
+/* Width of the column strips handled by a single task in vertical passes. */
+#define SCALE_STRIP_WIDTH 128
 
-  for (y = ibuf->y; y > 0; y--) {
-    sample = 0.0f;
-    val[0] = val[1] = val[2] = val[3] = 0.0f;
-    valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
+#ifdef __SSE2__
+typedef __m128 scale_float4;
 
-    for (x = newx; x > 0; x--) {
-      if (do_rect) {
-        nval[0] = -val[0] * sample;
-        nval[1] = -val[1] * sample;
-        nval[2] = -val[2] * sample;
-        nval[3] = -val[3] * sample;
-      }
-      if (do_float) {
-        nvalf[0] = -valf[0] * sample;
-        nvalf[1] = -valf[1] * sample;
-        nvalf[2] = -valf[2] * sample;
-        nvalf[3] = -valf[3] * sample;
-      }
+BLI_INLINE scale_float4 scale_f4_set1(const float f)
+{
+  return _mm_set1_ps(f);
+}
+BLI_INLINE scale_float4 scale_f4_add(const scale_float4 a, const scale_float4 b)
+{
+  return _mm_add_ps(a, b);
+}
+BLI_INLINE scale_float4 scale_f4_sub(const scale_float4 a, const scale_float4 b)
+{
+  return _mm_sub_ps(a, b);
+}
+BLI_INLINE scale_float4 scale_f4_mul(const scale_float4 a, const scale_float4 b)
+{
+  return _mm_mul_ps(a, b);
+}
+BLI_INLINE scale_float4 scale_f4_div(const scale_float4 a, const scale_float4 b)
+{
+  return _mm_div_ps(a, b);
+}
+BLI_INLINE scale_float4 scale_f4_negate(const scale_float4 a)
+{
+  return _mm_xor_ps(a, _mm_set1_ps(-0.0f));
+}
+BLI_INLINE scale_float4 scale_f4_clamp(const scale_float4 a, const float min, const float max)
+{
+  return _mm_min_ps(_mm_max_ps(a, _mm_set1_ps(min)), _mm_set1_ps(max));
+}
+BLI_INLINE scale_float4 scale_f4_load_float(const float *p)
+{
+  return _mm_loadu_ps(p);
+}
+BLI_INLINE void scale_f4_store_float(float *p, const scale_float4 a)
+{
+  _mm_storeu_ps(p, a);
+}
+BLI_INLINE scale_float4 scale_f4_load_uchar(const uchar *p)
+{
+  int32_t i;
+  __m128i v;
+
+  memcpy(&i, p, sizeof(i));
+  v = _mm_cvtsi32_si128(i);
+  v = _mm_unpacklo_epi8(v, _mm_setzero_si128());
+  v = _mm_unpacklo_epi16(v, _mm_setzero_si128());
+  return _mm_cvtepi32_ps(v);
+}
+/* Truncates like a cast to uchar, values are expected to be in the 0..255 range. */
+BLI_INLINE void scale_f4_store_uchar(uchar *p, const scale_float4 a)
+{
+  __m128i v = _mm_cvttps_epi32(a);
+  int32_t i;
 
-      sample += add;
+  v = _mm_packs_epi32(v, v);
+  v = _mm_packus_epi16(v, v);
+  i = _mm_cvtsi128_si32(v);
+  memcpy(p, &i, sizeof(i));
+}
+#else
+typedef struct scale_float4 {
+  float v[4];
+} scale_float4;
 
-      while (sample >= 1.0f) {
-        sample -= 1.0f;
+BLI_INLINE scale_float4 scale_f4_set1(const float f)
+{
+  scale_float4 r = {{f, f, f, f}};
+  return r;
+}
+BLI_INLINE scale_float4 scale_f4_add(const scale_float4 a, const scale_float4 b)
+{
+  scale_float4 r = {{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]}};
+  return r;
+}
+BLI_INLINE scale_float4 scale_f4_sub(const scale_float4 a, const scale_float4 b)
+{
+  scale_float4 r = {{a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]}};
+  return r;
+}
+BLI_INLINE scale_float4 scale_f4_mul(const scale_float4 a, const scale_float4 b)
+{
+  scale_float4 r = {{a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]}};
+  return r;
+}
+BLI_INLINE scale_float4 scale_f4_div(const scale_float4 a, const scale_float4 b)
+{
+  scale_float4 r = {{a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2], a.v[3] / b.v[3]}};
+  return r;
+}
+BLI_INLINE scale_float4 scale_f4_negate(const scale_float4 a)
+{
+  scale_float4 r = {{-a.v[0], -a.v[1], -a.v[2], -a.v[3]}};
+  return r;
+}
+BLI_INLINE scale_float4 scale_f4_clamp(const scale_float4 a, const float min, const float max)
+{
+  scale_float4 r = {{CLAMPIS(a.v[0], min, max),
+                     CLAMPIS(a.v[1], min, max),
+                     CLAMPIS(a.v[2], min, max),
+                     CLAMPIS(a.v[3], min, max)}};
+  return r;
+}
+BLI_INLINE scale_float4 scale_f4_load_float(const float *p)
+{
+  scale_float4 r = {{p[0], p[1], p[2], p[3]}};
+  return r;
+}
+BLI_INLINE void scale_f4_store_float(float *p, const scale_float4 a)
+{
+  p[0] = a.v[0];
+  p[1] = a.v[1];
+  p[2] = a.v[2];
+  p[3] = a.v[3];
+}
+BLI_INLINE scale_float4 scale_f4_load_uchar(const uchar *p)
+{
+  scale_float4 r = {{p[0], p[1], p[2], p[3]}};
+  return r;
+}
+BLI_INLINE void scale_f4_store_uchar(uchar *p, const scale_float4 a)
+{
+  p[0] = a.v[0];
+  p[1] = a.v[1];
+  p[2] = a.v[2];
+  p[3] = a.v[3];
+}
+#endif /* __SSE2__ */
 
-        if (do_rect) {
-          nval[0] += rect[0];
-          nval[1] += rect[1];
-          nval[2] += rect[2];
-          nval[3] += rect[3];
-          rect += 4;
-        }
-        if (do_float) {
-          nvalf[0] += rectf[0];
-          nvalf[1] += rectf[1];
-          nvalf[2] += rectf[2];
-          nvalf[3] += rectf[3];
-          rectf += 4;
-        }
-      }
+typedef struct ScalePassData {
+  const ImBuf *ibuf;
+  /* New size along the scaled axis. */
+  int newlen;
+  float add;
 
-      if (do_rect) {
-        val[0] = rect[0];
-        val[1] = rect[1];
-        val[2] = rect[2];
-        val[3] = rect[3];
-        rect += 4;
+  uchar *newrect;
+  float *newrectf;
+} ScalePassData;
 
-        newrect[0] = ((nval[0] + sample * val[0]) / add + 0.5f);
-        newrect[1] = ((nval[1] + sample * val[1]) / add + 0.5f);
-        newrect[2] = ((nval[2] + sample * val[2]) / add + 0.5f);
-        newrect[3] = ((nval[3] + sample * val[3]) / add + 0.5f);
+static void scale_pass_settings(TaskParallelSettings *settings, const ImBuf *ibuf, int newlen)
+{
+  BLI_parallel_range_settings_defaults(settings);
+  settings->use_threading = ((size_t)max_ii(ibuf->x, ibuf->y) * newlen > 64 * 64);
+}
 
-        newrect += 4;
-      }
-      if (do_float) {
+static int scale_pass_strips_num(const ImBuf *ibuf)
+{
+  return (ibuf->x + SCALE_STRIP_WIDTH - 1) / SCALE_STRIP_WIDTH;
+}
 
-        valf[0] = rectf[0];
-        valf[1] = rectf[1];
-        valf[2] = rectf[2];
-        valf[3] = rectf[3];
-        rectf += 4;
+static bool scale_pass_alloc(ScalePassData *data, ImBuf *ibuf, int newx, int newy, float add)
+{
+  const size_t newsize = (size_t)newx * newy * 4;
 
-        newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
-        newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
-        newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
-        newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
+  data->ibuf = ibuf;
+  data->add = add;
+  data->newrect = NULL;
+  data->newrectf = NULL;
 
-        newrectf += 4;
+  if (ibuf->rect) {
+    data->newrect = MEM_mallocN(newsize * sizeof(uchar), "scale rect");
+    if (data->newrect == NULL) {
+      return false;
+    }
+  }
+  if (ibuf->rect_float) {
+    data->newrectf = MEM_mallocN(newsize * sizeof(float), "scale rectf");
+    if (data->newrectf == NULL) {
+      if (data->newrect) {
+        MEM_freeN(data->newrect);
       }
-
-      sample -= 1.0f;
+      return false;
     }
   }
+  return true;
+}
 
-  if (do_rect) {
-    // printf("%ld %ld\n", (uchar *)rect - ((uchar *)ibuf->rect), rect_size);
-    BLI_assert((uchar *)rect - ((uchar *)ibuf->rect) == rect_size); /* see bug [#26502] */
+static void scale_pass_finish(ScalePassData *data, ImBuf *ibuf, int newx, int newy)
+{
+  if (data->newrect) {
     imb_freerectImBuf(ibuf);
     ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)_newrect;
+    ibuf->rect = (unsigned int *)data->newrect;
   }
-  if (do_float) {
-    // printf("%ld %ld\n", rectf - ibuf->rect_float, rect_size);
-    BLI_assert((rectf - ibuf->rect_float) == rect_size); /* see bug [#26502] */
+  if (data->newrectf) {
     imb_freerectfloatImBuf(ibuf);
     ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = _newrectf;
+    ibuf->rect_float = data->newrectf;
   }
-  (void)rect_size; /* UNUSED in release builds */
 
   ibuf->x = newx;
-  return (ibuf);
+  ibuf->y = newy;
 }
 
-static ImBuf *scaledowny(struct ImBuf *ibuf, int newy)
+static void scaledownx_row(void *__restrict userdata,
+                           const int y,
+                           const TaskParallelTLS *__restrict UNUSED(tls))
 {
-  const int do_rect = (ibuf->rect != NULL);
-  const int do_float = (ibuf->rect_float != NULL);
-  const size_t rect_size = ibuf->x * ibuf->y * 4;
-
-  uchar *rect, *_newrect, *newrect;
-  float *rectf, *_newrectf, *newrectf;
-  float sample, add, val[4], nval[4], valf[4], nvalf[4];
-  int x, y, skipx;
+  const ScalePassData *data = userdata;
+  const ImBuf *ibuf = data->ibuf;
+  const int newx = data->newlen;
+  const scale_float4 add = scale_f4_set1(data->add);
+  const scale_float4 half = scale_f4_set1(0.5f);
+
+  const uchar *rect = NULL;
+  const float *rectf = NULL;
+  uchar *newrect = NULL;
+  float *newrectf = NULL;
+  scale_float4 val, nval, valf, nvalf;
+  float sample = 0.0f;
+  int x;
+
+  val = nval = valf = nvalf = scale_f4_set1(0.0f);
+
+  if (data->newrect) {
+    rect = (uchar *)ibuf->rect + (size_t)y * ibuf->x * 4;
+    newrect = data->newrect + (size_t)y * newx * 4;
+  }
+  if (data->newrectf) {
+    rectf = ibuf->rect_float + (size_t)y * ibuf->x * 4;
+    newrectf = data->newrectf + (size_t)y * newx * 4;
+  }
+
+  for (x = newx; x > 0; x--) {
+    if (rect) {
+      nval = scale_f4_mul(scale_f4_negate(val), scale_f4_set1(sample));
+    }
+    if (rectf) {
+      nvalf = scale_f4_mul(scale_f4_negate(valf), scale_f4_set1(sample));
+    }
 
-  rectf = _newrectf = newrectf = NULL;
-  rect = _newrect = newrect = NULL;
-  nval[0] = nval[1] = nval[2] = nval[3] = 0.0f;
-  nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
+    sample += data->add;
 
-  if (!do_rect && !do_float) {
-    return (ibuf);
-  }
+    while (sample >= 1.0f) {
+      sample -= 1.0f;
 
-  if (do_rect) {
-    _newrect = MEM_mallocN(newy * ibuf->x * sizeof(uchar) * 4, "scaledowny");
-    if (_newrect == NULL) {
-      return (ibuf);
-    }
-  }
-  if (do_float) {
-    _newrectf = MEM_mallocN(newy * ibuf->x * sizeof(float) * 4, "scaledownyf");
-    if (_newrectf == NULL) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
+      if (rect) {
+        nval = scale_f4_add(nval, scale_f4_load_uchar(rect));
+        rect += 4;
+      }
+      if (rectf) {
+        nvalf = scale_f4_add(nvalf, scale_f4_load_float(rectf));
+        rectf += 4;
       }
-      return (ibuf);
     }
-  }
 
-  add = (ibuf->y - 0.01) / newy;
-  skipx = 4 * ibuf->x;
+    if (rect) {
+      val = scale_f4_load_uchar(rect);
+      rect += 4;
 
-  for (x = skipx - 4; x >= 0; x -= 4) {
-    if (do_rect) {
-      rect = ((uchar *)ibuf->rect) + x;
-      newrect = _newrect + x;
+      scale_f4_store_uchar(
+          newrect,
+          scale_f4_add(scale_f4_div(scale_f4_add(nval, scale_f4_mul(scale_f4_set1(sample), val)),
+                                    add),
+                       half));
+      newrect += 4;
     }
-    if (do_float) {
-      rectf = ibuf->rect_float + x;
-      newrectf = _newrectf + x;
+    if (rectf) {
+      valf = scale_f4_load_float(rectf);
+      rectf += 4;
+
+      scale_f4_store_float(
+          newrectf,
+          scale_f4_div(scale_f4_add(nvalf, scale_f4_mul(scale_f4_set1(sample), valf)), add));
+      newrectf += 4;
     }
 
-    sample = 0.0f;
-    val[0] = val[1] = val[2] = val[3] = 0.0f;
-    valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
+    sample -= 1.0f;
+  }
 
-    for (y = newy; y > 0; y--) {
-      if (do_rect) {
-        nval[0] = -val[0] * sample;
-        nval[1] = -val[1] * sample;
-        nval[2] = -val[2] * sample;
-        nval[3] = -val[3] * sample;
+  /* Every row has to consume exactly one row of the source, see bug [#26502]. */
+  BLI_assert(!rect || rect == (uchar *)ibuf->rect + (size_t)(y + 1) * ibuf->x * 4);
+  BLI_assert(!rectf || rectf == ibuf->rect_float + (size_t)(y + 1) * ibuf->x * 4);
+}
+
+static ImBuf *scaledownx(struct ImBuf *ibuf, int newx)
+{
+  ScalePassData data;
+  TaskParallelSettings settings;
+
+  if (ibuf->rect == NULL && ibuf->rect_float == NULL) {
+    return (ibuf);
+  }
+  if (!scale_pass_alloc(&data, ibuf, newx, ibuf->y, (ibuf->x - 0.01) / newx)) {
+    return (ibuf);
+  }
+  data.newlen = newx;
+
+  scale_pass_settings(&settings, ibuf, newx);
+  BLI_task_parallel_range(0, ibuf->y, &data, scaledownx_row, &settings);
+
+  scale_pass_finish(&data, ibuf, newx, ibuf->y);
+  return (ibuf);
+}
+
+static void scaledowny_strip(void *__restrict userdata,
+                             const int strip,
+                             const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ScalePassData *data = userdata;
+  const ImBuf *ibuf = data->ibuf;
+  const int newy = data->newlen;
+  const size_t skipx = 4 * (size_t)ibuf->x;
+  const int x_start = strip * SCALE_STRIP_WIDTH;
+  const int width = min_ii(SCALE_STRIP_WIDTH, ibuf->x - x_start);
+  const scale_float4 add = scale_f4_set1(data->add);
+  const scale_float4 half = scale_f4_set1(0.5f);
+
+  const uchar *rect = NULL;
+  const float *rectf = NULL;
+  uchar *newrect = NULL;
+  float *newrectf = NULL;
+  /* Per column state of the strip, the sample position is the same for all columns. */
+  scale_float4 val[SCALE_STRIP_WIDTH], nval[SCALE_STRIP_WIDTH];
+  scale_float4 valf[SCALE_STRIP_WIDTH], nvalf[SCALE_STRIP_WIDTH];
+  float sample = 0.0f;
+  int i, y;
+
+  for (i = 0; i < width; i++) {
+    val[i] = valf[i] = scale_f4_set1(0.0f);
+  }
+
+  if (data->newrect) {
+    rect = (uchar *)ibuf->rect + 4 * (size_t)x_start;
+    newrect = data->newrect + 4 * (size_t)x_start;
+  }
+  if (data->newrectf) {
+    rectf = ibuf->rect_float + 4 * (size_t)x_start;
+    newrectf = data->newrectf + 4 * (size_t)x_start;
+  }
+
+  for (y = newy; y > 0; y--) {
+    const scale_float4 sample_prev = scale_f4_set1(sample);
+
+    for (i = 0; i < width; i++) {
+      if (rect) {
+        nval[i] = scale_f4_mul(scale_f4_negate(val[i]), sample_prev);
       }
-      if (do_float) {
-        nvalf[0] = -valf[0] * sample;
-        nvalf[1] = -valf[1] * sample;
-        nvalf[2] = -valf[2] * sample;
-        nvalf[3] = -valf[3] * sample;
+      if (rectf) {
+        nvalf[i] = scale_f4_mul(scale_f4_negate(valf[i]), sample_prev);
       }
+    }
 
-      sample += add;
+    sample += data->add;
 
-      while (sample >= 1.0f) {
-        sample -= 1.0f;
+    while (sample >= 1.0f) {
+      sample -= 1.0f;
 
-        if (do_rect) {
-          nval[0] += rect[0];
-          nval[1] += rect[1];
-          nval[2] += rect[2];
-          nval[3] += rect[3];
-          rect += skipx;
+      for (i = 0; i < width; i++) {
+        if (rect) {
+          nval[i] = scale_f4_add(nval[i], scale_f4_load_uchar(rect + 4 * i));
         }
-        if (do_float) {
-          nvalf[0] += rectf[0];
-          nvalf[1] += rectf[1];
-          nvalf[2] += rectf[2];
-          nvalf[3] += rectf[3];
-          rectf += skipx;
+        if (rectf) {
+          nvalf[i] = scale_f4_add(nvalf[i], scale_f4_load_float(rectf + 4 * i));
         }
       }
-
-      if (do_rect) {
-        val[0] = rect[0];
-        val[1] = rect[1];
-        val[2] = rect[2];
-        val[3] = rect[3];
+      if (rect) {
         rect += skipx;
-
-        newrect[0] = ((nval[0] + sample * val[0]) / add + 0.5f);
-        newrect[1] = ((nval[1] + sample * val[1]) / add + 0.5f);
-        newrect[2] = ((nval[2] + sample * val[2]) / add + 0.5f);
-        newrect[3] = ((nval[3] + sample * val[3]) / add + 0.5f);
-
-        newrect += skipx;
       }
-      if (do_float) {
-
-        valf[0] = rectf[0];
-        valf[1] = rectf[1];
-        valf[2] = rectf[2];
-        valf[3] = rectf[3];
+      if (rectf) {
         rectf += skipx;
+      }
+    }
 
-        newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
-        newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
-        newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
-        newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
-
-        newrectf += skipx;
+    {
+      const scale_float4 sample_cur = scale_f4_set1(sample);
+
+      for (i = 0; i < width; i++) {
+        if (rect) {
+          val[i] = scale_f4_load_uchar(rect + 4 * i);
+          scale_f4_store_uchar(
+              newrect + 4 * i,
+              scale_f4_add(
+                  scale_f4_div(scale_f4_add(nval[i], scale_f4_mul(sample_cur, val[i])), add),
+                  half));
+        }
+        if (rectf) {
+          valf[i] = scale_f4_load_float(rectf + 4 * i);
+          scale_f4_store_float(
+              newrectf + 4 * i,
+              scale_f4_div(scale_f4_add(nvalf[i], scale_f4_mul(sample_cur, valf[i])), add));
+        }
       }
+    }
 
-      sample -= 1.0f;
+    if (rect) {
+      rect += skipx;
+      newrect += skipx;
     }
+    if (rectf) {
+      rectf += skipx;
+      newrectf += skipx;
+    }
+
+    sample -= 1.0f;
   }
 
-  if (do_rect) {
-    // printf("%ld %ld\n", (uchar *)rect - ((uchar *)ibuf->rect), rect_size);
-    BLI_assert((uchar *)rect - ((uchar *)ibuf->rect) == rect_size); /* see bug [#26502] */
-    imb_freerectImBuf(ibuf);
-    ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)_newrect;
+  /* Every column has to consume exactly one column of the source, see bug [#26502]. */
+  BLI_assert(!rect || rect == (uchar *)ibuf->rect + skipx * ibuf->y + 4 * (size_t)x_start);
+  BLI_assert(!rectf || rectf == ibuf->rect_float + skipx * ibuf->y + 4 * (size_t)x_start);
+}
+
+static ImBuf *scaledowny(struct ImBuf *ibuf, int newy)
+{
+  ScalePassData data;
+  TaskParallelSettings settings;
+
+  if (ibuf->rect == NULL && ibuf->rect_float == NULL) {
+    return (ibuf);
   }
-  if (do_float) {
-    // printf("%ld %ld\n", rectf - ibuf->rect_float, rect_size);
-    BLI_assert((rectf - ibuf->rect_float) == rect_size); /* see bug [#26502] */
-    imb_freerectfloatImBuf(ibuf);
-    ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = (float *)_newrectf;
+  if (!scale_pass_alloc(&data, ibuf, ibuf->x, newy, (ibuf->y - 0.01) / newy)) {
+    return (ibuf);
   }
-  (void)rect_size; /* UNUSED in release builds */
+  data.newlen = newy;
 
-  ibuf->y = newy;
+  scale_pass_settings(&settings, ibuf, newy);
+  BLI_task_parallel_range(0, scale_pass_strips_num(ibuf), &data, scaledowny_strip, &settings);
+
+  scale_pass_finish(&data, ibuf, ibuf->x, newy);
   return (ibuf);
 }
 
+static void scaleupx_row(void *__restrict userdata,
+                         const int y,
+                         const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ScalePassData *data = userdata;
+  const ImBuf *ibuf = data->ibuf;
+  const int newx = data->newlen;
+  /* A single pixel wide image has nothing to interpolate with. */
+  const int next = (ibuf->x > 1) ? 4 : 0;
+  const scale_float4 half = scale_f4_set1(0.5f);
+
+  const uchar *rect = NULL;
+  const float *rectf = NULL;
+  uchar *newrect = NULL;
+  float *newrectf = NULL;
+  scale_float4 val, nval, diff, valf, nvalf, difff;
+  float sample = 0.0f;
+  int x;
+
+  val = nval = diff = valf = nvalf = difff = scale_f4_set1(0.0f);
+
+  if (data->newrect) {
+    rect = (uchar *)ibuf->rect + (size_t)y * ibuf->x * 4;
+    newrect = data->newrect + (size_t)y * newx * 4;
+
+    val = scale_f4_load_uchar(rect);
+    nval = scale_f4_load_uchar(rect + next);
+    diff = scale_f4_sub(nval, val);
+    val = scale_f4_add(val, half);
+    rect += 8;
+  }
+  if (data->newrectf) {
+    rectf = ibuf->rect_float + (size_t)y * ibuf->x * 4;
+    newrectf = data->newrectf + (size_t)y * newx * 4;
+
+    valf = scale_f4_load_float(rectf);
+    nvalf = scale_f4_load_float(rectf + next);
+    difff = scale_f4_sub(nvalf, valf);
+    rectf += 8;
+  }
+
+  for (x = newx; x > 0; x--) {
+    if (sample >= 1.0f) {
+      sample -= 1.0f;
+
+      if (rect) {
+        val = nval;
+        nval = scale_f4_load_uchar(rect);
+        diff = scale_f4_sub(nval, val);
+        val = scale_f4_add(val, half);
+        rect += 4;
+      }
+      if (rectf) {
+        valf = nvalf;
+        nvalf = scale_f4_load_float(rectf);
+        difff = scale_f4_sub(nvalf, valf);
+        rectf += 4;
+      }
+    }
+
+    if (rect) {
+      scale_f4_store_uchar(newrect, scale_f4_add(val, scale_f4_mul(scale_f4_set1(sample), diff)));
+      newrect += 4;
+    }
+    if (rectf) {
+      scale_f4_store_float(newrectf,
+                           scale_f4_add(valf, scale_f4_mul(scale_f4_set1(sample), difff)));
+      newrectf += 4;
+    }
+
+    sample += data->add;
+  }
+}
+
 static ImBuf *scaleupx(struct ImBuf *ibuf, int newx)
 {
-  uchar *rect, *_newrect = NULL, *newrect;
-  float *rectf, *_newrectf = NULL, *newrectf;
-  float sample, add;
-  float val_a, nval_a, diff_a;
-  float val_b, nval_b, diff_b;
-  float val_g, nval_g, diff_g;
-  float val_r, nval_r, diff_r;
-  float val_af, nval_af, diff_af;
-  float val_bf, nval_bf, diff_bf;
-  float val_gf, nval_gf, diff_gf;
-  float val_rf, nval_rf, diff_rf;
-  int x, y;
-  bool do_rect = false, do_float = false;
+  ScalePassData data;
+  TaskParallelSettings settings;
 
-  val_a = nval_a = diff_a = val_b = nval_b = diff_b = 0;
-  val_g = nval_g = diff_g = val_r = nval_r = diff_r = 0;
-  val_af = nval_af = diff_af = val_bf = nval_bf = diff_bf = 0;
-  val_gf = nval_gf = diff_gf = val_rf = nval_rf = diff_rf = 0;
   if (ibuf == NULL) {
     return (NULL);
   }
   if (ibuf->rect == NULL && ibuf->rect_float == NULL) {
     return (ibuf);
   }
-
-  if (ibuf->rect) {
-    do_rect = true;
-    _newrect = MEM_mallocN(newx * ibuf->y * sizeof(int), "scaleupx");
-    if (_newrect == NULL) {
-      return (ibuf);
-    }
-  }
-  if (ibuf->rect_float) {
-    do_float = true;
-    _newrectf = MEM_mallocN(newx * ibuf->y * sizeof(float) * 4, "scaleupxf");
-    if (_newrectf == NULL) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
-      }
-      return (ibuf);
-    }
+  if (!scale_pass_alloc(&data, ibuf, newx, ibuf->y, (ibuf->x - 1.001) / (newx - 1.0))) {
+    return (ibuf);
   }
+  data.newlen = newx;
 
-  add = (ibuf->x - 1.001) / (newx - 1.0);
-
-  rect = (uchar *)ibuf->rect;
-  rectf = (float *)ibuf->rect_float;
-  newrect = _newrect;
-  newrectf = _newrectf;
+  scale_pass_settings(&settings, ibuf, newx);
+  BLI_task_parallel_range(0, ibuf->y, &data, scaleupx_row, &settings);
 
-  for (y = ibuf->y; y > 0; y--) {
-
-    sample = 0;
+  scale_pass_finish(&data, ibuf, newx, ibuf->y);
+  return (ibuf);
+}
 
-    if (do_rect) {
-      val_a = rect[0];
-      nval_a = rect[4];
-      diff_a = nval_a - val_a;
-      val_a += 0.5f;
-
-      val_b = rect[1];
-      nval_b = rect[5];
-      diff_b = nval_b - val_b;
-      val_b += 0.5f;
-
-      val_g = rect[2];
-      nval_g = rect[6];
-      diff_g = nval_g - val_g;
-      val_g += 0.5f;
-
-      val_r = rect[3];
-      nval_r = rect[7];
-      diff_r = nval_r - val_r;
-      val_r += 0.5f;
-
-      rect += 8;
+static void scaleupy_strip(void *__restrict userdata,
+                           const int strip,
+                           const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ScalePassData *data = userdata;
+  const ImBuf *ibuf = data->ibuf;
+  const int newy = data->newlen;
+  const size_t skipx = 4 * (size_t)ibuf->x;
+  /* A single pixel high image has nothing to interpolate with. */
+  const size_t next = (ibuf->y > 1) ? skipx : 0;
+  const int x_start = strip * SCALE_STRIP_WIDTH;
+  const int width = min_ii(SCALE_STRIP_WIDTH, ibuf->x - x_start);
+  const scale_float4 half = scale_f4_set1(0.5f);
+
+  const uchar *rect = NULL;
+  const float *rectf = NULL;
+  uchar *newrect = NULL;
+  float *newrectf = NULL;
+  /* Per column state of the strip, the sample position is the same for all columns. */
+  scale_float4 val[SCALE_STRIP_WIDTH], nval[SCALE_STRIP_WIDTH], diff[SCALE_STRIP_WIDTH];
+  scale_float4 valf[SCALE_STRIP_WIDTH], nvalf[SCALE_STRIP_WIDTH], difff[SCALE_STRIP_WIDTH];
+  float sample = 0.0f;
+  int i, y;
+
+  if (data->newrect) {
+    rect = (uchar *)ibuf->rect + 4 * (size_t)x_start;
+    newrect = data->newrect + 4 * (size_t)x_start;
+
+    for (i = 0; i < width; i++) {
+      val[i] = scale_f4_load_uchar(rect + 4 * i);
+      nval[i] = scale_f4_load_uchar(rect + next + 4 * i);
+      diff[i] = scale_f4_sub(nval[i], val[i]);
+      val[i] = scale_f4_add(val[i], half);
     }
-    if (do_float) {
-      val_af = rectf[0];
-      nval_af = rectf[4];
-      diff_af = nval_af - val_af;
+    rect += 2 * skipx;
+  }
+  if (data->newrectf) {
+    rectf = ibuf->rect_float + 4 * (size_t)x_start;
+    newrectf = data->newrectf + 4 * (size_t)x_start;
 
-      val_bf = rectf[1];
-      nval_bf = rectf[5];
-      diff_bf = nval_bf - val_bf;
+    for (i = 0; i < width; i++) {
+      valf[i] = scale_f4_load_float(rectf + 4 * i);
+      nvalf[i] = scale_f4_load_float(rectf + next + 4 * i);
+      difff[i] = scale_f4_sub(nvalf[i], valf[i]);
+    }
+    rectf += 2 * skipx;
+  }
 
-      val_gf = rectf[2];
-      nval_gf = rectf[6];
-      diff_gf = nval_gf - val_gf;
+  for (y = newy; y > 0; y--) {
+    scale_float4 sample_cur;
 
-      val_rf = rectf[3];
-      nval_rf = rectf[7];
-      diff_rf = nval_rf - val_rf;
+    if (sample >= 1.0f) {
+      sample -= 1.0f;
 
-      rectf += 8;
-    }
-    for (x = newx; x > 0; x--) {
-      if (sample >= 1.0f) {
-        sample -= 1.0f;
-
-        if (do_rect) {
-          val_a = nval_a;
-          nval_a = rect[0];
-          diff_a = nval_a - val_a;
-          val_a += 0.5f;
-
-          val_b = nval_b;
-          nval_b = rect[1];
-          diff_b = nval_b - val_b;
-          val_b += 0.5f;
-
-          val_g = nval_g;
-          nval_g = rect[2];
-          diff_g = nval_g - val_g;
-          val_g += 0.5f;
-
-          val_r = nval_r;
-          nval_r = rect[3];
-          diff_r = nval_r - val_r;
-          val_r += 0.5f;
-          rect += 4;
+      for (i = 0; i < width; i++) {
+        if (rect) {
+          val[i] = nval[i];
+          nval[i] = scale_f4_load_uchar(rect + 4 * i);
+          diff[i] = scale_f4_sub(nval[i], val[i]);
+          val[i] = scale_f4_add(val[i], half);
         }
-        if (do_float) {
-          val_af = nval_af;
-          nval_af = rectf[0];
-          diff_af = nval_af - val_af;
-
-          val_bf = nval_bf;
-          nval_bf = rectf[1];
-          diff_bf = nval_bf - val_bf;
-
-          val_gf = nval_gf;
-          nval_gf = rectf[2];
-          diff_gf = nval_gf - val_gf;
-
-          val_rf = nval_rf;
-          nval_rf = rectf[3];
-          diff_rf = nval_rf - val_rf;
-          rectf += 4;
+        if (rectf) {
+          valf[i] = nvalf[i];
+          nvalf[i] = scale_f4_load_float(rectf + 4 * i);
+          difff[i] = scale_f4_sub(nvalf[i], valf[i]);
         }
       }
-      if (do_rect) {
-        newrect[0] = val_a + sample * diff_a;
-        newrect[1] = val_b + sample * diff_b;
-        newrect[2] = val_g + sample * diff_g;
-        newrect[3] = val_r + sample * diff_r;
-        newrect += 4;
+      if (rect) {
+        rect += skipx;
       }
-      if (do_float) {
-        newrectf[0] = val_af + sample * diff_af;
-        newrectf[1] = val_bf + sample * diff_bf;
-        newrectf[2] = val_gf + sample * diff_gf;
-        newrectf[3] = val_rf + sample * diff_rf;
-        newrectf += 4;
+      if (rectf) {
+        rectf += skipx;
       }
-      sample += add;
     }
-  }
 
-  if (do_rect) {
-    imb_freerectImBuf(ibuf);
-    ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)_newrect;
-  }
-  if (do_float) {
-    imb_freerectfloatImBuf(ibuf);
-    ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = (float *)_newrectf;
-  }
+    sample_cur = scale_f4_set1(sample);
+    for (i = 0; i < width; i++) {
+      if (rect) {
+        scale_f4_store_uchar(newrect + 4 * i,
+                             scale_f4_add(val[i], scale_f4_mul(sample_cur, diff[i])));
+      }
+      if (rectf) {
+        scale_f4_store_float(newrectf + 4 * i,
+                             scale_f4_add(valf[i], scale_f4_mul(sample_cur, difff[i])));
+      }
+    }
 
-  ibuf->x = newx;
-  return (ibuf);
+    if (rect) {
+      newrect += skipx;
+    }
+    if (rectf) {
+      newrectf += skipx;
+    }
+
+    sample += data->add;
+  }
 }
 
 static ImBuf *scaleupy(struct ImBuf *ibuf, int newy)
 {
-  uchar *rect, *_newrect = NULL, *newrect;
-  float *rectf, *_newrectf = NULL, *newrectf;
-  float sample, add;
-  float val_a, nval_a, diff_a;
-  float val_b, nval_b, diff_b;
-  float val_g, nval_g, diff_g;
-  float val_r, nval_r, diff_r;
-  float val_af, nval_af, diff_af;
-  float val_bf, nval_bf, diff_bf;
-  float val_gf, nval_gf, diff_gf;
-  float val_rf, nval_rf, diff_rf;
-  int x, y, skipx;
-  bool do_rect = false, do_float = false;
-
-  val_a = nval_a = diff_a = val_b = nval_b = diff_b = 0;
-  val_g = nval_g = diff_g = val_r = nval_r = diff_r = 0;
-  val_af = nval_af = diff_af = val_bf = nval_bf = diff_bf = 0;
-  val_gf = nval_gf = diff_gf = val_rf = nval_rf = diff_rf = 0;
+  ScalePassData data;
+  TaskParallelSettings settings;
+
   if (ibuf == NULL) {
     return (NULL);
   }
   if (ibuf->rect == NULL && ibuf->rect_float == NULL) {
     return (ibuf);
   }
+  if (!scale_pass_alloc(&data, ibuf, ibuf->x, newy, (ibuf->y - 1.001) / (newy - 1.0))) {
+    return (ibuf);
+  }
+  data.newlen = newy;
 
-  if (ibuf->rect) {
-    do_rect = true;
-    _newrect = MEM_mallocN(ibuf->x * newy * sizeof(int), "scaleupy");
-    if (_newrect == NULL) {
-      return (ibuf);
-    }
+  scale_pass_settings(&settings, ibuf, newy);
+  BLI_task_parallel_range(0, scale_pass_strips_num(ibuf), &data, scaleupy_strip, &settings);
+
+  scale_pass_finish(&data, ibuf, ibuf->x, newy);
+  return (ibuf);
+}
+
+/* -------------------------------------------------------------------- */
+/* Filtered scaling
+ *
+ * Generic separable resampling with a filter kernel, widened by the scale factor when scaling
+ * down. Both passes accumulate in floats, the horizontal pass writes into a temporary float
+ * buffer which the vertical pass reads from.
+ */
+
+typedef struct ScaleFilterAxis {
+  /* First source pixel and number of taps of each destination pixel. */
+  int *start;
+  int *taps;
+  /* Normalized weights, taps_max per destination pixel. */
+  float *weights;
+  int taps_max;
+} ScaleFilterAxis;
+
+static float scale_filter_radius(eIMBScaleFilter filter)
+{
+  switch (filter) {
+    case IMB_SCALE_FILTER_LANCZOS:
+      return 3.0f;
+    case IMB_SCALE_FILTER_BILINEAR:
+      return 1.0f;
+    case IMB_SCALE_FILTER_BOX:
+    default:
+      return 0.5f;
   }
-  if (ibuf->rect_float) {
-    do_float = true;
-    _newrectf = MEM_mallocN(ibuf->x * newy * sizeof(float) * 4, "scaleupyf");
-    if (_newrectf == NULL) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
+}
+
+static float scale_filter_weight(eIMBScaleFilter filter, float x)
+{
+  x = fabsf(x);
+
+  switch (filter) {
+    case IMB_SCALE_FILTER_LANCZOS: {
+      const float px = (float)M_PI * x;
+      if (x < 1e-6f) {
+        return 1.0f;
+      }
+      if (x >= 3.0f) {
+        return 0.0f;
       }
-      return (ibuf);
+      return 3.0f * sinf(px) * sinf(px / 3.0f) / (px * px);
     }
+    case IMB_SCALE_FILTER_BILINEAR:
+      return (x < 1.0f) ? 1.0f - x : 0.0f;
+    case IMB_SCALE_FILTER_BOX:
+    default:
+      return (x <= 0.5f) ? 1.0f : 0.0f;
   }
+}
 
-  add = (ibuf->y - 1.001) / (newy - 1.0);
-  skipx = 4 * ibuf->x;
+static void scale_filter_axis_init(ScaleFilterAxis *axis,
+                                   eIMBScaleFilter filter,
+                                   int len,
+                                   int newlen)
+{
+  const float scale = (float)len / (float)newlen;
+  const float filter_scale = max_ff(scale, 1.0f);
+  const float support = scale_filter_radius(filter) * filter_scale;
+  int i;
 
-  rect = (uchar *)ibuf->rect;
-  rectf = (float *)ibuf->rect_float;
-  newrect = _newrect;
-  newrectf = _newrectf;
+  axis->taps_max = (len == newlen) ? 1 : (int)ceilf(support) * 2 + 1;
+  axis->start = MEM_mallocN(sizeof(*axis->start) * newlen, __func__);
+  axis->taps = MEM_mallocN(sizeof(*axis->taps) * newlen, __func__);
+  axis->weights = MEM_callocN(sizeof(*axis->weights) * newlen * axis->taps_max, __func__);
+
+  for (i = 0; i < newlen; i++) {
+    float *weights = axis->weights + (size_t)i * axis->taps_max;
+    float center, weight_sum = 0.0f;
+    int j, first, last, start, end;
+
+    if (len == newlen) {
+      axis->start[i] = i;
+      axis->taps[i] = 1;
+      weights[0] = 1.0f;
+      continue;
+    }
 
-  for (x = ibuf->x; x > 0; x--) {
+    center = (i + 0.5f) * scale - 0.5f;
+    first = (int)ceilf(center - support);
+    last = (int)floorf(center + support);
+    last = min_ii(last, first + axis->taps_max - 1);
+
+    /* Taps outside of the image are folded onto the edge pixels. */
+    start = max_ii(first, 0);
+    end = min_ii(last, len - 1);
+    start = min_ii(start, len - 1);
+    end = max_ii(end, start);
+
+    for (j = first; j <= last; j++) {
+      const float weight = scale_filter_weight(filter, (j - center) / filter_scale);
+      weights[CLAMPIS(j, start, end) - start] += weight;
+      weight_sum += weight;
+    }
 
-    sample = 0;
-    if (do_rect) {
-      rect = ((uchar *)ibuf->rect) + 4 * (x - 1);
-      newrect = _newrect + 4 * (x - 1);
-
-      val_a = rect[0];
-      nval_a = rect[skipx];
-      diff_a = nval_a - val_a;
-      val_a += 0.5f;
-
-      val_b = rect[1];
-      nval_b = rect[skipx + 1];
-      diff_b = nval_b - val_b;
-      val_b += 0.5f;
-
-      val_g = rect[2];
-      nval_g = rect[skipx + 2];
-      diff_g = nval_g - val_g;
-      val_g += 0.5f;
-
-      val_r = rect[3];
-      nval_r = rect[skipx + 3];
-      diff_r = nval_r - val_r;
-      val_r += 0.5f;
-
-      rect += 2 * skipx;
+    if (weight_sum != 0.0f) {
+      for (j = 0; j <= end - start; j++) {
+        weights[j] /= weight_sum;
+      }
     }
-    if (do_float) {
-      rectf = ibuf->rect_float + 4 * (x - 1);
-      newrectf = _newrectf + 4 * (x - 1);
 
-      val_af = rectf[0];
-      nval_af = rectf[skipx];
-      diff_af = nval_af - val_af;
+    axis->start[i] = start;
+    axis->taps[i] = end - start + 1;
+  }
+}
 
-      val_bf = rectf[1];
-      nval_bf = rectf[skipx + 1];
-      diff_bf = nval_bf - val_bf;
+static void scale_filter_axis_free(ScaleFilterAxis *axis)
+{
+  MEM_freeN(axis->start);
+  MEM_freeN(axis->taps);
+  MEM_freeN(axis->weights);
+}
 
-      val_gf = rectf[2];
-      nval_gf = rectf[skipx + 2];
-      diff_gf = nval_gf - val_gf;
+typedef struct ScaleFilterData {
+  const ImBuf *ibuf;
+  int newx, newy;
+  ScaleFilterAxis axis_x, axis_y;
+
+  /* Source, either bytes or floats. */
+  const uchar *rect;
+  const float *rectf;
+  /* Horizontally scaled image, newx * ibuf->y pixels. */
+  float *temp;
+  /* Destination, either bytes or floats. */
+  uchar *newrect;
+  float *newrectf;
+} ScaleFilterData;
+
+static void scale_filter_horizontal_row(void *__restrict userdata,
+                                        const int y,
+                                        const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ScaleFilterData *data = userdata;
+  const ScaleFilterAxis *axis = &data->axis_x;
+  const size_t row = (size_t)y * data->ibuf->x;
+  float *temp = data->temp + (size_t)y * data->newx * 4;
+  int x, i;
+
+  for (x = 0; x < data->newx; x++) {
+    const float *weights = axis->weights + (size_t)x * axis->taps_max;
+    const size_t start = row + axis->start[x];
+    scale_float4 sum = scale_f4_set1(0.0f);
+
+    if (data->rect) {
+      for (i = 0; i < axis->taps[x]; i++) {
+        sum = scale_f4_add(sum,
+                           scale_f4_mul(scale_f4_set1(weights[i]),
+                                        scale_f4_load_uchar(data->rect + (start + i) * 4)));
+      }
+    }
+    else {
+      for (i = 0; i < axis->taps[x]; i++) {
+        sum = scale_f4_add(sum,
+                           scale_f4_mul(scale_f4_set1(weights[i]),
+                                        scale_f4_load_float(data->rectf + (start + i) * 4)));
+      }
+    }
 
-      val_rf = rectf[3];
-      nval_rf = rectf[skipx + 3];
-      diff_rf = nval_rf - val_rf;
+    scale_f4_store_float(temp + (size_t)x * 4, sum);
+  }
+}
 
-      rectf += 2 * skipx;
+static void scale_filter_vertical_row(void *__restrict userdata,
+                                      const int y,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ScaleFilterData *data = userdata;
+  const ScaleFilterAxis *axis = &data->axis_y;
+  const float *weights = axis->weights + (size_t)y * axis->taps_max;
+  const size_t stride = (size_t)data->newx * 4;
+  const float *temp = data->temp + axis->start[y] * stride;
+  const size_t offset = (size_t)y * stride;
+  int x, i;
+
+  for (x = 0; x < data->newx; x++) {
+    scale_float4 sum = scale_f4_set1(0.0f);
+
+    for (i = 0; i < axis->taps[y]; i++) {
+      sum = scale_f4_add(
+          sum,
+          scale_f4_mul(scale_f4_set1(weights[i]), scale_f4_load_float(temp + i * stride + x * 4)));
     }
 
-    for (y = newy; y > 0; y--) {
-      if (sample >= 1.0f) {
-        sample -= 1.0f;
-
-        if (do_rect) {
-          val_a = nval_a;
-          nval_a = rect[0];
-          diff_a = nval_a - val_a;
-          val_a += 0.5f;
-
-          val_b = nval_b;
-          nval_b = rect[1];
-          diff_b = nval_b - val_b;
-          val_b += 0.5f;
-
-          val_g = nval_g;
-          nval_g = rect[2];
-          diff_g = nval_g - val_g;
-          val_g += 0.5f;
-
-          val_r = nval_r;
-          nval_r = rect[3];
-          diff_r = nval_r - val_r;
-          val_r += 0.5f;
-          rect += skipx;
-        }
-        if (do_float) {
-          val_af = nval_af;
-          nval_af = rectf[0];
-          diff_af = nval_af - val_af;
-
-          val_bf = nval_bf;
-          nval_bf = rectf[1];
-          diff_bf = nval_bf - val_bf;
-
-          val_gf = nval_gf;
-          nval_gf = rectf[2];
-          diff_gf = nval_gf - val_gf;
-
-          val_rf = nval_rf;
-          nval_rf = rectf[3];
-          diff_rf = nval_rf - val_rf;
-          rectf += skipx;
-        }
-      }
-      if (do_rect) {
-        newrect[0] = val_a + sample * diff_a;
-        newrect[1] = val_b + sample * diff_b;
-        newrect[2] = val_g + sample * diff_g;
-        newrect[3] = val_r + sample * diff_r;
-        newrect += skipx;
-      }
-      if (do_float) {
-        newrectf[0] = val_af + sample * diff_af;
-        newrectf[1] = val_bf + sample * diff_bf;
-        newrectf[2] = val_gf + sample * diff_gf;
-        newrectf[3] = val_rf + sample * diff_rf;
-        newrectf += skipx;
-      }
-      sample += add;
+    if (data->newrect) {
+      sum = scale_f4_add(scale_f4_clamp(sum, 0.0f, 255.0f), scale_f4_set1(0.5f));
+      scale_f4_store_uchar(data->newrect + offset + x * 4, sum);
+    }
+    else {
+      scale_f4_store_float(data->newrectf + offset + x * 4, sum);
     }
   }
+}
 
-  if (do_rect) {
+static void *scale_filter_buffer(ScaleFilterData *data, const uchar *rect, const float *rectf)
+{
+  const ImBuf *ibuf = data->ibuf;
+  TaskParallelSettings settings;
+
+  data->rect = rect;
+  data->rectf = rectf;
+  data->newrect = NULL;
+  data->newrectf = NULL;
+  if (rect) {
+    data->newrect = MEM_mallocN((size_t)data->newx * data->newy * 4, "scale filter rect");
+  }
+  else {
+    data->newrectf = MEM_mallocN((size_t)data->newx * data->newy * 4 * sizeof(float),
+                                 "scale filter rectf");
+  }
+
+  scale_pass_settings(&settings, ibuf, data->newx);
+  BLI_task_parallel_range(0, ibuf->y, data, scale_filter_horizontal_row, &settings);
+
+  scale_pass_settings(&settings, ibuf, data->newy);
+  BLI_task_parallel_range(0, data->newy, data, scale_filter_vertical_row, &settings);
+
+  return (rect) ? (void *)data->newrect : (void *)data->newrectf;
+}
+
+static void scale_filter(ImBuf *ibuf, int newx, int newy, eIMBScaleFilter filter)
+{
+  ScaleFilterData data = {NULL};
+
+  data.ibuf = ibuf;
+  data.newx = newx;
+  data.newy = newy;
+  scale_filter_axis_init(&data.axis_x, filter, ibuf->x, newx);
+  scale_filter_axis_init(&data.axis_y, filter, ibuf->y, newy);
+  data.temp = MEM_mallocN((size_t)newx * ibuf->y * 4 * sizeof(float), "scale filter temp");
+
+  if (ibuf->rect) {
+    uchar *newrect = scale_filter_buffer(&data, (uchar *)ibuf->rect, NULL);
     imb_freerectImBuf(ibuf);
     ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)_newrect;
+    ibuf->rect = (unsigned int *)newrect;
   }
-  if (do_float) {
+  if (ibuf->rect_float) {
+    float *newrectf = scale_filter_buffer(&data, NULL, ibuf->rect_float);
     imb_freerectfloatImBuf(ibuf);
     ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = (float *)_newrectf;
+    ibuf->rect_float = newrectf;
   }
 
+  MEM_freeN(data.temp);
+  scale_filter_axis_free(&data.axis_x);
+  scale_filter_axis_free(&data.axis_y);
+
+  ibuf->x = newx;
   ibuf->y = newy;
-  return (ibuf);
 }
 
 static void scalefast_Z_ImBuf(ImBuf *ibuf, int newx, int newy)
@@ -1617,6 +1891,18 @@ static void scalefast_Z_ImBuf(ImBuf *ibuf, int newx, int newy)
  * Return true if \a ibuf is modified.
  */
 bool IMB_scaleImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy)
+{
+  return IMB_scaleImBuf_filter(ibuf, newx, newy, IMB_SCALE_FILTER_BOX);
+}
+
+/**
+ * Scale with the given \a filter, a zero size leaves that axis as it is.
+ * Return true if \a ibuf is modified.
+ */
+bool IMB_scaleImBuf_filter(struct ImBuf *ibuf,
+                           unsigned int newx,
+                           unsigned int newy,
+                           eIMBScaleFilter filter)
 {
   if (ibuf == NULL) {
     return false;
@@ -1625,6 +1911,13 @@ bool IMB_scaleImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy)
     return false;
   }
 
+  if (newx == 0) {
+    newx = ibuf->x;
+  }
+  if (newy == 0) {
+    newy = ibuf->y;
+  }
+
   if (newx == ibuf->x && newy == ibuf->y) {
     return false;
   }
@@ -1639,16 +1932,21 @@ bool IMB_scaleImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy)
     return true;
   }
 
-  if (newx && (newx < ibuf->x)) {
+  if (filter != IMB_SCALE_FILTER_BOX) {
+    scale_filter(ibuf, newx, newy, filter);
+    return true;
+  }
+
+  if (newx < ibuf->x) {
     scaledownx(ibuf, newx);
   }
-  if (newy && (newy < ibuf->y)) {
+  if (newy < ibuf->y) {
     scaledowny(ibuf, newy);
   }
-  if (newx && (newx > ibuf->x)) {
+  if (newx > ibuf->x) {
     scaleupx(ibuf, newx);
   }
-  if (newy && (newy > ibuf->y)) {
+  if (newy > ibuf->y) {
     scaleupy(ibuf, newy);
   }
 
@@ -64,6 +64,8 @@ enum {
   TSE_ACTIVE = (1 << 9),
   /* Needed because walk selection should not activate */
   TSE_ACTIVE_WALK = (1 << 10),
+  /* All children were toggled open, open the ones added by the next tree rebuild too */
+  TSE_OPEN_SUBTREE = (1 << 11),
   TSE_DRAG_ANY = (TSE_DRAG_INTO | TSE_DRAG_BEFORE | TSE_DRAG_AFTER),
 };
 
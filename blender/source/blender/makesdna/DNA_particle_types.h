@@ -338,6 +338,8 @@ typedef struct ParticleSystem {
 
   /** Run-time only lattice deformation data. */
   struct LatticeDeformData *lattice_deform_data;
+  /** Run-time only per-child path parameters, reused between path cache updates. */
+  struct ParticleChildInterpCache *child_interp_cache;
 
   /** Particles from global space -> parent space. */
   struct Object *parent;
@@ -255,6 +255,11 @@ typedef struct SpaceOutliner {
   char show_restrict_flags;
   short filter_id_type;
 
+  /** Depsgraph relations stamp the tree was last built from, zero forces a rebuild (runtime,
+   * cleared on file read and duplicate). */
+  int tree_content_stamp;
+  char _pad1[4];
+
   /**
    * Pointers to treestore elements, grouped by (id, type, nr)
    * in hashtable for faster searching */
@@ -144,6 +144,8 @@ typedef struct wmWindowManager {
 
   /** Refresh/redraw wmNotifier structs. */
   ListBase queue;
+  /** Runtime: the notifiers in #queue, for fast de-duplication. */
+  struct GSet *notifier_queue_set;
 
   /** Information and error reports. */
   struct ReportList reports;
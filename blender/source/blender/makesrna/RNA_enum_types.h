@@ -76,6 +76,7 @@ extern const EnumPropertyItem rna_enum_image_type_items[];
 extern const EnumPropertyItem rna_enum_image_color_mode_items[];
 extern const EnumPropertyItem rna_enum_image_color_depth_items[];
 extern const EnumPropertyItem rna_enum_image_generated_type_items[];
+extern const EnumPropertyItem rna_enum_image_scale_filter_items[];
 
 extern const EnumPropertyItem rna_enum_normal_space_items[];
 extern const EnumPropertyItem rna_enum_normal_swizzle_items[];
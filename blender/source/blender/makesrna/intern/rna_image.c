@@ -28,6 +28,8 @@
 
 #include "BKE_image.h"
 
+#include "IMB_imbuf.h"
+
 #include "DEG_depsgraph.h"
 #include "DEG_depsgraph_build.h"
 
@@ -51,6 +53,21 @@ const EnumPropertyItem rna_enum_image_generated_type_items[] = {
     {0, NULL, 0, NULL, NULL},
 };
 
+const EnumPropertyItem rna_enum_image_scale_filter_items[] = {
+    {IMB_SCALE_FILTER_BOX,
+     "BOX",
+     0,
+     "Box",
+     "Average pixels when scaling down, interpolate linearly when scaling up"},
+    {IMB_SCALE_FILTER_BILINEAR, "BILINEAR", 0, "Bilinear", "Triangle filter"},
+    {IMB_SCALE_FILTER_LANCZOS,
+     "LANCZOS",
+     0,
+     "Lanczos",
+     "Three lobed Lanczos filter, keeps edges sharp but may ring around them"},
+    {0, NULL, 0, NULL, NULL},
+};
+
 static const EnumPropertyItem image_source_items[] = {
     {IMA_SRC_FILE, "FILE", 0, "Single Image", "Single image file"},
     {IMA_SRC_SEQUENCE, "SEQUENCE", 0, "Image Sequence", "Multiple image files, as a sequence"},
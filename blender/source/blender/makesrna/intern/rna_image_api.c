@@ -38,6 +38,8 @@
 
 #include "BKE_packedFile.h"
 
+#include "IMB_imbuf.h"
+
 #include "rna_internal.h" /* own include */
 
 #ifdef RNA_RUNTIME
@@ -46,7 +48,6 @@
 #  include "BKE_image.h"
 #  include "BKE_main.h"
 
-#  include "IMB_imbuf.h"
 #  include "IMB_colormanagement.h"
 
 #  include "DNA_image_types.h"
@@ -208,9 +209,9 @@ static void rna_Image_update(Image *image, ReportList *reports)
   BKE_image_release_ibuf(image, ibuf, NULL);
 }
 
-static void rna_Image_scale(Image *image, ReportList *reports, int width, int height)
+static void rna_Image_scale(Image *image, ReportList *reports, int width, int height, int filter)
 {
-  if (!BKE_image_scale(image, width, height)) {
+  if (!BKE_image_scale(image, width, height, filter)) {
     BKE_reportf(reports, RPT_ERROR, "Image '%s' does not have any image data", image->id.name + 2);
   }
 }
@@ -326,6 +327,12 @@ void RNA_api_image(StructRNA *srna)
   RNA_def_parameter_flags(parm, 0, PARM_REQUIRED);
   parm = RNA_def_int(func, "height", 1, 1, 10000, "", "Height", 1, 10000);
   RNA_def_parameter_flags(parm, 0, PARM_REQUIRED);
+  RNA_def_enum(func,
+               "filter",
+               rna_enum_image_scale_filter_items,
+               IMB_SCALE_FILTER_BOX,
+               "Filter",
+               "Filter used to compute the new pixels");
 
   func = RNA_def_function(srna, "gl_touch", "rna_Image_gl_touch");
   RNA_def_function_ui_description(
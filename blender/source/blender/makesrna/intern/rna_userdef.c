@@ -5062,6 +5062,14 @@ static void rna_def_userdef_system(BlenderRNA *brna)
       prop, "Image Display Method", "Method used for displaying images on the screen");
   RNA_def_property_update(prop, 0, "rna_userdef_update");
 
+  prop = RNA_def_property(srna, "use_display_transform_lut", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "flag", USER_DISPLAY_TRANSFORM_LUT);
+  RNA_def_property_ui_text(prop,
+                           "Baked Display Transform",
+                           "Apply view and display transforms of large images on the CPU "
+                           "through a baked lookup table, faster but slightly less accurate");
+  RNA_def_property_update(prop, 0, "rna_userdef_update");
+
   prop = RNA_def_property(srna, "anisotropic_filter", PROP_ENUM, PROP_NONE);
   RNA_def_property_enum_sdna(prop, NULL, "anisotropic_filter");
   RNA_def_property_enum_items(prop, anisotropic_items);
@@ -34,6 +34,7 @@
 #  include "DNA_texture_types.h"
 
 #  include "BLI_math.h"
+#  include "BLI_task.h"
 #  include "BLI_utildefines.h"
 
 #  include "BKE_cloth.h"
@@ -46,9 +47,9 @@
 #    pragma GCC diagnostic ignored "-Wtype-limits"
 #  endif
 
-#  ifdef _OPENMP
-#    define CLOTH_OPENMP_LIMIT 512
-#  endif
+/* Vertex count from which the solver runs its loops in parallel,
+ * also used as the size of the blocks these loops are split into. */
+#  define CLOTH_PARALLEL_LIMIT 1024
 
 //#define DEBUG_TIME
 
@@ -192,6 +193,39 @@ DO_INLINE void submul_lfvectorS(float (*to)[3],
     VECSUBMUL(to[i], fLongVector[i], scalar);
   }
 }
+/* Arguments of the threaded long vector operations. */
+typedef struct LfVectorTaskData {
+  float (*to)[3];
+  float (*a)[3];
+  float (*b)[3];
+  float scalar;
+  /* Per block partial sums of reductions. */
+  float *partial;
+  unsigned int verts;
+} LfVectorTaskData;
+
+BLI_INLINE void lfvector_parallel_settings(TaskParallelSettings *settings, unsigned int verts)
+{
+  BLI_parallel_range_settings_defaults(settings);
+  settings->use_threading = (verts >= CLOTH_PARALLEL_LIMIT);
+  settings->scheduling_mode = TASK_SCHEDULING_STATIC;
+}
+
+static void dot_lfvector_block_cb(void *__restrict userdata,
+                                  const int block,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const LfVectorTaskData *data = userdata;
+  const int start = block * CLOTH_PARALLEL_LIMIT;
+  const int end = min_ii(start + CLOTH_PARALLEL_LIMIT, (int)data->verts);
+  float temp = 0.0f;
+
+  for (int i = start; i < end; i++) {
+    temp += dot_v3v3(data->a[i], data->b[i]);
+  }
+  data->partial[block] = temp;
+}
+
 /* dot product for big vector */
 DO_INLINE float dot_lfvector(float (*fLongVectorA)[3],
                              float (*fLongVectorB)[3],
@@ -199,14 +233,34 @@ DO_INLINE float dot_lfvector(float (*fLongVectorA)[3],
 {
   long i = 0;
   float temp = 0.0;
-  // XXX brecht, disabled this for now (first schedule line was already disabled),
-  // due to non-commutative nature of floating point ops this makes the sim give
-  // different results each time you run it!
-  // schedule(guided, 2)
-  //#pragma omp parallel for reduction(+: temp) if (verts > CLOTH_OPENMP_LIMIT)
-  for (i = 0; i < (long)verts; i++) {
-    temp += dot_v3v3(fLongVectorA[i], fLongVectorB[i]);
+
+  if (verts < CLOTH_PARALLEL_LIMIT) {
+    for (i = 0; i < (long)verts; i++) {
+      temp += dot_v3v3(fLongVectorA[i], fLongVectorB[i]);
+    }
+    return temp;
+  }
+
+  /* Sum fixed size blocks in parallel and add up the partial sums in order,
+   * a plain reduction would give different results each time you run the sim
+   * due to the non-commutative nature of floating point ops. */
+  const int blocks_len = (int)((verts + CLOTH_PARALLEL_LIMIT - 1) / CLOTH_PARALLEL_LIMIT);
+  LfVectorTaskData data = {
+      .a = fLongVectorA,
+      .b = fLongVectorB,
+      .partial = MEM_mallocN(sizeof(float) * blocks_len, __func__),
+      .verts = verts,
+  };
+
+  TaskParallelSettings settings;
+  lfvector_parallel_settings(&settings, verts);
+  BLI_task_parallel_range(0, blocks_len, &data, dot_lfvector_block_cb, &settings);
+
+  for (i = 0; i < blocks_len; i++) {
+    temp += data.partial[i];
   }
+  MEM_freeN(data.partial);
+
   return temp;
 }
 /* A = B + C  --> for big vector */
@@ -221,6 +275,14 @@ DO_INLINE void add_lfvector_lfvector(float (*to)[3],
     add_v3_v3v3(to[i], fLongVectorA[i], fLongVectorB[i]);
   }
 }
+static void add_lfvector_lfvectorS_cb(void *__restrict userdata,
+                                      const int i,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const LfVectorTaskData *data = userdata;
+  VECADDS(data->to[i], data->a[i], data->b[i], data->scalar);
+}
+
 /* A = B + C * float --> for big vector */
 DO_INLINE void add_lfvector_lfvectorS(float (*to)[3],
                                       float (*fLongVectorA)[3],
@@ -230,9 +292,23 @@ DO_INLINE void add_lfvector_lfvectorS(float (*to)[3],
 {
   unsigned int i = 0;
 
-  for (i = 0; i < verts; i++) {
-    VECADDS(to[i], fLongVectorA[i], fLongVectorB[i], bS);
+  if (verts < CLOTH_PARALLEL_LIMIT) {
+    for (i = 0; i < verts; i++) {
+      VECADDS(to[i], fLongVectorA[i], fLongVectorB[i], bS);
+    }
+    return;
   }
+
+  LfVectorTaskData data = {
+      .to = to,
+      .a = fLongVectorA,
+      .b = fLongVectorB,
+      .scalar = bS,
+  };
+  TaskParallelSettings settings;
+  lfvector_parallel_settings(&settings, verts);
+  settings.min_iter_per_thread = CLOTH_PARALLEL_LIMIT;
+  BLI_task_parallel_range(0, (int)verts, &data, add_lfvector_lfvectorS_cb, &settings);
 }
 /* A = B * float + C * float --> for big vector */
 DO_INLINE void add_lfvectorS_lfvectorS(float (*to)[3],
@@ -607,49 +683,161 @@ DO_INLINE void initdiag_bfmatrix(fmatrix3x3 *matrix, float m3[3][3])
   }
 }
 
-/* SPARSE SYMMETRIC multiply big matrix with long vector*/
-/* STATUS: verified */
-DO_INLINE void mul_bfmatrix_lfvector(float (*to)[3], fmatrix3x3 *from, lfVector *fLongVector)
+/* Block-CSR (compressed sparse row) index of a big matrix.
+ *
+ * Only the lower triangle of the symmetric matrix is stored in the #fmatrix3x3 array,
+ * so every off-diagonal block contributes to two rows of a product. Listing the blocks
+ * of each row allows computing products one row at a time, without write conflicts
+ * between threads. The blocks themselves are not copied, forces keep writing to them
+ * by index. */
+typedef struct bfmatrixCSR {
+  /* For each row i, the transposed blocks (row i is their column) are in
+   * `blocks[row_start[i * 2]] .. blocks[row_start[i * 2 + 1]]`, followed by the
+   * blocks stored for that row up to `blocks[row_start[i * 2 + 2]]`. */
+  int *row_start;
+  int *blocks;
+  unsigned int vcount;
+} bfmatrixCSR;
+
+static void create_bfmatrix_csr(bfmatrixCSR *csr, unsigned int verts, unsigned int springs)
 {
-  unsigned int vcount = from[0].vcount;
-  lfVector *temp = create_lfvector(vcount);
-
-  zero_lfvector(to, vcount);
-
-#  pragma omp parallel sections if (vcount > CLOTH_OPENMP_LIMIT)
-  {
-#  pragma omp section
-    {
-      for (unsigned int i = from[0].vcount; i < from[0].vcount + from[0].scount; i++) {
-        /* This is the lower triangle of the sparse matrix,
-         * therefore multiplication occurs with transposed submatrices. */
-        muladd_fmatrixT_fvector(to[from[i].c], from[i].m, fLongVector[from[i].r]);
-      }
+  csr->row_start = MEM_mallocN(sizeof(int) * (verts * 2 + 1), "cloth_implicit_csr_rows");
+  csr->blocks = MEM_mallocN(sizeof(int) * (verts + springs * 2), "cloth_implicit_csr_blocks");
+  csr->vcount = verts;
+}
+
+static void del_bfmatrix_csr(bfmatrixCSR *csr)
+{
+  MEM_SAFE_FREE(csr->row_start);
+  MEM_SAFE_FREE(csr->blocks);
+}
+
+/* Rebuild the row index for the first `blocks_len` blocks of the matrix.
+ * Blocks of each row stay in storage order, so sums are accumulated in the same order
+ * as the column-wise product. */
+static void update_bfmatrix_csr(bfmatrixCSR *csr, fmatrix3x3 *matrix, unsigned int blocks_len)
+{
+  const unsigned int vcount = csr->vcount;
+  int *row_start = csr->row_start;
+  unsigned int i;
+
+  memset(row_start, 0, sizeof(int) * (vcount * 2 + 1));
+  for (i = 0; i < blocks_len; i++) {
+    if (i >= vcount) {
+      row_start[matrix[i].c * 2 + 1]++;
     }
-#  pragma omp section
-    {
-      for (unsigned int i = 0; i < from[0].vcount + from[0].scount; i++) {
-        muladd_fmatrix_fvector(temp[from[i].r], from[i].m, fLongVector[from[i].c]);
-      }
+    row_start[matrix[i].r * 2 + 2]++;
+  }
+  for (i = 1; i <= vcount * 2; i++) {
+    row_start[i] += row_start[i - 1];
+  }
+
+  /* Fill using the start of each segment as cursor, shifting the offsets up by one segment. */
+  for (i = 0; i < blocks_len; i++) {
+    if (i >= vcount) {
+      csr->blocks[row_start[matrix[i].c * 2]++] = (int)i;
     }
+    csr->blocks[row_start[matrix[i].r * 2 + 1]++] = (int)i;
+  }
+  for (i = vcount * 2; i > 0; i--) {
+    row_start[i] = row_start[i - 1];
+  }
+  row_start[0] = 0;
+}
+
+typedef struct BfMatrixMulData {
+  float (*to)[3];
+  fmatrix3x3 *from;
+  const bfmatrixCSR *csr;
+  lfVector *fLongVector;
+} BfMatrixMulData;
+
+static void mul_bfmatrix_lfvector_row_cb(void *__restrict userdata,
+                                         const int row,
+                                         const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BfMatrixMulData *data = userdata;
+  const int *row_start = &data->csr->row_start[row * 2];
+  const int *blocks = data->csr->blocks;
+  fmatrix3x3 *from = data->from;
+  lfVector *fLongVector = data->fLongVector;
+  float lower[3] = {0.0f, 0.0f, 0.0f};
+  float upper[3] = {0.0f, 0.0f, 0.0f};
+  int j;
+
+  for (j = row_start[0]; j < row_start[1]; j++) {
+    /* This is the lower triangle of the sparse matrix,
+     * therefore multiplication occurs with transposed submatrices. */
+    const fmatrix3x3 *block = &from[blocks[j]];
+    muladd_fmatrixT_fvector(lower, (float(*)[3])block->m, fLongVector[block->r]);
+  }
+  for (j = row_start[1]; j < row_start[2]; j++) {
+    const fmatrix3x3 *block = &from[blocks[j]];
+    muladd_fmatrix_fvector(upper, (float(*)[3])block->m, fLongVector[block->c]);
   }
-  add_lfvector_lfvector(to, to, temp, from[0].vcount);
+  add_v3_v3v3(data->to[row], lower, upper);
+}
+
+/* SPARSE SYMMETRIC multiply big matrix with long vector*/
+/* STATUS: verified */
+DO_INLINE void mul_bfmatrix_lfvector(float (*to)[3],
+                                     fmatrix3x3 *from,
+                                     const bfmatrixCSR *csr,
+                                     lfVector *fLongVector)
+{
+  unsigned int vcount = from[0].vcount;
+  BfMatrixMulData data = {
+      .to = to,
+      .from = from,
+      .csr = csr,
+      .fLongVector = fLongVector,
+  };
+
+  BLI_assert(csr->vcount == vcount);
 
-  del_lfvector(temp);
+  TaskParallelSettings settings;
+  lfvector_parallel_settings(&settings, vcount);
+  settings.min_iter_per_thread = CLOTH_PARALLEL_LIMIT / 4;
+  BLI_task_parallel_range(0, (int)vcount, &data, mul_bfmatrix_lfvector_row_cb, &settings);
 }
 
 /* SPARSE SYMMETRIC sub big matrix with big matrix*/
 /* A -= B * float + C * float --> for big matrix */
 /* VERIFIED */
+typedef struct BfMatrixSubAddData {
+  fmatrix3x3 *to, *from, *matrix;
+  float aS, bS;
+} BfMatrixSubAddData;
+
+static void subadd_bfmatrixS_bfmatrixS_cb(void *__restrict userdata,
+                                          const int i,
+                                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BfMatrixSubAddData *data = userdata;
+  subadd_fmatrixS_fmatrixS(
+      data->to[i].m, data->from[i].m, data->aS, data->matrix[i].m, data->bS);
+}
+
 DO_INLINE void subadd_bfmatrixS_bfmatrixS(
     fmatrix3x3 *to, fmatrix3x3 *from, float aS, fmatrix3x3 *matrix, float bS)
 {
-  unsigned int i = 0;
+  BfMatrixSubAddData data = {
+      .to = to,
+      .from = from,
+      .matrix = matrix,
+      .aS = aS,
+      .bS = bS,
+  };
 
   /* process diagonal elements */
-  for (i = 0; i < matrix[0].vcount + matrix[0].scount; i++) {
-    subadd_fmatrixS_fmatrixS(to[i].m, from[i].m, aS, matrix[i].m, bS);
-  }
+  TaskParallelSettings settings;
+  lfvector_parallel_settings(&settings, matrix[0].vcount);
+  settings.min_iter_per_thread = CLOTH_PARALLEL_LIMIT;
+  BLI_task_parallel_range(0,
+                          (int)(matrix[0].vcount + matrix[0].scount),
+                          &data,
+                          subadd_bfmatrixS_bfmatrixS_cb,
+                          &settings);
 }
 
 ///////////////////////////////////////////////////////////////////
@@ -664,6 +852,7 @@ typedef struct Implicit_Data {
   lfVector *F;             /* forces */
   fmatrix3x3 *dFdV, *dFdX; /* force jacobians */
   int num_blocks;          /* number of off-diagonal blocks (springs) */
+  bfmatrixCSR csr;         /* row index of the blocks, shared by A, dFdV and dFdX */
 
   /* motion state data */
   lfVector *X, *Xnew; /* positions */
@@ -702,6 +891,8 @@ Implicit_Data *BPH_mass_spring_solver_create(int numverts, int numsprings)
   id->dV = create_lfvector(numverts);
   id->z = create_lfvector(numverts);
 
+  create_bfmatrix_csr(&id->csr, numverts, numsprings);
+
   initdiag_bfmatrix(id->bigI, I);
 
   return id;
@@ -728,6 +919,8 @@ void BPH_mass_spring_solver_free(Implicit_Data *id)
   del_lfvector(id->dV);
   del_lfvector(id->z);
 
+  del_bfmatrix_csr(&id->csr);
+
   MEM_freeN(id);
 }
 
@@ -759,19 +952,49 @@ BLI_INLINE void root_to_world_m3(Implicit_Data *data, int index, float r[3][3],
 
 /* ================================ */
 
+typedef struct FilterData {
+  lfVector *V;
+  fmatrix3x3 *S;
+} FilterData;
+
+static void filter_cb(void *__restrict userdata,
+                      const int i,
+                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const FilterData *data = userdata;
+  mul_m3_v3(data->S[i].m, data->V[data->S[i].r]);
+}
+
 DO_INLINE void filter(lfVector *V, fmatrix3x3 *S)
 {
   unsigned int i = 0;
 
-  for (i = 0; i < S[0].vcount; i++) {
-    mul_m3_v3(S[i].m, V[S[i].r]);
+  if (S[0].vcount < CLOTH_PARALLEL_LIMIT) {
+    for (i = 0; i < S[0].vcount; i++) {
+      mul_m3_v3(S[i].m, V[S[i].r]);
+    }
+    return;
   }
+
+  FilterData data = {
+      .V = V,
+      .S = S,
+  };
+  TaskParallelSettings settings;
+  lfvector_parallel_settings(&settings, S[0].vcount);
+  settings.min_iter_per_thread = CLOTH_PARALLEL_LIMIT;
+  BLI_task_parallel_range(0, (int)S[0].vcount, &data, filter_cb, &settings);
 }
 
 /* this version of the CG algorithm does not work very well with partial constraints
  * (where S has non-zero elements). */
 #  if 0
-static int cg_filtered(lfVector *ldV, fmatrix3x3 *lA, lfVector *lB, lfVector *z, fmatrix3x3 *S)
+static int cg_filtered(lfVector *ldV,
+                       fmatrix3x3 *lA,
+                       const bfmatrixCSR *csr,
+                       lfVector *lB,
+                       lfVector *z,
+                       fmatrix3x3 *S)
 {
   // Solves for unknown X in equation AX=B
   unsigned int conjgrad_loopcount = 0, conjgrad_looplimit = 100;
@@ -791,7 +1014,7 @@ static int cg_filtered(lfVector *ldV, fmatrix3x3 *lA, lfVector *lB, lfVector *z,
 
   // r = B - Mul(tmp, A, X);    // just use B if X known to be zero
   cp_lfvector(r, lB, numverts);
-  mul_bfmatrix_lfvector(tmp, lA, ldV);
+  mul_bfmatrix_lfvector(tmp, lA, csr, ldV);
   sub_lfvector_lfvector(r, r, tmp, numverts);
 
   filter(r, S);
@@ -803,7 +1026,7 @@ static int cg_filtered(lfVector *ldV, fmatrix3x3 *lA, lfVector *lB, lfVector *z,
 
   while (s > starget && conjgrad_loopcount < conjgrad_looplimit) {
     // Mul(q, A, d); // q = A*d;
-    mul_bfmatrix_lfvector(q, lA, d);
+    mul_bfmatrix_lfvector(q, lA, csr, d);
 
     filter(q, S);
 
@@ -840,6 +1063,7 @@ static int cg_filtered(lfVector *ldV, fmatrix3x3 *lA, lfVector *lB, lfVector *z,
 
 static int cg_filtered(lfVector *ldV,
                        fmatrix3x3 *lA,
+                       const bfmatrixCSR *csr,
                        lfVector *lB,
                        lfVector *z,
                        fmatrix3x3 *S,
@@ -867,7 +1091,7 @@ static int cg_filtered(lfVector *ldV,
   delta_target = conjgrad_epsilon * conjgrad_epsilon * bnorm2;
 
   /* r = filter(B - A * dV) */
-  mul_bfmatrix_lfvector(AdV, lA, ldV);
+  mul_bfmatrix_lfvector(AdV, lA, csr, ldV);
   sub_lfvector_lfvector(r, lB, AdV, numverts);
   filter(r, S);
 
@@ -890,7 +1114,7 @@ static int cg_filtered(lfVector *ldV,
 #  endif
 
   while (delta_new > delta_target && conjgrad_loopcount < conjgrad_looplimit) {
-    mul_bfmatrix_lfvector(q, lA, c);
+    mul_bfmatrix_lfvector(q, lA, csr, c);
     filter(q, S);
 
     alpha = delta_new / dot_lfvector(c, q, numverts);
@@ -952,6 +1176,7 @@ DO_INLINE void BuildPPinv(fmatrix3x3 *lA, fmatrix3x3 *P, fmatrix3x3 *Pinv)
 // version 1.3
 static int cg_filtered_pre(lfVector *dv,
                            fmatrix3x3 *lA,
+                           const bfmatrixCSR *csr,
                            lfVector *lB,
                            lfVector *z,
                            fmatrix3x3 *S,
@@ -971,7 +1196,7 @@ static int cg_filtered_pre(lfVector *dv,
   filter(dv, S);
   add_lfvector_lfvector(dv, dv, z, numverts);
 
-  mul_bfmatrix_lfvector(r, lA, dv);
+  mul_bfmatrix_lfvector(r, lA, csr, dv);
   sub_lfvector_lfvector(r, lB, r, numverts);
   filter(r, S);
 
@@ -989,7 +1214,7 @@ static int cg_filtered_pre(lfVector *dv,
   while ((deltaNew > delta0) && (iterations < conjgrad_looplimit)) {
     iterations++;
 
-    mul_bfmatrix_lfvector(s, lA, p);
+    mul_bfmatrix_lfvector(s, lA, csr, p);
     filter(s, S);
 
     alpha = deltaNew / dot_lfvector(p, s, numverts);
@@ -1029,12 +1254,14 @@ static int cg_filtered_pre(lfVector *dv,
 // version 1.4
 static int cg_filtered_pre(lfVector *dv,
                            fmatrix3x3 *lA,
+                           const bfmatrixCSR *csr,
                            lfVector *lB,
                            lfVector *z,
                            fmatrix3x3 *S,
                            fmatrix3x3 *P,
                            fmatrix3x3 *Pinv,
-                           fmatrix3x3 *bigI)
+                           fmatrix3x3 *bigI,
+                           const bfmatrixCSR *bigI_csr)
 {
   unsigned int numverts = lA[0].vcount, iterations = 0, conjgrad_looplimit = 100;
   float delta0 = 0, deltaNew = 0, deltaOld = 0, alpha = 0, tol = 0;
@@ -1055,12 +1282,12 @@ static int cg_filtered_pre(lfVector *dv,
   add_lfvector_lfvector(dv, dv, z, numverts);
 
   // b_hat = S(b-A(I-S)z)
-  mul_bfmatrix_lfvector(r, lA, z);
-  mul_bfmatrix_lfvector(bhat, bigI, r);
+  mul_bfmatrix_lfvector(r, lA, csr, z);
+  mul_bfmatrix_lfvector(bhat, bigI, bigI_csr, r);
   sub_lfvector_lfvector(bhat, lB, bhat, numverts);
 
   // r = S(b-Ax)
-  mul_bfmatrix_lfvector(r, lA, dv);
+  mul_bfmatrix_lfvector(r, lA, csr, dv);
   sub_lfvector_lfvector(r, lB, r, numverts);
   filter(r, S);
 
@@ -1079,7 +1306,7 @@ static int cg_filtered_pre(lfVector *dv,
   filter(dv, S);
   add_lfvector_lfvector(dv, dv, z, numverts);
 
-  mul_bfmatrix_lfvector(r, lA, dv);
+  mul_bfmatrix_lfvector(r, lA, csr, dv);
   sub_lfvector_lfvector(r, lB, r, numverts);
   filter(r, S);
 
@@ -1100,7 +1327,7 @@ static int cg_filtered_pre(lfVector *dv,
   while ((deltaNew > delta0 * tol * tol) && (iterations < conjgrad_looplimit)) {
     iterations++;
 
-    mul_bfmatrix_lfvector(s, lA, p);
+    mul_bfmatrix_lfvector(s, lA, csr, p);
     filter(s, S);
 
     alpha = deltaNew / dot_lfvector(p, s, numverts);
@@ -1148,9 +1375,12 @@ bool BPH_mass_spring_solve_velocities(Implicit_Data *data, float dt, ImplicitSol
 
   cp_bfmatrix(data->A, data->M);
 
+  /* All matrices share the layout of the spring blocks added for this step. */
+  update_bfmatrix_csr(&data->csr, data->A, numverts + data->num_blocks);
+
   subadd_bfmatrixS_bfmatrixS(data->A, data->dFdV, dt, data->dFdX, (dt * dt));
 
-  mul_bfmatrix_lfvector(dFdXmV, data->dFdX, data->V);
+  mul_bfmatrix_lfvector(dFdXmV, data->dFdX, &data->csr, data->V);
 
   add_lfvectorS_lfvectorS(data->B, data->F, dt, dFdXmV, (dt * dt), numverts);
 
@@ -1159,9 +1389,7 @@ bool BPH_mass_spring_solve_velocities(Implicit_Data *data, float dt, ImplicitSol
 #  endif
 
   /* Conjugate gradient algorithm to solve Ax=b. */
-  cg_filtered(data->dV, data->A, data->B, data->z, data->S, result);
-
-  // cg_filtered_pre(id->dV, id->A, id->B, id->z, id->S, id->P, id->Pinv, id->bigI);
+  cg_filtered(data->dV, data->A, &data->csr, data->B, data->z, data->S, result);
 
 #  ifdef DEBUG_TIME
   double end = PIL_check_seconds_timer();
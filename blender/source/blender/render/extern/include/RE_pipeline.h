@@ -152,6 +152,13 @@ typedef struct RenderResult {
   char *error;
 
   struct StampData *stamp_data;
+
+  /* multilayer file the pass buffers are read from on demand, owned by the result */
+  void *exrhandle;
+  /* ThreadMutex for reading passes from exrhandle, only allocated along with it */
+  void *exr_mutex;
+  char exr_colorspace[64]; /* MAX_COLORSPACE_NAME */
+  bool exr_predivide;
 } RenderResult;
 
 typedef struct RenderStats {
@@ -160,6 +167,8 @@ typedef struct RenderStats {
   short curfield, curblur, curpart, partsdone, convertdone, curfsa;
   bool localview;
   double starttime, lastframetime;
+  /* Frames saved per second by an animation render, 0 when unknown. */
+  float output_fps;
   const char *infostr, *statstr;
   char scene_name[MAX_ID_NAME - 2];
   float mem_used, mem_peak;
@@ -315,6 +324,7 @@ bool RE_WriteRenderResult(struct ReportList *reports,
                           int layer);
 struct RenderResult *RE_MultilayerConvert(
     void *exrhandle, const char *colorspace, bool predivide, int rectx, int recty);
+float *RE_render_result_pass_rect_ensure(struct RenderResult *rr, struct RenderPass *rpass);
 
 /* display and event callbacks */
 void RE_display_init_cb(struct Render *re,
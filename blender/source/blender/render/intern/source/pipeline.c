@@ -2398,50 +2398,55 @@ bool RE_WriteRenderViewsMovie(ReportList *reports,
   return ok;
 }
 
-static int do_write_image_or_movie(Render *re,
+static void render_output_filepath(char *name,
                                    Main *bmain,
                                    Scene *scene,
-                                   bMovieHandle *mh,
-                                   const int totvideos,
                                    const char *name_override)
 {
-  char name[FILE_MAX];
-  RenderResult rres;
-  double render_time;
+  if (name_override) {
+    BLI_strncpy(name, name_override, FILE_MAX);
+  }
+  else {
+    BKE_image_path_from_imformat(name,
+                                 scene->r.pic,
+                                 BKE_main_blendfile_path(bmain),
+                                 scene->r.cfra,
+                                 &scene->r.im_format,
+                                 (scene->r.scemode & R_EXTENSION) != 0,
+                                 true,
+                                 NULL);
+  }
+}
+
+static bool render_write_result(ReportList *reports,
+                                RenderResult *rres,
+                                Scene *scene,
+                                RenderData *rd,
+                                bMovieHandle *mh,
+                                void **movie_ctx_arr,
+                                const int totvideos,
+                                char *name)
+{
   bool ok = true;
 
-  RE_AcquireResultImageViews(re, &rres);
-
   /* write movie or image */
   if (BKE_imtype_is_movie(scene->r.im_format.imtype)) {
-    RE_WriteRenderViewsMovie(
-        re->reports, &rres, scene, &re->r, mh, re->movie_ctx_arr, totvideos, false);
+    RE_WriteRenderViewsMovie(reports, rres, scene, rd, mh, movie_ctx_arr, totvideos, false);
   }
   else {
-    if (name_override) {
-      BLI_strncpy(name, name_override, sizeof(name));
-    }
-    else {
-      BKE_image_path_from_imformat(name,
-                                   scene->r.pic,
-                                   BKE_main_blendfile_path(bmain),
-                                   scene->r.cfra,
-                                   &scene->r.im_format,
-                                   (scene->r.scemode & R_EXTENSION) != 0,
-                                   true,
-                                   NULL);
-    }
-
     /* write images as individual images or stereo */
-    ok = RE_WriteRenderViewsImage(re->reports, &rres, scene, true, name);
+    ok = RE_WriteRenderViewsImage(reports, rres, scene, true, name);
   }
 
-  RE_ReleaseResultImageViews(re, &rres);
+  return ok;
+}
 
-  render_time = re->i.lastframetime;
-  re->i.lastframetime = PIL_check_seconds_timer() - re->i.starttime;
+/* Print total time spent on a frame and the part of it spent on saving. */
+static void render_print_frame_time(Render *re, double frame_time, double save_time)
+{
+  char name[FILE_MAX];
 
-  BLI_timecode_string_from_time_simple(name, sizeof(name), re->i.lastframetime);
+  BLI_timecode_string_from_time_simple(name, sizeof(name), frame_time);
   printf(" Time: %s", name);
 
   /* Flush stdout to be sure python callbacks are printing stuff after blender. */
@@ -2451,11 +2456,39 @@ static int do_write_image_or_movie(Render *re,
    * Not sure it's actually even used anyway, we could as well pass NULL? */
   render_callback_exec_null(re, G_MAIN, BKE_CB_EVT_RENDER_STATS);
 
-  BLI_timecode_string_from_time_simple(name, sizeof(name), re->i.lastframetime - render_time);
+  BLI_timecode_string_from_time_simple(name, sizeof(name), save_time);
   printf(" (Saving: %s)\n", name);
 
   fputc('\n', stdout);
   fflush(stdout); /* needed for renderd !! (not anymore... (ton)) */
+}
+
+static int do_write_image_or_movie(Render *re,
+                                   Main *bmain,
+                                   Scene *scene,
+                                   bMovieHandle *mh,
+                                   const int totvideos,
+                                   const char *name_override)
+{
+  char name[FILE_MAX];
+  RenderResult rres;
+  double render_time;
+  bool ok = true;
+
+  RE_AcquireResultImageViews(re, &rres);
+
+  if (!BKE_imtype_is_movie(scene->r.im_format.imtype)) {
+    render_output_filepath(name, bmain, scene, name_override);
+  }
+  ok = render_write_result(
+      re->reports, &rres, scene, &re->r, mh, re->movie_ctx_arr, totvideos, name);
+
+  RE_ReleaseResultImageViews(re, &rres);
+
+  render_time = re->i.lastframetime;
+  re->i.lastframetime = PIL_check_seconds_timer() - re->i.starttime;
+
+  render_print_frame_time(re, re->i.lastframetime, re->i.lastframetime - render_time);
 
   return ok;
 }
@@ -2496,6 +2529,291 @@ static void re_movie_free_all(Render *re, bMovieHandle *mh, int totvideos)
   MEM_SAFE_FREE(re->movie_ctx_arr);
 }
 
+/* remove empty file created by R_TOUCH */
+static void render_anim_remove_touched(Scene *scene,
+                                       const RenderData *rd,
+                                       const char *name,
+                                       const bool is_multiview_name)
+{
+  if ((rd->mode & R_TOUCH) == 0) {
+    return;
+  }
+
+  if (!is_multiview_name) {
+    if ((BLI_file_size(name) == 0)) {
+      /* BLI_exists(name) is implicit */
+      BLI_delete(name, false, false);
+    }
+  }
+  else {
+    SceneRenderView *srv;
+    char filepath[FILE_MAX];
+
+    for (srv = scene->r.views.first; srv; srv = srv->next) {
+      if (!BKE_scene_multiview_is_render_view_active(&scene->r, srv)) {
+        continue;
+      }
+
+      BKE_scene_multiview_filepath_get(srv, name, filepath);
+
+      if ((BLI_file_size(filepath) == 0)) {
+        /* BLI_exists(filepath) is implicit */
+        BLI_delete(filepath, false, false);
+      }
+    }
+  }
+}
+
+/* ********* animation output queue ******** */
+
+/* Frames of an animation are written by separate threads, so compressing and saving
+ * a frame overlaps with rendering the next one. The number of frames waiting to be
+ * written is limited, rendering waits when the writers fall behind. Results of the
+ * writes are reported back on the render thread, in the order frames were rendered. */
+
+#define RENDER_OUTPUT_IMAGE_THREADS 2
+
+typedef struct RenderOutputFrame {
+  struct RenderOutputFrame *next, *prev;
+
+  /* Render result of the frame, the item takes ownership of it
+   * once the next frame starts rendering. */
+  RenderResult *result;
+  RenderResult rres;
+  bool owns_result;
+
+  /* Shallow copy, the output settings can be animated and are evaluated
+   * for the next frame while this one is written. */
+  Scene scene;
+  char name[FILE_MAX];
+
+  ReportList reports;
+  double frame_time;
+  double save_time;
+  bool done;
+  bool ok;
+} RenderOutputFrame;
+
+typedef struct RenderOutputQueue {
+  Render *re;
+  bMovieHandle *mh;
+  int totvideos;
+  const RenderData *rd;
+  bool is_multiview_name;
+
+  /* Frames not written yet, more are rendered only when fewer are left. */
+  int max_pending;
+
+  /* For output frame rate statistics. */
+  double starttime;
+  int totsaved;
+
+  /* All frames not reported yet, in render order. */
+  ListBase frames;
+  ThreadMutex mutex;
+  ThreadCondition done_cond;
+
+  ThreadQueue *todo;
+  ListBase threads;
+} RenderOutputQueue;
+
+static void render_output_frame_free(RenderOutputFrame *frame)
+{
+  if (frame->owns_result) {
+    render_result_free(frame->result);
+  }
+  BKE_reports_clear(&frame->reports);
+  MEM_freeN(frame);
+}
+
+static void *render_output_queue_thread(void *data)
+{
+  RenderOutputQueue *queue = (RenderOutputQueue *)data;
+  Render *re = queue->re;
+  RenderOutputFrame *frame;
+
+  while ((frame = BLI_thread_queue_pop(queue->todo))) {
+    double start_time = PIL_check_seconds_timer();
+    bool ok = render_write_result(&frame->reports,
+                                  &frame->rres,
+                                  &frame->scene,
+                                  &frame->scene.r,
+                                  queue->mh,
+                                  re->movie_ctx_arr,
+                                  queue->totvideos,
+                                  frame->name);
+    render_result_views_shallowdelete(&frame->rres);
+
+    BLI_mutex_lock(&queue->mutex);
+    frame->save_time = PIL_check_seconds_timer() - start_time;
+    frame->ok = ok;
+    frame->done = true;
+    /* Result is not used by the render anymore. */
+    if (frame->owns_result) {
+      render_result_free(frame->result);
+      frame->owns_result = false;
+    }
+    frame->result = NULL;
+    BLI_condition_notify_all(&queue->done_cond);
+    BLI_mutex_unlock(&queue->mutex);
+  }
+
+  return NULL;
+}
+
+static RenderOutputQueue *render_output_queue_create(Render *re,
+                                                     bMovieHandle *mh,
+                                                     const int totvideos,
+                                                     const RenderData *rd,
+                                                     const bool is_multiview_name)
+{
+  RenderOutputQueue *queue = MEM_callocN(sizeof(RenderOutputQueue), "RenderOutputQueue");
+  /* Movie frames have to be appended in order by a single writer. */
+  const int num_threads = (mh != NULL) ? 1 : RENDER_OUTPUT_IMAGE_THREADS;
+
+  queue->re = re;
+  queue->mh = mh;
+  queue->totvideos = totvideos;
+  queue->rd = rd;
+  queue->is_multiview_name = is_multiview_name;
+  queue->max_pending = num_threads;
+  queue->starttime = PIL_check_seconds_timer();
+
+  BLI_mutex_init(&queue->mutex);
+  BLI_condition_init(&queue->done_cond);
+  queue->todo = BLI_thread_queue_init();
+
+  BLI_threadpool_init(&queue->threads, render_output_queue_thread, num_threads);
+  for (int i = 0; i < num_threads; i++) {
+    BLI_threadpool_insert(&queue->threads, queue);
+  }
+
+  return queue;
+}
+
+/* Hand the current render result over to the writers. */
+static void render_output_queue_push(RenderOutputQueue *queue, Main *bmain, Scene *scene)
+{
+  Render *re = queue->re;
+  RenderOutputFrame *frame = MEM_callocN(sizeof(RenderOutputFrame), "RenderOutputFrame");
+
+  frame->scene = *scene;
+  if (!BKE_imtype_is_movie(scene->r.im_format.imtype)) {
+    render_output_filepath(frame->name, bmain, scene, NULL);
+  }
+  BKE_reports_init(&frame->reports, RPT_STORE);
+
+  /* Views reference buffers of the result, they stay valid until the writer is done with it,
+   * see render_output_queue_detach_result(). */
+  RE_AcquireResultImageViews(re, &frame->rres);
+  frame->result = re->result;
+  BLI_rw_mutex_unlock(&re->resultmutex);
+
+  frame->frame_time = re->i.lastframetime;
+
+  BLI_mutex_lock(&queue->mutex);
+  BLI_addtail(&queue->frames, frame);
+  BLI_mutex_unlock(&queue->mutex);
+
+  BLI_thread_queue_push(queue->todo, frame);
+}
+
+/* Called before the next frame is initialized, which would otherwise free the result
+ * still being written. The render gets a new result, the old one is freed by the writer. */
+static void render_output_queue_detach_result(RenderOutputQueue *queue)
+{
+  Render *re = queue->re;
+
+  BLI_mutex_lock(&queue->mutex);
+  RenderOutputFrame *frame = queue->frames.last;
+  if (frame && !frame->done && frame->result != NULL && frame->result == re->result) {
+    BLI_rw_mutex_lock(&re->resultmutex, THREAD_LOCK_WRITE);
+    re->result = NULL;
+    BLI_rw_mutex_unlock(&re->resultmutex);
+    frame->owns_result = true;
+  }
+  BLI_mutex_unlock(&queue->mutex);
+}
+
+/* Report a written frame on the render thread, returns false when writing failed. */
+static bool render_output_frame_finish(RenderOutputQueue *queue,
+                                       Scene *scene,
+                                       RenderOutputFrame *frame)
+{
+  Render *re = queue->re;
+
+  for (Report *report = frame->reports.list.first; report; report = report->next) {
+    BKE_report(re->reports, report->type, report->message);
+  }
+
+  render_print_frame_time(re, frame->frame_time + frame->save_time, frame->save_time);
+
+  if (!frame->ok) {
+    if (!BKE_imtype_is_movie(frame->scene.r.im_format.imtype)) {
+      render_anim_remove_touched(scene, queue->rd, frame->name, queue->is_multiview_name);
+    }
+    return false;
+  }
+
+  queue->totsaved++;
+  re->i.output_fps = (float)(queue->totsaved / (PIL_check_seconds_timer() - queue->starttime));
+  re->stats_draw(re->sdh, &re->i);
+
+  /* Handlers expect the scene to be at the frame that was written. */
+  const int cfra = scene->r.cfra;
+  scene->r.cfra = frame->scene.r.cfra;
+  render_callback_exec_id(re, re->main, &scene->id, BKE_CB_EVT_RENDER_WRITE);
+  scene->r.cfra = cfra;
+
+  return true;
+}
+
+/* Report frames written so far and wait until no more than max_pending frames are left.
+ * Returns false when writing any of the frames failed. */
+static bool render_output_queue_flush(RenderOutputQueue *queue, Scene *scene, int max_pending)
+{
+  bool ok = true;
+
+  BLI_mutex_lock(&queue->mutex);
+  while (queue->frames.first) {
+    RenderOutputFrame *frame = queue->frames.first;
+
+    if (frame->done) {
+      BLI_remlink(&queue->frames, frame);
+      BLI_mutex_unlock(&queue->mutex);
+
+      ok &= render_output_frame_finish(queue, scene, frame);
+      render_output_frame_free(frame);
+
+      BLI_mutex_lock(&queue->mutex);
+    }
+    else if (BLI_listbase_count_at_most(&queue->frames, max_pending + 1) > max_pending) {
+      BLI_condition_wait(&queue->done_cond, &queue->mutex);
+    }
+    else {
+      break;
+    }
+  }
+  BLI_mutex_unlock(&queue->mutex);
+
+  return ok;
+}
+
+/* Write all remaining frames and stop the writers. */
+static bool render_output_queue_free(RenderOutputQueue *queue, Scene *scene)
+{
+  bool ok = render_output_queue_flush(queue, scene, 0);
+
+  BLI_thread_queue_nowait(queue->todo);
+  BLI_threadpool_end(&queue->threads);
+  BLI_thread_queue_free(queue->todo);
+  BLI_condition_end(&queue->done_cond);
+  BLI_mutex_end(&queue->mutex);
+  MEM_freeN(queue);
+
+  return ok;
+}
+
 /* saves images to disk */
 void RE_RenderAnim(Render *re,
                    Main *bmain,
@@ -2573,6 +2891,9 @@ void RE_RenderAnim(Render *re,
 
   re->flag |= R_ANIMATION;
 
+  RenderOutputQueue *output_queue = render_output_queue_create(
+      re, mh, totvideos, &rd, is_multiview_name);
+
   {
     for (nfra = sfra, scene->r.cfra = sfra; scene->r.cfra <= efra; scene->r.cfra++) {
       char name[FILE_MAX];
@@ -2596,6 +2917,9 @@ void RE_RenderAnim(Render *re,
 
       render_update_depsgraph(re);
 
+      /* Previous frame may still be written. */
+      render_output_queue_detach_result(output_queue);
+
       /* only border now, todo: camera lens. (ton) */
       render_initialize_from_main(re, &rd, bmain, scene, single_layer, camera_override, 1, 0);
 
@@ -2690,7 +3014,8 @@ void RE_RenderAnim(Render *re,
 
       if (re->test_break(re->tbh) == 0) {
         if (!G.is_break) {
-          if (!do_write_image_or_movie(re, bmain, scene, mh, totvideos, NULL)) {
+          render_output_queue_push(output_queue, bmain, scene);
+          if (!render_output_queue_flush(output_queue, scene, output_queue->max_pending)) {
             G.is_break = true;
           }
         }
@@ -2702,44 +3027,24 @@ void RE_RenderAnim(Render *re,
       if (G.is_break == true) {
         /* remove touched file */
         if (is_movie == false) {
-          if ((rd.mode & R_TOUCH)) {
-            if (!is_multiview_name) {
-              if ((BLI_file_size(name) == 0)) {
-                /* BLI_exists(name) is implicit */
-                BLI_delete(name, false, false);
-              }
-            }
-            else {
-              SceneRenderView *srv;
-              char filepath[FILE_MAX];
-
-              for (srv = scene->r.views.first; srv; srv = srv->next) {
-                if (!BKE_scene_multiview_is_render_view_active(&scene->r, srv)) {
-                  continue;
-                }
-
-                BKE_scene_multiview_filepath_get(srv, name, filepath);
-
-                if ((BLI_file_size(filepath) == 0)) {
-                  /* BLI_exists(filepath) is implicit */
-                  BLI_delete(filepath, false, false);
-                }
-              }
-            }
-          }
+          render_anim_remove_touched(scene, &rd, name, is_multiview_name);
         }
 
         break;
       }
 
       if (G.is_break == false) {
-        /* keep after file save */
+        /* RENDER_WRITE is sent once the frame is saved, see render_output_frame_finish(). */
         render_callback_exec_id(re, re->main, &scene->id, BKE_CB_EVT_RENDER_POST);
-        render_callback_exec_id(re, re->main, &scene->id, BKE_CB_EVT_RENDER_WRITE);
       }
     }
   }
 
+  if (!render_output_queue_free(output_queue, scene)) {
+    G.is_break = true;
+  }
+  re->i.output_fps = 0.0f;
+
   /* end movie */
   if (is_movie) {
     re_movie_free_all(re, mh, totvideos);
@@ -120,6 +120,11 @@ void render_result_free(RenderResult *res)
     MEM_freeN(res->error);
   }
 
+  if (res->exrhandle) {
+    IMB_exr_close(res->exrhandle);
+    BLI_mutex_free(res->exr_mutex);
+  }
+
   BKE_stamp_data_free(res->stamp_data);
 
   MEM_freeN(res);
@@ -747,6 +752,14 @@ RenderResult *render_result_new_from_exr(
   rr->rectx = rectx;
   rr->recty = recty;
 
+  if (IMB_exr_has_lazy_passes(exrhandle)) {
+    /* Passes are read on demand, the result takes over the handle. */
+    rr->exrhandle = exrhandle;
+    rr->exr_mutex = BLI_mutex_alloc();
+    BLI_strncpy(rr->exr_colorspace, colorspace, sizeof(rr->exr_colorspace));
+    rr->exr_predivide = predivide;
+  }
+
   IMB_exr_multilayer_convert(exrhandle, rr, ml_addview_cb, ml_addlayer_cb, ml_addpass_cb);
 
   for (rl = rr->layers.first; rl; rl = rl->next) {
@@ -759,7 +772,7 @@ RenderResult *render_result_new_from_exr(
       rpass->rectx = rectx;
       rpass->recty = recty;
 
-      if (rpass->channels >= 3) {
+      if (rpass->rect && rpass->channels >= 3) {
         IMB_colormanagement_transform(rpass->rect,
                                       rpass->rectx,
                                       rpass->recty,
@@ -774,6 +787,71 @@ RenderResult *render_result_new_from_exr(
   return rr;
 }
 
+/* Read the buffer of a pass of a result converted from a lazily read multilayer file,
+ * the color space conversion matches the one done on conversion. Thread safe, the
+ * passes of one result may be read from several threads. Returns NULL when the pass
+ * can't be read from the file, reading is tried again on the next call. */
+float *RE_render_result_pass_rect_ensure(RenderResult *rr, RenderPass *rpass)
+{
+  if (rr->exrhandle == NULL) {
+    return rpass->rect;
+  }
+
+  BLI_mutex_lock(rr->exr_mutex);
+
+  if (rpass->rect) {
+    BLI_mutex_unlock(rr->exr_mutex);
+    return rpass->rect;
+  }
+
+  for (RenderLayer *rl = rr->layers.first; rl; rl = rl->next) {
+    if (BLI_findindex(&rl->passes, rpass) == -1) {
+      continue;
+    }
+
+    rpass->rect = IMB_exr_read_pass(rr->exrhandle, rl->name, rpass->name, rpass->view);
+
+    if (rpass->rect && rpass->channels >= 3) {
+      const char *to_colorspace = IMB_colormanagement_role_colorspace_name_get(
+          COLOR_ROLE_SCENE_LINEAR);
+
+      IMB_colormanagement_transform(rpass->rect,
+                                    rpass->rectx,
+                                    rpass->recty,
+                                    rpass->channels,
+                                    rr->exr_colorspace,
+                                    to_colorspace,
+                                    rr->exr_predivide);
+    }
+    break;
+  }
+
+  BLI_mutex_unlock(rr->exr_mutex);
+
+  return rpass->rect;
+}
+
+static void render_result_passes_ensure(RenderResult *rr)
+{
+  if (rr->exrhandle == NULL) {
+    return;
+  }
+
+  for (RenderLayer *rl = rr->layers.first; rl; rl = rl->next) {
+    for (RenderPass *rpass = rl->passes.first; rpass; rpass = rpass->next) {
+      if (RE_render_result_pass_rect_ensure(rr, rpass) == NULL) {
+        /* Saving and duplicating need every buffer, passes that fail to read stay black. */
+        BLI_mutex_lock(rr->exr_mutex);
+        if (rpass->rect == NULL) {
+          rpass->rect = MEM_callocN(
+              sizeof(float) * rpass->rectx * rpass->recty * rpass->channels, "render pass rect");
+        }
+        BLI_mutex_unlock(rr->exr_mutex);
+      }
+    }
+  }
+}
+
 void render_result_view_new(RenderResult *rr, const char *viewname)
 {
   RenderView *rv = MEM_callocN(sizeof(RenderView), "new render view");
@@ -898,6 +976,9 @@ bool RE_WriteRenderResult(ReportList *reports,
     layer = 0;
   }
 
+  /* Passes of results read from multilayer files may not be loaded yet. */
+  render_result_passes_ensure(rr);
+
   /* First add views since IMB_exr_add_channel checks number of views. */
   if (render_result_has_views(rr)) {
     for (RenderView *rview = rr->views.first; rview; rview = rview->next) {
@@ -1668,7 +1749,10 @@ static RenderView *duplicate_render_view(RenderView *rview)
 RenderResult *RE_DuplicateRenderResult(RenderResult *rr)
 {
   RenderResult *new_rr = MEM_mallocN(sizeof(RenderResult), "new duplicated render result");
+  render_result_passes_ensure(rr);
   *new_rr = *rr;
+  new_rr->exrhandle = NULL;
+  new_rr->exr_mutex = NULL;
   new_rr->next = new_rr->prev = NULL;
   new_rr->layers.first = new_rr->layers.last = NULL;
   new_rr->views.first = new_rr->views.last = NULL;
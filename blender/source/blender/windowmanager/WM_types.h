@@ -275,6 +275,8 @@ typedef struct wmNotifier {
 
 /* category */
 #define NOTE_CATEGORY 0xFF000000
+/* Bit of a category in a mask, categories must be below (32 << 24). */
+#define NOTE_CATEGORY_FLAG(category) (1u << ((unsigned int)(category) >> 24))
 #define NC_WM (1 << 24)
 #define NC_WINDOW (2 << 24)
 #define NC_SCREEN (3 << 24)
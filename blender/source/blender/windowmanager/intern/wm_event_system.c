@@ -42,6 +42,7 @@
 
 #include "BLI_blenlib.h"
 #include "BLI_dynstr.h"
+#include "BLI_ghash.h"
 #include "BLI_utildefines.h"
 #include "BLI_math.h"
 #include "BLI_timer.h"
@@ -67,6 +68,8 @@
 #include "ED_util.h"
 #include "ED_undo.h"
 
+#include "GPU_draw.h"
+
 #include "RNA_access.h"
 
 #include "UI_interface.h"
@@ -201,66 +204,72 @@ void wm_event_init_from_window(wmWindow *win, wmEvent *event)
 
 /* ********************* notifiers, listeners *************** */
 
-static bool wm_test_duplicate_notifier(wmWindowManager *wm, unsigned int type, void *reference)
+/* Notifiers are de-duplicated by their type and reference, the window isn't compared. */
+static uint note_hash_for_queue_fn(const void *ptr)
 {
-  wmNotifier *note;
-
-  for (note = wm->queue.first; note; note = note->next) {
-    if ((note->category | note->data | note->subtype | note->action) == type &&
-        note->reference == reference) {
-      return 1;
-    }
-  }
+  const wmNotifier *note = ptr;
+  return (BLI_ghashutil_ptrhash(note->reference) ^
+          (note->category | note->data | note->subtype | note->action));
+}
 
-  return 0;
+static bool note_cmp_for_queue_fn(const void *a, const void *b)
+{
+  const wmNotifier *note_a = a;
+  const wmNotifier *note_b = b;
+  return !(((note_a->category | note_a->data | note_a->subtype | note_a->action) ==
+            (note_b->category | note_b->data | note_b->subtype | note_b->action)) &&
+           (note_a->reference == note_b->reference));
 }
 
-/* XXX: in future, which notifiers to send to other windows? */
-void WM_event_add_notifier(const bContext *C, unsigned int type, void *reference)
+/**
+ * Append a notifier to the queue, unless an identical one is already waiting.
+ * Operators and scripts may send thousands of notifiers per event,
+ * so this avoids a linear search of the queue.
+ */
+static void wm_event_add_notifier_ex(wmWindowManager *wm,
+                                     wmWindow *win,
+                                     unsigned int type,
+                                     void *reference)
 {
-  wmWindowManager *wm = CTX_wm_manager(C);
-  wmNotifier *note;
+  wmNotifier note_test = {NULL};
 
-  if (wm_test_duplicate_notifier(wm, type, reference)) {
+  note_test.category = type & NOTE_CATEGORY;
+  note_test.data = type & NOTE_DATA;
+  note_test.subtype = type & NOTE_SUBTYPE;
+  note_test.action = type & NOTE_ACTION;
+  note_test.reference = reference;
+
+  if (wm->notifier_queue_set == NULL) {
+    wm->notifier_queue_set = BLI_gset_new_ex(
+        note_hash_for_queue_fn, note_cmp_for_queue_fn, __func__, 1024);
+  }
+  else if (BLI_gset_haskey(wm->notifier_queue_set, &note_test)) {
     return;
   }
 
-  note = MEM_callocN(sizeof(wmNotifier), "notifier");
-
+  wmNotifier *note = MEM_mallocN(sizeof(*note), "notifier");
+  *note = note_test;
   note->wm = wm;
-  BLI_addtail(&note->wm->queue, note);
+  note->window = win;
 
-  note->window = CTX_wm_window(C);
-
-  note->category = type & NOTE_CATEGORY;
-  note->data = type & NOTE_DATA;
-  note->subtype = type & NOTE_SUBTYPE;
-  note->action = type & NOTE_ACTION;
+  BLI_addtail(&wm->queue, note);
+  BLI_gset_insert(wm->notifier_queue_set, note);
+}
 
-  note->reference = reference;
+/* XXX: in future, which notifiers to send to other windows? */
+void WM_event_add_notifier(const bContext *C, unsigned int type, void *reference)
+{
+  wm_event_add_notifier_ex(CTX_wm_manager(C), CTX_wm_window(C), type, reference);
 }
 
 void WM_main_add_notifier(unsigned int type, void *reference)
 {
   Main *bmain = G_MAIN;
   wmWindowManager *wm = bmain->wm.first;
-  wmNotifier *note;
 
-  if (!wm || wm_test_duplicate_notifier(wm, type, reference)) {
-    return;
+  if (wm) {
+    wm_event_add_notifier_ex(wm, NULL, type, reference);
   }
-
-  note = MEM_callocN(sizeof(wmNotifier), "notifier");
-
-  note->wm = wm;
-  BLI_addtail(&note->wm->queue, note);
-
-  note->category = type & NOTE_CATEGORY;
-  note->data = type & NOTE_DATA;
-  note->subtype = type & NOTE_SUBTYPE;
-  note->action = type & NOTE_ACTION;
-
-  note->reference = reference;
 }
 
 /**
@@ -280,6 +289,7 @@ void WM_main_remove_notifier_reference(const void *reference)
       if (note->reference == reference) {
         /* don't remove because this causes problems for #wm_event_do_notifiers
          * which may be looping on the data (deleting screens) */
+        BLI_gset_remove(wm->notifier_queue_set, note, NULL);
         wm_notifier_clear(note);
       }
     }
@@ -398,6 +408,116 @@ void wm_event_do_refresh_wm_and_depsgraph(bContext *C)
   CTX_wm_window_set(C, NULL);
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Notifier Listener Index
+ *
+ * Area and region listeners of a window, by notifier category. Region types that declare
+ * the categories they listen to (#ARegionType.listener_categories) are only indexed for
+ * those, so notifiers don't visit every region of every window.
+ * \{ */
+
+/* Category bits, the first entry has every listener for categories without a bit. */
+#define WM_NOTIFIER_CATEGORY_LEN 32
+
+typedef struct wmNotifierListener {
+  ScrArea *sa;
+  /* NULL for the listener of the area. */
+  ARegion *ar;
+} wmNotifierListener;
+
+typedef struct wmNotifierListenerIndex {
+  /* Listeners in the order notifiers were always sent to them. */
+  wmNotifierListener *listeners[WM_NOTIFIER_CATEGORY_LEN];
+  int listeners_len[WM_NOTIFIER_CATEGORY_LEN];
+} wmNotifierListenerIndex;
+
+static uint wm_notifier_region_categories(const ARegion *ar)
+{
+  /* See #ED_region_do_listen, every region handles these. */
+  const uint generic = NOTE_CATEGORY_FLAG(NC_WM) | NOTE_CATEGORY_FLAG(NC_WINDOW);
+
+  if (ar->type == NULL || ar->type->listener == NULL) {
+    return generic;
+  }
+  if (ar->type->listener_categories == 0) {
+    return ~0u;
+  }
+  return ar->type->listener_categories | generic;
+}
+
+static void wm_notifier_listener_index_add(wmNotifierListenerIndex *index,
+                                           ScrArea *sa,
+                                           ARegion *ar,
+                                           uint categories)
+{
+  for (int i = 0; i < WM_NOTIFIER_CATEGORY_LEN; i++) {
+    if (i == 0 || (categories & (1u << i))) {
+      wmNotifierListener *listener = &index->listeners[i][index->listeners_len[i]++];
+      listener->sa = sa;
+      listener->ar = ar;
+    }
+  }
+}
+
+static void wm_notifier_listener_index_build(wmNotifierListenerIndex *index,
+                                             wmWindow *win,
+                                             bScreen *screen)
+{
+  int listeners_len = BLI_listbase_count(&screen->regionbase);
+  ED_screen_areas_iter(win, screen, sa)
+  {
+    listeners_len += 1 + BLI_listbase_count(&sa->regionbase);
+  }
+
+  for (int i = 0; i < WM_NOTIFIER_CATEGORY_LEN; i++) {
+    index->listeners[i] = MEM_mallocN(sizeof(wmNotifierListener) * (size_t)max_ii(listeners_len, 1),
+                                      __func__);
+    index->listeners_len[i] = 0;
+  }
+
+  for (ARegion *ar = screen->regionbase.first; ar; ar = ar->next) {
+    wm_notifier_listener_index_add(index, NULL, ar, wm_notifier_region_categories(ar));
+  }
+
+  ED_screen_areas_iter(win, screen, sa)
+  {
+    wm_notifier_listener_index_add(index, sa, NULL, ~0u);
+    for (ARegion *ar = sa->regionbase.first; ar; ar = ar->next) {
+      wm_notifier_listener_index_add(index, sa, ar, wm_notifier_region_categories(ar));
+    }
+  }
+}
+
+static void wm_notifier_listener_index_free(wmNotifierListenerIndex *index)
+{
+  for (int i = 0; i < WM_NOTIFIER_CATEGORY_LEN; i++) {
+    MEM_freeN(index->listeners[i]);
+  }
+}
+
+static void wm_notifier_listener_index_send(const wmNotifierListenerIndex *index,
+                                            wmWindow *win,
+                                            wmNotifier *note,
+                                            Scene *scene)
+{
+  uint i = note->category >> 24;
+  if (i >= WM_NOTIFIER_CATEGORY_LEN) {
+    i = 0;
+  }
+
+  for (int j = 0; j < index->listeners_len[i]; j++) {
+    const wmNotifierListener *listener = &index->listeners[i][j];
+    if (listener->ar) {
+      ED_region_do_listen(win, listener->sa, listener->ar, note, scene);
+    }
+    else {
+      ED_area_do_listen(win, listener->sa, note, scene);
+    }
+  }
+}
+
+/** \} */
+
 /* called in mainloop */
 void wm_event_do_notifiers(bContext *C)
 {
@@ -411,6 +531,11 @@ void wm_event_do_notifiers(bContext *C)
 
   BLI_timer_execute();
 
+  /* Images loaded in the background are uploaded when viewports draw. */
+  if (GPU_image_load_finished()) {
+    WM_main_add_notifier(NC_SPACE | ND_SPACE_VIEW3D, NULL);
+  }
+
   /* disable? - keep for now since its used for window level notifiers. */
 #if 1
   /* cache & catch WM level notifiers, such as frame change, scene/screen set */
@@ -502,9 +627,30 @@ void wm_event_do_notifiers(bContext *C)
     }
   }
 
+  /* Windows don't change layout while listening, so their index can be built once. */
+  wmNotifierListenerIndex *listener_index = NULL;
+  if (wm->queue.first) {
+    int win_index = 0;
+    listener_index = MEM_mallocN(sizeof(*listener_index) * BLI_listbase_count(&wm->windows),
+                                 __func__);
+    for (win = wm->windows.first; win; win = win->next, win_index++) {
+      wm_notifier_listener_index_build(
+          &listener_index[win_index], win, WM_window_get_active_screen(win));
+    }
+  }
+
   /* the notifiers are sent without context, to keep it clean */
   while ((note = BLI_pophead(&wm->queue))) {
-    for (win = wm->windows.first; win; win = win->next) {
+    BLI_gset_remove(wm->notifier_queue_set, note, NULL);
+
+    /* cleared by #WM_main_remove_notifier_reference, no listener acts on it */
+    if (note->category == 0) {
+      MEM_freeN(note);
+      continue;
+    }
+
+    int win_index = 0;
+    for (win = wm->windows.first; win; win = win->next, win_index++) {
       Scene *scene = WM_window_get_active_scene(win);
       bScreen *screen = WM_window_get_active_screen(win);
       WorkSpace *workspace = WM_window_get_active_workspace(win);
@@ -518,8 +664,6 @@ void wm_event_do_notifiers(bContext *C)
         /* pass */
       }
       else {
-        ARegion *ar;
-
         /* XXX context in notifiers? */
         CTX_wm_window_set(C, win);
 
@@ -531,22 +675,20 @@ void wm_event_do_notifiers(bContext *C)
 #  endif
         ED_screen_do_listen(C, note);
 
-        for (ar = screen->regionbase.first; ar; ar = ar->next) {
-          ED_region_do_listen(win, NULL, ar, note, scene);
-        }
-
-        ED_screen_areas_iter(win, screen, sa)
-        {
-          ED_area_do_listen(win, sa, note, scene);
-          for (ar = sa->regionbase.first; ar; ar = ar->next) {
-            ED_region_do_listen(win, sa, ar, note, scene);
-          }
-        }
+        wm_notifier_listener_index_send(&listener_index[win_index], win, note, scene);
       }
     }
 
     MEM_freeN(note);
   }
+
+  if (listener_index) {
+    int win_index = 0;
+    for (win = wm->windows.first; win; win = win->next, win_index++) {
+      wm_notifier_listener_index_free(&listener_index[win_index]);
+    }
+    MEM_freeN(listener_index);
+  }
 #endif /* if 1 (postpone disabling for in favor of message-bus), eventually. */
 
   /* Handle message bus. */
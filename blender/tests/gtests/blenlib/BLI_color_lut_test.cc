@@ -0,0 +1,115 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <math.h>
+
+extern "C" {
+#include "BLI_color_lut.h"
+#include "BLI_math.h"
+#include "BLI_rand.h"
+#include "BLI_utildefines.h"
+}
+
+/* Accuracy of a baked table against the exact transform, in display values. */
+#define LUT_SIZE 65
+#define LUT_RANGE 64.0f
+#define LUT_MAX_ERROR (1.0f / 255.0f)
+
+/* Standard view: clip and sRGB transfer function. */
+static void transform_standard(float rgb[3])
+{
+  for (int i = 0; i < 3; i++) {
+    rgb[i] = linearrgb_to_srgb(min_ff(rgb[i], 1.0f));
+  }
+}
+
+/* Filmic like view: channel crosstalk and a soft shoulder. */
+static void transform_filmic(float rgb[3])
+{
+  const float mat[3][3] = {{0.80f, 0.10f, 0.05f}, {0.15f, 0.80f, 0.10f}, {0.05f, 0.10f, 0.85f}};
+  float mixed[3];
+  mul_v3_m3v3(mixed, mat, rgb);
+  for (int i = 0; i < 3; i++) {
+    rgb[i] = powf(mixed[i] / (mixed[i] + 0.6f), 1.0f / 2.2f);
+  }
+}
+
+typedef void (*TransformFn)(float rgb[3]);
+
+static void bake_cb(void *userdata, float (*rgb)[3], int len)
+{
+  TransformFn transform = (TransformFn)userdata;
+  for (int i = 0; i < len; i++) {
+    transform(rgb[i]);
+  }
+}
+
+static float lut_max_error(TransformFn transform)
+{
+  ColorLUT3D *lut = BLI_color_lut_bake(LUT_SIZE, LUT_RANGE, bake_cb, (void *)transform);
+  RNG *rng = BLI_rng_new(0);
+  float max_error = 0.0f;
+
+  for (int i = 0; i < 100000; i++) {
+    float rgb[3], expected[3];
+    for (int j = 0; j < 3; j++) {
+      /* Half uniform in the usual range, half spread over stops. */
+      const float u = BLI_rng_get_float(rng);
+      rgb[j] = (i & 1) ? u * 2.0f : max_ff(powf(2.0f, -10.0f + 16.0f * u) - 0.001f, 0.0f);
+    }
+    copy_v3_v3(expected, rgb);
+    transform(expected);
+
+    EXPECT_TRUE(BLI_color_lut_apply_v3(lut, rgb));
+    for (int j = 0; j < 3; j++) {
+      max_error = max_ff(max_error, fabsf(rgb[j] - expected[j]));
+    }
+  }
+
+  BLI_rng_free(rng);
+  BLI_color_lut_free(lut);
+
+  return max_error;
+}
+
+TEST(color_lut, AccuracyStandard)
+{
+  EXPECT_LT(lut_max_error(transform_standard), LUT_MAX_ERROR);
+}
+
+TEST(color_lut, AccuracyFilmic)
+{
+  EXPECT_LT(lut_max_error(transform_filmic), LUT_MAX_ERROR);
+}
+
+TEST(color_lut, ExactOnSamples)
+{
+  ColorLUT3D *lut = BLI_color_lut_bake(LUT_SIZE, LUT_RANGE, bake_cb, (void *)transform_filmic);
+
+  /* Zero and one are samples of the table. */
+  float rgb[3] = {0.0f, 1.0f, 0.0f}, expected[3];
+  copy_v3_v3(expected, rgb);
+  transform_filmic(expected);
+  EXPECT_TRUE(BLI_color_lut_apply_v3(lut, rgb));
+  EXPECT_V3_NEAR(rgb, expected, 1e-5f);
+
+  BLI_color_lut_free(lut);
+}
+
+TEST(color_lut, OutOfRange)
+{
+  ColorLUT3D *lut = BLI_color_lut_bake(LUT_SIZE, LUT_RANGE, bake_cb, (void *)transform_standard);
+
+  const float values[4][3] = {
+      {-0.1f, 0.5f, 0.5f}, {0.5f, LUT_RANGE * 2.0f, 0.5f}, {0.5f, 0.5f, NAN}, {INFINITY, 0, 0}};
+  for (int i = 0; i < (int)ARRAY_SIZE(values); i++) {
+    float rgb[3];
+    copy_v3_v3(rgb, values[i]);
+    EXPECT_FALSE(BLI_color_lut_apply_v3(lut, rgb));
+    /* Left unchanged for the caller to transform. */
+    EXPECT_EQ(memcmp(rgb, values[i], sizeof(rgb)), 0);
+  }
+
+  BLI_color_lut_free(lut);
+}
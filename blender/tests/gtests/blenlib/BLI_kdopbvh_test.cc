@@ -9,6 +9,7 @@ extern "C" {
 #include "BLI_kdopbvh.h"
 #include "BLI_rand.h"
 #include "BLI_math_vector.h"
+#include "BLI_threads.h"
 #include "MEM_guardedalloc.h"
 }
 
@@ -135,3 +136,61 @@ TEST(kdopbvh, OptimalFindNearest_500)
 {
   find_nearest_points_test(500, 1.0, 1000, 12, true);
 }
+
+/**
+ * Move all points after balancing and refit the tree,
+ * large trees are refit in parallel, level by level.
+ */
+static void update_tree_test(int points_len, char tree_type, int random_seed)
+{
+  BLI_threadapi_init();
+
+  struct RNG *rng = BLI_rng_new(random_seed);
+  BVHTree *tree = BLI_bvhtree_new(points_len, 0.0, tree_type, 8);
+
+  void *mem = MEM_mallocN(sizeof(float[3]) * points_len, __func__);
+  float(*points)[3] = (float(*)[3])mem;
+
+  for (int i = 0; i < points_len; i++) {
+    rng_v3_round(points[i], 3, rng, 1000, 1.0f);
+    BLI_bvhtree_insert(tree, i, points[i], 1);
+  }
+  BLI_bvhtree_balance(tree);
+
+  for (int i = 0; i < points_len; i++) {
+    rng_v3_round(points[i], 3, rng, 1000, 10.0f);
+    EXPECT_TRUE(BLI_bvhtree_update_node(tree, i, points[i], NULL, 1));
+  }
+  BLI_bvhtree_update_tree(tree);
+
+  /* every node must still be reachable at its new location */
+  for (int i = 0; i < points_len; i++) {
+    const int j = BLI_bvhtree_find_nearest(tree, points[i], NULL, NULL, NULL);
+    EXPECT_GE(j, 0);
+    EXPECT_LT(j, points_len);
+    EXPECT_EQ_ARRAY(points[i], points[j], 3);
+  }
+
+  BLI_bvhtree_free(tree);
+  BLI_rng_free(rng);
+  MEM_freeN(points);
+
+  BLI_threadapi_exit();
+}
+
+TEST(kdopbvh, UpdateTree_500)
+{
+  update_tree_test(500, 4, 12);
+}
+TEST(kdopbvh, UpdateTree_Binary_5000)
+{
+  update_tree_test(5000, 2, 123);
+}
+TEST(kdopbvh, UpdateTree_Quad_5000)
+{
+  update_tree_test(5000, 4, 1234);
+}
+TEST(kdopbvh, UpdateTree_Oct_5000)
+{
+  update_tree_test(5000, 8, 12345);
+}
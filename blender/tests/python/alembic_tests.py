@@ -23,6 +23,7 @@ import argparse
 import pathlib
 import subprocess
 import sys
+import textwrap
 import unittest
 
 from modules.test_utils import (
@@ -414,6 +415,110 @@ class LongNamesExportTest(AbstractAlembicTest):
         self.assertIn('.faceCounts', abcprop)
 
 
+class CrowdExportTest(AbstractAlembicTest):
+    """Exports several animated meshes, their samples are prepared in parallel.
+
+    Some of the meshes have modifiers that read the evaluated mesh of another animated object,
+    which must not be evaluated concurrently. The imported positions are compared to the ones
+    of the evaluated meshes in the exporting scene.
+    """
+
+    crowd_size = 10
+    frame_count = 3
+
+    # Checksum of the positions of each mesh per frame, printed by both scripts.
+    positions_script = textwrap.dedent("""\
+        def print_positions(objects, frame_count):
+            scene = bpy.context.scene
+            for frame in range(1, frame_count + 1):
+                scene.frame_set(frame)
+                depsgraph = bpy.context.evaluated_depsgraph_get()
+                for ob in objects:
+                    ob_eval = ob.evaluated_get(depsgraph)
+                    mesh = ob_eval.to_mesh()
+                    checksum = sum((index + 1) * (vert.co.x + 2.0 * vert.co.y + 3.0 * vert.co.z)
+                                   for index, vert in enumerate(mesh.vertices))
+                    print('POSITIONS %s %d %d %.6g' % (ob.name, frame, len(mesh.vertices), checksum))
+                    ob_eval.to_mesh_clear()
+        """)
+
+    def export_crowd(self, abc: pathlib.Path) -> list:
+        """Exports the crowd and returns the positions of the exported meshes."""
+        script = 'import bpy\nimport bmesh\n\n' + self.positions_script + textwrap.dedent("""\
+
+            scene = bpy.context.scene
+
+            mesh = bpy.data.meshes.new('TargetMesh')
+            bm = bmesh.new()
+            bmesh.ops.create_uvsphere(bm, u_segments=16, v_segments=8, diameter=5.0)
+            bm.to_mesh(mesh)
+            bm.free()
+            target = bpy.data.objects.new('Target', mesh)
+            target.location = (6.0, 3.0, 0.0)
+            target.modifiers.new('Wave', 'WAVE')
+            scene.collection.objects.link(target)
+
+            for index in range({crowd_size}):
+                mesh = bpy.data.meshes.new('CrowdMesh%03d' % index)
+                bm = bmesh.new()
+                bmesh.ops.create_grid(bm, x_segments=8, y_segments=8, size=1.0)
+                bm.to_mesh(mesh)
+                bm.free()
+                ob = bpy.data.objects.new('Crowd%03d' % index, mesh)
+                ob.location = (index % 5 * 3.0, index // 5 * 3.0, 0.0)
+                ob.modifiers.new('Wave', 'WAVE')
+                if index % 5 == 1:
+                    modifier = ob.modifiers.new('Shrinkwrap', 'SHRINKWRAP')
+                    modifier.target = target
+                elif index % 5 == 3:
+                    modifier = ob.modifiers.new('Boolean', 'BOOLEAN')
+                    modifier.operation = 'DIFFERENCE'
+                    modifier.object = target
+                scene.collection.objects.link(ob)
+
+            bpy.ops.wm.alembic_export(filepath='{abc}', start=1, end={frame_count},
+                                      renderable_only=False, visible_layers_only=False,
+                                      flatten=True)
+
+            objects = sorted((ob for ob in scene.objects
+                              if ob.name.startswith(('Crowd', 'Target'))),
+                             key=lambda ob: ob.name)
+            print_positions(objects, {frame_count})
+            """).format(crowd_size=self.crowd_size, frame_count=self.frame_count,
+                        abc=abc.as_posix())
+        output = self.run_blender('', script)
+        return [line for line in output.splitlines() if line.startswith('POSITIONS ')]
+
+    def read_positions(self, abc: pathlib.Path) -> list:
+        """Imports the Alembic file and returns the positions of the imported meshes."""
+        script = 'import bpy\n\n' + self.positions_script + textwrap.dedent("""\
+
+            bpy.ops.wm.alembic_import(filepath='{abc}', as_background_job=False)
+            objects = sorted((ob for ob in bpy.context.scene.objects
+                              if ob.type == 'MESH' and ob.name.startswith(('Crowd', 'Target'))),
+                             key=lambda ob: ob.name)
+            print_positions(objects, {frame_count})
+            """).format(abc=abc.as_posix(), frame_count=self.frame_count)
+        output = self.run_blender('', script)
+        return [line for line in output.splitlines() if line.startswith('POSITIONS ')]
+
+    @with_tempdir
+    def test_export_animated_crowd(self, tempdir: pathlib.Path):
+        abc = tempdir / 'crowd.abc'
+
+        positions_exported = self.export_crowd(abc)
+
+        # Check the first and last object of the crowd.
+        for index in (0, self.crowd_size - 1):
+            name = 'Crowd%03d' % index
+            abcprop = self.abcprop(abc, '/%s/%sShape/.geom' % (name, name))
+            self.assertIn('.faceCounts', abcprop)
+
+        positions = self.read_positions(abc)
+        self.assertEqual(len(positions), (self.crowd_size + 1) * self.frame_count)
+        self.assertEqual(positions, positions_exported)
+
+
 if __name__ == '__main__':
     parser = argparse.ArgumentParser()
     parser.add_argument('--blender', required=True)
@@ -24,6 +24,7 @@
 
 import pathlib
 import sys
+import tempfile
 import unittest
 
 import bpy
@@ -218,6 +219,65 @@ class SimpleImportTest(AbstractAlembicTest):
         self.assertEqual('CubeShape', bpy.data.objects['Cube'].data.name)
 
 
+class MeshSequenceCacheTest(AbstractAlembicTest):
+    frame_end = 12
+
+    def evaluated_mesh_data(self, ob):
+        depsgraph = bpy.context.evaluated_depsgraph_get()
+        ob_eval = ob.evaluated_get(depsgraph)
+        mesh = ob_eval.to_mesh()
+        verts = [tuple(v.co) for v in mesh.vertices]
+        polys = [tuple(p.vertices) for p in mesh.polygons]
+        ob_eval.to_mesh_clear()
+        return verts, polys
+
+    def test_playback_order(self):
+        # Samples are read ahead while playing forward, and reused or waited for when evaluating.
+        # Whatever order frames are evaluated in, the result has to match the exported mesh.
+        scene = bpy.context.scene
+        scene.frame_start = 1
+        scene.frame_end = self.frame_end
+
+        bpy.ops.mesh.primitive_grid_add(x_subdivisions=16, y_subdivisions=16, size=2)
+        ob = bpy.context.active_object
+        ob.modifiers.new("Wave", 'WAVE')
+
+        expect = {}
+        for frame in range(1, self.frame_end + 1):
+            scene.frame_set(frame)
+            expect[frame] = self.evaluated_mesh_data(ob)
+
+        with tempfile.TemporaryDirectory() as tempdir:
+            abc = pathlib.Path(tempdir) / "wave.abc"
+            res = bpy.ops.wm.alembic_export(filepath=str(abc), start=1, end=self.frame_end,
+                                            selected=True, as_background_job=False)
+            self.assertEqual({'FINISHED'}, res)
+
+            bpy.ops.wm.open_mainfile(filepath=str(self.testdir / "empty.blend"))
+            res = bpy.ops.wm.alembic_import(filepath=str(abc), as_background_job=False)
+            self.assertEqual({'FINISHED'}, res)
+
+            ob = bpy.context.active_object
+            scene = bpy.context.scene
+
+            frames = list(range(1, self.frame_end + 1))
+            frames += list(reversed(frames))
+            frames += [1, 2, 9, 10, 3, 12, 11, 4, 5]
+
+            for frame in frames:
+                scene.frame_set(frame)
+                verts, polys = self.evaluated_mesh_data(ob)
+                expect_verts, expect_polys = expect[frame]
+
+                self.assertEqual(expect_polys, polys, 'Topology differs at frame %d' % frame)
+                self.assertEqual(len(expect_verts), len(verts))
+                for co, expect_co in zip(verts, expect_verts):
+                    self.assertAlmostEqualFloatArray(co, expect_co, places=5)
+
+            # Release the archive before the temporary directory is removed.
+            bpy.ops.wm.open_mainfile(filepath=str(self.testdir / "empty.blend"))
+
+
 class VertexColourImportTest(AbstractAlembicTest):
     def test_import_from_houdini(self):
         # Houdini saved "face-varying", and as RGB.
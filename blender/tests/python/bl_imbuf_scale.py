@@ -0,0 +1,202 @@
+# Apache License, Version 2.0
+
+# ./blender.bin --background -noaudio --factory-startup --python tests/python/bl_imbuf_scale.py -- --verbose
+import unittest
+
+import bpy
+import numpy as np
+
+
+# Reference for the box filter of IMB_scaleImBuf: the serial scaledown/scaleup loops from
+# before the scaling passes were made separable and threaded, ported to float32 arithmetic.
+# Lines are arrays of shape (lines, length, 4), all lines step through the same samples.
+
+def ref_scale_down(lines, newlen, is_byte):
+    length = lines.shape[1]
+    add = np.float32((length - 0.01) / newlen)
+    out = np.zeros((lines.shape[0], newlen, 4), dtype=np.float32)
+
+    sample = np.float32(0.0)
+    val = np.zeros((lines.shape[0], 4), dtype=np.float32)
+    i = 0
+    for x in range(newlen):
+        nval = -val * sample
+        sample = np.float32(sample + add)
+        while sample >= 1.0:
+            sample = np.float32(sample - np.float32(1.0))
+            nval = nval + lines[:, i]
+            i += 1
+        val = lines[:, i].copy()
+        i += 1
+        res = (nval + sample * val) / add
+        out[:, x] = np.floor(res + np.float32(0.5)) if is_byte else res
+        sample = np.float32(sample - np.float32(1.0))
+
+    # Same check as the bug #26502 asserts, all source pixels are consumed.
+    assert i == length
+    return out
+
+
+def ref_scale_up(lines, newlen, is_byte):
+    length = lines.shape[1]
+    add = np.float32((length - 1.001) / (newlen - 1.0))
+    out = np.zeros((lines.shape[0], newlen, 4), dtype=np.float32)
+    half = np.float32(0.5) if is_byte else np.float32(0.0)
+
+    sample = np.float32(0.0)
+    nval = lines[:, 1].copy()
+    diff = nval - lines[:, 0]
+    val = lines[:, 0] + half
+    i = 2
+    for x in range(newlen):
+        if sample >= 1.0:
+            sample = np.float32(sample - np.float32(1.0))
+            val = nval
+            nval = lines[:, i].copy()
+            diff = nval - val
+            val = val + half
+            i += 1
+        res = val + sample * diff
+        out[:, x] = np.floor(res) if is_byte else res
+        sample = np.float32(sample + add)
+
+    return out
+
+
+def ref_scale(pixels, newx, newy, is_byte):
+    # pixels has shape (y, x, 4), scaled in the same order as IMB_scaleImBuf.
+    if newx < pixels.shape[1]:
+        pixels = ref_scale_down(pixels, newx, is_byte)
+    if newy < pixels.shape[0]:
+        pixels = ref_scale_down(pixels.transpose(1, 0, 2), newy, is_byte).transpose(1, 0, 2)
+    if newx > pixels.shape[1]:
+        pixels = ref_scale_up(pixels, newx, is_byte)
+    if newy > pixels.shape[0]:
+        pixels = ref_scale_up(pixels.transpose(1, 0, 2), newy, is_byte).transpose(1, 0, 2)
+    return pixels
+
+
+# Reference for the bilinear and Lanczos filters: the same separable resampler written as one
+# weight matrix per axis, taps outside of the image are folded onto the edge pixels.
+
+FILTER_RADIUS = {'BILINEAR': 1.0, 'LANCZOS': 3.0}
+
+
+def ref_filter_weight(filter, x):
+    x = np.abs(x)
+    if filter == 'BILINEAR':
+        return np.where(x < 1.0, 1.0 - x, 0.0)
+    px = np.pi * np.maximum(x, 1e-6)
+    weight = 3.0 * np.sin(px) * np.sin(px / 3.0) / (px * px)
+    return np.where(x < 1e-6, 1.0, np.where(x >= 3.0, 0.0, weight))
+
+
+def ref_filter_matrix(filter, length, newlen):
+    if length == newlen:
+        return np.identity(length)
+
+    scale = length / newlen
+    filter_scale = max(scale, 1.0)
+    support = FILTER_RADIUS[filter] * filter_scale
+    taps_max = int(np.ceil(support)) * 2 + 1
+
+    matrix = np.zeros((newlen, length))
+    for i in range(newlen):
+        center = (i + 0.5) * scale - 0.5
+        first = int(np.ceil(center - support))
+        last = min(int(np.floor(center + support)), first + taps_max - 1)
+        taps = np.arange(first, last + 1)
+        weights = ref_filter_weight(filter, (taps - center) / filter_scale)
+        np.add.at(matrix[i], np.clip(taps, 0, length - 1), weights)
+        if weights.sum() != 0.0:
+            matrix[i] /= weights.sum()
+    return matrix
+
+
+def ref_scale_filter(pixels, newx, newy, filter, is_byte):
+    # Horizontal pass first, then vertical, like scale_filter().
+    height, width = pixels.shape[:2]
+    pixels = np.einsum('ij,yjc->yic', ref_filter_matrix(filter, width, newx), pixels)
+    pixels = np.einsum('ij,jxc->ixc', ref_filter_matrix(filter, height, newy), pixels)
+    return np.floor(np.clip(pixels, 0.0, 255.0) + 0.5) if is_byte else pixels
+
+
+class ImBufScaleTest(unittest.TestCase):
+    # Large enough for the passes to run threaded and for vertical passes to use several
+    # strips of columns, including a partial last one.
+    SIZE = (300, 200)
+    NEW_SIZES = (
+        (150, 90),
+        (517, 411),
+        (640, 131),
+        (129, 200),
+        (300, 450),
+        (20, 411),
+    )
+
+    def image_create(self, is_byte):
+        rng = np.random.RandomState(0)
+        width, height = self.SIZE
+        image = bpy.data.images.new("scale", width, height, alpha=True, float_buffer=not is_byte)
+
+        if is_byte:
+            pixels = rng.randint(0, 256, (height, width, 4)).astype(np.float32)
+            image.pixels[:] = (pixels / 255.0).ravel()
+        else:
+            pixels = (rng.random_sample((height, width, 4)) * 4.0 - 1.0).astype(np.float32)
+            image.pixels[:] = pixels.ravel()
+
+        return image, pixels
+
+    def image_pixels(self, image, is_byte):
+        width, height = image.size
+        pixels = np.array(image.pixels[:], dtype=np.float32).reshape(height, width, 4)
+        return np.round(pixels * 255.0) if is_byte else pixels
+
+    def check_scale(self, filter, is_byte):
+        for newx, newy in self.NEW_SIZES:
+            image, pixels = self.image_create(is_byte)
+            image.scale(newx, newy, filter=filter)
+
+            self.assertEqual(tuple(image.size), (newx, newy))
+
+            result = self.image_pixels(image, is_byte)
+            msg = "%s %dx%d -> %dx%d" % (filter, self.SIZE[0], self.SIZE[1], newx, newy)
+
+            if filter == 'BOX':
+                # Box scaling does the same float arithmetic per pixel as before,
+                # results are identical.
+                expect = ref_scale(pixels, newx, newy, is_byte)
+                np.testing.assert_array_equal(result, expect, err_msg=msg)
+            else:
+                # Sums are accumulated in a different order than the reference,
+                # bytes may round to the neighboring value.
+                expect = ref_scale_filter(pixels.astype(np.float64), newx, newy, filter, is_byte)
+                np.testing.assert_allclose(
+                    result, expect, rtol=0.0, atol=1.0 if is_byte else 1e-4, err_msg=msg)
+
+            bpy.data.images.remove(image)
+
+    def test_box_byte(self):
+        self.check_scale('BOX', True)
+
+    def test_box_float(self):
+        self.check_scale('BOX', False)
+
+    def test_bilinear_byte(self):
+        self.check_scale('BILINEAR', True)
+
+    def test_bilinear_float(self):
+        self.check_scale('BILINEAR', False)
+
+    def test_lanczos_byte(self):
+        self.check_scale('LANCZOS', True)
+
+    def test_lanczos_float(self):
+        self.check_scale('LANCZOS', False)
+
+
+if __name__ == '__main__':
+    import sys
+    sys.argv = [__file__] + (sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else [])
+    unittest.main()
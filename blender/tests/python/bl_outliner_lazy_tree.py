@@ -0,0 +1,91 @@
+# Apache License, Version 2.0
+
+# ./blender.bin --background -noaudio --factory-startup --python tests/python/bl_outliner_lazy_tree.py -- --verbose
+import os
+import tempfile
+import unittest
+
+import bpy
+
+
+# Contents the outliner only builds once their parent element is opened: modifiers, constraints
+# and vertex groups of objects, objects below a closed collection.
+OBJECT_COUNT = 8
+
+
+def scene_populate():
+    scene = bpy.context.scene
+    collection = bpy.data.collections.new("Closed")
+    scene.collection.children.link(collection)
+    nested = bpy.data.collections.new("Nested")
+    collection.children.link(nested)
+
+    target = bpy.data.objects.new("Target", None)
+    scene.collection.objects.link(target)
+
+    for i in range(OBJECT_COUNT):
+        mesh = bpy.data.meshes.new("Mesh")
+        mesh.from_pydata([(0.0, 0.0, 0.0), (1.0, 0.0, 0.0), (0.0, 1.0, 0.0)], [], [(0, 1, 2)])
+        ob = bpy.data.objects.new("Object", mesh)
+        (nested if i % 2 else collection).objects.link(ob)
+
+        ob.modifiers.new("Subdivision", 'SUBSURF')
+        ob.modifiers.new("Bevel", 'BEVEL')
+        constraint = ob.constraints.new('COPY_LOCATION')
+        constraint.target = target
+        ob.vertex_groups.new(name="Group")
+
+    return scene
+
+
+def outliner_context():
+    window = bpy.context.window_manager.windows[0]
+    screen = window.screen
+    area = next(area for area in screen.areas if area.type == 'OUTLINER')
+    region = next(region for region in area.regions if region.type == 'WINDOW')
+    return {'window': window, 'screen': screen, 'area': area, 'region': region}
+
+
+def outliner_build_tree():
+    """Adds a collection, the operator builds the tree to find the selected collection.
+
+    Nothing is selected in the tree, so the collection is added to the scene collection.
+    """
+    scene = bpy.context.scene
+    collections_len = len(scene.collection.children)
+    result = bpy.ops.outliner.collection_new(outliner_context(), nested=True)
+    return result == {'FINISHED'} and len(scene.collection.children) == collections_len + 1
+
+
+class OutlinerLazyTreeTest(unittest.TestCase):
+    def setUp(self):
+        bpy.ops.wm.read_factory_settings()
+
+    def test_build(self):
+        scene_populate()
+        self.assertTrue(outliner_build_tree())
+
+        # Scene contents change, the tree is built again with the new objects.
+        ob = bpy.data.objects.new("Added", None)
+        bpy.data.collections["Nested"].objects.link(ob)
+        bpy.context.view_layer.update()
+        self.assertTrue(outliner_build_tree())
+
+    def test_build_after_reload(self):
+        # A file read keeps the stored tree state but must not reuse a tree built before it.
+        scene_populate()
+        self.assertTrue(outliner_build_tree())
+
+        with tempfile.TemporaryDirectory() as tempdir:
+            filepath = os.path.join(tempdir, "outliner.blend")
+            bpy.ops.wm.save_mainfile(filepath=filepath)
+            bpy.ops.wm.open_mainfile(filepath=filepath, load_ui=True)
+
+        self.assertIn("Closed", bpy.data.collections)
+        self.assertTrue(outliner_build_tree())
+
+
+if __name__ == '__main__':
+    import sys
+    sys.argv = [__file__] + (sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else [])
+    unittest.main()
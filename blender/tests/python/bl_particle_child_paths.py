@@ -0,0 +1,84 @@
+# Apache License, Version 2.0
+
+# ./blender.bin --background -noaudio --factory-startup --python tests/python/bl_particle_child_paths.py -- --verbose
+import unittest
+
+import bpy
+
+
+# A small groom: an emitter deformed by a wave, so parents move on every frame while
+# the children keep their distribution.
+PARENT_COUNT = 100
+CHILD_COUNT = 10
+FRAME_COUNT = 3
+
+
+def groom_create():
+    size = 21
+    step = 2.0 / (size - 1)
+    verts = [(x * step - 1.0, y * step - 1.0, 0.0) for y in range(size) for x in range(size)]
+    faces = [(y * size + x, y * size + x + 1, (y + 1) * size + x + 1, (y + 1) * size + x)
+             for y in range(size - 1) for x in range(size - 1)]
+
+    mesh = bpy.data.meshes.new("Scalp")
+    mesh.from_pydata(verts, [], faces)
+    mesh.update()
+
+    ob = bpy.data.objects.new("Scalp", mesh)
+    bpy.context.scene.collection.objects.link(ob)
+
+    wave = ob.modifiers.new("Wave", 'WAVE')
+    wave.height = 0.2
+    wave.width = 0.5
+
+    ob.modifiers.new("Groom", 'PARTICLE_SYSTEM')
+    part = ob.particle_systems[0].settings
+    part.type = 'HAIR'
+    part.count = PARENT_COUNT
+    part.hair_length = 0.3
+    part.child_type = 'INTERPOLATED'
+    part.child_nbr = CHILD_COUNT
+    part.clump_factor = 0.5
+    part.kink = 'CURL'
+    part.kink_amplitude = 0.02
+    part.roughness_1 = 0.01
+
+    return ob
+
+
+def child_positions(ob):
+    """Tip positions of all children."""
+    depsgraph = bpy.context.evaluated_depsgraph_get()
+    ob_eval = ob.evaluated_get(depsgraph)
+    psys = ob_eval.particle_systems[0]
+    parents = len(psys.particles)
+    tip = 1 << psys.settings.display_step
+    return [tuple(psys.co_hair(ob_eval, particle_no=parents + i, step=tip))
+            for i in range(len(psys.child_particles))]
+
+
+class ParticleChildPathsTest(unittest.TestCase):
+    def test_groom_playback(self):
+        scene = bpy.context.scene
+        ob = groom_create()
+
+        # The first frame distributes the children and fills the child parameter cache.
+        for frame in range(1, FRAME_COUNT + 1):
+            scene.frame_set(frame)
+
+        positions = child_positions(ob)
+        self.assertEqual(len(positions), PARENT_COUNT * CHILD_COUNT)
+
+        # Tagging the particle settings rebuilds the cached child parameters,
+        # paths must be the same as the ones computed from the cache during playback.
+        part = ob.particle_systems[0].settings
+        part.clump_factor = part.clump_factor
+        bpy.context.view_layer.update()
+
+        self.assertEqual(child_positions(ob), positions)
+
+
+if __name__ == '__main__':
+    import sys
+    sys.argv = [__file__] + (sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else [])
+    unittest.main()
@@ -0,0 +1,106 @@
+# Apache License, Version 2.0
+
+# ./blender.bin --background -noaudio --factory-startup --python tests/python/bl_physics_cloth.py -- --verbose
+import subprocess
+import sys
+import unittest
+
+import bpy
+
+
+# A square garment of 33 * 33 = 1089 vertices pinned along one edge, just enough vertices for
+# the solver to use its threaded vector operations.
+GARMENT_SIZE = 33
+FRAME_COUNT = 4
+# The solver sums dot products per block of vertices, which is not bit-identical
+# to summing them in a single loop.
+TOLERANCE = 1e-4
+
+
+def garment_create():
+    size = GARMENT_SIZE
+    step = 2.0 / (size - 1)
+    verts = [(x * step - 1.0, y * step - 1.0, 0.0) for y in range(size) for x in range(size)]
+    faces = [(y * size + x, y * size + x + 1, (y + 1) * size + x + 1, (y + 1) * size + x)
+             for y in range(size - 1) for x in range(size - 1)]
+
+    mesh = bpy.data.meshes.new("Garment")
+    mesh.from_pydata(verts, [], faces)
+    mesh.update()
+
+    ob = bpy.data.objects.new("Garment", mesh)
+    bpy.context.scene.collection.objects.link(ob)
+
+    pin = ob.vertex_groups.new(name="Pin")
+    pin.add(range((size - 1) * size, size * size), 1.0, 'REPLACE')
+
+    cloth = ob.modifiers.new("Cloth", 'CLOTH')
+    cloth.settings.vertex_group_mass = "Pin"
+    cloth.point_cache.frame_start = 1
+    cloth.point_cache.frame_end = FRAME_COUNT
+
+    return ob
+
+
+def garment_simulate():
+    """Steps the simulation frame by frame, returns the resulting vertex positions."""
+    scene = bpy.context.scene
+    ob = garment_create()
+
+    for frame in range(1, FRAME_COUNT + 1):
+        scene.frame_set(frame)
+
+    depsgraph = bpy.context.evaluated_depsgraph_get()
+    ob_eval = ob.evaluated_get(depsgraph)
+    mesh = ob_eval.to_mesh()
+    positions = [tuple(vert.co) for vert in mesh.vertices]
+    ob_eval.to_mesh_clear()
+
+    return positions
+
+
+class ClothSolverTest(unittest.TestCase):
+    def test_garment(self):
+        positions = garment_simulate()
+        self.assertEqual(len(positions), GARMENT_SIZE * GARMENT_SIZE)
+
+        # Pinned vertices stay in place, the free edge falls.
+        size = GARMENT_SIZE
+        step = 2.0 / (size - 1)
+        for x in range(size):
+            co = positions[(size - 1) * size + x]
+            self.assertAlmostEqual(co[0], x * step - 1.0, delta=TOLERANCE)
+            self.assertAlmostEqual(co[1], 1.0, delta=TOLERANCE)
+            self.assertAlmostEqual(co[2], 0.0, delta=TOLERANCE)
+            self.assertLess(positions[x][2], -TOLERANCE)
+
+        # The result of the threaded solver matches the one of a single thread.
+        command = [
+            bpy.app.binary_path,
+            '--background',
+            '-noaudio',
+            '--factory-startup',
+            '--threads', '1',
+            '--python', __file__,
+            '--',
+            '--simulate',
+        ]
+        output = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                                check=True).stdout.decode('utf8')
+        serial = [tuple(float(value) for value in line.split()[1:])
+                  for line in output.splitlines() if line.startswith("GARMENT ")]
+        self.assertEqual(len(serial), len(positions), output)
+
+        for co, co_serial in zip(positions, serial):
+            for value, value_serial in zip(co, co_serial):
+                self.assertAlmostEqual(value, value_serial, delta=TOLERANCE)
+
+
+if __name__ == '__main__':
+    argv = sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else []
+    if "--simulate" in argv:
+        for co in garment_simulate():
+            print("GARMENT %.6f %.6f %.6f" % co)
+    else:
+        sys.argv = [__file__] + argv
+        unittest.main()
@@ -0,0 +1,75 @@
+# Apache License, Version 2.0
+
+# ./blender.bin --background -noaudio --factory-startup --threads 4 --python tests/python/bl_sequencer_prefetch.py -- --verbose
+import os
+import tempfile
+import unittest
+
+import bpy
+import numpy as np
+
+
+# Animated strips, so every frame looks different and frames prefetched by one worker can't be
+# mistaken for frames of another one. Enough threads are needed for several workers.
+FRAME_COUNT = 24
+WIDTH, HEIGHT = 64, 32
+
+
+def scene_create(name, use_prefetch):
+    scene = bpy.data.scenes.new(name)
+    scene.frame_start = 1
+    scene.frame_end = FRAME_COUNT
+    scene.render.resolution_x = WIDTH
+    scene.render.resolution_y = HEIGHT
+    scene.render.resolution_percentage = 100
+    scene.render.use_sequencer = True
+    scene.render.image_settings.file_format = 'PNG'
+
+    ed = scene.sequence_editor_create()
+    ed.use_cache_final = True
+    ed.use_prefetch = use_prefetch
+
+    base = ed.sequences.new_effect("Base", 'COLOR', 1, frame_start=1, frame_end=FRAME_COUNT + 1)
+    base.color = (0.0, 0.0, 0.0)
+    base.keyframe_insert("color", frame=1)
+    base.color = (1.0, 0.5, 0.25)
+    base.keyframe_insert("color", frame=FRAME_COUNT)
+
+    over = ed.sequences.new_effect("Over", 'COLOR', 2, frame_start=1, frame_end=FRAME_COUNT + 1)
+    over.color = (0.0, 0.25, 1.0)
+    over.blend_type = 'ALPHA_OVER'
+    over.blend_alpha = 0.0
+    over.keyframe_insert("blend_alpha", frame=1)
+    over.blend_alpha = 1.0
+    over.keyframe_insert("blend_alpha", frame=FRAME_COUNT)
+
+    return scene
+
+
+def render_frames(scene, directory):
+    scene.render.filepath = os.path.join(directory, scene.name + "_")
+    bpy.ops.render.render(animation=True, scene=scene.name)
+
+    frames = []
+    for frame in range(1, FRAME_COUNT + 1):
+        image = bpy.data.images.load(scene.render.frame_path(frame=frame))
+        frames.append(np.array(image.pixels[:], dtype=np.float32))
+        bpy.data.images.remove(image)
+    return frames
+
+
+class SequencerPrefetchTest(unittest.TestCase):
+    def test_prefetch_frames(self):
+        with tempfile.TemporaryDirectory() as tempdir:
+            frames = render_frames(scene_create("Serial", False), tempdir)
+            frames_prefetch = render_frames(scene_create("Prefetch", True), tempdir)
+
+        self.assertFalse(np.array_equal(frames[0], frames[-1]))
+        for frame, (pixels, pixels_prefetch) in enumerate(zip(frames, frames_prefetch), 1):
+            self.assertTrue(np.array_equal(pixels, pixels_prefetch), "frame %d differs" % frame)
+
+
+if __name__ == '__main__':
+    import sys
+    sys.argv = [__file__] + (sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else [])
+    unittest.main()
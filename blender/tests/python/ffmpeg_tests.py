@@ -22,6 +22,8 @@
 import argparse
 import pathlib
 import sys
+import tempfile
+import textwrap
 import unittest
 
 from modules.test_utils import AbstractBlenderRunnerTest
@@ -101,6 +103,151 @@ class FPSDetectionTest(AbstractFFmpegSequencerTest):
             50)
 
 
+class AutosplitTest(AbstractFFmpegSequencerTest):
+    """Renders past the 2 GB autosplit size, so the output continues in further files."""
+
+    frame_count = 40
+    autosplit_size = 2000000000
+
+    def render_movie(self, outdir: pathlib.Path):
+        # Uncompressible noise, so every frame adds about 64 MB to the file.
+        script = textwrap.dedent("""\
+            import bpy
+            import numpy
+
+            scene = bpy.context.scene
+            width, height = 4096, 4096
+
+            image = bpy.data.images.new("Noise", width, height)
+            rng = numpy.random.RandomState(0)
+            image.pixels.foreach_set(rng.random_sample(width * height * 4).astype(numpy.float32))
+            image.filepath_raw = %r
+            image.file_format = 'PNG'
+            image.save()
+
+            scene.sequence_editor_create()
+            strip = scene.sequence_editor.sequences.new_image("Noise", image.filepath_raw, 1, 1)
+            strip.frame_final_duration = %d
+
+            scene.frame_start = 1
+            scene.frame_end = %d
+            scene.render.resolution_x = width
+            scene.render.resolution_y = height
+            scene.render.resolution_percentage = 100
+            scene.render.use_sequencer = True
+            scene.render.image_settings.file_format = 'FFMPEG'
+            scene.render.image_settings.color_mode = 'RGBA'
+            scene.render.ffmpeg.format = 'AVI'
+            scene.render.ffmpeg.codec = 'HUFFYUV'
+            scene.render.ffmpeg.use_autosplit = True
+            scene.render.filepath = %r
+
+            bpy.ops.render.render(animation=True)
+            """) % ((outdir / "noise.png").as_posix(),
+                    self.frame_count,
+                    self.frame_count,
+                    (outdir / "movie_").as_posix())
+        self.run_blender('', script)
+
+    def test_autosplit(self):
+        with tempfile.TemporaryDirectory() as tempdir:
+            outdir = pathlib.Path(tempdir)
+            self.render_movie(outdir)
+
+            movies = sorted(outdir.glob("movie_*.avi"))
+            self.assertGreaterEqual(len(movies), 2, "expected the render to be split")
+            self.assertGreater(movies[0].stat().st_size, self.autosplit_size)
+
+            durations = [self.get_movie_file_duration(movie) for movie in movies]
+            self.assertEqual(sum(durations), self.frame_count)
+
+
+class DecodeAheadTest(AbstractFFmpegSequencerTest):
+    """Reads a movie forwards, which decodes frames ahead, and backwards, which seeks.
+
+    Both must give the frames the movie was rendered from.
+    """
+
+    frame_count = 24
+
+    def test_decode_ahead(self):
+        with tempfile.TemporaryDirectory() as tempdir:
+            outdir = pathlib.Path(tempdir)
+            script = textwrap.dedent("""\
+                import os
+                import bpy
+                import numpy
+
+                frame_count = %d
+                outdir = %r
+
+                def scene_create(name):
+                    scene = bpy.data.scenes.new(name)
+                    scene.frame_start = 1
+                    scene.frame_end = frame_count
+                    scene.render.resolution_x = 64
+                    scene.render.resolution_y = 32
+                    scene.render.resolution_percentage = 100
+                    scene.render.use_sequencer = True
+                    scene.sequence_editor_create()
+                    return scene
+
+                def render_frames(scene, frames):
+                    scene.render.image_settings.file_format = 'PNG'
+                    result = {}
+                    for frame in frames:
+                        scene.frame_set(frame)
+                        filename = '%%s_%%04d.png' %% (scene.name, frame)
+                        scene.render.filepath = os.path.join(outdir, filename)
+                        bpy.ops.render.render(write_still=True, scene=scene.name)
+                        image = bpy.data.images.load(scene.render.filepath)
+                        result[frame] = numpy.array(image.pixels[:])
+                        bpy.data.images.remove(image)
+                    return result
+
+                frames = range(1, frame_count + 1)
+
+                # Each frame differs from the previous one by about 10 steps in red.
+                source = scene_create('Source')
+                strip = source.sequence_editor.sequences.new_effect(
+                    'Color', 'COLOR', 1, frame_start=1, frame_end=frame_count + 1)
+                strip.color = (0.0, 0.0, 0.0)
+                strip.keyframe_insert('color', frame=1)
+                strip.color = (1.0, 0.5, 0.25)
+                strip.keyframe_insert('color', frame=frame_count)
+
+                source.render.image_settings.file_format = 'FFMPEG'
+                source.render.ffmpeg.format = 'AVI'
+                source.render.ffmpeg.codec = 'HUFFYUV'
+                source.render.filepath = os.path.join(outdir, 'movie_')
+                bpy.ops.render.render(animation=True, scene=source.name)
+                movie = source.render.frame_path(frame=1)
+
+                reference = render_frames(source, frames)
+
+                # A scene per read order, so each one opens the movie anew.
+                forward = scene_create('Forward')
+                forward.sequence_editor.sequences.new_movie('Movie', movie, 1, 1)
+                backward = scene_create('Backward')
+                backward.sequence_editor.sequences.new_movie('Movie', movie, 1, 1)
+
+                result_forward = render_frames(forward, frames)
+                result_backward = render_frames(backward, reversed(frames))
+
+                for frame in frames:
+                    pixels = result_forward[frame]
+                    if not numpy.allclose(pixels, reference[frame], atol=2.0 / 255.0):
+                        print('MISMATCH forward %%d' %% frame)
+                    if not numpy.array_equal(pixels, result_backward[frame]):
+                        print('MISMATCH backward %%d' %% frame)
+                print('FRAMES %%d' %% len(result_forward))
+                """) % (self.frame_count, outdir.as_posix())
+            output = self.run_blender('', script)
+
+        self.assertIn('FRAMES %d' % self.frame_count, output)
+        self.assertNotIn('MISMATCH', output)
+
+
 if __name__ == '__main__':
     parser = argparse.ArgumentParser()
     parser.add_argument('--blender', required=True)
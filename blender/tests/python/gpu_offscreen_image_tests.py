@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+# Apache License, Version 2.0
+
+# Checks that offscreen renders never show the placeholder of an image texture
+# that the viewport is still loading in the background.
+
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+
+
+def render_textured_plane():
+    import bpy
+
+    output_path = sys.argv[-1]
+    texture_path = os.path.join(os.path.dirname(output_path), "texture.png")
+    scene = bpy.context.scene
+
+    # A large file image, so loading it in the background takes a while.
+    image = bpy.data.images.new("Texture", 2048, 2048)
+    image.generated_color = (1.0, 0.0, 0.0, 1.0)
+    image.filepath_raw = texture_path
+    image.file_format = 'PNG'
+    image.save()
+    bpy.data.images.remove(image)
+    image = bpy.data.images.load(texture_path)
+
+    bpy.data.objects.remove(bpy.data.objects["Cube"])
+    bpy.ops.mesh.primitive_plane_add(size=100.0)
+    plane = bpy.context.active_object
+
+    material = bpy.data.materials.new("Texture")
+    material.use_nodes = True
+    node_texture = material.node_tree.nodes.new('ShaderNodeTexImage')
+    node_texture.image = image
+    material.node_tree.nodes.active = node_texture
+    plane.data.materials.append(material)
+
+    scene.render.engine = 'BLENDER_WORKBENCH'
+    scene.display.shading.light = 'FLAT'
+    scene.display.shading.color_type = 'TEXTURE'
+    scene.view_settings.view_transform = 'Standard'
+
+    # Draw the viewport with the same texture first, which starts loading it
+    # in the background and draws a placeholder meanwhile.
+    for area in bpy.context.screen.areas:
+        if area.type == 'VIEW_3D':
+            area.spaces.active.shading.type = 'SOLID'
+            area.spaces.active.shading.light = 'FLAT'
+            area.spaces.active.shading.color_type = 'TEXTURE'
+    bpy.ops.wm.redraw_timer(type='DRAW_WIN_SWAP', iterations=1)
+
+    scene.render.filepath = output_path
+    scene.render.image_settings.file_format = 'PNG'
+    bpy.ops.render.opengl(write_still=True)
+
+    result = bpy.data.images.load(output_path)
+    width, height = result.size
+    offset = ((height // 2) * width + (width // 2)) * 4
+    red, green, blue = result.pixels[offset:offset + 3]
+    print("Center pixel: %.3f %.3f %.3f" % (red, green, blue))
+
+    ok = red > 0.9 and green < 0.1 and blue < 0.1
+    if not ok:
+        print("FAIL: offscreen render did not use the loaded texture")
+    sys.exit(0 if ok else 1)
+
+
+# When run from inside Blender, render and exit.
+try:
+    import bpy
+    inside_blender = True
+except ImportError:
+    inside_blender = False
+
+if inside_blender:
+    render_textured_plane()
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("-blender", nargs=1)
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as tempdir:
+        command = [
+            args.blender[0],
+            "--no-window-focus",
+            "--window-geometry",
+            "0", "0", "1024", "768",
+            "-noaudio",
+            "--factory-startup",
+            "-P",
+            os.path.realpath(__file__),
+            "--",
+            os.path.join(tempdir, "render.png")]
+        returncode = subprocess.call(command, timeout=300)
+
+    sys.exit(returncode)
+
+
+if __name__ == "__main__":
+    main()